@@ -10,7 +10,7 @@ import {
 import Slider from "@react-native-community/slider";
 import { Container, Button } from "../components";
 import { SessionManager } from "../audio/SessionManager";
-import { presets } from "../../testPresets";
+import { openPresetLibrary, getPreset } from "../audio/PresetLibrary";
 import NativeCustomNodesModule from "../../specs/NativeCustomNodesModule";
 import { DEFAULT_MASTER_VOLUME } from "../audio/AudioConfig";
 import { NoiseNode } from "./types";
@@ -21,7 +21,7 @@ const SessionTest = () => {
   const noiseNode = useRef<NoiseNode | null>(null);
   const [isReady, setIsReady] = useState(false);
 
-  const presetNames = Object.keys(presets);
+  const [presetNames, setPresetNames] = useState<string[]>([]);
   const durationOptions = [
     { value: 60, label: "1 minute" },
     { value: 300, label: "5 minutes" },
@@ -60,6 +60,9 @@ const SessionTest = () => {
       NativeCustomNodesModule.injectCustomProcessorInstaller();
     }
 
+    // List the presets from the preset library's index
+    setPresetNames(openPresetLibrary().map((entry) => entry.id));
+
     // Then create the session manager
     sessionManager.current = new SessionManager();
     const manager = sessionManager.current;
@@ -90,25 +93,61 @@ const SessionTest = () => {
     };
   }, []);
 
-  const handlePlay = () => {
+  // Selected preset with the selected duration
+  const selectedPreset = () => {
+    const presetName = presetNames[selectedPresetIndex];
+    const preset = presetName ? getPreset(presetName) : null;
+    if (!preset) return null;
+    return {
+      ...preset,
+      header: {
+        ...preset.header,
+        d: durationOptions[durationIndex].value,
+      },
+    };
+  };
+
+  // Prepare the selected session in the background while the user is still
+  // choosing, so that play starts it on the next quantum
+  useEffect(() => {
+    const manager = sessionManager.current;
+    const preset = selectedPreset();
+    if (!isReady || !manager || !preset || state !== "idle") return;
+
+    (async () => {
+      while (manager.preparing) {
+        await manager.preparing;
+      }
+      if (manager.state !== "idle") return;
+      manager.loadPreset(preset);
+      manager.prepare();
+    })();
+  }, [isReady, selectedPresetIndex, durationIndex, state]);
+
+  // Switching presets while playing moves the session to the new preset
+  // without stopping it
+  useEffect(() => {
+    const manager = sessionManager.current;
+    const preset = selectedPreset();
+    if (!manager || !preset || state !== "playing") return;
+    manager.applyPreset(preset);
+    setVoices(manager.getVoices());
+  }, [selectedPresetIndex]);
+
+  const handlePlay = async () => {
     const manager = sessionManager.current;
     if (!manager) return;
 
     if (state === "idle") {
-      const presetName = presetNames[selectedPresetIndex];
-      const preset = (presets as any)[presetName];
-      if (!preset) return;
-
-      // Load preset with custom duration
-      const customPreset = {
-        ...preset,
-        header: {
-          ...preset.header,
-          d: durationOptions[durationIndex].value,
-        },
-      };
-
-      manager.loadPreset(customPreset);
+      while (manager.preparing) {
+        await manager.preparing;
+      }
+      if (!manager.prepared) {
+        const preset = selectedPreset();
+        if (!preset) return;
+        manager.loadPreset(preset);
+        await manager.prepare();
+      }
       manager.start();
       setVoices(manager.getVoices());
     } else if (state === "paused") {
@@ -276,7 +315,7 @@ const SessionTest = () => {
                 <Pressable
                   style={[
                     styles.arrowButton,
-                    state !== "idle" && styles.disabledButton,
+                    state === "paused" && styles.disabledButton,
                   ]}
                   onPress={() =>
                     setSelectedPresetIndex(
@@ -284,7 +323,7 @@ const SessionTest = () => {
                         presetNames.length
                     )
                   }
-                  disabled={state !== "idle"}
+                  disabled={state === "paused"}
                 >
                   <Text style={styles.arrowText}>◀</Text>
                 </Pressable>
@@ -296,14 +335,14 @@ const SessionTest = () => {
                 <Pressable
                   style={[
                     styles.arrowButton,
-                    state !== "idle" && styles.disabledButton,
+                    state === "paused" && styles.disabledButton,
                   ]}
                   onPress={() =>
                     setSelectedPresetIndex(
                       (selectedPresetIndex + 1) % presetNames.length
                     )
                   }
-                  disabled={state !== "idle"}
+                  disabled={state === "paused"}
                 >
                   <Text style={styles.arrowText}>▶</Text>
                 </Pressable>
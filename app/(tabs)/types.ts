@@ -28,6 +28,7 @@ export interface IMartigliNode extends IAudioNode {
   currentInhaleDur: number;
   currentExhaleDur: number;
   currentPeriod: number;
+  breathingClock: IBreathingClock | null;
   shouldStart: boolean;
   shouldPause: boolean;
   shouldResume: boolean;
@@ -44,6 +45,7 @@ export interface IBinauralNode extends IAudioNode {
   panOscPeriod: number;
   panOscTrans: number;
   martigliAnimationValue: number;
+  breathingClock: IBreathingClock | null;
   isPaused: boolean;
   shouldStart: boolean;
   shouldPause: boolean;
@@ -60,6 +62,8 @@ export interface ISymmetryNode extends IAudioNode {
   waveform: number;
   permfunc: number;
   volume: number;
+  release: number; // seconds of release tail after each note; 0 = automatic
+  seed: number; // write-only, fixes the shuffle order
   shouldStart: boolean;
   shouldPause: boolean;
   shouldResume: boolean;
@@ -88,6 +92,7 @@ export interface IMartigliBinauralNode extends IAudioNode {
   currentInhaleDur: number;
   currentExhaleDur: number;
   currentPeriod: number;
+  breathingClock: IBreathingClock | null;
   shouldStart: boolean;
   shouldPause: boolean;
   shouldResume: boolean;
@@ -97,9 +102,296 @@ export interface IMartigliBinauralNode extends IAudioNode {
 export interface INoiseNode extends IAudioNode {
   noiseColor: number; // 0=white, 1=pink, 2=brown
   volume: number;
+  seed: number; // write-only, fixes the noise sequence
   isPaused: boolean;
 }
 
+export interface ISampleNode extends IAudioNode {
+  volume: number;
+  loop: boolean;
+  loopStart: number; // file frames
+  loopEnd: number; // file frames, <= 0 for end of file
+  loopCrossfade: number; // seconds
+  playbackRate: number;
+  readonly frames: number;
+  readonly channels: number;
+  readonly fileSampleRate: number;
+  readonly position: number; // seconds
+  isPaused: boolean;
+  shouldStart: boolean;
+  shouldPause: boolean;
+  shouldResume: boolean;
+  shouldStop: boolean;
+  load(path: string): boolean;
+}
+
+export interface IVoiceMixNode extends IAudioNode {
+  voiceCount: number;
+  sharedVoiceCount: number;
+  parallelThreshold: number;
+  parallel: boolean;
+  isReplaying: boolean;
+  animationValue: number;
+  adaptiveQuality: boolean;
+  qualityTier: QualityTier;
+  shouldStart: boolean;
+  shouldPause: boolean;
+  shouldResume: boolean;
+  shouldStop: boolean;
+  qualityReport(): QualityReport;
+  addVoice(voice: IAudioNode): boolean;
+  removeVoice(voice: IAudioNode): void;
+  clearVoices(): void;
+  useRenderCache(
+    descriptor: string,
+    durationSeconds: number,
+    seed?: number
+  ): RenderCacheMode;
+  finishRenderCache(): void;
+  addModulation(
+    source: IAudioNode,
+    signal: string,
+    target: IAudioNode,
+    param: string,
+    depth?: number,
+    offset?: number
+  ): number;
+  removeModulation(id: number): void;
+  clearModulations(): void;
+  shareIdenticalVoices(): number;
+}
+
+export interface IMasterBusNode extends IAudioNode {
+  gain: number;
+  limiter: boolean;
+  threshold: number;
+  readonly peak: number;
+  readonly rms: number;
+  readonly limitedSamples: number;
+}
+
+// Breathing LFO shared by breath-locked voices (Martigli, Martigli-Binaural,
+// Binaural with panOsc 3). Attached with `node.breathingClock = clock`; while
+// attached, the clock's parameters replace the voice's own mp0/mp1/md/inhale/exhale.
+export interface IBreathingClock {
+  mp0: number;
+  mp1: number;
+  md: number;
+  inhaleDur: number;
+  exhaleDur: number;
+  readonly animationValue: number;
+  readonly currentPeriod: number;
+  readonly currentInhaleDur: number;
+  readonly currentExhaleDur: number;
+  readonly isRunning: boolean;
+}
+
+export interface FastMathAccuracyResult {
+  function: string;
+  tier: "fast" | "balanced" | "precise" | "reference";
+  maxAbsError: number;
+  maxErrorDb: number;
+  maxErrorCents: number;
+  nanosPerCall: number;
+}
+
+// Per-node processing time over the last 512 blocks (debug builds only)
+export interface DspLoadResult {
+  node: string; // e.g. "Binaural#3"
+  blocks: number;
+  meanMicros: number;
+  p99Micros: number;
+  maxMicros: number;
+  budgetPercent: number; // mean share of the block's real-time budget
+  peakBudgetPercent: number;
+}
+
+export interface TraceSummary {
+  path: string;
+  events: number; // written to the file
+  dropped: number; // lost because the ring was full
+}
+
+export interface GlitchCapture {
+  kind: "jump" | "nonFinite" | "deadlineMiss";
+  channel: number;
+  frame: number; // frames the node had output before this one
+  previous: number;
+  value: number; // deadlineMiss: callback gap in microseconds
+  threshold: number; // deadlineMiss: block duration in microseconds
+  samples: number[]; // output around the frame
+}
+
+// Output discontinuities of each custom node (always on)
+export interface GlitchResult {
+  node: string; // e.g. "Symmetry#2"
+  blocks: number;
+  jumps: number;
+  nonFinite: number;
+  deadlineMisses: number;
+  recent: GlitchCapture[];
+}
+
+export interface RealtimeSafetyViolation {
+  what: string; // "malloc", "pthread_mutex_lock", "printf", ...
+  node: string; // node kind whose processNode made the call
+  stack: string[]; // innermost frame first
+}
+
+// Only populated in builds with CUSTOM_NODES_RT_CHECK=1
+export interface RealtimeSafetyReport {
+  enabled: boolean;
+  total: number;
+  recent: RealtimeSafetyViolation[];
+}
+
+// 0 verbose, 1 debug, 2 info, 3 warn, 4 error, 5 none
+export type NativeLogLevel = 0 | 1 | 2 | 3 | 4 | 5;
+
+// Voice types as named in presets
+export type PooledVoiceType =
+  | "Martigli"
+  | "Martigli-Binaural"
+  | "Binaural"
+  | "Symmetry"
+  | "Noise"
+  | "Sample";
+
+export interface VoicePoolStats {
+  kind: PooledVoiceType;
+  idle: number; // nodes waiting in the pool
+  created: number; // nodes constructed because the pool was empty
+  reused: number; // nodes handed out from the pool
+}
+
+// Startup phases timed from JS; "play" opens a new attempt
+export type StartupMarker =
+  | "audioContextCreated"
+  | "play"
+  | "voicesCreated"
+  | "voicesConfigured"
+  | "renderCacheStarted";
+
+// Times in milliseconds since the native module was created
+export interface StartupPhase {
+  name: string; // a StartupMarker, or a native phase ("injectInstallers", "constructNode", "prepareSession"...)
+  subject?: string; // voice type of constructNode / prewarmNode
+  startMs: number;
+  durationMs: number; // 0 for instants
+}
+
+export interface NodeStartup {
+  node: string; // as in the glitch report, e.g. "Binaural#3"
+  firstBlockMs: number;
+  firstSoundMs: number | null; // null while the node has only output silence
+}
+
+export interface StartupReport {
+  playMs: number | null; // last markStartup("play")
+  timeToFirstAudioMs: number | null; // from play to the first non-silent sample
+  phases: StartupPhase[]; // oldest first
+  nodes: NodeStartup[]; // nodes that ran since play
+}
+
+// Result of createPresetVoices(), voices in preset order
+export interface PresetVoices {
+  duration: number;
+  seed: number;
+  voices: {
+    type: PooledVoiceType | null; // null for voice types this build does not know
+    node: IAudioNode | null; // null if the voice could not be created
+  }[];
+}
+
+// Result of applyPresetDiff(), voices in the new preset's order
+export interface PresetDiff {
+  duration: number;
+  seed: number;
+  changed: number; // parameters written to retargeted voices
+  voices: {
+    type: PooledVoiceType | null;
+    previous: number; // index of the retargeted running voice, or -1
+    node: IAudioNode | null; // new voice when previous is -1, else null
+  }[];
+  removed: number[]; // running voices the preset no longer has
+}
+
+// Preset library (shared/PresetLibrary.h)
+export interface PresetLibraryLocation {
+  path?: string; // default: presets.cnpl in the app's cache directory
+  tag: string; // what the library is built from; another tag is stale
+}
+
+export interface PresetLibrarySource {
+  id: string;
+  name: string;
+  preset: ArrayBuffer; // encodePreset()
+  meta: string; // JSON
+}
+
+export interface PresetLibraryEntry {
+  id: string;
+  name: string;
+  duration: number;
+  voices: number;
+}
+
+// Voice quality under render load (shared/QualityGovernor.h):
+// 0 full, 1 fast sines and a cheaper pink filter, 2 also control-rate panning
+export type QualityTier = 0 | 1 | 2;
+
+export interface QualityReport {
+  tier: QualityTier;
+  adaptive: boolean; // false: the tier stays where it was set
+  loadPercent: number; // smoothed render time / quantum duration
+  peakPercent: number; // worst quantum since the previous report
+  stepsDown: number;
+  stepsUp: number;
+  holdSeconds: number; // low load needed before the next step up
+}
+
+// Static CPU cost of a preset (shared/CostModel.h), in nanoseconds of audio
+// thread time per frame
+export interface PresetCost {
+  nanosPerFrame: number;
+  budgetPercent: number; // of real time at the sample rate
+  fits: boolean; // within the budgetPercent option
+  sharedVoices: number; // identical voices the mixer renders once
+  calibrated: boolean; // false: built-in coefficients, not timed on this device
+  voices: {
+    type: PooledVoiceType | null;
+    nanosPerFrame: number;
+    shared: boolean;
+  }[];
+}
+
+export interface CostModelCoefficients {
+  martigli: number[]; // by waveform, panOsc 0
+  martigliBinaural: number[];
+  binaural: number[];
+  symmetry: number[];
+  noise: number[]; // by noiseColor
+  pan: number[]; // added by panOsc mode
+  sample: number;
+  symmetryEvent: number; // per note on or off
+  mix: number;
+  calibrated: boolean;
+}
+
+export type RenderCacheMode = "replay" | "record" | "off";
+
+export interface RenderCacheInfo {
+  directory: string;
+  maxBytes: number;
+  usedBytes: number;
+}
+
+export interface VoiceRenderingBenchmarkResult {
+  voices: number;
+  serialMicros: number;
+  parallelMicros: number;
+}
+
 // Helper to create property accessors
 const createProp = (node: IAudioNode, name: string) => ({
   get: () => (node as any)[name],
@@ -225,6 +517,12 @@ export class MartigliNode extends AudioNode {
   get currentPeriod() {
     return this.n.currentPeriod;
   }
+  get breathingClock() {
+    return this.n.breathingClock;
+  }
+  set breathingClock(v: IBreathingClock | null) {
+    this.n.breathingClock = v;
+  }
 
   start() {
     this.n.shouldStart = true;
@@ -302,6 +600,12 @@ export class BinauralNode extends AudioNode {
   set martigliAnimationValue(v: number) {
     this.n.martigliAnimationValue = v;
   }
+  get breathingClock() {
+    return this.n.breathingClock;
+  }
+  set breathingClock(v: IBreathingClock | null) {
+    this.n.breathingClock = v;
+  }
   get isPaused() {
     return this.n.isPaused;
   }
@@ -370,6 +674,15 @@ export class SymmetryNode extends AudioNode {
   set volume(v: number) {
     this.n.volume = v;
   }
+  get release() {
+    return this.n.release;
+  }
+  set release(v: number) {
+    this.n.release = v;
+  }
+  set seed(v: number) {
+    this.n.seed = v;
+  }
 
   start() {
     this.n.shouldStart = true;
@@ -498,6 +811,12 @@ export class MartigliBinauralNode extends AudioNode {
   get currentPeriod() {
     return this.n.currentPeriod;
   }
+  get breathingClock() {
+    return this.n.breathingClock;
+  }
+  set breathingClock(v: IBreathingClock | null) {
+    this.n.breathingClock = v;
+  }
 
   start() {
     this.n.shouldStart = true;
@@ -533,6 +852,9 @@ export class NoiseNode extends AudioNode {
   set volume(v: number) {
     this.n.volume = v;
   }
+  set seed(v: number) {
+    this.n.seed = v;
+  }
   get isPaused() {
     return this.n.isPaused;
   }
@@ -551,6 +873,264 @@ export class NoiseNode extends AudioNode {
   }
 }
 
+// Plays a WAV file straight from its memory mapping (nothing is decoded
+// into memory up front), optionally looping with a crossfaded seam.
+export class SampleNode extends AudioNode {
+  private n: ISampleNode;
+
+  constructor(context: BaseAudioContext, node: ISampleNode) {
+    super(context, node);
+    this.n = node;
+  }
+
+  load(path: string) {
+    return this.n.load(path);
+  }
+
+  get volume() {
+    return this.n.volume;
+  }
+  set volume(v: number) {
+    this.n.volume = v;
+  }
+  get loop() {
+    return this.n.loop;
+  }
+  set loop(v: boolean) {
+    this.n.loop = v;
+  }
+  get loopStart() {
+    return this.n.loopStart;
+  }
+  set loopStart(v: number) {
+    this.n.loopStart = v;
+  }
+  get loopEnd() {
+    return this.n.loopEnd;
+  }
+  set loopEnd(v: number) {
+    this.n.loopEnd = v;
+  }
+  get loopCrossfade() {
+    return this.n.loopCrossfade;
+  }
+  set loopCrossfade(v: number) {
+    this.n.loopCrossfade = v;
+  }
+  get playbackRate() {
+    return this.n.playbackRate;
+  }
+  set playbackRate(v: number) {
+    this.n.playbackRate = v;
+  }
+  get frames() {
+    return this.n.frames;
+  }
+  get channels() {
+    return this.n.channels;
+  }
+  get fileSampleRate() {
+    return this.n.fileSampleRate;
+  }
+  get position() {
+    return this.n.position;
+  }
+  get isPaused() {
+    return this.n.isPaused;
+  }
+
+  start() {
+    this.n.shouldStart = true;
+  }
+  pause() {
+    this.n.shouldPause = true;
+  }
+  resume() {
+    this.n.shouldResume = true;
+  }
+  stop() {
+    this.n.shouldStop = true;
+  }
+}
+
+// Renders the voices added to it (instead of connecting each voice to the
+// destination) and sums them, spreading larger voice stacks across cores.
+export class VoiceMixNode extends AudioNode {
+  private n: IVoiceMixNode;
+
+  constructor(context: BaseAudioContext, node: IVoiceMixNode) {
+    super(context, node);
+    this.n = node;
+  }
+
+  get voiceCount() {
+    return this.n.voiceCount;
+  }
+  // Voices rendered through an identical voice (shareIdenticalVoices)
+  get sharedVoiceCount() {
+    return this.n.sharedVoiceCount;
+  }
+  get parallelThreshold() {
+    return this.n.parallelThreshold;
+  }
+  set parallelThreshold(v: number) {
+    this.n.parallelThreshold = v;
+  }
+  get parallel() {
+    return this.n.parallel;
+  }
+  set parallel(v: boolean) {
+    this.n.parallel = v;
+  }
+  get isReplaying() {
+    return this.n.isReplaying;
+  }
+  get animationValue() {
+    return this.n.animationValue;
+  }
+  // Lowers the voices' quality tier when rendering nears the quantum's
+  // duration, and raises it back once the load stays low. Off: the tier
+  // stays at qualityTier.
+  get adaptiveQuality() {
+    return this.n.adaptiveQuality;
+  }
+  set adaptiveQuality(v: boolean) {
+    this.n.adaptiveQuality = v;
+  }
+  get qualityTier() {
+    return this.n.qualityTier;
+  }
+  set qualityTier(v: QualityTier) {
+    this.n.qualityTier = v;
+  }
+  // The governor's load since the previous report
+  qualityReport() {
+    return this.n.qualityReport();
+  }
+
+  addVoice(voice: AudioNode) {
+    return this.n.addVoice((voice as any).node);
+  }
+  removeVoice(voice: AudioNode) {
+    this.n.removeVoice((voice as any).node);
+  }
+  clearVoices() {
+    this.n.clearVoices();
+  }
+
+  // Prepares voices that are not added yet, and the render cache for
+  // useRenderCache(descriptor, duration, seed), on a native background thread
+  prepareSession(
+    voices: AudioNode[],
+    descriptor: string,
+    duration: number,
+    seed: number
+  ): Promise<RenderCacheMode> {
+    return global.prepareSession(this.n, {
+      voices: voices.map((voice) => (voice as any).node),
+      descriptor,
+      duration,
+      seed,
+    });
+  }
+
+  // Drives target's param from source's signal once per block:
+  // param = base + offset + depth * signal, base being the parameter's own
+  // value (writes to it while routed move the base; it is restored when the
+  // last route goes). Both voices must be added first.
+  // Signals: breath (Martigli types), gate (Symmetry), envelope, level.
+  // Returns the route id, or -1 if a name is unknown.
+  addModulation(
+    source: AudioNode,
+    signal: string,
+    target: AudioNode,
+    param: string,
+    depth = 1,
+    offset = 0
+  ) {
+    return this.n.addModulation(
+      (source as any).node,
+      signal,
+      (target as any).node,
+      param,
+      depth,
+      offset
+    );
+  }
+  removeModulation(id: number) {
+    this.n.removeModulation(id);
+  }
+  clearModulations() {
+    this.n.clearModulations();
+  }
+  // Renders identical voices once. Call after the voices and modulations
+  // are added, before the voices start.
+  shareIdenticalVoices() {
+    return this.n.shareIdenticalVoices();
+  }
+
+  // Replays a cached rendering of the same session if there is one,
+  // otherwise records this one. Call after the voices are configured.
+  useRenderCache(descriptor: string, durationSeconds: number, seed = 0) {
+    return this.n.useRenderCache(descriptor, durationSeconds, seed);
+  }
+  finishRenderCache() {
+    this.n.finishRenderCache();
+  }
+
+  start() {
+    this.n.shouldStart = true;
+  }
+  pause() {
+    this.n.shouldPause = true;
+  }
+  resume() {
+    this.n.shouldResume = true;
+  }
+  stop() {
+    this.n.shouldStop = true;
+  }
+}
+
+// Master gain (smoothed natively), soft limiter and output meters, between
+// the session's VoiceMixNode and the destination.
+export class MasterBusNode extends AudioNode {
+  private n: IMasterBusNode;
+
+  constructor(context: BaseAudioContext, node: IMasterBusNode) {
+    super(context, node);
+    this.n = node;
+  }
+
+  get gain() {
+    return this.n.gain;
+  }
+  set gain(v: number) {
+    this.n.gain = v;
+  }
+  get limiter() {
+    return this.n.limiter;
+  }
+  set limiter(v: boolean) {
+    this.n.limiter = v;
+  }
+  get threshold() {
+    return this.n.threshold;
+  }
+  set threshold(v: number) {
+    this.n.threshold = v;
+  }
+  get peak() {
+    return this.n.peak;
+  }
+  get rms() {
+    return this.n.rms;
+  }
+  get limitedSamples() {
+    return this.n.limitedSamples;
+  }
+}
+
 declare global {
   var createMyOscillatorNode: (context: IBaseAudioContext) => IMyOscillatorNode;
   var createMartigliNode: (context: IBaseAudioContext) => IMartigliNode;
@@ -560,4 +1140,69 @@ declare global {
     context: IBaseAudioContext
   ) => IMartigliBinauralNode;
   var createNoiseNode: (context: IBaseAudioContext) => INoiseNode;
+  var createSampleNode: (context: IBaseAudioContext) => ISampleNode;
+  var createVoiceMixNode: (context: IBaseAudioContext) => IVoiceMixNode;
+  var createMasterBusNode: (context: IBaseAudioContext) => IMasterBusNode;
+  var benchmarkVoiceRendering: (
+    maxVoices?: number,
+    frames?: number,
+    iterations?: number
+  ) => VoiceRenderingBenchmarkResult[];
+  var configureRenderCache: (options?: {
+    directory?: string;
+    maxBytes?: number;
+    clear?: boolean;
+  }) => RenderCacheInfo;
+  var fastMathAccuracyReport: (samples?: number) => FastMathAccuracyResult[];
+  var dspLoadReport: () => DspLoadResult[];
+  var startTrace: (path: string) => boolean;
+  var stopTrace: () => TraceSummary | null;
+  var glitchReport: () => GlitchResult[];
+  var resetGlitches: () => void;
+  var realtimeSafetyReport: () => RealtimeSafetyReport;
+  var resetRealtimeSafety: () => void;
+  var setNativeLogLevel: (level: NativeLogLevel) => void;
+  var prewarmVoices: (
+    context: IBaseAudioContext,
+    counts: Partial<Record<PooledVoiceType, number>>
+  ) => void;
+  var releaseVoices: (context: IBaseAudioContext, nodes: IAudioNode[]) => number;
+  var drainVoicePool: (context: IBaseAudioContext) => void;
+  var voicePoolReport: (context: IBaseAudioContext) => VoicePoolStats[];
+  var prepareSession: (
+    mixer: IVoiceMixNode,
+    options: {
+      voices: IAudioNode[];
+      descriptor: string;
+      duration: number;
+      seed: number;
+    }
+  ) => Promise<RenderCacheMode>;
+  var markStartup: (phase: StartupMarker) => void;
+  var startupReport: () => StartupReport;
+  var createPresetVoices: (
+    context: IBaseAudioContext,
+    preset: ArrayBuffer | string // binary preset or preset library id
+  ) => PresetVoices | null;
+  var applyPresetDiff: (
+    context: IBaseAudioContext,
+    nodes: IAudioNode[],
+    preset: ArrayBuffer | string,
+    options?: { rampSeconds?: number; volumes?: number[] }
+  ) => PresetDiff | null;
+  var openPresetLibrary: (location: PresetLibraryLocation) => number;
+  var writePresetLibrary: (
+    library: PresetLibraryLocation & { presets: PresetLibrarySource[] }
+  ) => boolean;
+  var presetLibraryList: (query?: string) => PresetLibraryEntry[];
+  var presetLibraryMeta: (id: string) => string | null;
+  var estimateCost: (
+    preset: ArrayBuffer | string,
+    options?: { sampleRate?: number; budgetPercent?: number }
+  ) => PresetCost | null;
+  var calibrateCostModel: (
+    context: IBaseAudioContext,
+    options?: { frames?: number; iterations?: number }
+  ) => CostModelCoefficients | null;
+  var createBreathingClock: () => IBreathingClock;
 }
@@ -15,6 +15,7 @@ export const DEFAULT_VOLUMES = {
   Binaural: 0.12,
   Symmetry: 0.1, // Can be harsh, start lower
   Noise: 0.08, // Background element
+  Sample: 0.2, // Recorded beds are usually mastered loud already
 };
 
 /**
@@ -0,0 +1,122 @@
+// ============================================
+// BINARY PRESET ENCODER
+// ============================================
+// Packs a preset into the binary format decoded natively by
+// global.createPresetVoices() (shared/PresetFormat.h), so that a session's
+// voices are created and configured in one call instead of one JSI write
+// per parameter. Fields a preset leaves out are not written: the native
+// side fills them from the defaults in shared/VoiceParams.h.
+// ============================================
+
+const MAGIC = 0x31504e43; // "CNP1"
+const VERSION = 1;
+const HEADER_BYTES = 16;
+const RECORD_BYTES = 8;
+
+// Wire type ids and field order, mirroring the field tables in
+// shared/PresetFormat.cpp. Append only. i: int32, otherwise float32.
+const VOICE_TYPES = {
+  Martigli: {
+    id: 1,
+    fields: [
+      ["mf0"], ["ma"], ["mp0"], ["mp1"], ["md"], ["inhaleDur"], ["exhaleDur"],
+      ["waveformM", "i"], ["panOsc", "i"], ["panOscPeriod"], ["panOscTrans"],
+    ],
+  },
+  "Martigli-Binaural": {
+    id: 2,
+    fields: [
+      ["fl"], ["fr"], ["waveformL", "i"], ["waveformR", "i"], ["ma"], ["mp0"],
+      ["mp1"], ["md"], ["inhaleDur"], ["exhaleDur"], ["panOsc", "i"],
+      ["panOscPeriod"], ["panOscTrans"],
+    ],
+  },
+  Binaural: {
+    id: 3,
+    fields: [
+      ["fl"], ["fr"], ["waveformL", "i"], ["waveformR", "i"], ["panOsc", "i"],
+      ["panOscPeriod"], ["panOscTrans"],
+    ],
+  },
+  Symmetry: {
+    id: 4,
+    fields: [
+      ["f0"], ["noctaves"], ["nnotes", "i"], ["d"], ["waveform", "i"],
+      ["permfunc", "i"], ["release"],
+    ],
+  },
+  Noise: {
+    id: 5,
+    fields: [["noiseColor", "i"]],
+  },
+  Sample: {
+    id: 6,
+    // loopStart / loopEnd in seconds, as in presets
+    fields: [
+      ["loop", "i"], ["loopStart"], ["loopEnd"], ["loopCrossfade"],
+      ["playbackRate"],
+    ],
+  },
+};
+
+function utf8(text) {
+  return new TextEncoder().encode(text);
+}
+
+function padded(bytes) {
+  return (bytes + 3) & ~3;
+}
+
+/**
+ * Encodes preset.header (d, seed) and preset.voices into an ArrayBuffer.
+ * Voices of unknown types are kept as empty records, so voice indices
+ * (e.g. in preset.modulations) stay valid.
+ */
+export function encodePreset(preset) {
+  const voices = (preset.voices ?? []).map((settings) => {
+    const type = VOICE_TYPES[settings.type];
+    const path =
+      settings.type === "Sample" ? utf8(settings.path ?? settings.url ?? "") : null;
+    return { settings, type, path };
+  });
+
+  let size = HEADER_BYTES;
+  voices.forEach(({ type, path }) => {
+    size += RECORD_BYTES + 4 * (type?.fields.length ?? 0) + padded(path?.length ?? 0);
+  });
+
+  const buffer = new ArrayBuffer(size);
+  const view = new DataView(buffer);
+  view.setUint32(0, MAGIC, true);
+  view.setUint16(4, VERSION, true);
+  view.setUint16(6, voices.length, true);
+  view.setFloat32(8, preset.header?.d ?? 900, true);
+  view.setUint32(12, preset.header?.seed ?? 1, true);
+
+  let offset = HEADER_BYTES;
+  voices.forEach(({ settings, type, path }) => {
+    const fields = type?.fields ?? [];
+    let present = 0;
+    fields.forEach(([name, kind], i) => {
+      const value = settings[name];
+      if (value === null || value === undefined) return;
+      present |= 1 << i;
+      const at = offset + RECORD_BYTES + 4 * i;
+      if (kind === "i") {
+        view.setInt32(at, Number(value), true);
+      } else {
+        view.setFloat32(at, value, true);
+      }
+    });
+    view.setUint8(offset, type?.id ?? 0);
+    view.setUint8(offset + 1, fields.length);
+    view.setUint16(offset + 2, path?.length ?? 0, true);
+    view.setUint32(offset + 4, present >>> 0, true);
+    offset += RECORD_BYTES + 4 * fields.length;
+    if (path) {
+      new Uint8Array(buffer, offset, path.length).set(path);
+      offset += padded(path.length);
+    }
+  });
+  return buffer;
+}
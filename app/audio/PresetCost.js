@@ -0,0 +1,125 @@
+// ============================================
+// PRESET CPU COST
+// ============================================
+// Static estimate of what a preset's voices cost the audio thread, from
+// their parameters alone (shared/CostModel.h), so that a preset too heavy
+// for the device is caught before it plays. The bundled library is checked
+// as a whole when it is rebuilt; presets that do not come from the library
+// (generated or edited ones) are simplified by SessionManager until they
+// fit.
+// ============================================
+
+import { encodePreset } from "./PresetCodec";
+import { getDefaultVolume } from "./AudioConfig";
+
+// Share of real time the voices may take: the rest of the audio graph, the
+// mixer's scheduling and a slow block or two need the other half
+export const DEFAULT_BUDGET_PERCENT = 50;
+
+let calibration = null;
+
+/**
+ * Times the voice nodes on this device so that estimates use its own
+ * coefficients rather than the built-in ones. Runs once, for a few tens of
+ * milliseconds: call it while nothing plays.
+ */
+export function calibrateCostModel(context) {
+  if (!calibration && typeof global.calibrateCostModel === "function") {
+    calibration = global.calibrateCostModel(context);
+  }
+  return calibration;
+}
+
+/**
+ * The cost estimate of a preset (settings, or its library id), or null if
+ * the custom nodes are not installed or the preset cannot be encoded:
+ * { nanosPerFrame, budgetPercent, fits, sharedVoices, calibrated,
+ *   voices: [{ type, nanosPerFrame, shared }] }
+ */
+export function estimatePresetCost(preset, options = {}) {
+  if (typeof global.estimateCost !== "function" || !preset) return null;
+  const source =
+    typeof preset === "string" ? preset : preset.libraryId ?? encodePreset(preset);
+  return global.estimateCost(source, {
+    budgetPercent: DEFAULT_BUDGET_PERCENT,
+    ...options,
+  });
+}
+
+/**
+ * Estimates every preset of the open library; those over budget first, the
+ * most expensive first. For checking the catalog offline (in development,
+ * or against a budget measured on a target phone).
+ */
+export function auditPresetLibrary(options = {}) {
+  if (typeof global.presetLibraryList !== "function") return [];
+  return global
+    .presetLibraryList()
+    .map(({ id, name }) => ({ id, name, cost: estimatePresetCost(id, options) }))
+    .filter(({ cost }) => cost)
+    .sort(
+      (a, b) =>
+        Number(a.cost.fits) - Number(b.cost.fits) ||
+        b.cost.budgetPercent - a.cost.budgetPercent
+    );
+}
+
+/**
+ * A preset that fits the budget: the preset itself if it does, otherwise a
+ * copy without its quietest voices (the costliest of equally quiet ones),
+ * dropped one at a time until it fits; modulations of dropped voices go
+ * with them. The last voice is always kept.
+ * Returns { preset, cost, dropped: [indices in the original preset] }.
+ */
+export function fitPresetToBudget(preset, options = {}) {
+  let cost = estimatePresetCost(preset, options);
+  if (!cost || cost.fits) return { preset, cost, dropped: [] };
+
+  const voices = preset.voices ?? [];
+  let kept = voices.map((_, i) => i);
+  const dropped = [];
+  let candidate = preset;
+  while (!cost.fits && kept.length > 1) {
+    // cost.voices follows the order of kept
+    let victim = 0;
+    kept.forEach((index, k) => {
+      const volume = getDefaultVolume(voices[index].type, voices[index].iniVolume);
+      const victimIndex = kept[victim];
+      const victimVolume = getDefaultVolume(
+        voices[victimIndex].type,
+        voices[victimIndex].iniVolume
+      );
+      if (
+        volume < victimVolume ||
+        (volume === victimVolume &&
+          cost.voices[k].nanosPerFrame > cost.voices[victim].nanosPerFrame)
+      ) {
+        victim = k;
+      }
+    });
+    dropped.push(kept[victim]);
+    kept = kept.filter((_, k) => k !== victim);
+    candidate = withVoices(preset, kept);
+    cost = estimatePresetCost(candidate, options);
+    if (!cost) break;
+  }
+  return { preset: candidate, cost, dropped: dropped.sort((a, b) => a - b) };
+}
+
+// A copy of preset with only the voices at these indices, its modulations
+// renumbered to match
+function withVoices(preset, indices) {
+  const position = new Map(indices.map((index, k) => [index, k]));
+  const { libraryId, ...settings } = preset;
+  return {
+    ...settings,
+    voices: indices.map((index) => preset.voices[index]),
+    modulations: (preset.modulations ?? [])
+      .filter((m) => position.has(m.source) && position.has(m.target))
+      .map((m) => ({
+        ...m,
+        source: position.get(m.source),
+        target: position.get(m.target),
+      })),
+  };
+}
@@ -0,0 +1,109 @@
+// ============================================
+// PRESET LIBRARY
+// ============================================
+// The session catalog lives in one memory-mapped file written natively
+// (shared/PresetLibrary.h). At startup only its index is read to list the
+// presets; a preset's settings are parsed when it is selected, and its
+// voices are decoded natively straight from the file. The bundled presets
+// (testPresets.js) are loaded only to (re)build the file, on first launch
+// and after an app update.
+// ============================================
+
+import Constants from "expo-constants";
+import { encodePreset } from "./PresetCodec";
+import { auditPresetLibrary } from "./PresetCost";
+
+// Bump when the presets or how they are encoded change
+const PRESETS_REVISION = 1;
+
+let catalog = null; // [{ id, name, duration, voices }]
+const presetCache = new Map();
+
+function libraryTag() {
+  const version = Constants.expoConfig?.version ?? "0";
+  return `${version}/${PRESETS_REVISION}`;
+}
+
+function bundledPresets() {
+  return require("../../testPresets").presets;
+}
+
+function writeLibrary(tag) {
+  const presets = bundledPresets();
+  const entries = Object.keys(presets).map((id) => ({
+    id,
+    name: presets[id].header?.med2 ?? id,
+    preset: encodePreset(presets[id]),
+    meta: JSON.stringify(presets[id]),
+  }));
+  return global.writePresetLibrary({ tag, presets: entries });
+}
+
+/**
+ * Opens the library, writing it from the bundled presets if it is missing
+ * or stale (always in development, where presets are edited), and returns
+ * the catalog.
+ */
+export function openPresetLibrary() {
+  if (catalog) return catalog;
+  if (typeof global.openPresetLibrary !== "function") {
+    // Custom nodes not installed: list the bundled presets
+    const presets = bundledPresets();
+    catalog = Object.keys(presets).map((id) => ({
+      id,
+      name: presets[id].header?.med2 ?? id,
+      duration: presets[id].header?.d ?? 900,
+      voices: presets[id].voices?.length ?? 0,
+    }));
+    return catalog;
+  }
+
+  const tag = libraryTag();
+  let count = __DEV__ ? -1 : global.openPresetLibrary({ tag });
+  if (count < 0 && writeLibrary(tag)) {
+    count = global.openPresetLibrary({ tag });
+  }
+  if (count < 0) {
+    console.warn("Cannot open the preset library");
+  }
+  catalog = global.presetLibraryList();
+  if (__DEV__) {
+    // Bundled presets must fit the built-in (low-end phone) cost model
+    auditPresetLibrary()
+      .filter(({ cost }) => !cost.fits)
+      .forEach(({ id, cost }) =>
+        console.warn(`Preset ${id} is over the CPU budget: ${cost.budgetPercent.toFixed(1)}%`)
+      );
+  }
+  return catalog;
+}
+
+/** Catalog entries whose id or name contains query */
+export function searchPresets(query) {
+  if (typeof global.presetLibraryList !== "function") {
+    const needle = query.toLowerCase();
+    return openPresetLibrary().filter(
+      ({ id, name }) =>
+        id.toLowerCase().includes(needle) || name.toLowerCase().includes(needle)
+    );
+  }
+  return global.presetLibraryList(query);
+}
+
+/**
+ * The settings of the preset with this id, or null. Presets read from the
+ * library carry libraryId, which SessionManager passes to
+ * global.createPresetVoices() instead of encoding the preset again.
+ */
+export function getPreset(id) {
+  if (presetCache.has(id)) return presetCache.get(id);
+  let preset = null;
+  if (typeof global.presetLibraryMeta === "function") {
+    const meta = global.presetLibraryMeta(id);
+    preset = meta ? { ...JSON.parse(meta), libraryId: id } : null;
+  } else {
+    preset = bundledPresets()[id] ?? null;
+  }
+  presetCache.set(id, preset);
+  return preset;
+}
@@ -11,16 +11,32 @@ import {
   BinauralNode,
   SymmetryNode,
   NoiseNode,
+  SampleNode,
+  VoiceMixNode,
+  MasterBusNode,
 } from "../(tabs)/types";
 import { DEFAULT_MASTER_VOLUME, getDefaultVolume } from "./AudioConfig";
+import { encodePreset } from "./PresetCodec";
+import { calibrateCostModel, fitPresetToBudget } from "./PresetCost";
 
 export class SessionManager {
   constructor() {
     this.audioContext = new AudioContext();
+    global.markStartup("audioContextCreated");
     this.voices = []; // {node, volume}
+    this.retiringVoices = []; // dropped by applyPreset(), fading out in the mixer
+    this.retireTimerId = null;
+    this.mixer = null; // VoiceMixNode rendering all voices of the session
+    this.master = null; // MasterBusNode: master volume, limiter, meters
+    this.breathingClock = null; // Breathing LFO shared by breath-locked voices
     this.preset = null;
+    this.presetBuffer = null; // preset encoded for global.createPresetVoices(), or its library id
     this.duration = 900;
+    this.seed = 1; // fixed so that a session can be replayed from the render cache
+    this.cacheMode = "off"; // "replay" | "record" | "off"
     this.state = "idle";
+    this.preparing = null; // pending prepare()
+    this.prepared = false; // voices created and prepared, waiting for start()
 
     // Timing
     this.startTime = null;
@@ -45,19 +61,137 @@ export class SessionManager {
   // ============================================
 
   loadPreset(preset) {
-    if (this.state !== "idle") {
+    if (this.state !== "idle" || this.preparing) {
       console.warn("Cannot load preset while session is active");
       return;
     }
+    if (this.prepared) {
+      // Voices prepared for the previous preset go back to the pool
+      this._cleanup();
+    }
+    preset = this._fitToBudget(preset);
     this.preset = preset;
+    // Presets from the preset library are decoded natively from the library
+    this.presetBuffer = preset?.libraryId ?? (preset ? encodePreset(preset) : null);
     this.duration = preset?.header?.d ?? 900;
+    this.seed = preset?.header?.seed ?? 1;
+    this._prewarmVoices();
+  }
+
+  // Creates the voices and does the work they need before their first block
+  // (note tables, sample pages, render cache file) on a native background
+  // thread. Once it resolves, start() only flips the voices on. Optional:
+  // start() does the same work itself if the session was not prepared.
+  prepare() {
+    if (this.state !== "idle" || !this.preset) return Promise.resolve();
+    if (this.preparing) return this.preparing;
+    if (this.prepared) return Promise.resolve();
+
+    const nodes = this._createVoices();
+    const done = () => {
+      this._addVoicesToMixer(nodes);
+      this.prepared = true;
+      this.preparing = null;
+    };
+    // A failed preparation still leaves usable voices: they do whatever
+    // setup is missing when they start
+    this.preparing = this.mixer
+      .prepareSession(
+        this.voices.map(({ node }) => node),
+        this._renderCacheDescriptor(),
+        this.duration,
+        this.seed
+      )
+      .then(done, (error) => {
+        done();
+        throw error;
+      });
+    return this.preparing;
+  }
+
+  // Moves a playing session to another preset without stopping it: voices
+  // both presets have are retargeted in place (their parameters and volumes
+  // ramping over rampSeconds), only the voices the new preset adds are
+  // created, and the ones it drops fade out. The session keeps its timer.
+  // When no session is playing, this is loadPreset().
+  applyPreset(preset, rampSeconds = 2) {
+    if (this.state !== "playing") {
+      this.loadPreset(preset);
+      return;
+    }
+
+    preset = this._fitToBudget(preset);
+    const settings = preset.voices ?? [];
+    const source = preset.libraryId ?? encodePreset(preset);
+    const diff = global.applyPresetDiff(
+      this.audioContext.context,
+      this.voices.map(({ node }) => node.node),
+      source,
+      {
+        rampSeconds,
+        volumes: settings.map((s) => getDefaultVolume(s.type, s.iniVolume)),
+      }
+    );
+    if (!diff) {
+      console.warn("Cannot apply preset");
+      return;
+    }
+
+    const previous = this.voices;
+    this.voices = [];
+    const added = [];
+    const nodes = settings.map((s, i) => {
+      const voice = diff.voices[i];
+      let node = null;
+      if (voice.previous >= 0) {
+        node = previous[voice.previous].node;
+      } else if (voice.node) {
+        node = this._wrapVoice(voice.type, voice.node);
+        if (node) added.push(node);
+      }
+      if (!node) {
+        console.warn("Cannot create voice", s.type);
+        return null;
+      }
+      this.voices.push({
+        node,
+        volume: getDefaultVolume(s.type, s.iniVolume),
+      });
+      return node;
+    });
+
+    this.preset = preset;
+    this.presetBuffer = source;
+    this._shareBreathingClock();
+
+    // New voices fade in with their start ramp
+    added.forEach((node) => {
+      this.mixer.addVoice(node);
+      node.volume = this.voices.find((v) => v.node === node).volume;
+      node.start();
+      if (node.isOn !== undefined) {
+        node.isOn = true;
+      }
+    });
+    this.mixer.clearModulations();
+    this._addModulations(nodes);
+
+    this._retireVoices(diff.removed.map((i) => previous[i].node));
   }
 
   start() {
-    if (this.state !== "idle" || !this.preset) return;
+    if (this.state !== "idle" || !this.preset || this.preparing) return;
 
-    this._createVoices();
+    global.markStartup("play");
+    if (!this.prepared) {
+      this._addVoicesToMixer(this._createVoices());
+      global.markStartup("voicesCreated");
+    }
+    this.prepared = false;
     this._startVoices();
+    global.markStartup("voicesConfigured");
+    this._startRenderCache();
+    global.markStartup("renderCacheStarted");
     this.startTime = Date.now();
     this.pausedTime = 0;
     this._startTimer();
@@ -98,9 +232,20 @@ export class SessionManager {
     this._setState("stopped");
   }
 
+  // One native write; the master bus smooths the change
   setMasterVolume(volume) {
     this.masterVolume = Math.max(0, Math.min(1, volume));
-    this._updateVolumes();
+    if (this.master) {
+      this.master.gain = this.masterVolume;
+    }
+  }
+
+  // Output level after the master bus (linear, 0..1)
+  getOutputLevel() {
+    return {
+      peak: this.master?.peak ?? 0,
+      rms: this.master?.rms ?? 0,
+    };
   }
 
   setVoiceVolume(index, volume) {
@@ -167,10 +312,22 @@ export class SessionManager {
     // To make breathing slower, we increase the period (multiply by > 1)
     node.mp0 = Math.max(1, node.mp0 * factor); // Min 1 second
     node.mp1 = Math.max(1, node.mp1 * factor); // Min 1 second
+
+    // The shared clock is what the voices actually follow
+    if (node.breathingClock) {
+      node.breathingClock.mp0 = node.mp0;
+      node.breathingClock.mp1 = node.mp1;
+    }
   }
 
   destroy() {
     this.stop();
+    if (this.prepared) {
+      this._cleanup();
+    }
+    if (this.audioContext) {
+      global.drainVoicePool(this.audioContext.context);
+    }
     this.audioContext = null;
   }
 
@@ -178,82 +335,178 @@ export class SessionManager {
   // PRIVATE METHODS
   // ============================================
 
+  // Constructs the preset's voice nodes now, while the user is still browsing,
+  // so that start() only takes them from the native pool. Nodes released by
+  // the previous session count towards it.
+  _prewarmVoices() {
+    const counts = {};
+    (this.preset?.voices ?? []).forEach(({ type }) => {
+      counts[type] = (counts[type] ?? 0) + 1;
+    });
+    global.prewarmVoices(this.audioContext.context, counts);
+  }
+
+  // Creates the mixer and the preset's voices, without adding the voices to
+  // the mixer yet. Returns the nodes by preset.voices index.
   _createVoices() {
     this.voices = [];
-    if (!this.preset?.voices) return;
 
-    this.preset.voices.forEach((settings) => {
-      const node = this._createNode(settings);
-      if (!node) return;
+    // Voices are rendered by the mixer (in parallel for larger presets)
+    // rather than being connected to the destination one by one.
+    const ctx = this.audioContext;
+    this.mixer = new VoiceMixNode(ctx, global.createVoiceMixNode(ctx.context));
+    this.master = new MasterBusNode(ctx, global.createMasterBusNode(ctx.context));
+    this.master.gain = this.masterVolume;
+    this.mixer.connect(this.master);
+    this.master.connect(ctx.destination);
+
+    // One call creates every voice and sets its preset parameters
+    const created = global.createPresetVoices(ctx.context, this.presetBuffer);
+    const nodes = (this.preset.voices ?? []).map((settings, i) => {
+      const voice = created?.voices[i];
+      const node = voice?.node ? this._wrapVoice(voice.type, voice.node) : null;
+      if (!node) {
+        console.warn("Cannot create voice", settings.type);
+        return null;
+      }
 
-      node.connect(this.audioContext.destination);
       const volume = getDefaultVolume(settings.type, settings.iniVolume);
       this.voices.push({ node, volume });
+      return node;
     });
+
+    this._shareBreathingClock();
+    return nodes;
   }
 
-  _createNode(settings) {
-    const ctx = this.audioContext;
-    let node = null;
+  _addVoicesToMixer(nodes) {
+    this.voices.forEach(({ node }) => {
+      this.mixer.addVoice(node);
+    });
+    this._addModulations(nodes);
+    // Presets may repeat a voice; identical voices are rendered once
+    this.mixer.shareIdenticalVoices();
+  }
 
-    switch (settings.type) {
-      case "Martigli":
-        node = new MartigliNode(ctx, global.createMartigliNode(ctx.context));
-        node.f = settings.f ?? 200;
-        node.waveform = settings.waveform ?? 0;
-        node.ma = settings.ma ?? 0.5;
-        node.inhaleDur = settings.inhaleDur ?? 4;
-        node.exhaleDur = settings.exhaleDur ?? 6;
-        break;
+  // Preset modulations refer to voices by their index in preset.voices:
+  // { source, signal, target, param, depth, offset }
+  _addModulations(nodes) {
+    (this.preset.modulations ?? []).forEach((m) => {
+      const source = nodes[m.source];
+      const target = nodes[m.target];
+      if (!source || !target) return;
+
+      const id = this.mixer.addModulation(
+        source,
+        m.signal,
+        target,
+        m.param,
+        m.depth ?? 1,
+        m.offset ?? 0
+      );
+      if (id < 0) {
+        console.warn("Modulation not applied:", m);
+      }
+    });
+  }
 
-      case "Martigli-Binaural":
-        node = new MartigliBinauralNode(
-          ctx,
-          global.createMartigliBinauralNode(ctx.context)
-        );
-        node.fl = settings.fl ?? 200;
-        node.fr = settings.fr ?? 210;
-        node.waveformL = settings.waveformL ?? 0;
-        node.waveformR = settings.waveformR ?? 0;
-        node.ma = settings.ma ?? 0.5;
-        node.mp0 = settings.mp0 ?? 0;
-        node.mp1 = settings.mp1 ?? 1;
-        node.md = settings.md ?? 10;
-        node.inhaleDur = settings.inhaleDur ?? 4;
-        node.exhaleDur = settings.exhaleDur ?? 6;
-        node.panOsc = settings.panOsc ?? 0;
-        node.panPeriod = settings.panPeriod ?? 5;
-        node.panTrans = settings.panTrans ?? 0;
-        break;
+  // Library presets were checked against the CPU budget when the library
+  // was built; others (generated or edited) lose their quietest voices
+  // until they fit. The cost model is calibrated the first time, while
+  // nothing plays.
+  _fitToBudget(preset) {
+    if (!preset || preset.libraryId) return preset;
+    if (this.state === "idle") {
+      calibrateCostModel(this.audioContext.context);
+    }
+    const { preset: fitted, cost, dropped } = fitPresetToBudget(preset, {
+      sampleRate: this.audioContext.sampleRate,
+    });
+    if (dropped.length > 0) {
+      console.warn(
+        `Preset too heavy for this device, dropped voices ${dropped.join(", ")} ` +
+          `(now ${cost?.budgetPercent.toFixed(1)}% of real time)`
+      );
+    }
+    return fitted;
+  }
 
-      case "Binaural":
-        node = new BinauralNode(ctx, global.createBinauralNode(ctx.context));
-        node.fl = settings.fl ?? 200;
-        node.fr = settings.fr ?? 210;
-        node.waveformL = settings.waveformL ?? 0;
-        node.waveformR = settings.waveformR ?? 0;
-        node.panOsc = settings.panOsc ?? 0;
-        node.panPeriod = settings.panPeriod ?? 5;
-        node.panTrans = settings.panTrans ?? 0;
-        break;
+  // Fades out voices a new preset dropped, then takes them out of the mixer
+  // and gives them back to the pool
+  _retireVoices(nodes) {
+    nodes.forEach((node) => {
+      if (node.isOn !== undefined) {
+        node.isOn = false;
+      }
+      node.stop();
+    });
+    this.retiringVoices.push(...nodes);
+    if (this.retireTimerId || this.retiringVoices.length === 0) return;
 
-      case "Symmetry":
-        node = new SymmetryNode(ctx, global.createSymmetryNode(ctx.context));
-        node.f0 = settings.f0 ?? 200;
-        node.noctaves = settings.noctaves ?? 2;
-        node.nnotes = settings.nnotes ?? 2;
-        node.d = settings.d ?? 1;
-        node.waveform = settings.waveform ?? 0;
-        node.permfunc = settings.permfunc ?? 0;
-        break;
+    // Same fade-out time as stop()
+    this.retireTimerId = setTimeout(() => {
+      this.retireTimerId = null;
+      this._releaseRetiringVoices();
+    }, 1500);
+  }
 
-      case "Noise":
-        node = new NoiseNode(ctx, global.createNoiseNode(ctx.context));
-        node.noiseColor = settings.noiseColor ?? 0; // 0=white, 1=pink, 2=brown
-        break;
+  _releaseRetiringVoices() {
+    if (this.mixer) {
+      this.retiringVoices.forEach((node) => this.mixer.removeVoice(node));
+    }
+    if (this.audioContext) {
+      global.releaseVoices(
+        this.audioContext.context,
+        this.retiringVoices.map((node) => node.node)
+      );
     }
+    this.retiringVoices = [];
+  }
+
+  // One breathing clock drives every breath-locked voice, so their LFOs stay
+  // in phase. Its parameters come from the first Martigli-type voice; a
+  // preset applied while playing keeps the clock, and so the breath's phase.
+  _shareBreathingClock() {
+    const breathVoices = this.voices.filter(
+      ({ node }) =>
+        node.mp0 !== undefined ||
+        (node instanceof BinauralNode && node.panOsc === 3)
+    );
+    const leader = breathVoices.find(({ node }) => node.mp0 !== undefined);
+    if (!leader) return;
+
+    const clock = this.breathingClock ?? global.createBreathingClock();
+    clock.mp0 = leader.node.mp0;
+    clock.mp1 = leader.node.mp1;
+    clock.md = leader.node.md;
+    clock.inhaleDur = leader.node.inhaleDur;
+    clock.exhaleDur = leader.node.exhaleDur;
+
+    breathVoices.forEach(({ node }) => {
+      node.breathingClock = clock;
+    });
+    this.breathingClock = clock;
+  }
 
-    return node;
+  // Wraps a node created by global.createPresetVoices() for its preset type
+  _wrapVoice(type, node) {
+    const ctx = this.audioContext;
+    switch (type) {
+      case "Martigli":
+        return new MartigliNode(ctx, node);
+      case "Martigli-Binaural":
+        return new MartigliBinauralNode(ctx, node);
+      case "Binaural":
+        return new BinauralNode(ctx, node);
+      case "Symmetry":
+        return new SymmetryNode(ctx, node);
+      case "Noise":
+        return new NoiseNode(ctx, node);
+      case "Sample":
+        return new SampleNode(ctx, node);
+      default:
+        return null;
+    }
   }
 
   _startVoices() {
@@ -267,7 +520,27 @@ export class SessionManager {
     this._updateVolumes();
   }
 
+  // Must run after every voice parameter (including volumes) is set: any
+  // later parameter change makes the mixer drop back to live synthesis.
+  _startRenderCache() {
+    this.cacheMode = this.mixer.useRenderCache(
+      this._renderCacheDescriptor(),
+      this.duration,
+      this.seed
+    );
+    this.mixer.start();
+  }
+
+  // The master volume is applied after the mixer, so it is not part of
+  // the rendering
+  _renderCacheDescriptor() {
+    return JSON.stringify({
+      voices: this.preset.voices,
+    });
+  }
+
   _stopVoices() {
+    this.mixer?.stop();
     this.voices.forEach(({ node }) => {
       if (node.isOn !== undefined) {
         node.isOn = false;
@@ -277,6 +550,7 @@ export class SessionManager {
   }
 
   _pauseVoices() {
+    this.mixer?.pause();
     this.voices.forEach(({ node }) => {
       if (node.pause) {
         node.pause();
@@ -285,6 +559,7 @@ export class SessionManager {
   }
 
   _resumeVoices() {
+    this.mixer?.resume();
     this.voices.forEach(({ node }) => {
       if (node.resume) {
         node.resume();
@@ -294,7 +569,7 @@ export class SessionManager {
 
   _updateVolumes() {
     this.voices.forEach(({ node, volume }) => {
-      node.volume = volume * this.masterVolume;
+      node.volume = volume;
     });
   }
 
@@ -322,6 +597,15 @@ export class SessionManager {
 
   _startAnimation() {
     this.animationId = setInterval(() => {
+      // Replayed sessions carry the animation value alongside the audio
+      if (this.mixer?.isReplaying) {
+        this.animationValue = this.mixer.animationValue;
+        if (this.onAnimationUpdate) {
+          this.onAnimationUpdate(this.animationValue);
+        }
+        return;
+      }
+
       // Find first active Martigli-type voice
       const martigliVoice = this.voices.find(
         ({ node }) =>
@@ -345,15 +629,42 @@ export class SessionManager {
   }
 
   _cleanup() {
-    this.voices.forEach(({ node }) => {
+    if (this.retireTimerId) {
+      clearTimeout(this.retireTimerId);
+      this.retireTimerId = null;
+    }
+    if (this.mixer) {
+      this.mixer.finishRenderCache();
+      this._releaseRetiringVoices();
+      this.mixer.clearVoices();
+      // Out of the mixer: the nodes go back to the pool for the next
+      // session, unless the manager was destroyed in the meantime
+      if (this.audioContext) {
+        global.releaseVoices(
+          this.audioContext.context,
+          this.voices.map(({ node }) => node.node)
+        );
+      }
       try {
-        node.disconnect();
+        this.mixer.disconnect();
       } catch (e) {
         // Already disconnected
       }
-    });
+      this.mixer = null;
+    }
+    if (this.master) {
+      try {
+        this.master.disconnect();
+      } catch (e) {
+        // Already disconnected
+      }
+      this.master = null;
+    }
     this.voices = [];
+    this.breathingClock = null;
     this.preset = null;
+    this.prepared = false;
+    this.cacheMode = "off";
     this.startTime = null;
     this.pausedTime = 0;
     this._setState("idle");
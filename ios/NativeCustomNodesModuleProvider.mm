@@ -1,13 +1,43 @@
 #import "NativeCustomNodesModuleProvider.h"
+#import <AVFoundation/AVFoundation.h>
 #import <ReactCommon/CallInvoker.h>
 #import <ReactCommon/TurboModule.h>
 #import "NativeCustomNodesModule.h"
+#import "VoiceRenderPool.h"
+
+// The os_workgroup_t of the output unit react-native-audio-api renders into,
+// for the voice render workers to join. Looked up by name so that we do not
+// depend on the library's private headers; nullptr before an AudioContext
+// has started the engine, or before iOS 14.
+static void *audioDeviceWorkgroup()
+{
+  if (@available(iOS 14.0, *)) {
+    Class engineClass = NSClassFromString(@"AudioEngine");
+    if (engineClass == nil || ![engineClass respondsToSelector:@selector(sharedInstance)]) {
+      return nullptr;
+    }
+    id engine = [engineClass performSelector:@selector(sharedInstance)];
+    AVAudioEngine *audioEngine = nil;
+    @try {
+      audioEngine = [engine valueForKey:@"audioEngine"];
+    } @catch (NSException *exception) {
+      return nullptr;
+    }
+    if (![audioEngine isKindOfClass:[AVAudioEngine class]]) {
+      return nullptr;
+    }
+    os_workgroup_t workgroup = audioEngine.outputNode.AUAudioUnit.osWorkgroup;
+    return (__bridge void *)workgroup;
+  }
+  return nullptr;
+}
 
 @implementation NativeCustomNodesModuleProvider
 
 - (std::shared_ptr<facebook::react::TurboModule>)getTurboModule:
     (const facebook::react::ObjCTurboModule::InitParams &)params
 {
+  audioapi::VoiceRenderPool::setWorkgroupProvider(&audioDeviceWorkgroup);
   return std::make_shared<facebook::react::NativeCustomNodesModule>(params.jsInvoker);
 }
 
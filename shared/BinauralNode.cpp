@@ -1,11 +1,10 @@
 #include "BinauralNode.h"
-#include "AnimationValueRegistry.h"
+#include "NativeLog.h"
 #include <audioapi/core/BaseAudioContext.h>
 #include <audioapi/utils/AudioBus.h>
 #include <audioapi/utils/AudioArray.h>
 #include <cmath>
 #include <algorithm>
-#include <cstdio>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -18,15 +17,77 @@ BinauralNode::BinauralNode(BaseAudioContext *context)
   channelCount_ = 2;
   channelCountMode_ = ChannelCountMode::EXPLICIT;
   channelInterpretation_ = ChannelInterpretation::SPEAKERS;
+  modulation().addSignal("envelope");
+  modulation().addSignal("level");
+  modulation().addParam("volume", &volume);
+  modulation().addParam("fl", &fl);
+  modulation().addParam("fr", &fr);
   isInitialized_ = true;
-  printf("BinauralNode: Constructor called\n");
+  CUSTOM_NODES_LOG_DEBUG("BinauralNode", "Constructor called");
+}
+
+void BinauralNode::resetVoice() {
+  applyParams(kBinauralDefaults);
+  volume = 0.5;
+  martigliAnimationValue = 0.0f;
+  breathing_.attach(nullptr);
+
+  shouldStart = false;
+  shouldPause = false;
+  shouldResume = false;
+  shouldStop = false;
+  isPaused = false;
+  isRunning_ = false;
+  frameCount = 0;
+
+  phaseL_ = 0.0;
+  phaseR_ = 0.0;
+  panPhase_ = 0.0;
+  panOscPhase_ = 0.0;
+  currentGain_ = 0.0f;
+  startGain_ = 0.0f;
+  targetGain_ = 1.0f;
+  rampDuration_ = 1.0f;
+  rampElapsed_ = 0.0f;
+  isRamping_ = false;
+
+  glitches_.reset();
+  touchParams();
+}
+
+void BinauralNode::applyParams(const BinauralParams &params) {
+  fl = params.fl;
+  fr = params.fr;
+  waveformL = params.waveformL;
+  waveformR = params.waveformR;
+  panOsc = params.panOsc;
+  panOscPeriod = params.panOscPeriod;
+  panOscTrans = params.panOscTrans;
+  touchParams();
+}
+
+BinauralParams BinauralNode::getParams() {
+  return {static_cast<float>(fl), static_cast<float>(fr), waveformL, waveformR, panOsc,
+          static_cast<float>(panOscPeriod), static_cast<float>(panOscTrans)};
 }
 
 void BinauralNode::processNode(
   const std::shared_ptr<AudioBus> &processingBus,
   int framesToProcess
 ) {
+  CUSTOM_NODES_RT_SCOPE("Binaural");
+  // Both carriers can land on one channel (panOsc 0 sums them)
+  const float maxStep = GlitchDetector::waveformStep(waveformL, fl, volume, _context->getSampleRate()) +
+                        GlitchDetector::waveformStep(waveformR, fr, volume, _context->getSampleRate());
+  GlitchDetector::Scope glitchScope(glitches_, processingBus, framesToProcess, _context->getSampleRate(), maxStep);
+  CUSTOM_NODES_DSP_SCOPE(dspLoad_, framesToProcess, _context->getSampleRate());
+  CUSTOM_NODES_TRACE_SCOPE("dsp", "Binaural");
+
   // Handle control flags
+  trace::commandsApplied(this, {CUSTOM_NODES_TRACE_FLAG(shouldStart),
+                                CUSTOM_NODES_TRACE_FLAG(shouldPause),
+                                CUSTOM_NODES_TRACE_FLAG(shouldResume),
+                                CUSTOM_NODES_TRACE_FLAG(shouldStop)});
   if (shouldStart) {
     isRunning_ = true;
     isPaused = false;
@@ -71,6 +132,18 @@ void BinauralNode::processNode(
     processingBus->zero();
     return;
   }
+  if (const uint64_t frames = takePendingSeek(); frames > 0 && !isPaused) {
+    // Catch up with a replay the mixer falls back from (which fades the
+    // voice in itself, so the start ramp is past as well)
+    const double seconds = static_cast<double>(frames) / _context->getSampleRate();
+    rampElapsed_ += static_cast<float>(seconds);
+    phaseL_ = fastmath::wrap(phaseL_ + fl * seconds, 1.0);
+    phaseR_ = fastmath::wrap(phaseR_ + fr * seconds, 1.0);
+    if (panOscPeriod > 0.0) {
+      panOscPhase_ = fastmath::wrap(panOscPhase_ + seconds, 2.0 * panOscPeriod);
+      panPhase_ = fastmath::wrap(panPhase_ + seconds / panOscPeriod, 1.0);
+    }
+  }
   
   // Increment frame counter for debugging
   frameCount++;
@@ -79,10 +152,30 @@ void BinauralNode::processNode(
   auto *rightChannel = processingBus->getChannel(1)->getData();
 
   const double sampleRate = _context->getSampleRate();
-  const double twoPi = 2.0 * M_PI;
   const float frameDuration = 1.0f / sampleRate;
 
+  // With a shared breathing clock, pan in lock with the Martigli voices
+  BreathingClockSlot::Use clock(breathing_);
+  const uint64_t breathPosition = clock.position(_context->getCurrentSampleFrame(), framesToProcess);
+  const BreathingBlock *breath = nullptr;
+  int breathStart = 0;
+  if (panOsc == 3 && clock.isShared()) {
+    breath = &clock.block(breathPosition, framesToProcess, static_cast<float>(sampleRate));
+  }
+
+  const QualityTier tier = getQualityTier();
+  const bool fastSine = tier >= QualityTier::Reduced;
+  const bool controlRate = tier >= QualityTier::Low;
+  double panGainL = 1.0;
+  double panGainR = 1.0;
+
   for (int i = 0; i < framesToProcess; ++i) {
+    if (breath != nullptr && i - breathStart == breath->frames) {
+      // A render longer than one block
+      breathStart = i;
+      breath = &clock.block(breathPosition + i, framesToProcess - i, static_cast<float>(sampleRate));
+    }
+
     // Update volume ramping
     if (isRamping_) {
       rampElapsed_ += frameDuration;
@@ -105,7 +198,7 @@ void BinauralNode::processNode(
     double carrierL = 0.0;
     switch (waveformL) {
       case 0: // sine
-        carrierL = std::sin(twoPi * phaseL_);
+        carrierL = fastmath::sin2pi<kAccuracy>(static_cast<float>(phaseL_), fastSine);
         break;
       case 1: // triangle
         carrierL = 2.0 * std::abs(2.0 * (phaseL_ - std::floor(phaseL_ + 0.5))) - 1.0;
@@ -122,7 +215,7 @@ void BinauralNode::processNode(
     double carrierR = 0.0;
     switch (waveformR) {
       case 0: // sine
-        carrierR = std::sin(twoPi * phaseR_);
+        carrierR = fastmath::sin2pi<kAccuracy>(static_cast<float>(phaseR_), fastSine);
         break;
       case 1: // triangle
         carrierR = 2.0 * std::abs(2.0 * (phaseR_ - std::floor(phaseR_ + 0.5))) - 1.0;
@@ -143,11 +236,17 @@ void BinauralNode::processNode(
     carrierL *= currentGain_;
     carrierR *= currentGain_;
 
-    // Calculate panning modulation based on panOsc mode
-    double panGainL = 1.0;
-    double panGainR = 1.0;
+    // Calculate panning modulation based on panOsc mode. At QualityTier::Low
+    // the ping-pong and sinusoidal pans are held for kControlInterval frames
+    const bool panHeld = controlRate && (panOsc == 1 || panOsc == 2) && i % kControlInterval != 0;
+    if (!panHeld) {
+      panGainL = 1.0;
+      panGainR = 1.0;
+    }
 
-    if (panOsc == 1) {
+    if (panHeld) {
+      // Keep the gains of the interval's first frame
+    } else if (panOsc == 1) {
       // Ping-pong crossfade mode
       // Full cycle = 2 * panOscPeriod
       // Phase 1: Hold at original (0 to panOscPeriod - panOscTrans)
@@ -156,7 +255,7 @@ void BinauralNode::processNode(
       // Phase 4: Crossfade back (2*panOscPeriod - panOscTrans to 2*panOscPeriod)
       
       double fullCycleDuration = 2.0 * panOscPeriod;
-      double phaseInCycle = fmod(panOscPhase_, fullCycleDuration);
+      double phaseInCycle = fastmath::wrap(panOscPhase_, fullCycleDuration);
       double crossfadeValue = 0.0; // 0.0 = normal position, 1.0 = swapped
       
       if (phaseInCycle < (panOscPeriod - panOscTrans)) {
@@ -188,7 +287,7 @@ void BinauralNode::processNode(
       // sin(π) = 0 -> carriers back to normal
       // sin(3π/2) = -1 -> carriers swapped opposite direction
       // sin(2π) = 0 -> back to start
-      double sinValue = std::sin(twoPi * panPhase_);
+      double sinValue = fastmath::sin2pi<kAccuracy>(static_cast<float>(panPhase_), fastSine);
       // Map sin [-1,1] to crossfade [0,1,0,1] pattern
       // We want: -1→0, 0→0.5, 1→1
       double crossfadeValue = (sinValue + 1.0) * 0.5; // [-1,1] -> [0,1]
@@ -196,9 +295,11 @@ void BinauralNode::processNode(
       panGainR = crossfadeValue;
       
     } else if (panOsc == 3) {
-      // Follow Martigli animation value from registry
-      // Read directly from registry (no JS bridge crossing!)
-      double animValue = AnimationValueRegistry::getInstance().getMartigliAnimationValue();
+      // Follow the shared breathing clock, or the Martigli animation value
+      // from the registry (no JS bridge crossing either way)
+      double animValue = breath != nullptr
+          ? (breath->value[i - breathStart] + 1.0f) * 0.5f
+          : getMartigliAnimationValue();
       // animValue: 0.0 (trough) to 1.0 (peak)
       // At trough: normal position (L→L, R→R)
       // At peak: swapped position (L→R, R→L)
@@ -239,6 +340,9 @@ void BinauralNode::processNode(
       // panOsc == 3: no phase advancement needed (uses external value)
     }
   }
+
+  modulation().publish(kEnvelopeSignal, currentGain_);
+  modulation().publish(kLevelSignal, static_cast<float>(volume) * currentGain_);
 }
 
 } // namespace audioapi
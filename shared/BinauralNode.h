@@ -1,11 +1,23 @@
 #pragma once
 #include <audioapi/core/AudioNode.h>
+#include "VoiceRenderer.h"
+#include "VoiceParams.h"
+#include "BreathingClock.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include "FastMath.h"
 
 namespace audioapi {
 class AudioBus;
 class BaseAudioContext;
 
-class BinauralNode : public AudioNode {
+class BinauralNode : public AudioNode, public VoiceRenderer {
+public:
+  // Accuracy tier of the sine carriers and pan LFO (see FastMath.h)
+  static constexpr fastmath::Accuracy kAccuracy = fastmath::Accuracy::Balanced;
+
 private:
   BaseAudioContext* _context;
   
@@ -20,26 +32,46 @@ private:
   // Audio state
   bool isRunning_ = false;
 
+  // Shared breathing clock followed by panOsc=3, if attached
+  BreathingClockSlot breathing_;
+
+  DspLoadMeter dspLoad_{"Binaural"};
+  GlitchDetector glitches_{"Binaural"};
+
 public:
   explicit BinauralNode(BaseAudioContext *context);
 
+  void renderVoice(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override {
+    processNode(bus, framesToProcess);
+  }
+  void resetVoice() override;
+  // Sets the preset parameters, as decoded from a binary preset. JS thread.
+  void applyParams(const BinauralParams &params);
+  // The current preset parameters, as applyParams() takes them. JS thread.
+  BinauralParams getParams();
+
   // Oscillator frequencies
-  double fl = 340.0;
-  double fr = 160.0;
+  double fl = kBinauralDefaults.fl;
+  double fr = kBinauralDefaults.fr;
 
   // Waveforms (0=sine, 1=triangle, 2=square, 3=sawtooth)
-  int waveformL = 0;
-  int waveformR = 0;
+  int waveformL = kBinauralDefaults.waveformL;
+  int waveformR = kBinauralDefaults.waveformR;
 
   // Volume
   double volume = 0.5;
 
   // Panning oscillator settings
-  int panOsc = 0;          // 0=none, 1=envelope, 2=independent sine, 3=synced to martigli
-  double panOscPeriod = 120.0;
-  double panOscTrans = 20.0;
+  int panOsc = kBinauralDefaults.panOsc; // 0=none, 1=envelope, 2=independent sine, 3=synced to martigli
+  double panOscPeriod = kBinauralDefaults.panOscPeriod;
+  double panOscTrans = kBinauralDefaults.panOscTrans;
   float martigliAnimationValue = 0.0f; // For panOsc=3: 0.0 to 1.0 from Martigli voice
 
+  // panOsc=3 follows this clock sample by sample when attached (JS thread),
+  // otherwise the active Martigli voice's value (getMartigliAnimationValue())
+  void setBreathingClock(const std::shared_ptr<BreathingClock> &clock) { breathing_.attach(clock); }
+  std::shared_ptr<BreathingClock> getBreathingClock() { return breathing_.attached(); }
+
   // Control flags
   bool shouldStart = false;
   bool shouldPause = false;
@@ -51,6 +83,10 @@ public:
   int frameCount = 0;
 
 private:
+  // Modulation signals, in the order they are declared to modulation():
+  // envelope (start/stop ramp), level (volume * envelope)
+  enum ModulationSignal { kEnvelopeSignal, kLevelSignal };
+
   // Volume ramping state
   float currentGain_ = 0.0f;
   float startGain_ = 0.0f;
@@ -1,10 +1,12 @@
 #pragma once
 
 #include "BinauralNode.h"
+#include "VoiceRenderer.h"
+#include "BreathingClockHostObject.h"
+#include "NativeLog.h"
 #include <audioapi/HostObjects/AudioNodeHostObject.h>
 #include <jsi/jsi.h>
 #include <memory>
-#include <cstdio>
 
 using namespace facebook;
 
@@ -18,6 +20,7 @@ namespace audioapi {
 #define BINAURAL_PROPERTY_SETTER(type, name) \
   if (propName == #name) { \
     node_->name = static_cast<type>(value.asNumber()); \
+    node_->touchParams(); \
     return; \
   }
 
@@ -28,17 +31,18 @@ namespace audioapi {
 
 #define BINAURAL_PROPERTY_SETTER_BOOL(name) \
   if (propName == #name) { \
-    printf("BinauralNodeHostObject: Setting " #name " to %s\n", value.asBool() ? "true" : "false"); \
+    CUSTOM_NODES_LOG_DEBUG("BinauralNodeHostObject", "Setting " #name " to %s", value.asBool() ? "true" : "false"); \
     node_->name = value.asBool(); \
     return; \
   }
 
-class BinauralNodeHostObject : public AudioNodeHostObject {
+class BinauralNodeHostObject : public AudioNodeHostObject, public VoiceHostObject {
 public:
   explicit BinauralNodeHostObject(std::shared_ptr<BinauralNode> node)
       : AudioNodeHostObject(std::static_pointer_cast<AudioNode>(node)), node_(node) {}
 
   jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    trace::Scope traceScope("jsi", "Binaural.get", node_.get());
     auto propName = propNameId.utf8(runtime);
 
     BINAURAL_PROPERTY(double, fl)
@@ -56,12 +60,21 @@ public:
     BINAURAL_PROPERTY_BOOL(shouldStop)
     BINAURAL_PROPERTY_BOOL(isPaused)
     BINAURAL_PROPERTY(int, frameCount)
+    if (propName == "breathingClock") {
+      auto clock = node_->getBreathingClock();
+      if (!clock) {
+        return jsi::Value::null();
+      }
+      return jsi::Object::createFromHostObject(runtime, std::make_shared<BreathingClockHostObject>(clock));
+    }
 
     return AudioNodeHostObject::get(runtime, propNameId);
   }
 
   void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    trace::Scope traceScope("jsi", "Binaural.set", node_.get());
     auto propName = propNameId.utf8(runtime);
+    trace::commandQueued(propName, value.isBool() && value.getBool(), node_.get());
 
     BINAURAL_PROPERTY_SETTER(double, fl)
     BINAURAL_PROPERTY_SETTER(double, fr)
@@ -77,10 +90,19 @@ public:
     BINAURAL_PROPERTY_SETTER_BOOL(shouldResume)
     BINAURAL_PROPERTY_SETTER_BOOL(shouldStop)
     BINAURAL_PROPERTY_SETTER_BOOL(isPaused)
+    if (propName == "breathingClock") {
+      node_->setBreathingClock(BreathingClockHostObject::fromValue(runtime, value));
+      node_->touchParams();
+      return;
+    }
 
     AudioNodeHostObject::set(runtime, propNameId, value);
   }
 
+  std::shared_ptr<VoiceRenderer> getVoiceRenderer() const override {
+    return node_;
+  }
+
 private:
   std::shared_ptr<BinauralNode> node_;
 };
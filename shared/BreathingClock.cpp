@@ -0,0 +1,223 @@
+#include "BreathingClock.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace audioapi {
+
+namespace {
+
+inline void cpuRelax() {
+#if defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+// Adds dt to t once per frame, as compute() does in float, for at most
+// `frames` frames and until t reaches limit; returns the frames used. Within
+// a binade every float sum rounds dt to the same multiple of t's ulp, so the
+// frames of a binade are added at once and the result matches the
+// frame-by-frame sum, rounding drift included.
+uint64_t accumulate(float &t, float dt, uint64_t frames, float limit) {
+  uint64_t used = 0;
+  while (used < frames && t < limit) {
+    const float step = (t + dt) - t;
+    if (step <= 0.0f) {
+      break;
+    }
+    int exponent = 0;
+    std::frexp(t, &exponent);
+    // Frames whose sums stay in t's binade, up to the one reaching limit
+    const double inBinade = std::ceil((std::ldexp(1.0, exponent) - t) / step) - 1.0;
+    const double toLimit = std::ceil((static_cast<double>(limit) - t) / step);
+    const double count = std::min({inBinade, toLimit, static_cast<double>(frames - used)});
+    if (t > 0.0f && count >= 1.0) {
+      t = static_cast<float>(t + count * static_cast<double>(step));
+      used += static_cast<uint64_t>(count);
+    } else {
+      t += dt;
+      ++used;
+    }
+  }
+  return used;
+}
+
+} // namespace
+
+BreathingClock::SpinGuard::SpinGuard(std::atomic_flag &flag) : flag_(flag) {
+  // Held for one block computation at most, a few microseconds
+  while (flag_.test_and_set(std::memory_order_acquire)) {
+    cpuRelax();
+  }
+}
+
+BreathingClock::SpinGuard::~SpinGuard() {
+  flag_.clear(std::memory_order_release);
+}
+
+const BreathingBlock &BreathingClock::blockFor(uint64_t position, int frames, float sampleRate) {
+  frames = std::min(frames, BreathingBlock::kMaxFrames);
+  SpinGuard guard(lock_);
+  if (position != blockPosition_ || frames != block_.frames) {
+    compute(frames, sampleRate);
+    blockPosition_ = position;
+  }
+  return block_;
+}
+
+const BreathingBlock &BreathingClock::advance(int frames, float sampleRate) {
+  frames = std::min(frames, BreathingBlock::kMaxFrames);
+  SpinGuard guard(lock_);
+  compute(frames, sampleRate);
+  return block_;
+}
+
+bool BreathingClock::accept(Command command, uint64_t stamp) {
+  if (commandStamps_[command] == stamp) {
+    return false;
+  }
+  commandStamps_[command] = stamp;
+  return true;
+}
+
+void BreathingClock::start(uint64_t stamp, bool scaleFirstCycle) {
+  SpinGuard guard(lock_);
+  if (!accept(Start, stamp)) {
+    return;
+  }
+  running_ = true;
+  isRamping_ = true;
+  rampElapsedTime_ = 0.0f;
+  lfoPhaseTime_ = 0.0f; // Start at trough (beginning of inhale)
+  lastPhase_ = 0.0f;
+  lockCycle(mp0);
+  if (!scaleFirstCycle && inhaleDur > 0.0f && exhaleDur > 0.0f) {
+    cycleInhale_ = inhaleDur;
+    cycleExhale_ = exhaleDur;
+  }
+}
+
+void BreathingClock::join() {
+  SpinGuard guard(lock_);
+  ++voices_;
+  running_ = true;
+}
+
+void BreathingClock::leave() {
+  SpinGuard guard(lock_);
+  if (voices_ > 0 && --voices_ == 0) {
+    running_ = false;
+  }
+}
+
+void BreathingClock::resume(uint64_t stamp) {
+  SpinGuard guard(lock_);
+  // Voices still breathing on a shared clock keep their phase
+  if (!accept(Resume, stamp) || running_) {
+    return;
+  }
+  running_ = true;
+  lfoPhaseTime_ = 0.0f;
+  lastPhase_ = 0.0f;
+}
+
+void BreathingClock::resetPhase(uint64_t stamp) {
+  SpinGuard guard(lock_);
+  if (!accept(ResetPhase, stamp)) {
+    return;
+  }
+  lfoPhaseTime_ = 0.0f;
+  lastPhase_ = 0.0f;
+}
+
+void BreathingClock::seek(uint64_t stamp, uint64_t frames, float sampleRate) {
+  SpinGuard guard(lock_);
+  if (!accept(Seek, stamp) || !running_) {
+    return;
+  }
+  const float dt = 1.0f / sampleRate;
+  const auto advanceRamp = [&](uint64_t count) {
+    if (isRamping_) {
+      accumulate(rampElapsedTime_, dt, count, std::numeric_limits<float>::infinity());
+      isRamping_ = rampElapsedTime_ < md;
+    }
+  };
+  lfoPhaseTime_ = fastmath::wrap(lfoPhaseTime_, cycleInhale_ + cycleExhale_);
+  while (frames > 0) {
+    const float cycle = cycleInhale_ + cycleExhale_;
+    const uint64_t used = accumulate(lfoPhaseTime_, dt, frames, cycle);
+    frames -= used;
+    advanceRamp(used);
+    if (frames == 0 || used == 0) {
+      break;
+    }
+    // The frame that wraps starts a cycle at the period of that moment
+    lfoPhaseTime_ = fastmath::wrap(lfoPhaseTime_, cycle);
+    lockCycle(rampedPeriod());
+  }
+  lastPhase_ = lfoPhaseTime_;
+}
+
+float BreathingClock::rampedPeriod() const {
+  return isRamping_ && md > 0.0f ? mp0 + (mp1 - mp0) * std::min(rampElapsedTime_ / md, 1.0f) : mp1;
+}
+
+void BreathingClock::lockCycle(float period) {
+  if (inhaleDur > 0.0f && exhaleDur > 0.0f) {
+    float scale = period / (inhaleDur + exhaleDur);
+    cycleInhale_ = inhaleDur * scale;
+    cycleExhale_ = exhaleDur * scale;
+  } else {
+    cycleInhale_ = cycleExhale_ = period * 0.5f;
+  }
+}
+
+void BreathingClock::compute(int frames, float sampleRate) {
+  const float dt = 1.0f / sampleRate;
+
+  // Calculate current period (with ramping)
+  float currentPeriod = rampedPeriod();
+  if (isRamping_ && rampElapsedTime_ >= md) {
+    isRamping_ = false;
+    currentPeriod = mp1;
+  }
+  block_.period = currentPeriod;
+  if (inhaleDur > 0.0f && exhaleDur > 0.0f) {
+    float scale = currentPeriod / (inhaleDur + exhaleDur);
+    block_.inhaleDur = inhaleDur * scale;
+    block_.exhaleDur = exhaleDur * scale;
+  } else {
+    block_.inhaleDur = block_.exhaleDur = currentPeriod * 0.5f;
+  }
+
+  for (int i = 0; i < frames; ++i) {
+    // Piecewise cosine with locked cycle durations
+    float phase = fastmath::wrap(lfoPhaseTime_, cycleInhale_ + cycleExhale_);
+
+    // Detect cycle wrap and take the current period for the next cycle
+    if (phase < lastPhase_) {
+      lfoPhaseTime_ = phase;
+      cycleInhale_ = block_.inhaleDur;
+      cycleExhale_ = block_.exhaleDur;
+    }
+    lastPhase_ = phase;
+
+    block_.value[i] = (phase < cycleInhale_)
+        ? -fastmath::cos2pi<kAccuracy>(0.5f * phase / cycleInhale_)
+        : fastmath::cos2pi<kAccuracy>(0.5f * (phase - cycleInhale_) / cycleExhale_);
+
+    if (running_) {
+      lfoPhaseTime_ += dt;
+      if (isRamping_) rampElapsedTime_ += dt;
+    }
+  }
+
+  block_.frames = frames;
+  if (frames > 0) {
+    block_.animationValue = (block_.value[frames - 1] + 1.0f) * 0.5f;
+  }
+}
+
+} // namespace audioapi
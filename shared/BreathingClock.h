@@ -0,0 +1,232 @@
+#pragma once
+#include "FastMath.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace audioapi {
+
+// Breathing LFO shared by every breath-locked voice of a session.
+//
+// The clock holds the piecewise-cosine breathing curve that MartigliNode and
+// MartigliBinauralNode used to compute each on their own: the inhale/exhale
+// split, the cycle locking (a new period only takes effect at the start of a
+// breath) and the mp0 -> mp1 period ramp over md seconds. It computes one
+// block of breath values per render quantum; every voice that references the
+// clock reads the same block, so the LFO is computed once and the voices can
+// never drift apart, including across pause and resume.
+//
+// blockFor() may be called from several voices of one quantum, also from the
+// VoiceMixNode worker threads: the first caller computes the block, the others
+// wait for it and read it. Blocks are keyed on their first frame's position
+// in the voices' shared timeline (BreathingClockSlot::Use::position), so the
+// chunks the mixer renders a large quantum in each get their own block; the
+// voices sharing a clock must ask for the same blocks in the same order,
+// which both the mixer's chunks and the graph's serial pull do.
+struct BreathingBlock {
+  static constexpr int kMaxFrames = 1024;
+
+  // Breathing curve per frame: -1 at the start of an inhale, +1 at its end
+  // (the start of the exhale), back to -1 at the end of the exhale
+  std::array<float, kMaxFrames> value{};
+  int frames = 0;
+
+  float animationValue = 0.0f;  // last frame mapped to 0 (trough) .. 1 (peak)
+  float period = 0.0f;          // current target period (seconds)
+  float inhaleDur = 0.0f;       // current inhale/exhale split of that period
+  float exhaleDur = 0.0f;
+};
+
+class BreathingClock {
+public:
+  static constexpr fastmath::Accuracy kAccuracy = fastmath::Accuracy::Balanced;
+
+  // Parameters, same meaning as on MartigliNode
+  float mp0 = 10.0f;        // Initial period
+  float mp1 = 20.0f;        // Final period
+  float md = 600.0f;        // Ramp duration
+  float inhaleDur = -1.0f;  // Inhale duration (optional, sets the ratio)
+  float exhaleDur = -1.0f;  // Exhale duration (optional)
+
+  void setParameters(float initialPeriod, float finalPeriod, float rampDuration, float inhale, float exhale) {
+    mp0 = initialPeriod;
+    mp1 = finalPeriod;
+    md = rampDuration;
+    inhaleDur = inhale;
+    exhaleDur = exhale;
+  }
+
+  // Block starting at position, computed by the first voice to ask for it.
+  // Both return at most BreathingBlock::kMaxFrames frames; a voice rendering
+  // more asks again for the rest (BreathingClockSlot::Use::block).
+  const BreathingBlock &blockFor(uint64_t position, int frames, float sampleRate);
+
+  // Computes the next block unconditionally, for a clock owned by one voice.
+  const BreathingBlock &advance(int frames, float sampleRate);
+
+  const BreathingBlock &lastBlock() const { return block_; }
+
+  // Control. Each voice sharing the clock forwards its own start/resume;
+  // repeats of a command within one quantum (same stamp) are ignored, so the
+  // clock is reset once however many voices it drives.
+  // scaleFirstCycle = false takes inhaleDur/exhaleDur as given for the first
+  // breath instead of scaling them to mp0, as MartigliBinauralNode always did
+  void start(uint64_t stamp, bool scaleFirstCycle = true);
+  void resume(uint64_t stamp);     // a paused clock restarts at the beginning of an inhale
+  void resetPhase(uint64_t stamp);
+  // Moves a running clock `frames` frames ahead as compute() would, one
+  // breathing cycle at a time, without computing the curve
+  void seek(uint64_t stamp, uint64_t frames, float sampleRate);
+
+  bool isRunning() const { return running_; }
+
+  // Voices driving the clock (BreathingClockSlot::hold). The clock stops
+  // advancing when the last of them leaves, i.e. once every voice sharing it
+  // has faded out; a joining voice sets it running again where it stopped.
+  void join();
+  void leave();
+
+private:
+  enum Command { Start, Resume, ResetPhase, Seek, CommandCount };
+
+  class SpinGuard {
+  public:
+    explicit SpinGuard(std::atomic_flag &flag);
+    ~SpinGuard();
+
+  private:
+    std::atomic_flag &flag_;
+  };
+
+  bool accept(Command command, uint64_t stamp);
+  void compute(int frames, float sampleRate);
+  void lockCycle(float period);
+  float rampedPeriod() const;
+
+  std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+  uint64_t blockPosition_ = UINT64_MAX;
+  std::array<uint64_t, CommandCount> commandStamps_{UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX};
+
+  BreathingBlock block_;
+
+  bool running_ = true;
+  int voices_ = 0;
+  bool isRamping_ = false;
+  float lfoPhaseTime_ = 0.0f;
+  float rampElapsedTime_ = 0.0f;
+  float lastPhase_ = 0.0f;
+
+  // Period of the breathing cycle in progress
+  float cycleInhale_ = 5.0f;
+  float cycleExhale_ = 5.0f;
+};
+
+// A voice's reference to its breathing clock: a private clock, driven by the
+// voice's own parameters, until a shared clock is attached from JS.
+class BreathingClockSlot {
+public:
+  ~BreathingClockSlot() {
+    if (held_ != nullptr && held_ != &own_) {
+      held_->leave();
+    }
+  }
+
+  // JS thread. nullptr goes back to the private clock. A voice driving the
+  // old clock leaves it and joins the new one at its next render.
+  void attach(const std::shared_ptr<BreathingClock> &clock) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (held_ != nullptr && held_ != &own_) {
+      held_->leave();
+      held_ = nullptr;
+    }
+    shared_ = clock;
+  }
+
+  // Audio thread, or while the voice does not render. The voice drives its
+  // clock from hold() (start, resume) until release() (its fade-out has
+  // ended); a shared clock only pauses once none of its voices drives it.
+  // Applied when the render call's Use ends.
+  void hold() { holding_ = true; }
+  void release() { holding_ = false; }
+
+  std::shared_ptr<BreathingClock> attached() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return shared_;
+  }
+
+  // Audio thread, for one quantum. Never blocks: while the JS thread is
+  // swapping the shared clock, the voice uses its private clock.
+  class Use {
+  public:
+    explicit Use(BreathingClockSlot &slot) : slot_(slot), lock_(slot.mutex_, std::try_to_lock) {
+      clock_ = lock_.owns_lock() && slot.shared_ ? slot.shared_.get() : &slot.own_;
+      shared_ = clock_ != &slot.own_;
+    }
+
+    ~Use() {
+      if (lock_.owns_lock()) {
+        slot_.syncHold(clock_);
+      }
+    }
+
+    BreathingClock *get() const { return clock_; }
+    bool isShared() const { return shared_; }
+
+    // Position of this render call's first frame: the quantum's stamp (the
+    // context's current sample frame) plus the frames the voice already
+    // rendered of that quantum, which the mixer renders in chunks. Once per
+    // render call.
+    uint64_t position(uint64_t stamp, int frames) {
+      if (stamp != slot_.renderStamp_) {
+        slot_.renderStamp_ = stamp;
+        slot_.renderEnd_ = stamp;
+      }
+      const uint64_t start = slot_.renderEnd_;
+      slot_.renderEnd_ += static_cast<uint64_t>(frames);
+      return start;
+    }
+
+    // The breath values from position on, up to frames of them or
+    // BreathingBlock::kMaxFrames, whichever is fewer: the shared clock's
+    // block, or the private clock's next one. Ask again at position +
+    // block.frames for the rest of a longer render.
+    const BreathingBlock &block(uint64_t position, int frames, float sampleRate) {
+      return shared_ ? clock_->blockFor(position, frames, sampleRate) : clock_->advance(frames, sampleRate);
+    }
+
+  private:
+    BreathingClockSlot &slot_;
+    std::unique_lock<std::mutex> lock_;
+    BreathingClock *clock_;
+    bool shared_;
+  };
+
+private:
+  // Under mutex_: joins the clock the voice renders with while it holds it
+  void syncHold(BreathingClock *clock) {
+    BreathingClock *wanted = holding_ ? clock : nullptr;
+    if (wanted == held_) {
+      return;
+    }
+    if (held_ != nullptr) {
+      held_->leave();
+    }
+    if (wanted != nullptr) {
+      wanted->join();
+    }
+    held_ = wanted;
+  }
+
+  std::mutex mutex_;
+  std::shared_ptr<BreathingClock> shared_;
+  BreathingClock own_;
+  BreathingClock *held_ = nullptr;  // under mutex_: the clock the voice has joined
+  bool holding_ = false;
+  // Audio thread, for Use::position
+  uint64_t renderStamp_ = UINT64_MAX;
+  uint64_t renderEnd_ = 0;
+};
+
+} // namespace audioapi
@@ -0,0 +1,85 @@
+#pragma once
+#include "BreathingClock.h"
+#include <jsi/jsi.h>
+#include <memory>
+
+using namespace facebook;
+
+namespace audioapi {
+
+// JS handle of a BreathingClock. Not an audio node: it is attached to voices
+// with `voice.breathingClock = clock` and produces no sound of its own.
+class BreathingClockHostObject : public jsi::HostObject {
+public:
+  explicit BreathingClockHostObject(const std::shared_ptr<BreathingClock> &clock) : clock_(clock) {}
+
+  jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    auto propName = propNameId.utf8(runtime);
+
+    if (propName == "mp0") {
+      return jsi::Value(static_cast<double>(clock_->mp0));
+    }
+    if (propName == "mp1") {
+      return jsi::Value(static_cast<double>(clock_->mp1));
+    }
+    if (propName == "md") {
+      return jsi::Value(static_cast<double>(clock_->md));
+    }
+    if (propName == "inhaleDur") {
+      return jsi::Value(static_cast<double>(clock_->inhaleDur));
+    }
+    if (propName == "exhaleDur") {
+      return jsi::Value(static_cast<double>(clock_->exhaleDur));
+    }
+    if (propName == "animationValue") {
+      return jsi::Value(static_cast<double>(clock_->lastBlock().animationValue));
+    }
+    if (propName == "currentPeriod") {
+      return jsi::Value(static_cast<double>(clock_->lastBlock().period));
+    }
+    if (propName == "currentInhaleDur") {
+      return jsi::Value(static_cast<double>(clock_->lastBlock().inhaleDur));
+    }
+    if (propName == "currentExhaleDur") {
+      return jsi::Value(static_cast<double>(clock_->lastBlock().exhaleDur));
+    }
+    if (propName == "isRunning") {
+      return jsi::Value(clock_->isRunning());
+    }
+
+    return jsi::Value::undefined();
+  }
+
+  void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    auto propName = propNameId.utf8(runtime);
+
+    if (propName == "mp0") {
+      clock_->mp0 = static_cast<float>(value.asNumber());
+    } else if (propName == "mp1") {
+      clock_->mp1 = static_cast<float>(value.asNumber());
+    } else if (propName == "md") {
+      clock_->md = static_cast<float>(value.asNumber());
+    } else if (propName == "inhaleDur") {
+      clock_->inhaleDur = static_cast<float>(value.asNumber());
+    } else if (propName == "exhaleDur") {
+      clock_->exhaleDur = static_cast<float>(value.asNumber());
+    }
+  }
+
+  const std::shared_ptr<BreathingClock> &clock() const { return clock_; }
+
+  // The clock behind a JS value: a BreathingClock handle, or nullptr for
+  // null/undefined (detach)
+  static std::shared_ptr<BreathingClock> fromValue(jsi::Runtime &runtime, const jsi::Value &value) {
+    if (!value.isObject()) {
+      return nullptr;
+    }
+    auto hostObject = value.asObject(runtime).getHostObject<BreathingClockHostObject>(runtime);
+    return hostObject ? hostObject->clock() : nullptr;
+  }
+
+private:
+  std::shared_ptr<BreathingClock> clock_;
+};
+
+} // namespace audioapi
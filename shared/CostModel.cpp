@@ -0,0 +1,247 @@
+#include "CostModel.h"
+#include "MartigliNode.h"
+#include "MartigliBinauralNode.h"
+#include "BinauralNode.h"
+#include "SymmetryNode.h"
+#include "NoiseNode.h"
+#include <audioapi/core/BaseAudioContext.h>
+#include <audioapi/utils/AudioBus.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+namespace audioapi::cost {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kWarmupQuanta = 8;
+constexpr int kRuns = 3;
+// Loop of the Symmetry probe that times sequencer events: 16 events every
+// 5 ms. The event term is a small difference of two timings, so both probes
+// run this many times the iterations of the other terms.
+constexpr float kEventProbeLoopSeconds = 0.005f;
+constexpr int kEventProbeRepeat = 4;
+
+std::mutex coefficientsMutex;
+Coefficients current = defaults();
+
+// Out-of-range waveforms and colors render as the node's default case
+double byIndex(const auto &table, int index) {
+  return index >= 0 && index < static_cast<int>(table.size()) ? table[index] : table[0];
+}
+
+// The two carriers of a binaural voice: the mean of the costs of a voice
+// with both on either waveform
+double carriers(const std::array<double, 4> &table, int left, int right) {
+  return 0.5 * (byIndex(table, left) + byIndex(table, right));
+}
+
+template <typename Params>
+bool sameParams(const preset::Voice &a, const preset::Voice &b) {
+  return std::memcmp(&std::get<Params>(a.params), &std::get<Params>(b.params), sizeof(Params)) == 0;
+}
+
+// Nanoseconds per frame of a started node rendering with these parameters
+template <typename Node, typename Params>
+double timeNode(BaseAudioContext *context, const Params &params, const std::shared_ptr<AudioBus> &bus, int frames,
+                int iterations) {
+  auto node = std::make_shared<Node>(context);
+  node->applyParams(params);
+  if constexpr (std::is_same_v<Node, NoiseNode>) {
+    node->start();
+  } else {
+    node->shouldStart = true;
+  }
+  for (int i = 0; i < kWarmupQuanta; ++i) {
+    node->renderVoice(bus, frames);
+  }
+  double best = 0.0;
+  for (int run = 0; run < kRuns; ++run) {
+    const auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      node->renderVoice(bus, frames);
+    }
+    const double nanos = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    best = run == 0 ? nanos : std::min(best, nanos);
+  }
+  return best / (static_cast<double>(iterations) * frames);
+}
+
+// Sequencer events per frame of a Symmetry voice, as voiceCost() counts them
+double symmetryEventsPerFrame(const SymmetryParams &params, float sampleRate) {
+  const int notes = std::clamp(params.nnotes, 1, SymmetryNode::kMaxNotes);
+  const double loopSeconds = std::max(params.d, 1e-3f);
+  return 2.0 * notes / (loopSeconds * sampleRate);
+}
+
+// The mixer's summation of one stereo voice, as in VoiceMixNode
+double timeMix(int frames, int iterations) {
+  std::vector<float> in(2 * frames, 0.25f);
+  std::vector<float> out(2 * frames, 0.0f);
+  volatile float gain = 0.5f;
+  double best = 0.0;
+  for (int run = 0; run < kRuns; ++run) {
+    const auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      const float g = gain;
+      for (int s = 0; s < 2 * frames; ++s) {
+        out[s] += g * in[s];
+      }
+    }
+    const double nanos = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    best = run == 0 ? nanos : std::min(best, nanos);
+  }
+  gain = out[0];
+  return best / (static_cast<double>(iterations) * frames);
+}
+
+} // namespace
+
+const Coefficients &defaults() {
+  static const Coefficients coefficients = [] {
+    Coefficients c;
+    // About three times a desktop core's calibration
+    c.martigli = {150.0, 135.0, 125.0, 120.0};
+    c.martigliBinaural = {190.0, 160.0, 150.0, 140.0};
+    c.binaural = {110.0, 80.0, 75.0, 70.0};
+    c.symmetry = {60.0, 60.0, 55.0, 52.0};
+    c.noise = {32.0, 54.0, 40.0};
+    c.pan = {0.0, 15.0, 40.0, 14.0};
+    c.sample = 60.0;
+    c.symmetryEvent = 240.0;
+    c.mix = 3.0;
+    return c;
+  }();
+  return coefficients;
+}
+
+Coefficients coefficients() {
+  std::lock_guard<std::mutex> lock(coefficientsMutex);
+  return current;
+}
+
+void setCoefficients(const Coefficients &coefficients) {
+  std::lock_guard<std::mutex> lock(coefficientsMutex);
+  current = coefficients;
+}
+
+double voiceCost(const preset::Voice &voice, float sampleRate, const Coefficients &c) {
+  using preset::VoiceType;
+  double nanos = 0.0;
+  switch (voice.type) {
+    case VoiceType::Martigli: {
+      const auto &params = std::get<MartigliParams>(voice.params);
+      nanos = byIndex(c.martigli, params.waveformM) + byIndex(c.pan, params.panOsc);
+      break;
+    }
+    case VoiceType::MartigliBinaural: {
+      const auto &params = std::get<MartigliBinauralParams>(voice.params);
+      nanos = carriers(c.martigliBinaural, params.waveformL, params.waveformR) + byIndex(c.pan, params.panOsc);
+      break;
+    }
+    case VoiceType::Binaural: {
+      const auto &params = std::get<BinauralParams>(voice.params);
+      nanos = carriers(c.binaural, params.waveformL, params.waveformR) + byIndex(c.pan, params.panOsc);
+      break;
+    }
+    case VoiceType::Symmetry: {
+      const auto &params = std::get<SymmetryParams>(voice.params);
+      nanos = byIndex(c.symmetry, params.waveform) + c.symmetryEvent * symmetryEventsPerFrame(params, sampleRate);
+      break;
+    }
+    case VoiceType::Noise:
+      nanos = byIndex(c.noise, std::get<NoiseParams>(voice.params).noiseColor);
+      break;
+    case VoiceType::Sample:
+      nanos = c.sample;
+      break;
+    default:
+      return 0.0;
+  }
+  return nanos + c.mix;
+}
+
+Estimate estimate(const preset::Preset &preset, float sampleRate, const Coefficients &c) {
+  Estimate result;
+  result.voices.reserve(preset.voices.size());
+  for (size_t i = 0; i < preset.voices.size(); ++i) {
+    const preset::Voice &voice = preset.voices[i];
+    VoiceCost cost;
+    cost.type = voice.type;
+    // Every voice of a preset has the preset's seed, so same parameters
+    // means the same render key
+    for (size_t j = 0; j < i && voice.type == preset::VoiceType::Symmetry && !cost.shared; ++j) {
+      cost.shared = preset.voices[j].type == voice.type && sameParams<SymmetryParams>(voice, preset.voices[j]);
+    }
+    cost.nanosPerFrame = cost.shared ? c.mix : voiceCost(voice, sampleRate, c);
+    result.nanosPerFrame += cost.nanosPerFrame;
+    result.sharedVoices += cost.shared ? 1 : 0;
+    result.voices.push_back(cost);
+  }
+  result.budgetPercent = result.nanosPerFrame * sampleRate * 1e-7;
+  return result;
+}
+
+Coefficients calibrate(BaseAudioContext *context, int framesPerQuantum, int iterations) {
+  const int frames = std::max(1, framesPerQuantum);
+  iterations = std::max(1, iterations);
+  const float sampleRate = context->getSampleRate();
+  auto bus = std::make_shared<AudioBus>(frames, 2, sampleRate);
+
+  Coefficients c = defaults();
+
+  // Symmetry's per-event term: the same voice at its default loop and at a
+  // loop short enough to sequence many events per run. The difference over
+  // the difference in event rate is the cost of one event; the symmetry
+  // terms below are then what is left without events.
+  SymmetryParams slowLoop;
+  SymmetryParams fastLoop;
+  fastLoop.d = kEventProbeLoopSeconds;
+  const int probeIterations = kEventProbeRepeat * iterations;
+  const double slowNanos = timeNode<SymmetryNode>(context, slowLoop, bus, frames, probeIterations);
+  const double fastNanos = timeNode<SymmetryNode>(context, fastLoop, bus, frames, probeIterations);
+  const double rateDifference =
+      symmetryEventsPerFrame(fastLoop, sampleRate) - symmetryEventsPerFrame(slowLoop, sampleRate);
+  c.symmetryEvent = std::max(0.0, (fastNanos - slowNanos) / rateDifference);
+
+  for (int waveform = 0; waveform < 4; ++waveform) {
+    MartigliParams martigli;
+    martigli.waveformM = waveform;
+    c.martigli[waveform] = timeNode<MartigliNode>(context, martigli, bus, frames, iterations);
+
+    MartigliBinauralParams martigliBinaural;
+    martigliBinaural.waveformL = martigliBinaural.waveformR = waveform;
+    c.martigliBinaural[waveform] = timeNode<MartigliBinauralNode>(context, martigliBinaural, bus, frames, iterations);
+
+    BinauralParams binaural;
+    binaural.waveformL = binaural.waveformR = waveform;
+    c.binaural[waveform] = timeNode<BinauralNode>(context, binaural, bus, frames, iterations);
+
+    SymmetryParams symmetry;
+    symmetry.waveform = waveform;
+    c.symmetry[waveform] =
+        std::max(0.0, timeNode<SymmetryNode>(context, symmetry, bus, frames, iterations) -
+                          c.symmetryEvent * symmetryEventsPerFrame(symmetry, sampleRate));
+  }
+  for (int color = 0; color < 3; ++color) {
+    NoiseParams noise;
+    noise.noiseColor = color;
+    c.noise[color] = timeNode<NoiseNode>(context, noise, bus, frames, iterations);
+  }
+  // Panning on top of a sine binaural, which has every mode
+  c.pan[0] = 0.0;
+  for (int mode = 1; mode < 4; ++mode) {
+    BinauralParams binaural;
+    binaural.panOsc = mode;
+    c.pan[mode] = std::max(0.0, timeNode<BinauralNode>(context, binaural, bus, frames, iterations) - c.binaural[0]);
+  }
+  c.mix = timeMix(frames, iterations);
+  c.calibrated = true;
+  return c;
+}
+
+} // namespace audioapi::cost
@@ -0,0 +1,78 @@
+#pragma once
+#include "PresetFormat.h"
+#include <array>
+#include <vector>
+
+namespace audioapi {
+class BaseAudioContext;
+}
+
+namespace audioapi::cost {
+
+// Static CPU cost of a preset, known from its parameters before any voice is
+// built, so that a preset too heavy for the device (a generated one, say) can
+// be rejected or simplified instead of dropping out once it plays.
+//
+// A voice costs a sum of per-frame terms read off its parameters: the carrier
+// kernel of its type and waveform(s), its panOsc mode, the noise filter of its
+// color, Symmetry's sequencer events (2 * nnotes per loop of d seconds; the
+// notes themselves always cost one bunch of SymmetryNode::kMaxVoices lanes,
+// however many there are), and the mixer summing it into the bus. Identical
+// Symmetry voices count once plus their summation, as
+// VoiceMixNode::shareIdenticalVoices() renders them once. The estimate is CPU
+// time while every voice sounds, at QualityTier::Full: the parallel mixer
+// shortens the wall time of a quantum, not the work.
+//
+// Terms are in nanoseconds per frame, not cycles, as the clock of a phone
+// core is neither known nor constant. The defaults are rough values for a
+// low-end Android phone; calibrate() replaces them with the actual nodes
+// timed on this device.
+struct Coefficients {
+  std::array<double, 4> martigli{};          // by waveformM, panOsc 0
+  std::array<double, 4> martigliBinaural{};  // both carriers with this waveform, panOsc 0
+  std::array<double, 4> binaural{};          // same
+  std::array<double, 4> symmetry{};          // by waveform
+  std::array<double, 3> noise{};             // by noiseColor
+  std::array<double, 4> pan{};               // added by panOsc 0..3
+  double sample = 0.0;                       // interpolated playback
+  double symmetryEvent = 0.0;                // nanoseconds per note on or off
+  double mix = 0.0;                          // VoiceMixNode summation, per voice
+  bool calibrated = false;
+};
+
+struct VoiceCost {
+  preset::VoiceType type = preset::VoiceType::None;
+  double nanosPerFrame = 0.0;
+  bool shared = false;  // rendered by an identical earlier voice
+};
+
+struct Estimate {
+  std::vector<VoiceCost> voices;  // in preset order
+  double nanosPerFrame = 0.0;
+  double budgetPercent = 0.0;     // of real time at the sample rate
+  int sharedVoices = 0;
+};
+
+const Coefficients &defaults();
+
+// The coefficients estimate() uses by default: the last calibrated or set
+// ones, the defaults before. Thread-safe.
+Coefficients coefficients();
+void setCoefficients(const Coefficients &coefficients);
+
+double voiceCost(const preset::Voice &voice, float sampleRate, const Coefficients &coefficients);
+
+Estimate estimate(const preset::Preset &preset, float sampleRate, const Coefficients &coefficients);
+inline Estimate estimate(const preset::Preset &preset, float sampleRate) {
+  return estimate(preset, sampleRate, coefficients());
+}
+
+// Times framesPerQuantum-frame quanta of each term's node (created for the
+// purpose, never connected), best of three runs of `iterations` quanta;
+// symmetryEvent comes from two Symmetry voices that differ only in loop
+// length. About 10 ms on a desktop core for 32 quanta, on the calling thread; run it while
+// nothing plays, as the Martigli probes publish their breathing to the UI.
+// Sample keeps its default, having no file to play.
+Coefficients calibrate(BaseAudioContext *context, int framesPerQuantum, int iterations);
+
+} // namespace audioapi::cost
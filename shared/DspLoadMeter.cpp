@@ -0,0 +1,71 @@
+#include "DspLoadMeter.h"
+#include "InstrumentRegistry.h"
+#include <algorithm>
+
+namespace audioapi {
+
+#if CUSTOM_NODES_DSP_METER
+
+DspLoadMeter::DspLoadMeter(const char *kind) {
+  InstrumentRegistry<DspLoadMeter>::shared().add(this, kind, name_);
+}
+
+DspLoadMeter::~DspLoadMeter() {
+  InstrumentRegistry<DspLoadMeter>::shared().remove(this);
+}
+
+void DspLoadMeter::record(uint32_t nanos, uint32_t budgetNanos) {
+  const uint64_t block = blocks_.load(std::memory_order_relaxed);
+  const auto slot = static_cast<size_t>(block % kWindow);
+  nanos_[slot].store(nanos, std::memory_order_relaxed);
+  budgetNanos_[slot].store(budgetNanos, std::memory_order_relaxed);
+  blocks_.store(block + 1, std::memory_order_release);
+}
+
+DspLoadStats DspLoadMeter::stats() const {
+  DspLoadStats stats;
+  stats.node = name_;
+  stats.blocks = blocks_.load(std::memory_order_acquire);
+  const int count = static_cast<int>(std::min<uint64_t>(stats.blocks, kWindow));
+  if (count == 0) {
+    return stats;
+  }
+
+  std::array<uint32_t, kWindow> nanos;
+  double totalNanos = 0.0;
+  double totalBudget = 0.0;
+  for (int i = 0; i < count; ++i) {
+    nanos[i] = nanos_[i].load(std::memory_order_relaxed);
+    const uint32_t budget = budgetNanos_[i].load(std::memory_order_relaxed);
+    totalNanos += nanos[i];
+    totalBudget += budget;
+    if (budget > 0) {
+      stats.peakBudgetPercent = std::max(stats.peakBudgetPercent, 100.0 * nanos[i] / budget);
+    }
+  }
+
+  const int p99 = std::max(0, (count * 99 + 99) / 100 - 1);
+  std::nth_element(nanos.begin(), nanos.begin() + p99, nanos.begin() + count);
+  stats.p99Micros = nanos[p99] * 1e-3;
+  stats.maxMicros = *std::max_element(nanos.begin() + p99, nanos.begin() + count) * 1e-3;
+  stats.meanMicros = totalNanos / count * 1e-3;
+  stats.budgetPercent = totalBudget > 0.0 ? 100.0 * totalNanos / totalBudget : 0.0;
+  return stats;
+}
+
+std::vector<DspLoadStats> collectDspLoad() {
+  std::vector<DspLoadStats> result;
+  InstrumentRegistry<DspLoadMeter>::shared().forEach(
+      [&](const DspLoadMeter &meter) { result.push_back(meter.stats()); });
+  return result;
+}
+
+#else
+
+std::vector<DspLoadStats> collectDspLoad() {
+  return {};
+}
+
+#endif
+
+} // namespace audioapi
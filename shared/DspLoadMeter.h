@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-node DSP load instrumentation. On by default in debug builds (DEBUG on
+// iOS, no NDEBUG elsewhere) and compiled out entirely otherwise; define
+// CUSTOM_NODES_DSP_METER to 0 or 1 to override.
+#ifndef CUSTOM_NODES_DSP_METER
+#if defined(DEBUG) || (!defined(__APPLE__) && !defined(NDEBUG))
+#define CUSTOM_NODES_DSP_METER 1
+#else
+#define CUSTOM_NODES_DSP_METER 0
+#endif
+#endif
+
+namespace audioapi {
+
+struct DspLoadStats {
+  std::string node;              // node kind and instance number, e.g. "Binaural#3"
+  uint64_t blocks = 0;           // blocks processed since creation
+  double meanMicros = 0.0;       // over the last DspLoadMeter::kWindow blocks
+  double p99Micros = 0.0;
+  double maxMicros = 0.0;
+  double budgetPercent = 0.0;    // processing time / block duration, mean
+  double peakBudgetPercent = 0.0;
+};
+
+#if CUSTOM_NODES_DSP_METER
+
+// Times a node's processNode with the monotonic clock and keeps the last
+// kWindow block durations in a ring. The audio thread is the only writer and
+// never locks; readers copy the ring (relaxed loads, a block written during
+// the copy lands in this or the next report) and compute the statistics on
+// their own thread. Meters register themselves for collectDspLoad().
+class DspLoadMeter {
+public:
+  static constexpr int kWindow = 512;
+
+  explicit DspLoadMeter(const char *kind);
+  ~DspLoadMeter();
+
+  DspLoadMeter(const DspLoadMeter &) = delete;
+  DspLoadMeter &operator=(const DspLoadMeter &) = delete;
+
+  // Audio thread
+  void record(uint32_t nanos, uint32_t budgetNanos);
+
+  DspLoadStats stats() const;
+
+  class Scope {
+  public:
+    Scope(DspLoadMeter &meter, int frames, float sampleRate)
+        : meter_(meter),
+          budgetNanos_(static_cast<uint32_t>(1e9 * frames / sampleRate)),
+          start_(std::chrono::steady_clock::now()) {}
+    ~Scope() {
+      auto elapsed = std::chrono::steady_clock::now() - start_;
+      meter_.record(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                    budgetNanos_);
+    }
+
+  private:
+    DspLoadMeter &meter_;
+    uint32_t budgetNanos_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+private:
+  std::string name_;
+  std::array<std::atomic<uint32_t>, kWindow> nanos_{};
+  std::array<std::atomic<uint32_t>, kWindow> budgetNanos_{};
+  std::atomic<uint64_t> blocks_{0};
+};
+
+#define CUSTOM_NODES_DSP_SCOPE(meter, frames, sampleRate) \
+  ::audioapi::DspLoadMeter::Scope dspLoadScope_((meter), (frames), (sampleRate))
+
+#else
+
+class DspLoadMeter {
+public:
+  explicit DspLoadMeter(const char *) {}
+};
+
+#define CUSTOM_NODES_DSP_SCOPE(meter, frames, sampleRate) ((void)0)
+
+#endif
+
+// Statistics of every live node, in creation order. Empty when the meters
+// are compiled out. JS thread.
+std::vector<DspLoadStats> collectDspLoad();
+
+} // namespace audioapi
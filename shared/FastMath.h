@@ -0,0 +1,427 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CUSTOM_NODES_FASTMATH_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CUSTOM_NODES_FASTMATH_SSE2 1
+#endif
+
+// Header-only polynomial approximations for the oscillator hot paths.
+//
+// Every function takes its accuracy tier as a template argument, so a node
+// picks its tier at compile time and pays nothing for the choice:
+//
+//   Fast      sin -83 dB, exp2 0.13 cents, log2 0.007 cents
+//   Balanced  sin -122 dB, exp2 0.005 cents, log2 < 0.001 cents
+//   Precise   sin -133 dB, exp2 0.0003 cents (float rounding dominates)
+//   Reference std:: functions, for comparison
+//
+// (sin errors are for phases in [0, 1) turns, the range oscillators use.)
+//
+// The coefficients are minimax (Remez) fits over the reduced ranges below.
+// measureFastMathAccuracy() in FastMathAccuracy.h reports the measured error
+// of each function and tier against the std:: reference.
+//
+// Oscillator phases in this project are mostly kept in turns (0..1 per
+// cycle), so sin2pi/cos2pi take turns directly and skip a multiply by 2*pi.
+
+#ifndef CUSTOM_NODES_FASTMATH_ACCURACY
+#define CUSTOM_NODES_FASTMATH_ACCURACY 1  // Balanced
+#endif
+
+namespace audioapi::fastmath {
+
+enum class Accuracy { Fast = 0, Balanced = 1, Precise = 2, Reference = 3 };
+
+inline constexpr Accuracy kDefaultAccuracy = static_cast<Accuracy>(CUSTOM_NODES_FASTMATH_ACCURACY);
+
+inline constexpr float kTwoPi = 6.283185307179586f;
+inline constexpr float kInvTwoPi = 0.15915494309189535f;
+
+// ---------------------------------------------------------------------------
+// Range reduction
+
+// x mod 1 into [0, 1), also for negative x. Replaces fmod(x, 1).
+inline float wrap01(float x) { return x - std::floor(x); }
+inline double wrap01(double x) { return x - std::floor(x); }
+
+// x mod period into [0, period) for period > 0. Replaces fmod for phases.
+inline float wrap(float x, float period) { return x - period * std::floor(x / period); }
+inline double wrap(double x, double period) { return x - period * std::floor(x / period); }
+
+// ---------------------------------------------------------------------------
+// Float4: the four-lane type the SIMD variants are written against. Falls
+// back to plain arrays where neither NEON (arm64) nor SSE2 is available.
+
+struct Float4 {
+#if defined(CUSTOM_NODES_FASTMATH_NEON)
+  float32x4_t v;
+  static Float4 load(const float *p) { return {vld1q_f32(p)}; }
+  static Float4 broadcast(float x) { return {vdupq_n_f32(x)}; }
+  void store(float *p) const { vst1q_f32(p, v); }
+#elif defined(CUSTOM_NODES_FASTMATH_SSE2)
+  __m128 v;
+  static Float4 load(const float *p) { return {_mm_loadu_ps(p)}; }
+  static Float4 broadcast(float x) { return {_mm_set1_ps(x)}; }
+  void store(float *p) const { _mm_storeu_ps(p, v); }
+#else
+  float v[4];
+  static Float4 load(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+  static Float4 broadcast(float x) { return {{x, x, x, x}}; }
+  void store(float *p) const { memcpy(p, v, sizeof(v)); }
+#endif
+};
+
+#if defined(CUSTOM_NODES_FASTMATH_NEON)
+inline Float4 operator+(Float4 a, Float4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline Float4 operator-(Float4 a, Float4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, Float4 b) { return {vmulq_f32(a.v, b.v)}; }
+inline Float4 operator/(Float4 a, Float4 b) { return {vdivq_f32(a.v, b.v)}; }
+inline Float4 abs(Float4 a) { return {vabsq_f32(a.v)}; }
+inline Float4 floor(Float4 a) { return {vrndmq_f32(a.v)}; }
+inline Float4 min(Float4 a, Float4 b) { return {vminq_f32(a.v, b.v)}; }
+inline Float4 max(Float4 a, Float4 b) { return {vmaxq_f32(a.v, b.v)}; }
+// Lanes where a > b take x, the others y.
+inline Float4 selectGreater(Float4 a, Float4 b, Float4 x, Float4 y) {
+  return {vbslq_f32(vcgtq_f32(a.v, b.v), x.v, y.v)};
+}
+// Sum of the four lanes.
+inline float sum(Float4 a) { return vaddvq_f32(a.v); }
+// 2^n for lanes holding integral n in [-126, 127].
+inline Float4 pow2Integer(Float4 n) {
+  int32x4_t bits = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127)), 23);
+  return {vreinterpretq_f32_s32(bits)};
+}
+// Splits x > 0 into exponent and mantissa in [1, 2).
+inline void frexp2(Float4 x, Float4 &exponent, Float4 &mantissa) {
+  int32x4_t bits = vreinterpretq_s32_f32(x.v);
+  exponent.v = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127)));
+  mantissa.v = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007FFFFF)), vdupq_n_s32(0x3F800000)));
+}
+#elif defined(CUSTOM_NODES_FASTMATH_SSE2)
+inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline Float4 operator/(Float4 a, Float4 b) { return {_mm_div_ps(a.v, b.v)}; }
+inline Float4 abs(Float4 a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+inline Float4 floor(Float4 a) {
+  // Truncate, then step down where truncation rounded a negative value up.
+  __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+  return {_mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.0f)))};
+}
+inline Float4 min(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline Float4 max(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+inline Float4 selectGreater(Float4 a, Float4 b, Float4 x, Float4 y) {
+  __m128 mask = _mm_cmpgt_ps(a.v, b.v);
+  return {_mm_or_ps(_mm_and_ps(mask, x.v), _mm_andnot_ps(mask, y.v))};
+}
+inline float sum(Float4 a) {
+  __m128 pairs = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+  return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+inline Float4 pow2Integer(Float4 n) {
+  __m128i bits = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127)), 23);
+  return {_mm_castsi128_ps(bits)};
+}
+inline void frexp2(Float4 x, Float4 &exponent, Float4 &mantissa) {
+  __m128i bits = _mm_castps_si128(x.v);
+  exponent.v = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+  mantissa.v = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+                                             _mm_set1_epi32(0x3F800000)));
+}
+#else
+#define CUSTOM_NODES_FASTMATH_LANEWISE(expr) \
+  Float4 r; \
+  for (int i = 0; i < 4; ++i) { r.v[i] = (expr); } \
+  return r;
+inline Float4 operator+(Float4 a, Float4 b) { CUSTOM_NODES_FASTMATH_LANEWISE(a.v[i] + b.v[i]) }
+inline Float4 operator-(Float4 a, Float4 b) { CUSTOM_NODES_FASTMATH_LANEWISE(a.v[i] - b.v[i]) }
+inline Float4 operator*(Float4 a, Float4 b) { CUSTOM_NODES_FASTMATH_LANEWISE(a.v[i] * b.v[i]) }
+inline Float4 operator/(Float4 a, Float4 b) { CUSTOM_NODES_FASTMATH_LANEWISE(a.v[i] / b.v[i]) }
+inline Float4 abs(Float4 a) { CUSTOM_NODES_FASTMATH_LANEWISE(std::fabs(a.v[i])) }
+inline Float4 floor(Float4 a) { CUSTOM_NODES_FASTMATH_LANEWISE(std::floor(a.v[i])) }
+inline Float4 min(Float4 a, Float4 b) { CUSTOM_NODES_FASTMATH_LANEWISE(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+inline Float4 max(Float4 a, Float4 b) { CUSTOM_NODES_FASTMATH_LANEWISE(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+inline Float4 selectGreater(Float4 a, Float4 b, Float4 x, Float4 y) {
+  CUSTOM_NODES_FASTMATH_LANEWISE(a.v[i] > b.v[i] ? x.v[i] : y.v[i])
+}
+inline float sum(Float4 a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+inline Float4 pow2Integer(Float4 n) {
+  CUSTOM_NODES_FASTMATH_LANEWISE(std::ldexp(1.0f, static_cast<int>(n.v[i])))
+}
+inline void frexp2(Float4 x, Float4 &exponent, Float4 &mantissa) {
+  for (int i = 0; i < 4; ++i) {
+    int e = 0;
+    mantissa.v[i] = std::frexp(x.v[i], &e) * 2.0f;
+    exponent.v[i] = static_cast<float>(e - 1);
+  }
+}
+#undef CUSTOM_NODES_FASTMATH_LANEWISE
+#endif
+
+inline Float4 operator+(Float4 a, float b) { return a + Float4::broadcast(b); }
+inline Float4 operator-(Float4 a, float b) { return a - Float4::broadcast(b); }
+inline Float4 operator*(Float4 a, float b) { return a * Float4::broadcast(b); }
+inline Float4 operator+(float a, Float4 b) { return Float4::broadcast(a) + b; }
+inline Float4 operator-(float a, Float4 b) { return Float4::broadcast(a) - b; }
+inline Float4 operator*(float a, Float4 b) { return Float4::broadcast(a) * b; }
+
+// Scalar counterparts, so the kernels below are written once for both.
+template <typename T>
+inline T splat(float x) {
+  if constexpr (std::is_same_v<T, Float4>) {
+    return Float4::broadcast(x);
+  } else {
+    return x;
+  }
+}
+inline float abs(float a) { return std::fabs(a); }
+inline float floor(float a) { return std::floor(a); }
+inline float min(float a, float b) { return a < b ? a : b; }
+inline float max(float a, float b) { return a > b ? a : b; }
+inline float selectGreater(float a, float b, float x, float y) { return a > b ? x : y; }
+inline float pow2Integer(float n) {
+  const int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+inline void frexp2(float x, float &exponent, float &mantissa) {
+  int32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  exponent = static_cast<float>((bits >> 23) - 127);
+  bits = (bits & 0x007FFFFF) | 0x3F800000;
+  memcpy(&mantissa, &bits, sizeof(mantissa));
+}
+
+// ---------------------------------------------------------------------------
+// Kernels, generic over float and Float4
+
+namespace detail {
+
+// sin(2*pi*v) for v in [-0.25, 0.25], odd polynomial in v.
+template <Accuracy A, typename T>
+inline T sinQuarter(T v) {
+  const T v2 = v * v;
+  if constexpr (A == Accuracy::Fast) {
+    return v * (6.281280077f + v2 * (-41.09524269f + v2 * 73.58551475f));
+  } else if constexpr (A == Accuracy::Balanced) {
+    return v * (6.283164044f + v2 * (-41.33714237f + v2 * (81.34076889f + v2 * -70.99343328f)));
+  } else {
+    return v * (6.283185302f + v2 * (-41.34169186f + v2 * (81.60326573f +
+           v2 * (-76.59820792f + v2 * 39.87323178f))));
+  }
+}
+
+// 2^f for f in [0, 1).
+template <Accuracy A, typename T>
+inline T exp2Unit(T f) {
+  if constexpr (A == Accuracy::Fast) {
+    return 0.9999252186f + f * (0.6958335405f + f * (0.2260671554f + f * 0.07802452266f));
+  } else if constexpr (A == Accuracy::Balanced) {
+    return 1.000002593f + f * (0.6930038345f + f * (0.2414427569f + f * (0.05201146062f +
+           f * 0.01353416791f)));
+  } else {
+    return 0.9999999251f + f * (0.6931530732f + f * (0.2401536170f + f * (0.05582631805f +
+           f * (0.008989340095f + f * 0.001877576673f))));
+  }
+}
+
+// log2((1 + s) / (1 - s)) for |s| <= 0.1716 (mantissa in [sqrt(1/2), sqrt(2))).
+template <Accuracy A, typename T>
+inline T log2Ratio(T s) {
+  const T s2 = s * s;
+  if constexpr (A == Accuracy::Fast) {
+    return s * (2.885228570f + s2 * 0.9835345091f);
+  } else if constexpr (A == Accuracy::Balanced) {
+    return s * (2.885391289f + s2 * (0.9614708090f + s2 * 0.5989738857f));
+  } else {
+    return s * (2.885390073f + s2 * (0.9618007592f + s2 * (0.5765845414f + s2 * 0.4342559412f)));
+  }
+}
+
+// sin(2*pi*t) == sin(2*pi*v) with v in [-0.25, 0.25]:
+// sin(2*pi*t) = cos(2*pi*w) for w = t - 1/4, cos is even with period 1, and
+// cos(2*pi*u) = sin(2*pi*(1/4 - u)).
+template <typename T>
+inline T reduceTurns(T t) {
+  const T w = t - 0.25f;
+  const T u = abs(w - floor(w + 0.5f));
+  return 0.25f - u;
+}
+
+template <Accuracy A, typename T>
+inline T exp2Kernel(T x) {
+  x = min(max(x, splat<T>(-126.0f)), splat<T>(126.0f));
+  const T n = floor(x);
+  return exp2Unit<A>(x - n) * pow2Integer(n);
+}
+
+template <Accuracy A, typename T>
+inline T log2Kernel(T x) {
+  T exponent, mantissa;
+  frexp2(x, exponent, mantissa);
+  // Center the mantissa on 1 so the series converges fastest.
+  const T high = selectGreater(mantissa, splat<T>(1.41421356f), splat<T>(1.0f), splat<T>(0.0f));
+  mantissa = mantissa * (1.0f - 0.5f * high);
+  exponent = exponent + high;
+  return exponent + log2Ratio<A>((mantissa - 1.0f) / (mantissa + 1.0f));
+}
+
+} // namespace detail
+
+// ---------------------------------------------------------------------------
+// Scalar API
+
+// sin(2*pi*turns), any finite turns.
+template <Accuracy A = kDefaultAccuracy>
+inline float sin2pi(float turns) {
+  if constexpr (A == Accuracy::Reference) {
+    return static_cast<float>(std::sin(6.283185307179586 * turns));
+  } else {
+    return detail::sinQuarter<A>(detail::reduceTurns(turns));
+  }
+}
+
+// cos(2*pi*turns)
+template <Accuracy A = kDefaultAccuracy>
+inline float cos2pi(float turns) {
+  return sin2pi<A>(turns + 0.25f);
+}
+
+// sin(radians), for code that keeps its phase in radians.
+template <Accuracy A = kDefaultAccuracy>
+inline float sin(float radians) {
+  if constexpr (A == Accuracy::Reference) {
+    return std::sin(radians);
+  } else {
+    return sin2pi<A>(radians * kInvTwoPi);
+  }
+}
+
+template <Accuracy A = kDefaultAccuracy>
+inline float cos(float radians) {
+  if constexpr (A == Accuracy::Reference) {
+    return std::cos(radians);
+  } else {
+    return cos2pi<A>(radians * kInvTwoPi);
+  }
+}
+
+// 2^x, x clamped to [-126, 126].
+template <Accuracy A = kDefaultAccuracy>
+inline float exp2(float x) {
+  if constexpr (A == Accuracy::Reference) {
+    return std::exp2(x);
+  } else {
+    return detail::exp2Kernel<A>(x);
+  }
+}
+
+// log2(x) for normal x > 0.
+template <Accuracy A = kDefaultAccuracy>
+inline float log2(float x) {
+  if constexpr (A == Accuracy::Reference) {
+    return std::log2(x);
+  } else {
+    return detail::log2Kernel<A>(x);
+  }
+}
+
+// x^y for x > 0.
+template <Accuracy A = kDefaultAccuracy>
+inline float pow(float x, float y) {
+  if constexpr (A == Accuracy::Reference) {
+    return std::pow(x, y);
+  } else {
+    return exp2<A>(y * log2<A>(x));
+  }
+}
+
+// sin2pi/sin at tier A, or at Fast when `fast` is set, for nodes whose
+// accuracy QualityGovernor lowers at run time. The flag is the same for a
+// whole block, so the branch predicts perfectly.
+template <Accuracy A = kDefaultAccuracy>
+inline float sin2pi(float turns, bool fast) {
+  return fast ? sin2pi<Accuracy::Fast>(turns) : sin2pi<A>(turns);
+}
+
+template <Accuracy A = kDefaultAccuracy>
+inline float sin(float radians, bool fast) {
+  return fast ? sin<Accuracy::Fast>(radians) : sin<A>(radians);
+}
+
+// ---------------------------------------------------------------------------
+// SIMD API: four lanes at once, and whole-block helpers with a scalar tail.
+
+template <Accuracy A = kDefaultAccuracy>
+inline Float4 sin2pi(Float4 turns) {
+  if constexpr (A == Accuracy::Reference) {
+    float lanes[4];
+    turns.store(lanes);
+    for (float &lane : lanes) {
+      lane = sin2pi<A>(lane);
+    }
+    return Float4::load(lanes);
+  } else {
+    return detail::sinQuarter<A>(detail::reduceTurns(turns));
+  }
+}
+
+template <Accuracy A = kDefaultAccuracy>
+inline Float4 exp2(Float4 x) {
+  if constexpr (A == Accuracy::Reference) {
+    float lanes[4];
+    x.store(lanes);
+    for (float &lane : lanes) {
+      lane = std::exp2(lane);
+    }
+    return Float4::load(lanes);
+  } else {
+    return detail::exp2Kernel<A>(x);
+  }
+}
+
+template <Accuracy A = kDefaultAccuracy>
+inline Float4 log2(Float4 x) {
+  if constexpr (A == Accuracy::Reference) {
+    float lanes[4];
+    x.store(lanes);
+    for (float &lane : lanes) {
+      lane = std::log2(lane);
+    }
+    return Float4::load(lanes);
+  } else {
+    return detail::log2Kernel<A>(x);
+  }
+}
+
+template <Accuracy A = kDefaultAccuracy>
+inline void sin2pi(const float *turns, float *out, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    sin2pi<A>(Float4::load(turns + i)).store(out + i);
+  }
+  for (; i < count; ++i) {
+    out[i] = sin2pi<A>(turns[i]);
+  }
+}
+
+template <Accuracy A = kDefaultAccuracy>
+inline void exp2(const float *x, float *out, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    exp2<A>(Float4::load(x + i)).store(out + i);
+  }
+  for (; i < count; ++i) {
+    out[i] = exp2<A>(x[i]);
+  }
+}
+
+} // namespace audioapi::fastmath
@@ -0,0 +1,135 @@
+#pragma once
+#include "FastMath.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace audioapi::fastmath {
+
+// One row of the accuracy report: the worst error of one function at one
+// tier against the double-precision std:: reference, and its cost.
+struct AccuracyResult {
+  std::string function;
+  std::string tier;
+  double maxAbsError;     // in the function's own units
+  double maxErrorDb;      // 20*log10 of the worst absolute (sin) or relative (exp2, pow) error
+  double maxErrorCents;   // pitch error; 0 for sin
+  double nanosPerCall;
+};
+
+namespace detail {
+
+inline const char *tierName(Accuracy tier) {
+  switch (tier) {
+    case Accuracy::Fast: return "fast";
+    case Accuracy::Balanced: return "balanced";
+    case Accuracy::Precise: return "precise";
+    case Accuracy::Reference: return "reference";
+  }
+  return "";
+}
+
+inline double toDb(double error) {
+  return error > 0.0 ? 20.0 * std::log10(error) : -300.0;
+}
+
+// Throughput over a block, the way the nodes use these functions.
+template <typename Fn>
+double nanosPerCall(Fn &&fn, const std::vector<float> &inputs) {
+  std::vector<float> outputs(inputs.size());
+  volatile float sink = 0.0f;
+  const auto start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < 8; ++repeat) {
+    fn(inputs.data(), outputs.data(), static_cast<int>(inputs.size()));
+    sink = sink + outputs[repeat];
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / (8.0 * inputs.size());
+}
+
+template <typename Fn>
+auto perSample(Fn fn) {
+  return [fn](const float *in, float *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      out[i] = fn(in[i]);
+    }
+  };
+}
+
+template <Accuracy A>
+void measureTier(std::vector<AccuracyResult> &results, int samples) {
+  std::vector<float> turns(samples), exponents(samples), positives(samples);
+  for (int i = 0; i < samples; ++i) {
+    const double u = (i + 0.5) / samples;
+    turns[i] = static_cast<float>(u);                       // one oscillator cycle
+    exponents[i] = static_cast<float>(-10.0 + 20.0 * u);    // +-10 octaves
+    positives[i] = static_cast<float>(std::exp2(-10.0 + 24.0 * u));  // 1e-3 .. 1e4
+  }
+
+  // sin2pi, scalar and four lanes
+  double sinError = 0.0;
+  double sin4Error = 0.0;
+  for (int i = 0; i + 4 <= samples; i += 4) {
+    float lanes[4];
+    sin2pi<A>(Float4::load(&turns[i])).store(lanes);
+    for (int k = 0; k < 4; ++k) {
+      const double reference = std::sin(6.283185307179586 * turns[i + k]);
+      sinError = std::max(sinError, std::fabs(sin2pi<A>(turns[i + k]) - reference));
+      sin4Error = std::max(sin4Error, std::fabs(lanes[k] - reference));
+    }
+  }
+  results.push_back({"sin2pi", tierName(A), sinError, toDb(sinError), 0.0,
+                     nanosPerCall(perSample([](float x) { return sin2pi<A>(x); }), turns)});
+  results.push_back({"sin2pi x4", tierName(A), sin4Error, toDb(sin4Error), 0.0,
+                     nanosPerCall([](const float *in, float *out, int count) { sin2pi<A>(in, out, count); }, turns)});
+
+  // exp2 (scalar and four lanes) and pow: relative error, reported as cents of pitch
+  double exp2Error = 0.0;
+  double exp24Error = 0.0;
+  double powError = 0.0;
+  for (int i = 0; i + 4 <= samples; i += 4) {
+    float lanes[4];
+    exp2<A>(Float4::load(&exponents[i])).store(lanes);
+    for (int k = 0; k < 4; ++k) {
+      const double reference = std::exp2(static_cast<double>(exponents[i + k]));
+      exp2Error = std::max(exp2Error, std::fabs(exp2<A>(exponents[i + k]) / reference - 1.0));
+      exp24Error = std::max(exp24Error, std::fabs(lanes[k] / reference - 1.0));
+    }
+  }
+  for (int i = 0; i < samples; ++i) {
+    const double reference = std::pow(static_cast<double>(positives[i]), 1.5);
+    powError = std::max(powError, std::fabs(pow<A>(positives[i], 1.5f) / reference - 1.0));
+  }
+  results.push_back({"exp2", tierName(A), exp2Error, toDb(exp2Error), 1200.0 * std::log2(1.0 + exp2Error),
+                     nanosPerCall(perSample([](float x) { return exp2<A>(x); }), exponents)});
+  results.push_back({"exp2 x4", tierName(A), exp24Error, toDb(exp24Error), 1200.0 * std::log2(1.0 + exp24Error),
+                     nanosPerCall([](const float *in, float *out, int count) { exp2<A>(in, out, count); }, exponents)});
+  results.push_back({"pow", tierName(A), powError, toDb(powError), 1200.0 * std::log2(1.0 + powError),
+                     nanosPerCall(perSample([](float x) { return pow<A>(x, 1.5f); }), positives)});
+
+  // log2: absolute error in octaves
+  double log2Error = 0.0;
+  for (int i = 0; i < samples; ++i) {
+    log2Error = std::max(log2Error, std::fabs(log2<A>(positives[i]) - std::log2(static_cast<double>(positives[i]))));
+  }
+  results.push_back({"log2", tierName(A), log2Error, toDb(log2Error), 1200.0 * log2Error,
+                     nanosPerCall(perSample([](float x) { return log2<A>(x); }), positives)});
+}
+
+} // namespace detail
+
+// Accuracy and cost of every function at every tier. Takes a few
+// milliseconds; call it from JS (fastMathAccuracyReport) or a debug build,
+// never from the audio thread.
+inline std::vector<AccuracyResult> measureFastMathAccuracy(int samples = 1 << 16) {
+  std::vector<AccuracyResult> results;
+  detail::measureTier<Accuracy::Fast>(results, samples);
+  detail::measureTier<Accuracy::Balanced>(results, samples);
+  detail::measureTier<Accuracy::Precise>(results, samples);
+  detail::measureTier<Accuracy::Reference>(results, samples);
+  return results;
+}
+
+} // namespace audioapi::fastmath
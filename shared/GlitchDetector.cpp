@@ -0,0 +1,218 @@
+#include "GlitchDetector.h"
+#include "InstrumentRegistry.h"
+#include <audioapi/utils/AudioBus.h>
+#include <audioapi/utils/AudioArray.h>
+#include <algorithm>
+#include <cmath>
+
+namespace audioapi {
+
+GlitchDetector::GlitchDetector(const char *kind) {
+  InstrumentRegistry<GlitchDetector>::shared().add(this, kind, name_);
+}
+
+GlitchDetector::~GlitchDetector() {
+  InstrumentRegistry<GlitchDetector>::shared().remove(this);
+}
+
+float GlitchDetector::waveformStep(int waveform, float frequency, float amplitude, float sampleRate) {
+  const float peakToPeak = 2.0f * std::fabs(amplitude);
+  const float cycles = std::fabs(frequency) / sampleRate;  // per sample
+  switch (waveform) {
+    case 1:  // triangle: 4 amplitudes per cycle
+      return std::min(2.0f * peakToPeak * cycles, peakToPeak);
+    case 2:  // square
+    case 3:  // sawtooth
+      return peakToPeak;
+    default:  // sine: steepest at the zero crossing
+      return std::min(static_cast<float>(M_PI) * peakToPeak * cycles, peakToPeak);
+  }
+}
+
+void GlitchDetector::analyze(const AudioBus &bus, int frames, float sampleRate, float maxStep) {
+  if (frames <= 0) {
+    return;
+  }
+  if (resetRequested_.load(std::memory_order_relaxed)) {
+    std::unique_lock<std::mutex> lock(captureMutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+      captureCount_ = 0;
+      blocks_.store(0, std::memory_order_relaxed);
+      jumps_.store(0, std::memory_order_relaxed);
+      nonFinite_.store(0, std::memory_order_relaxed);
+      deadlineMisses_.store(0, std::memory_order_relaxed);
+      resetRequested_.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  // Callback timing
+  const auto now = std::chrono::steady_clock::now();
+  if (lastBlockSeconds_ > 0.0f) {
+    const float gap = std::chrono::duration<float>(now - lastCall_).count();
+    if (gap > kDeadlineSlack * lastBlockSeconds_ && gap < kIdleSeconds) {
+      deadlineMisses_.fetch_add(1, std::memory_order_relaxed);
+      GlitchCapture entry;
+      entry.kind = GlitchKind::DeadlineMiss;
+      entry.frame = framesDone_;
+      entry.value = gap * 1e6f;
+      entry.threshold = lastBlockSeconds_ * 1e6f;
+      capture(entry);
+    }
+  }
+  lastCall_ = now;
+  lastBlockSeconds_ = static_cast<float>(frames) / sampleRate;
+
+  const int channels = std::min(bus.getNumberOfChannels(), kMaxChannels);
+  const uint32_t attempt = startup::attempt();
+  if (startupAttempt_.load(std::memory_order_relaxed) != attempt) {
+    firstBlockNanos_.store(trace::nowNanos(), std::memory_order_relaxed);
+    firstSoundNanos_.store(0, std::memory_order_relaxed);
+    startupAttempt_.store(attempt, std::memory_order_release);
+    if (trace::enabled()) {
+      trace::TraceRecorder::shared().record('i', "startup", "firstBlock", reinterpret_cast<uintptr_t>(this));
+    }
+  }
+  if (firstSoundNanos_.load(std::memory_order_relaxed) == 0) {
+    markStartup(bus, frames, channels);
+  }
+
+  // Output: one compare per sample on the clean path. NaN fails the compare
+  // too, so non-finite output also lands in classify().
+  const float threshold = maxStep * kThresholdMargin + kThresholdFloor;
+  for (int c = 0; c < channels; ++c) {
+    const float *data = bus.getChannel(c)->getData();
+    float previous = last_[c];
+    bool clean = true;
+    for (int i = 0; i < frames; ++i) {
+      clean &= std::fabs(data[i] - previous) <= threshold;
+      previous = data[i];
+    }
+    if (!clean) {
+      classify(data, frames, c, threshold);
+    }
+    last_[c] = previous;
+  }
+
+  framesDone_ += static_cast<uint64_t>(frames);
+  blocks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GlitchDetector::classify(const float *data, int frames, int channel, float threshold) {
+  uint64_t jumps = 0;
+  uint64_t nonFinite = 0;
+  float previous = last_[channel];
+  for (int i = 0; i < frames; ++i) {
+    const float x = data[i];
+    GlitchKind kind;
+    if (!std::isfinite(x)) {
+      kind = GlitchKind::NonFinite;
+      if (nonFinite++ > 0) {
+        previous = x;
+        continue;
+      }
+    } else if (std::isfinite(previous) && std::fabs(x - previous) > threshold) {
+      kind = GlitchKind::Jump;
+      if (jumps++ > 0) {
+        previous = x;
+        continue;
+      }
+    } else {
+      // Clean, or the first finite sample after a non-finite run
+      previous = x;
+      continue;
+    }
+
+    GlitchCapture entry;
+    entry.kind = kind;
+    entry.channel = channel;
+    entry.frame = framesDone_ + static_cast<uint64_t>(i);
+    entry.previous = previous;
+    entry.value = x;
+    entry.threshold = threshold;
+    const int start = std::max(0, i - GlitchCapture::kContextFrames / 2);
+    entry.sampleCount = std::min(GlitchCapture::kContextFrames, frames - start);
+    std::copy(data + start, data + start + entry.sampleCount, entry.samples.begin());
+    capture(entry);
+    previous = x;
+  }
+  jumps_.fetch_add(jumps, std::memory_order_relaxed);
+  nonFinite_.fetch_add(nonFinite, std::memory_order_relaxed);
+}
+
+void GlitchDetector::markStartup(const AudioBus &bus, int frames, int channels) {
+  for (int c = 0; c < channels; ++c) {
+    const float *data = bus.getChannel(c)->getData();
+    float peak = 0.0f;
+    for (int i = 0; i < frames; ++i) {
+      peak = std::max(peak, std::fabs(data[i]));
+    }
+    // NaN is not silence either
+    if (!(peak <= startup::kSilence)) {
+      firstSoundNanos_.store(trace::nowNanos(), std::memory_order_relaxed);
+      if (trace::enabled()) {
+        trace::TraceRecorder::shared().record('i', "startup", "firstSound", reinterpret_cast<uintptr_t>(this));
+      }
+      return;
+    }
+  }
+}
+
+void GlitchDetector::capture(const GlitchCapture &entry) {
+  std::unique_lock<std::mutex> lock(captureMutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  captures_[captureCount_ % kCaptures] = entry;
+  ++captureCount_;
+}
+
+GlitchStats GlitchDetector::stats() const {
+  GlitchStats stats;
+  stats.node = name_;
+  stats.blocks = blocks_.load(std::memory_order_relaxed);
+  stats.jumps = jumps_.load(std::memory_order_relaxed);
+  stats.nonFinite = nonFinite_.load(std::memory_order_relaxed);
+  stats.deadlineMisses = deadlineMisses_.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(captureMutex_);
+  const uint64_t count = std::min<uint64_t>(captureCount_, kCaptures);
+  stats.recent.reserve(count);
+  for (uint64_t i = captureCount_ - count; i < captureCount_; ++i) {
+    stats.recent.push_back(captures_[i % kCaptures]);
+  }
+  return stats;
+}
+
+startup::NodeStartup GlitchDetector::startupMarkers() const {
+  startup::NodeStartup markers;
+  if (startupAttempt_.load(std::memory_order_acquire) == startup::attempt()) {
+    markers.node = name_;
+    markers.firstBlockNanos = firstBlockNanos_.load(std::memory_order_relaxed);
+    markers.firstSoundNanos = firstSoundNanos_.load(std::memory_order_relaxed);
+  }
+  return markers;
+}
+
+std::vector<GlitchStats> collectGlitches() {
+  std::vector<GlitchStats> result;
+  InstrumentRegistry<GlitchDetector>::shared().forEach(
+      [&](const GlitchDetector &detector) { result.push_back(detector.stats()); });
+  return result;
+}
+
+std::vector<startup::NodeStartup> collectStartup() {
+  std::vector<startup::NodeStartup> result;
+  InstrumentRegistry<GlitchDetector>::shared().forEach([&](const GlitchDetector &detector) {
+    auto markers = detector.startupMarkers();
+    if (!markers.node.empty()) {
+      result.push_back(std::move(markers));
+    }
+  });
+  return result;
+}
+
+void resetGlitches() {
+  InstrumentRegistry<GlitchDetector>::shared().forEach([](GlitchDetector &detector) { detector.reset(); });
+}
+
+} // namespace audioapi
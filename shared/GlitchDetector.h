@@ -0,0 +1,146 @@
+#pragma once
+#include "StartupProfiler.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace audioapi {
+class AudioBus;
+
+enum class GlitchKind : uint8_t {
+  Jump,          // sample-to-sample step above the node's threshold
+  NonFinite,     // NaN or Inf in the output
+  DeadlineMiss   // processNode called late: the previous callback overran
+};
+
+// One offending frame and the output around it. For DeadlineMiss, value is
+// the gap between callbacks and threshold the block duration, in microseconds.
+struct GlitchCapture {
+  static constexpr int kContextFrames = 16;
+
+  GlitchKind kind = GlitchKind::Jump;
+  int channel = 0;
+  uint64_t frame = 0;       // frames this node had output before the offending one
+  float previous = 0.0f;
+  float value = 0.0f;
+  float threshold = 0.0f;
+  std::array<float, kContextFrames> samples{};  // starting up to half the window before the frame
+  int sampleCount = 0;
+};
+
+struct GlitchStats {
+  std::string node;               // node kind and instance number, e.g. "Binaural#3"
+  uint64_t blocks = 0;            // since creation or the last reset
+  uint64_t jumps = 0;             // offending samples
+  uint64_t nonFinite = 0;         // offending samples
+  uint64_t deadlineMisses = 0;    // late callbacks
+  std::vector<GlitchCapture> recent;  // last GlitchDetector::kCaptures, oldest first
+};
+
+// Output analyzer of a custom node, always on.
+//
+// After every block it checks each output channel for steps larger than
+// the node's threshold (derived from waveform, frequency and volume through
+// waveformStep()) and for NaN/Inf, and times the gap since the previous
+// block. The clean path is one compare per sample; offending blocks are
+// then classified and the first offence of each kind per channel captured.
+// Counters are atomics; captures go through a mutex the audio thread only
+// try_locks, so a report being read costs at most a missing capture.
+//
+// It also stamps the startup markers of the node (see StartupProfiler.h):
+// its first block and first non-silent sample since the last play. Until
+// the node sounds that is one extra compare per sample.
+class GlitchDetector {
+public:
+  static constexpr int kMaxChannels = 2;
+  static constexpr int kCaptures = 8;
+  // Room above the analytical bound for gain ramps and pan movement
+  static constexpr float kThresholdMargin = 1.25f;
+  static constexpr float kThresholdFloor = 1e-4f;
+  // A callback is late once the gap since the previous one exceeds this many
+  // block durations; gaps longer than kIdleSeconds mean the node was not being
+  // pulled (disconnected, replayed from cache), not that it overran.
+  static constexpr float kDeadlineSlack = 2.0f;
+  static constexpr float kIdleSeconds = 0.5f;
+
+  explicit GlitchDetector(const char *kind);
+  ~GlitchDetector();
+
+  GlitchDetector(const GlitchDetector &) = delete;
+  GlitchDetector &operator=(const GlitchDetector &) = delete;
+
+  // Audio thread, once the node has written its output. maxStep is the
+  // largest legitimate |x[n] - x[n-1]| of the output.
+  void analyze(const AudioBus &bus, int frames, float sampleRate, float maxStep);
+
+  // JS thread. Counters restart at the node's next block.
+  void reset() { resetRequested_.store(true, std::memory_order_relaxed); }
+  GlitchStats stats() const;
+  // Empty node name if the node has not run since the last play
+  startup::NodeStartup startupMarkers() const;
+
+  // Largest step of a waveform (0 sine, 1 triangle, 2 square, 3 sawtooth) of
+  // the given peak amplitude. Square and sawtooth jump by design, so their
+  // bound is the full peak-to-peak range and only out-of-range output counts.
+  static float waveformStep(int waveform, float frequency, float amplitude, float sampleRate);
+
+  // Analyzes the bus when the scope ends, after every return path of processNode
+  class Scope {
+  public:
+    Scope(GlitchDetector &detector, const std::shared_ptr<AudioBus> &bus, int frames, float sampleRate,
+          float maxStep)
+        : detector_(detector), bus_(bus), frames_(frames), sampleRate_(sampleRate), maxStep_(maxStep) {}
+    ~Scope() { detector_.analyze(*bus_, frames_, sampleRate_, maxStep_); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    GlitchDetector &detector_;
+    const std::shared_ptr<AudioBus> &bus_;
+    int frames_;
+    float sampleRate_;
+    float maxStep_;
+  };
+
+private:
+  void classify(const float *data, int frames, int channel, float threshold);
+  void capture(const GlitchCapture &entry);
+  void markStartup(const AudioBus &bus, int frames, int channels);
+
+  std::string name_;
+
+  // Audio thread state
+  std::array<float, kMaxChannels> last_{};
+  uint64_t framesDone_ = 0;
+  std::chrono::steady_clock::time_point lastCall_{};
+  float lastBlockSeconds_ = 0.0f;
+
+  std::atomic<bool> resetRequested_{false};
+  std::atomic<uint64_t> blocks_{0};
+  std::atomic<uint64_t> jumps_{0};
+  std::atomic<uint64_t> nonFinite_{0};
+  std::atomic<uint64_t> deadlineMisses_{0};
+
+  // Startup markers: the audio thread writes the times, then the attempt
+  std::atomic<uint32_t> startupAttempt_{UINT32_MAX};
+  std::atomic<uint64_t> firstBlockNanos_{0};
+  std::atomic<uint64_t> firstSoundNanos_{0};
+
+  mutable std::mutex captureMutex_;
+  std::array<GlitchCapture, kCaptures> captures_;
+  uint64_t captureCount_ = 0;
+};
+
+// Statistics of every live node, in creation order. JS thread.
+std::vector<GlitchStats> collectGlitches();
+void resetGlitches();
+// Startup markers of every node that ran since the last play. JS thread.
+std::vector<startup::NodeStartup> collectStartup();
+
+} // namespace audioapi
@@ -0,0 +1,54 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace audioapi {
+
+// Live instruments of one type (DspLoadMeter, GlitchDetector), in creation
+// order, for the collect functions JS calls. Each instrument registers in its
+// constructor under a name of its node kind and a per-type instance number,
+// e.g. "Binaural#3", and unregisters in its destructor. Never touched by the
+// audio thread.
+template <typename T>
+class InstrumentRegistry {
+public:
+  static InstrumentRegistry &shared() {
+    static InstrumentRegistry instance;
+    return instance;
+  }
+
+  // Sets name before the instrument becomes visible to forEach(); call it
+  // last in the constructor
+  void add(T *instrument, const char *kind, std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    name = std::string(kind) + "#" + std::to_string(nextInstance_++);
+    instruments_.push_back(instrument);
+  }
+
+  void remove(T *instrument) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    instruments_.erase(std::remove(instruments_.begin(), instruments_.end(), instrument), instruments_.end());
+  }
+
+  // Calls visit(T &) on every live instrument, in creation order, under the
+  // registry lock
+  template <typename Visit>
+  void forEach(Visit &&visit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (T *instrument : instruments_) {
+      visit(*instrument);
+    }
+  }
+
+private:
+  InstrumentRegistry() = default;
+
+  std::mutex mutex_;
+  std::vector<T *> instruments_;
+  uint32_t nextInstance_ = 1;
+};
+
+} // namespace audioapi
@@ -9,24 +9,81 @@ MartigliBinauralNode::MartigliBinauralNode(BaseAudioContext *context) : AudioNod
     channelCount_ = 2;
     channelCountMode_ = ChannelCountMode::EXPLICIT;
     channelInterpretation_ = ChannelInterpretation::SPEAKERS;
+    modulation().addSignal("breath");
+    modulation().addSignal("envelope");
+    modulation().addSignal("level");
+    modulation().addParam("volume", &volume);
+    modulation().addParam("fl", &fl);
+    modulation().addParam("fr", &fr);
+    modulation().addParam("ma", &ma);
     isInitialized_ = true;
 }
 
+void MartigliBinauralNode::resetVoice() {
+    applyParams(kMartigliBinauralDefaults);
+    volume = 1.0f;
+    isOn = false;
+    _breathing.attach(nullptr);
+    _breathing.release();
+    
+    shouldStart = false;
+    shouldPause = false;
+    shouldResume = false;
+    shouldStop = false;
+    shouldResetPhase = false;
+    isPaused = false;
+    animationValue = 0.0f;
+    currentInhaleDur = 0.0f;
+    currentExhaleDur = 0.0f;
+    currentPeriod = 0.0f;
+    
+    _clock = nullptr;
+    _sharedClock = false;
+    _stamp = 0;
+    _carrierPhaseL = 0.0f;
+    _carrierPhaseR = 0.0f;
+    _currentGain = 0.0f;
+    _startGain = 0.0f;
+    _targetGain = 1.0f;
+    _rampDuration = 1.0f;
+    _rampElapsed = 0.0f;
+    _isVolumeRamping = false;
+    _panEnvPhaseTime = 0.0f;
+    _panOscPhase = 0.0f;
+    
+    _glitches.reset();
+    touchParams();
+}
+
+void MartigliBinauralNode::applyParams(const MartigliBinauralParams &params) {
+    fl = params.fl;
+    fr = params.fr;
+    waveformL = params.waveformL;
+    waveformR = params.waveformR;
+    ma = params.ma;
+    mp0 = params.mp0;
+    mp1 = params.mp1;
+    md = params.md;
+    inhaleDur = params.inhaleDur;
+    exhaleDur = params.exhaleDur;
+    panOsc = params.panOsc;
+    panOscPeriod = params.panOscPeriod;
+    panOscTrans = params.panOscTrans;
+    touchParams();
+}
+
+MartigliBinauralParams MartigliBinauralNode::getParams() {
+    return {fl, fr, waveformL, waveformR, ma, mp0, mp1, md, inhaleDur, exhaleDur, panOsc, panOscPeriod, panOscTrans};
+}
+
 void MartigliBinauralNode::start() {
-    _isRamping = true;
-    _rampElapsedTime = 0.0f;
-    _lfoPhaseTime = 0.0f; // Start at trough (beginning of inhale)
     _carrierPhaseL = 0.0f;
     _carrierPhaseR = 0.0f;
-    _lastPhase = 0.0f;
     
-    // Initialize cycle durations
-    if (inhaleDur > 0.0f && exhaleDur > 0.0f) {
-        _currentCycleInhale = inhaleDur;
-        _currentCycleExhale = exhaleDur;
-    } else {
-        _currentCycleInhale = _currentCycleExhale = mp0 * 0.5f;
-    }
+    // Start the breath at the trough, with the period ramp from mp0 (a shared
+    // clock also scales its first cycle to mp0, like MartigliNode)
+    _clock->start(_stamp, _sharedClock);
+    _breathing.hold();
     
     isPaused = false;
     _currentGain = 0.0f;
@@ -47,8 +104,8 @@ void MartigliBinauralNode::pause() {
 
 void MartigliBinauralNode::resume() {
     isPaused = false;
-    _lfoPhaseTime = 0.0f;
-    _lastPhase = 0.0f;
+    _clock->resume(_stamp);
+    _breathing.hold();
     _startGain = _isVolumeRamping ? _currentGain : 0.0f;
     _targetGain = 1.0f;
     _rampDuration = 0.5f;
@@ -57,8 +114,7 @@ void MartigliBinauralNode::resume() {
 }
 
 void MartigliBinauralNode::resetPhase() {
-    _lfoPhaseTime = 0.0f;
-    _lastPhase = 0.0f;
+    _clock->resetPhase(_stamp);
 }
 
 void MartigliBinauralNode::stop() {
@@ -69,32 +125,69 @@ void MartigliBinauralNode::stop() {
     _isVolumeRamping = true;
 }
 
+void MartigliBinauralNode::seek(uint64_t frames, float sampleRate) {
+    // The carrier phases are left alone: the mixer fades the voice in from
+    // here, so the start ramp is past as well
+    const float seconds = static_cast<float>(static_cast<double>(frames) / sampleRate);
+    _rampElapsed += seconds;
+    _clock->seek(_stamp, frames, sampleRate);
+    if (panOscPeriod > 0.0f) {
+        _panEnvPhaseTime = fastmath::wrap(_panEnvPhaseTime + seconds, panOscPeriod * 2.0f);
+        _panOscPhase = 2.0f * M_PI * fastmath::wrap01(_panOscPhase * fastmath::kInvTwoPi + seconds / panOscPeriod);
+    }
+}
+
 void MartigliBinauralNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) {
+    CUSTOM_NODES_RT_SCOPE("MartigliBinaural");
     auto sampleRate = context_->getSampleRate();
+    const float maxStep = GlitchDetector::waveformStep(waveformL, fl + std::fabs(ma), volume, sampleRate) +
+                          GlitchDetector::waveformStep(waveformR, fr + std::fabs(ma), volume, sampleRate);
+    GlitchDetector::Scope glitchScope(_glitches, bus, framesToProcess, sampleRate, maxStep);
+    CUSTOM_NODES_DSP_SCOPE(_dspLoad, framesToProcess, sampleRate);
+    CUSTOM_NODES_TRACE_SCOPE("dsp", "MartigliBinaural");
     float dt = 1.0f / sampleRate;
     
+    BreathingClockSlot::Use clock(_breathing);
+    _clock = clock.get();
+    _sharedClock = clock.isShared();
+    _stamp = context_->getCurrentSampleFrame();
+    if (!clock.isShared()) {
+        _clock->setParameters(mp0, mp1, md, inhaleDur, exhaleDur);
+    }
+    
     // Handle control flags
+    trace::commandsApplied(this, {CUSTOM_NODES_TRACE_FLAG(shouldStart),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldPause),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldResume),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldStop),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldResetPhase)});
     if (shouldStart) { start(); shouldStart = false; }
     if (shouldPause) { pause(); shouldPause = false; }
     if (shouldResume) { resume(); shouldResume = false; }
     if (shouldStop) { stop(); shouldStop = false; }
     if (shouldResetPhase) { resetPhase(); shouldResetPhase = false; }
-    
-    // Calculate current period (with ramping)
-    float currentPeriod = _isRamping && md > 0.0f ? mp0 + (mp1 - mp0) * std::min(_rampElapsedTime / md, 1.0f) : mp1;
-    if (_isRamping && _rampElapsedTime >= md) {
-        _isRamping = false;
-        currentPeriod = mp1;
+    if (const uint64_t frames = takePendingSeek(); frames > 0 && !isPaused) {
+        seek(frames, sampleRate);
     }
-    this->currentPeriod = currentPeriod;
     
-    // Calculate and store inhale/exhale durations
-    float scale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? currentPeriod / (inhaleDur + exhaleDur) : 0.5f;
-    this->currentInhaleDur = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? inhaleDur * scale : currentPeriod * 0.5f;
-    this->currentExhaleDur = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? exhaleDur * scale : currentPeriod * 0.5f;
+    // One block of the breathing LFO, computed once per quantum (or mixer
+    // chunk) for all voices sharing the clock
+    const uint64_t breathPosition = clock.position(_stamp, framesToProcess);
+    const BreathingBlock *breath = &clock.block(breathPosition, framesToProcess, sampleRate);
+    int breathStart = 0;
+    this->currentPeriod = breath->period;
+    this->currentInhaleDur = breath->inhaleDur;
+    this->currentExhaleDur = breath->exhaleDur;
+    animationValue = breath->animationValue;
+    AnimationValueRegistry::getInstance().setMartigliAnimationValue(animationValue, isOn);
     
     int numChannels = bus->getNumberOfChannels();
     
+    const QualityTier tier = getQualityTier();
+    const bool fastSine = tier >= QualityTier::Reduced;
+    const bool controlRate = tier >= QualityTier::Low;
+    float heldPan = 0.0f;
+    
     for (int i = 0; i < framesToProcess; ++i) {
         // Update volume ramping
         if (_isVolumeRamping) {
@@ -105,32 +198,20 @@ void MartigliBinauralNode::processNode(const std::shared_ptr<AudioBus> &bus, int
                 _isVolumeRamping = false;
                 if (_targetGain == 0.0f) {
                     isPaused = true;
+                    // Other voices sharing the clock keep breathing
+                    _breathing.release();
                 }
             } else {
                 _currentGain = _startGain + (_targetGain - _startGain) * t;
             }
         }
         
-        // Calculate LFO value using piecewise cosine with locked cycle durations
-        float totalPeriod = _currentCycleInhale + _currentCycleExhale;
-        float phase = fmod(_lfoPhaseTime, totalPeriod);
-        
-        // Detect cycle wrap and update durations for next cycle
-        if (phase < _lastPhase) {
-            _lfoPhaseTime = phase;
-            float scale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? currentPeriod / (inhaleDur + exhaleDur) : 1.0f;
-            _currentCycleInhale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? inhaleDur * scale : currentPeriod * 0.5f;
-            _currentCycleExhale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? exhaleDur * scale : currentPeriod * 0.5f;
-            totalPeriod = _currentCycleInhale + _currentCycleExhale;
+        if (i - breathStart == breath->frames) {
+            // A render longer than one block
+            breathStart = i;
+            breath = &clock.block(breathPosition + i, framesToProcess - i, sampleRate);
         }
-        _lastPhase = phase;
-        
-        float lfoValue = (phase < _currentCycleInhale) 
-            ? -cosf(M_PI * phase / _currentCycleInhale)
-            : cosf(M_PI * (phase - _currentCycleInhale) / _currentCycleExhale);
-        
-        animationValue = (lfoValue + 1.0f) * 0.5f;
-        AnimationValueRegistry::getInstance().setMartigliAnimationValue(animationValue, isOn);
+        float lfoValue = breath->value[i - breathStart];
         
         // Generate left carrier with frequency modulation
         float carrierFreqL = lfoValue * ma + fl;
@@ -139,10 +220,10 @@ void MartigliBinauralNode::processNode(const std::shared_ptr<AudioBus> &bus, int
         
         float carrierL = 0.0f;
         switch (waveformL) {
-            case 1: carrierL = 4.0f * fabsf(fmodf(_carrierPhaseL / (2.0f * M_PI) + 0.75f, 1.0f) - 0.5f) - 1.0f; break;
+            case 1: carrierL = 4.0f * fabsf(fastmath::wrap01(_carrierPhaseL * fastmath::kInvTwoPi + 0.75f) - 0.5f) - 1.0f; break;
             case 2: carrierL = (_carrierPhaseL < M_PI) ? 1.0f : -1.0f; break;
             case 3: carrierL = 2.0f * (_carrierPhaseL / (2.0f * M_PI)) - 1.0f; break;
-            default: carrierL = sinf(_carrierPhaseL);
+            default: carrierL = fastmath::sin<kAccuracy>(_carrierPhaseL, fastSine);
         }
         
         // Generate right carrier with frequency modulation
@@ -152,47 +233,55 @@ void MartigliBinauralNode::processNode(const std::shared_ptr<AudioBus> &bus, int
         
         float carrierR = 0.0f;
         switch (waveformR) {
-            case 1: carrierR = 4.0f * fabsf(fmodf(_carrierPhaseR / (2.0f * M_PI) + 0.75f, 1.0f) - 0.5f) - 1.0f; break;
+            case 1: carrierR = 4.0f * fabsf(fastmath::wrap01(_carrierPhaseR * fastmath::kInvTwoPi + 0.75f) - 0.5f) - 1.0f; break;
             case 2: carrierR = (_carrierPhaseR < M_PI) ? 1.0f : -1.0f; break;
             case 3: carrierR = 2.0f * (_carrierPhaseR / (2.0f * M_PI)) - 1.0f; break;
-            default: carrierR = sinf(_carrierPhaseR);
+            default: carrierR = fastmath::sin<kAccuracy>(_carrierPhaseR, fastSine);
         }
         
         carrierL *= volume * _currentGain;
         carrierR *= volume * _currentGain;
         
-        // Calculate panning modulation based on panOsc mode
+        // Calculate panning modulation based on panOsc mode. At
+        // QualityTier::Low the ping-pong and sinusoidal crossfades are held
+        // for kControlInterval frames; their phases still advance every frame
+        const bool panHeld = controlRate && i % kControlInterval != 0;
         float panGainL = 1.0f;
         float panGainR = 1.0f;
         
         if (panOsc == 1) {
             // Ping-pong crossfade mode (same as BinauralNode)
-            float fullCycleDuration = 2.0f * panOscPeriod;
-            float phaseInCycle = fmodf(_panEnvPhaseTime, fullCycleDuration);
-            float crossfadeValue = 0.0f; // 0.0 = normal position, 1.0 = swapped
-            
-            if (phaseInCycle < (panOscPeriod - panOscTrans)) {
-                crossfadeValue = 0.0f;
-            } else if (phaseInCycle < panOscPeriod) {
-                float transitionProgress = (phaseInCycle - (panOscPeriod - panOscTrans)) / panOscTrans;
-                crossfadeValue = transitionProgress;
-            } else if (phaseInCycle < (2.0f * panOscPeriod - panOscTrans)) {
-                crossfadeValue = 1.0f;
-            } else {
-                float transitionProgress = (phaseInCycle - (2.0f * panOscPeriod - panOscTrans)) / panOscTrans;
-                crossfadeValue = 1.0f - transitionProgress;
+            if (!panHeld) {
+                float fullCycleDuration = 2.0f * panOscPeriod;
+                float phaseInCycle = fastmath::wrap(_panEnvPhaseTime, fullCycleDuration);
+                float crossfadeValue = 0.0f; // 0.0 = normal position, 1.0 = swapped
+                
+                if (phaseInCycle < (panOscPeriod - panOscTrans)) {
+                    crossfadeValue = 0.0f;
+                } else if (phaseInCycle < panOscPeriod) {
+                    float transitionProgress = (phaseInCycle - (panOscPeriod - panOscTrans)) / panOscTrans;
+                    crossfadeValue = transitionProgress;
+                } else if (phaseInCycle < (2.0f * panOscPeriod - panOscTrans)) {
+                    crossfadeValue = 1.0f;
+                } else {
+                    float transitionProgress = (phaseInCycle - (2.0f * panOscPeriod - panOscTrans)) / panOscTrans;
+                    crossfadeValue = 1.0f - transitionProgress;
+                }
+                heldPan = crossfadeValue;
             }
             
-            panGainL = 1.0f - crossfadeValue;
-            panGainR = crossfadeValue;
+            panGainL = 1.0f - heldPan;
+            panGainR = heldPan;
             
             if (!isPaused) _panEnvPhaseTime += dt;
         } else if (panOsc == 2) {
             // Continuous sinusoidal panning (same as BinauralNode)
-            float sinValue = sinf(_panOscPhase);
-            float crossfadeValue = (sinValue + 1.0f) * 0.5f; // [-1,1] -> [0,1]
-            panGainL = 1.0f - crossfadeValue;
-            panGainR = crossfadeValue;
+            if (!panHeld) {
+                float sinValue = fastmath::sin<kAccuracy>(_panOscPhase, fastSine);
+                heldPan = (sinValue + 1.0f) * 0.5f; // [-1,1] -> [0,1]
+            }
+            panGainL = 1.0f - heldPan;
+            panGainR = heldPan;
             
             if (!isPaused) {
                 _panOscPhase += 2.0f * M_PI * dt / panOscPeriod;
@@ -214,14 +303,16 @@ void MartigliBinauralNode::processNode(const std::shared_ptr<AudioBus> &bus, int
         
         // Advance phases
         if (!isPaused) {
-            _lfoPhaseTime += dt;
             _carrierPhaseL += 2.0f * M_PI * carrierFreqL * dt;
             if (_carrierPhaseL >= 2.0f * M_PI) _carrierPhaseL -= 2.0f * M_PI;
             _carrierPhaseR += 2.0f * M_PI * carrierFreqR * dt;
             if (_carrierPhaseR >= 2.0f * M_PI) _carrierPhaseR -= 2.0f * M_PI;
-            if (_isRamping) _rampElapsedTime += dt;
         }
     }
+    
+    modulation().publish(kBreathSignal, animationValue);
+    modulation().publish(kEnvelopeSignal, _currentGain);
+    modulation().publish(kLevelSignal, volume * _currentGain);
 }
 
 } // namespace audioapi
@@ -3,15 +3,34 @@
 #include <audioapi/core/AudioNode.h>
 #include <audioapi/core/BaseAudioContext.h>
 #include "AnimationValueRegistry.h"
+#include "VoiceRenderer.h"
+#include "VoiceParams.h"
+#include "BreathingClock.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include "FastMath.h"
 
 namespace audioapi {
 
-class MartigliBinauralNode : public AudioNode {
+class MartigliBinauralNode : public AudioNode, public VoiceRenderer {
 public:
+    // Accuracy tier of the breathing LFO and sine carriers (see FastMath.h)
+    static constexpr fastmath::Accuracy kAccuracy = fastmath::Accuracy::Balanced;
+
     explicit MartigliBinauralNode(BaseAudioContext *context);
     ~MartigliBinauralNode() override = default;
 
     void processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override;
+    void renderVoice(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override {
+        processNode(bus, framesToProcess);
+    }
+    void resetVoice() override;
+    // Sets the preset parameters, as decoded from a binary preset. JS thread.
+    void applyParams(const MartigliBinauralParams &params);
+    // The current preset parameters, as applyParams() takes them. JS thread.
+    MartigliBinauralParams getParams();
     
     // Control methods
     void start();
@@ -20,21 +39,26 @@ public:
     void stop();
     void resetPhase();
     
+    // Shares the breathing LFO with other voices (JS thread); nullptr detaches.
+    // A shared clock uses its own mp0/mp1/md/inhaleDur/exhaleDur.
+    void setBreathingClock(const std::shared_ptr<BreathingClock> &clock) { _breathing.attach(clock); }
+    std::shared_ptr<BreathingClock> getBreathingClock() { return _breathing.attached(); }
+    
     // Public parameters
-    float fl = 250.0f;           // Left carrier frequency
-    float fr = 260.0f;           // Right carrier frequency
-    int waveformL = 0;           // Left waveform (0=sine, 1=tri, 2=square, 3=saw)
-    int waveformR = 0;           // Right waveform
-    float ma = 90.0f;            // Modulation amount
-    float mp0 = 11.0f;           // Initial period
-    float mp1 = 20.0f;           // Final period
-    float md = 600.0f;           // Ramp duration
-    float inhaleDur = 3.0f;      // Inhale duration (base)
-    float exhaleDur = 8.0f;      // Exhale duration (base)
+    float fl = kMartigliBinauralDefaults.fl;               // Left carrier frequency
+    float fr = kMartigliBinauralDefaults.fr;               // Right carrier frequency
+    int waveformL = kMartigliBinauralDefaults.waveformL;   // Left waveform (0=sine, 1=tri, 2=square, 3=saw)
+    int waveformR = kMartigliBinauralDefaults.waveformR;   // Right waveform
+    float ma = kMartigliBinauralDefaults.ma;               // Modulation amount
+    float mp0 = kMartigliBinauralDefaults.mp0;             // Initial period
+    float mp1 = kMartigliBinauralDefaults.mp1;             // Final period
+    float md = kMartigliBinauralDefaults.md;               // Ramp duration
+    float inhaleDur = kMartigliBinauralDefaults.inhaleDur; // Inhale duration (base)
+    float exhaleDur = kMartigliBinauralDefaults.exhaleDur; // Exhale duration (base)
     float volume = 1.0f;         // Master volume
-    int panOsc = 0;              // Panning mode (0=none, 1=envelope, 2=sine, 3=LFO)
-    float panOscPeriod = 120.0f; // Panning period
-    float panOscTrans = 20.0f;   // Panning transition time
+    int panOsc = kMartigliBinauralDefaults.panOsc;               // Panning mode (0=none, 1=envelope, 2=sine, 3=LFO)
+    float panOscPeriod = kMartigliBinauralDefaults.panOscPeriod; // Panning period
+    float panOscTrans = kMartigliBinauralDefaults.panOscTrans;   // Panning transition time
     bool isOn = false;           // Publish to AnimationValueRegistry
     
     // Control flags
@@ -52,11 +76,22 @@ public:
     float currentPeriod = 0.0f;
     
 private:
-    // LFO phase tracking
-    float _lfoPhaseTime = 0.0f;
-    float _currentCycleInhale = 0.0f;
-    float _currentCycleExhale = 0.0f;
-    float _lastPhase = 0.0f;
+    // Modulation signals, in the order they are declared to modulation():
+    // breath (0 trough .. 1 peak), envelope (start/stop ramp), level (volume * envelope)
+    enum ModulationSignal { kBreathSignal, kEnvelopeSignal, kLevelSignal };
+    
+    // Breathing LFO: private, or shared with the session's other breath-locked
+    // voices. _clock, _sharedClock and _stamp are valid while processNode runs.
+    BreathingClockSlot _breathing;
+    BreathingClock *_clock = nullptr;
+    bool _sharedClock = false;
+    uint64_t _stamp = 0;
+    
+    // Catches up with a replay the mixer falls back from (seekVoice())
+    void seek(uint64_t frames, float sampleRate);
+    
+    DspLoadMeter _dspLoad{"MartigliBinaural"};
+    GlitchDetector _glitches{"MartigliBinaural"};
     
     // Carrier phases
     float _carrierPhaseL = 0.0f;
@@ -70,10 +105,6 @@ private:
     float _rampElapsed = 0.0f;
     bool _isVolumeRamping = false;
     
-    // Period ramping
-    bool _isRamping = false;
-    float _rampElapsedTime = 0.0f;
-    
     // Panning
     float _panEnvPhaseTime = 0.0f;
     float _panOscPhase = 0.0f;
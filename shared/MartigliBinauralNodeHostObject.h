@@ -2,6 +2,8 @@
 
 #include <audioapi/HostObjects/AudioNodeHostObject.h>
 #include "MartigliBinauralNode.h"
+#include "VoiceRenderer.h"
+#include "BreathingClockHostObject.h"
 
 namespace audioapi {
 
@@ -11,10 +13,21 @@ namespace audioapi {
     return {std::static_pointer_cast<MartigliBinauralNode>(node_)->name}; \
   } \
   JSI_PROPERTY_SETTER(name) { \
-    std::static_pointer_cast<MartigliBinauralNode>(node_)->name = value.get##type(); \
+    auto node = std::static_pointer_cast<MartigliBinauralNode>(node_); \
+    node->name = value.get##type(); \
+    node->touchParams(); \
   }
 
-class MartigliBinauralNodeHostObject : public AudioNodeHostObject {
+// Control flags and isOn do not change the rendered sound's parameters
+#define MARTIGLI_BINAURAL_FLAG(name) \
+  JSI_PROPERTY_GETTER(name) { \
+    return {std::static_pointer_cast<MartigliBinauralNode>(node_)->name}; \
+  } \
+  JSI_PROPERTY_SETTER(name) { \
+    std::static_pointer_cast<MartigliBinauralNode>(node_)->name = value.getBool(); \
+  }
+
+class MartigliBinauralNodeHostObject : public AudioNodeHostObject, public VoiceHostObject {
 public:
     explicit MartigliBinauralNodeHostObject(std::shared_ptr<MartigliBinauralNode> node)
         : AudioNodeHostObject(node) {
@@ -44,6 +57,7 @@ public:
         addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliBinauralNodeHostObject, shouldResume));
         addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliBinauralNodeHostObject, shouldStop));
         addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliBinauralNodeHostObject, shouldResetPhase));
+        addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliBinauralNodeHostObject, breathingClock));
 
         // Add setters
         addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliBinauralNodeHostObject, fl));
@@ -66,6 +80,7 @@ public:
         addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliBinauralNodeHostObject, shouldResume));
         addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliBinauralNodeHostObject, shouldStop));
         addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliBinauralNodeHostObject, shouldResetPhase));
+        addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliBinauralNodeHostObject, breathingClock));
     }
 
     MARTIGLI_BINAURAL_PROPERTY(Number, fl)
@@ -82,12 +97,12 @@ public:
     MARTIGLI_BINAURAL_PROPERTY(Number, panOsc)
     MARTIGLI_BINAURAL_PROPERTY(Number, panOscPeriod)
     MARTIGLI_BINAURAL_PROPERTY(Number, panOscTrans)
-    MARTIGLI_BINAURAL_PROPERTY(Bool, isOn)
-    MARTIGLI_BINAURAL_PROPERTY(Bool, shouldStart)
-    MARTIGLI_BINAURAL_PROPERTY(Bool, shouldPause)
-    MARTIGLI_BINAURAL_PROPERTY(Bool, shouldResume)
-    MARTIGLI_BINAURAL_PROPERTY(Bool, shouldStop)
-    MARTIGLI_BINAURAL_PROPERTY(Bool, shouldResetPhase)
+    MARTIGLI_BINAURAL_FLAG(isOn)
+    MARTIGLI_BINAURAL_FLAG(shouldStart)
+    MARTIGLI_BINAURAL_FLAG(shouldPause)
+    MARTIGLI_BINAURAL_FLAG(shouldResume)
+    MARTIGLI_BINAURAL_FLAG(shouldStop)
+    MARTIGLI_BINAURAL_FLAG(shouldResetPhase)
 
     // Read-only properties
     JSI_PROPERTY_GETTER(isPaused) {
@@ -109,8 +124,43 @@ public:
     JSI_PROPERTY_GETTER(currentPeriod) {
         return {std::static_pointer_cast<MartigliBinauralNode>(node_)->currentPeriod};
     }
+
+    // Shared breathing clock (createBreathingClock()), or null for the voice's own
+    JSI_PROPERTY_GETTER(breathingClock) {
+        auto clock = std::static_pointer_cast<MartigliBinauralNode>(node_)->getBreathingClock();
+        if (!clock) {
+            return jsi::Value::null();
+        }
+        return jsi::Object::createFromHostObject(runtime, std::make_shared<BreathingClockHostObject>(clock));
+    }
+
+    JSI_PROPERTY_SETTER(breathingClock) {
+        auto node = std::static_pointer_cast<MartigliBinauralNode>(node_);
+        node->setBreathingClock(BreathingClockHostObject::fromValue(runtime, value));
+        node->touchParams();
+    }
+
+    // Properties are registered through addGetters/addSetters; these only
+    // wrap the lookups for tracing.
+    jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+        trace::Scope traceScope("jsi", "MartigliBinaural.get", std::static_pointer_cast<MartigliBinauralNode>(node_).get());
+        return AudioNodeHostObject::get(runtime, propNameId);
+    }
+
+    void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+        trace::Scope traceScope("jsi", "MartigliBinaural.set", std::static_pointer_cast<MartigliBinauralNode>(node_).get());
+        if (trace::enabled() && value.isBool()) {
+            trace::commandQueued(propNameId.utf8(runtime), value.getBool(), std::static_pointer_cast<MartigliBinauralNode>(node_).get());
+        }
+        AudioNodeHostObject::set(runtime, propNameId, value);
+    }
+
+    std::shared_ptr<VoiceRenderer> getVoiceRenderer() const override {
+        return std::static_pointer_cast<MartigliBinauralNode>(node_);
+    }
 };
 
 #undef MARTIGLI_BINAURAL_PROPERTY
+#undef MARTIGLI_BINAURAL_FLAG
 
 } // namespace audioapi
@@ -14,12 +14,69 @@ namespace audioapi {
 
 MartigliNode::MartigliNode(BaseAudioContext *context)
     : AudioNode(context), _context(context) {
+    modulation().addSignal("breath");
+    modulation().addSignal("envelope");
+    modulation().addSignal("level");
+    modulation().addParam("volume", &volume);
+    modulation().addParam("mf0", &mf0);
+    modulation().addParam("ma", &ma);
     isInitialized_ = true;
 }
 
+void MartigliNode::resetVoice() {
+    applyParams(kMartigliDefaults);
+    volume = 0.5f;
+    _breathing.attach(nullptr);
+    _breathing.release();
+    
+    animationValue = 0.0f;
+    isPaused = false;
+    isOn = false;
+    shouldStart = false;
+    shouldPause = false;
+    shouldResume = false;
+    shouldStop = false;
+    shouldResetPhase = false;
+    currentInhaleDur = 0.0f;
+    currentExhaleDur = 0.0f;
+    currentPeriod = 0.0f;
+    
+    _carrierPhase = 0.0f;
+    _panEnvPhaseTime = 0.0f;
+    _panOscPhase = 0.0f;
+    _clock = nullptr;
+    _stamp = 0;
+    _currentGain = 0.0f;
+    _startGain = 0.0f;
+    _targetGain = 1.0f;
+    _rampDuration = 1.0f;
+    _rampElapsed = 0.0f;
+    _isVolumeRamping = false;
+    
+    _glitches.reset();
+    touchParams();
+}
+
+void MartigliNode::applyParams(const MartigliParams &params) {
+    mf0 = params.mf0;
+    ma = params.ma;
+    mp0 = params.mp0;
+    mp1 = params.mp1;
+    md = params.md;
+    inhaleDur = params.inhaleDur;
+    exhaleDur = params.exhaleDur;
+    waveformM = params.waveformM;
+    panOsc = params.panOsc;
+    panOscPeriod = params.panOscPeriod;
+    panOscTrans = params.panOscTrans;
+    touchParams();
+}
+
+MartigliParams MartigliNode::getParams() {
+    return {mf0, ma, mp0, mp1, md, inhaleDur, exhaleDur, waveformM, panOsc, panOscPeriod, panOscTrans};
+}
+
 void MartigliNode::start() {
-    _isRamping = true;
-    _rampElapsedTime = 0.0f;
     isPaused = false;
     // Start volume fade-in
     _currentGain = 0.0f;
@@ -29,16 +86,9 @@ void MartigliNode::start() {
     _rampElapsed = 0.0f;
     _isVolumeRamping = true;
     
-    // Initialize cycle durations
-    _lfoPhaseTime = 0.0f;
-    _lastPhase = 0.0f;
-    if (inhaleDur > 0.0f && exhaleDur > 0.0f) {
-        float scale = mp0 / (inhaleDur + exhaleDur);
-        _currentCycleInhale = inhaleDur * scale;
-        _currentCycleExhale = exhaleDur * scale;
-    } else {
-        _currentCycleInhale = _currentCycleExhale = mp0 * 0.5f;
-    }
+    // Start the breath at the trough, with the period ramp from mp0
+    _clock->start(_stamp);
+    _breathing.hold();
 }
 
 void MartigliNode::pause() {
@@ -52,8 +102,8 @@ void MartigliNode::pause() {
 
 void MartigliNode::resume() {
     isPaused = false;
-    _lfoPhaseTime = 0.0f;
-    _lastPhase = 0.0f;
+    _clock->resume(_stamp);
+    _breathing.hold();
     _startGain = _isVolumeRamping ? _currentGain : 0.0f;
     _targetGain = 1.0f;
     _rampDuration = 0.5f;
@@ -62,8 +112,7 @@ void MartigliNode::resume() {
 }
 
 void MartigliNode::resetPhase() {
-    _lfoPhaseTime = 0.0f;
-    _lastPhase = 0.0f;
+    _clock->resetPhase(_stamp);
 }
 
 void MartigliNode::stop() {
@@ -75,32 +124,67 @@ void MartigliNode::stop() {
     _isVolumeRamping = true;
 }
 
+void MartigliNode::seek(uint64_t frames, float sampleRate) {
+    // The carrier phases are left alone: the mixer fades the voice in from
+    // here, so the start ramp is past as well
+    const float seconds = static_cast<float>(static_cast<double>(frames) / sampleRate);
+    _rampElapsed += seconds;
+    _clock->seek(_stamp, frames, sampleRate);
+    if (panOscPeriod > 0.0f) {
+        _panEnvPhaseTime = fastmath::wrap(_panEnvPhaseTime + seconds, panOscPeriod * 2.0f);
+        _panOscPhase = 2.0f * M_PI * fastmath::wrap01(_panOscPhase * fastmath::kInvTwoPi + seconds / panOscPeriod);
+    }
+}
+
 void MartigliNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) {
+    CUSTOM_NODES_RT_SCOPE("Martigli");
     auto sampleRate = _context->getSampleRate();
+    const float maxStep = GlitchDetector::waveformStep(waveformM, mf0 + std::fabs(ma), volume, sampleRate);
+    GlitchDetector::Scope glitchScope(_glitches, bus, framesToProcess, sampleRate, maxStep);
+    CUSTOM_NODES_DSP_SCOPE(_dspLoad, framesToProcess, sampleRate);
+    CUSTOM_NODES_TRACE_SCOPE("dsp", "Martigli");
     float dt = 1.0f / sampleRate;
     
+    BreathingClockSlot::Use clock(_breathing);
+    _clock = clock.get();
+    _stamp = _context->getCurrentSampleFrame();
+    if (!clock.isShared()) {
+        _clock->setParameters(mp0, mp1, md, inhaleDur, exhaleDur);
+    }
+    
     // Handle control flags
+    trace::commandsApplied(this, {CUSTOM_NODES_TRACE_FLAG(shouldStart),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldPause),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldResume),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldStop),
+                                  CUSTOM_NODES_TRACE_FLAG(shouldResetPhase)});
     if (shouldStart) { start(); shouldStart = false; }
     if (shouldPause) { pause(); shouldPause = false; }
     if (shouldResume) { resume(); shouldResume = false; }
     if (shouldStop) { stop(); shouldStop = false; }
     if (shouldResetPhase) { resetPhase(); shouldResetPhase = false; }
-    
-    // Calculate current period (with ramping)
-    float currentPeriod = _isRamping && md > 0.0f ? mp0 + (mp1 - mp0) * std::min(_rampElapsedTime / md, 1.0f) : mp1;
-    if (_isRamping && _rampElapsedTime >= md) {
-        _isRamping = false;
-        currentPeriod = mp1;
+    if (const uint64_t frames = takePendingSeek(); frames > 0 && !isPaused) {
+        seek(frames, sampleRate);
     }
-    this->currentPeriod = currentPeriod;
     
-    // Calculate and store inhale/exhale durations
-    float scale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? currentPeriod / (inhaleDur + exhaleDur) : 0.5f;
-    this->currentInhaleDur = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? inhaleDur * scale : currentPeriod * 0.5f;
-    this->currentExhaleDur = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? exhaleDur * scale : currentPeriod * 0.5f;
+    // One block of the breathing LFO, computed once per quantum (or mixer
+    // chunk) for all voices sharing the clock
+    const uint64_t breathPosition = clock.position(_stamp, framesToProcess);
+    const BreathingBlock *breath = &clock.block(breathPosition, framesToProcess, sampleRate);
+    int breathStart = 0;
+    this->currentPeriod = breath->period;
+    this->currentInhaleDur = breath->inhaleDur;
+    this->currentExhaleDur = breath->exhaleDur;
+    animationValue = breath->animationValue;
+    AnimationValueRegistry::getInstance().setMartigliAnimationValue(animationValue, isOn);
     
     int numChannels = bus->getNumberOfChannels();
     
+    const QualityTier tier = getQualityTier();
+    const bool fastSine = tier >= QualityTier::Reduced;
+    const bool controlRate = tier >= QualityTier::Low;
+    float heldPan = 0.0f;
+    
     for (int i = 0; i < framesToProcess; ++i) {
         // Update volume ramping
         if (_isVolumeRamping) {
@@ -109,33 +193,23 @@ void MartigliNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesT
             if (t >= 1.0f) {
                 _currentGain = _targetGain;
                 _isVolumeRamping = false;
-                if (_targetGain == 0.0f) isPaused = true;
+                if (_targetGain == 0.0f) {
+                    isPaused = true;
+                    // Other voices sharing the clock keep breathing
+                    _breathing.release();
+                }
             } else {
                 // Linear interpolation from start to target
                 _currentGain = _startGain + (_targetGain - _startGain) * t;
             }
         }
         
-        // Calculate LFO value using piecewise cosine with locked cycle durations
-        float totalPeriod = _currentCycleInhale + _currentCycleExhale;
-        float phase = fmod(_lfoPhaseTime, totalPeriod);
-        
-        // Detect cycle wrap and update durations for next cycle
-        if (phase < _lastPhase) {
-            _lfoPhaseTime = phase;
-            float scale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? currentPeriod / (inhaleDur + exhaleDur) : 1.0f;
-            _currentCycleInhale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? inhaleDur * scale : currentPeriod * 0.5f;
-            _currentCycleExhale = (inhaleDur > 0.0f && exhaleDur > 0.0f) ? exhaleDur * scale : currentPeriod * 0.5f;
-            totalPeriod = _currentCycleInhale + _currentCycleExhale;
+        if (i - breathStart == breath->frames) {
+            // A render longer than one block
+            breathStart = i;
+            breath = &clock.block(breathPosition + i, framesToProcess - i, sampleRate);
         }
-        _lastPhase = phase;
-        
-        float lfoValue = (phase < _currentCycleInhale) 
-            ? -cosf(M_PI * phase / _currentCycleInhale)
-            : cosf(M_PI * (phase - _currentCycleInhale) / _currentCycleExhale);
-        
-        animationValue = (lfoValue + 1.0f) * 0.5f;
-        AnimationValueRegistry::getInstance().setMartigliAnimationValue(animationValue, isOn);
+        float lfoValue = breath->value[i - breathStart];
         
         // Generate carrier waveform with frequency modulation
         float carrierFreq = lfoValue * ma + mf0;
@@ -144,25 +218,32 @@ void MartigliNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesT
         
         float carrier = 0.0f;
         switch (waveformM) {
-            case 1: carrier = 4.0f * fabsf(fmodf(_carrierPhase / (2.0f * M_PI) + 0.75f, 1.0f) - 0.5f) - 1.0f; break;
+            case 1: carrier = 4.0f * fabsf(fastmath::wrap01(_carrierPhase * fastmath::kInvTwoPi + 0.75f) - 0.5f) - 1.0f; break;
             case 2: carrier = (_carrierPhase < M_PI) ? 1.0f : -1.0f; break;
             case 3: carrier = 2.0f * (_carrierPhase / (2.0f * M_PI)) - 1.0f; break;
-            default: carrier = sinf(_carrierPhase);
+            default: carrier = fastmath::sin<kAccuracy>(_carrierPhase, fastSine);
         }
         
         carrier *= volume * _currentGain;
         
-        // Calculate panning
+        // Calculate panning. At QualityTier::Low the ping-pong and sinusoidal
+        // pans are held for kControlInterval frames; their phases still
+        // advance every frame
+        const bool panHeld = controlRate && i % kControlInterval != 0;
         float panValue = 0.0f;
         if (panOsc == 1) {
-            float panPhase = fmod(_panEnvPhaseTime, panOscPeriod * 2.0f);
-            panValue = (panPhase < panOscTrans) ? panPhase / panOscTrans :
-                      (panPhase < panOscTrans + panOscPeriod) ? 1.0f :
-                      (panPhase < panOscTrans * 2.0f + panOscPeriod) ? 1.0f - (panPhase - panOscTrans - panOscPeriod) / panOscTrans : 0.0f;
-            panValue = panValue * 2.0f - 1.0f;
+            if (!panHeld) {
+                float panPhase = fastmath::wrap(_panEnvPhaseTime, panOscPeriod * 2.0f);
+                heldPan = (panPhase < panOscTrans) ? panPhase / panOscTrans :
+                          (panPhase < panOscTrans + panOscPeriod) ? 1.0f :
+                          (panPhase < panOscTrans * 2.0f + panOscPeriod) ? 1.0f - (panPhase - panOscTrans - panOscPeriod) / panOscTrans : 0.0f;
+                heldPan = heldPan * 2.0f - 1.0f;
+            }
+            panValue = heldPan;
             if (!isPaused) _panEnvPhaseTime += dt;
         } else if (panOsc == 2) {
-            panValue = sinf(_panOscPhase);
+            if (!panHeld) heldPan = fastmath::sin<kAccuracy>(_panOscPhase, fastSine);
+            panValue = heldPan;
             if (!isPaused) {
                 _panOscPhase += 2.0f * M_PI * dt / panOscPeriod;
                 if (_panOscPhase >= 2.0f * M_PI) _panOscPhase -= 2.0f * M_PI;
@@ -178,12 +259,14 @@ void MartigliNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesT
         if (numChannels >= 2) bus->getChannel(1)->getData()[i] = carrier * rightGain;
         
         if (!isPaused) {
-            _lfoPhaseTime += dt;
             _carrierPhase += 2.0f * M_PI * carrierFreq * dt;
             if (_carrierPhase >= 2.0f * M_PI) _carrierPhase -= 2.0f * M_PI;
-            if (_isRamping) _rampElapsedTime += dt;
         }
     }
+    
+    modulation().publish(kBreathSignal, animationValue);
+    modulation().publish(kEnvelopeSignal, _currentGain);
+    modulation().publish(kLevelSignal, volume * _currentGain);
 }
 
 } // namespace audioapi
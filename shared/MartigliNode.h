@@ -1,43 +1,68 @@
 #pragma once
 #include <audioapi/core/AudioNode.h>
+#include "VoiceRenderer.h"
+#include "VoiceParams.h"
+#include "BreathingClock.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include "FastMath.h"
 
 namespace audioapi {
 class AudioBus;
 class BaseAudioContext;
 
-class MartigliNode : public AudioNode {
+class MartigliNode : public AudioNode, public VoiceRenderer {
+public:
+  // Accuracy tier of the breathing LFO and sine carrier (see FastMath.h)
+  static constexpr fastmath::Accuracy kAccuracy = fastmath::Accuracy::Balanced;
+
 private:
   BaseAudioContext* _context;
-  float _lfoPhaseTime = 0.0f;
   float _carrierPhase = 0.0f;
-  float _rampElapsedTime = 0.0f;
   float _panEnvPhaseTime = 0.0f;
   float _panOscPhase = 0.0f;
-  bool _isRamping = false;
   
-  // Track the period for the current breathing cycle
-  float _currentCycleInhale = 0.0f;
-  float _currentCycleExhale = 0.0f;
-  float _lastPhase = 0.0f;  // Track previous phase to detect wrapping
+  // Breathing LFO: private, or shared with the session's other breath-locked
+  // voices. _clock and _stamp are valid while processNode runs.
+  BreathingClockSlot _breathing;
+  BreathingClock *_clock = nullptr;
+  uint64_t _stamp = 0;
+  
+  // Catches up with a replay the mixer falls back from (seekVoice())
+  void seek(uint64_t frames, float sampleRate);
+  
+  DspLoadMeter _dspLoad{"Martigli"};
+  GlitchDetector _glitches{"Martigli"};
   
 public:
   explicit MartigliNode(BaseAudioContext *context);
+
+  void renderVoice(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override {
+    processNode(bus, framesToProcess);
+  }
+  void resetVoice() override;
+  // Sets the preset parameters, as decoded from a binary preset. JS thread.
+  void applyParams(const MartigliParams &params);
+  // The current preset parameters, as applyParams() takes them. JS thread.
+  MartigliParams getParams();
   
   // Core parameters
-  float mf0 = 250.0f;           // Base frequency
-  float ma = 90.0f;             // Modulation amount
-  float mp0 = 10.0f;            // Initial period
-  float mp1 = 20.0f;            // Final period
-  float md = 600.0f;            // Ramp duration
-  float inhaleDur = -1.0f;      // Inhale duration (optional)
-  float exhaleDur = -1.0f;      // Exhale duration (optional)
-  int waveformM = 0;            // Waveform type
+  float mf0 = kMartigliDefaults.mf0;             // Base frequency
+  float ma = kMartigliDefaults.ma;               // Modulation amount
+  float mp0 = kMartigliDefaults.mp0;             // Initial period
+  float mp1 = kMartigliDefaults.mp1;             // Final period
+  float md = kMartigliDefaults.md;               // Ramp duration
+  float inhaleDur = kMartigliDefaults.inhaleDur; // Inhale duration (optional)
+  float exhaleDur = kMartigliDefaults.exhaleDur; // Exhale duration (optional)
+  int waveformM = kMartigliDefaults.waveformM;   // Waveform type
   float volume = 0.5f;
   
   // Panning parameters
-  int panOsc = 0;
-  float panOscPeriod = 120.0f;
-  float panOscTrans = 20.0f;
+  int panOsc = kMartigliDefaults.panOsc;
+  float panOscPeriod = kMartigliDefaults.panOscPeriod;
+  float panOscTrans = kMartigliDefaults.panOscTrans;
   
   // State
   float animationValue = 0.0f;
@@ -59,8 +84,17 @@ public:
   void resume();
   void stop();
   void resetPhase();
+  
+  // Shares the breathing LFO with other voices (JS thread); nullptr detaches.
+  // A shared clock uses its own mp0/mp1/md/inhaleDur/exhaleDur.
+  void setBreathingClock(const std::shared_ptr<BreathingClock> &clock) { _breathing.attach(clock); }
+  std::shared_ptr<BreathingClock> getBreathingClock() { return _breathing.attached(); }
 
 private:
+  // Modulation signals, in the order they are declared to modulation():
+  // breath (0 trough .. 1 peak), envelope (start/stop ramp), level (volume * envelope)
+  enum ModulationSignal { kBreathSignal, kEnvelopeSignal, kLevelSignal };
+
   // Volume ramping state
   float _currentGain = 0.0f;
   float _startGain = 0.0f;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "MartigliNode.h"
+#include "VoiceRenderer.h"
+#include "BreathingClockHostObject.h"
 #include <audioapi/HostObjects/AudioNodeHostObject.h>
 #include <memory>
 
@@ -13,10 +15,21 @@ using namespace facebook;
     return {std::static_pointer_cast<MartigliNode>(node_)->name}; \
   } \
   JSI_PROPERTY_SETTER(name) { \
-    std::static_pointer_cast<MartigliNode>(node_)->name = value.get##type(); \
+    auto node = std::static_pointer_cast<MartigliNode>(node_); \
+    node->name = value.get##type(); \
+    node->touchParams(); \
   }
 
-class MartigliNodeHostObject : public AudioNodeHostObject {
+// Control flags and isOn do not change the rendered sound's parameters
+#define MARTIGLI_FLAG(name) \
+  JSI_PROPERTY_GETTER(name) { \
+    return {std::static_pointer_cast<MartigliNode>(node_)->name}; \
+  } \
+  JSI_PROPERTY_SETTER(name) { \
+    std::static_pointer_cast<MartigliNode>(node_)->name = value.getBool(); \
+  }
+
+class MartigliNodeHostObject : public AudioNodeHostObject, public VoiceHostObject {
 public:
   explicit MartigliNodeHostObject(const std::shared_ptr<MartigliNode> &node)
       : AudioNodeHostObject(node) {
@@ -44,6 +57,7 @@ public:
     addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliNodeHostObject, shouldResume));
     addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliNodeHostObject, shouldStop));
     addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliNodeHostObject, shouldResetPhase));
+    addGetters(JSI_EXPORT_PROPERTY_GETTER(MartigliNodeHostObject, breathingClock));
     
     // Add setters
     addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliNodeHostObject, mf0));
@@ -64,6 +78,7 @@ public:
     addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliNodeHostObject, shouldResume));
     addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliNodeHostObject, shouldStop));
     addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliNodeHostObject, shouldResetPhase));
+    addSetters(JSI_EXPORT_PROPERTY_SETTER(MartigliNodeHostObject, breathingClock));
   }
 
   MARTIGLI_PROPERTY(Number, mf0)
@@ -78,12 +93,12 @@ public:
   MARTIGLI_PROPERTY(Number, panOsc)
   MARTIGLI_PROPERTY(Number, panOscPeriod)
   MARTIGLI_PROPERTY(Number, panOscTrans)
-  MARTIGLI_PROPERTY(Bool, isOn)
-  MARTIGLI_PROPERTY(Bool, shouldStart)
-  MARTIGLI_PROPERTY(Bool, shouldPause)
-  MARTIGLI_PROPERTY(Bool, shouldResume)
-  MARTIGLI_PROPERTY(Bool, shouldStop)
-  MARTIGLI_PROPERTY(Bool, shouldResetPhase)
+  MARTIGLI_FLAG(isOn)
+  MARTIGLI_FLAG(shouldStart)
+  MARTIGLI_FLAG(shouldPause)
+  MARTIGLI_FLAG(shouldResume)
+  MARTIGLI_FLAG(shouldStop)
+  MARTIGLI_FLAG(shouldResetPhase)
   
   JSI_PROPERTY_GETTER(animationValue) {
     return {std::static_pointer_cast<MartigliNode>(node_)->animationValue};
@@ -104,8 +119,43 @@ public:
   JSI_PROPERTY_GETTER(currentPeriod) {
     return {std::static_pointer_cast<MartigliNode>(node_)->currentPeriod};
   }
+
+  // Shared breathing clock (createBreathingClock()), or null for the voice's own
+  JSI_PROPERTY_GETTER(breathingClock) {
+    auto clock = std::static_pointer_cast<MartigliNode>(node_)->getBreathingClock();
+    if (!clock) {
+      return jsi::Value::null();
+    }
+    return jsi::Object::createFromHostObject(runtime, std::make_shared<BreathingClockHostObject>(clock));
+  }
+
+  JSI_PROPERTY_SETTER(breathingClock) {
+    auto node = std::static_pointer_cast<MartigliNode>(node_);
+    node->setBreathingClock(BreathingClockHostObject::fromValue(runtime, value));
+    node->touchParams();
+  }
+
+  // Properties are registered through addGetters/addSetters; these only
+  // wrap the lookups for tracing.
+  jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    trace::Scope traceScope("jsi", "Martigli.get", std::static_pointer_cast<MartigliNode>(node_).get());
+    return AudioNodeHostObject::get(runtime, propNameId);
+  }
+
+  void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    trace::Scope traceScope("jsi", "Martigli.set", std::static_pointer_cast<MartigliNode>(node_).get());
+    if (trace::enabled() && value.isBool()) {
+      trace::commandQueued(propNameId.utf8(runtime), value.getBool(), std::static_pointer_cast<MartigliNode>(node_).get());
+    }
+    AudioNodeHostObject::set(runtime, propNameId, value);
+  }
+
+  std::shared_ptr<VoiceRenderer> getVoiceRenderer() const override {
+    return std::static_pointer_cast<MartigliNode>(node_);
+  }
 };
 
 #undef MARTIGLI_PROPERTY
+#undef MARTIGLI_FLAG
 
 } // namespace audioapi
@@ -0,0 +1,128 @@
+#include "MasterBusNode.h"
+#include "FastMath.h"
+#include <audioapi/utils/AudioBus.h>
+#include <audioapi/utils/AudioArray.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace audioapi {
+
+namespace {
+
+// Soft clipper, generic over float and fastmath::Float4. Below threshold the
+// gain is 1; above it |x| is mapped through a rational tanh approximation
+// that leaves the knee with slope 1 and reaches exactly 1.0 at three knee
+// widths past it. `limited` gets 1 in every lane that was bent.
+template <typename T>
+inline T softClip(T x, float threshold, T &limited) {
+  using namespace fastmath;
+  const T one = splat<T>(1.0f);
+  const T zero = splat<T>(0.0f);
+  const T knee = splat<T>(threshold);
+  const float width = 1.0f - threshold;
+
+  const T a = abs(x);
+  const T u = min(max(a - knee, zero) * (1.0f / width), splat<T>(3.0f));
+  const T u2 = u * u;
+  const T shaped = knee + width * (u * (27.0f + u2) / (27.0f + 9.0f * u2));
+  limited = selectGreater(a, knee, one, zero);
+  return x * selectGreater(a, knee, shaped / max(a, splat<T>(1e-9f)), one);
+}
+
+} // namespace
+
+MasterBusNode::MasterBusNode(BaseAudioContext *context)
+    : AudioNode(context), sampleRate_(context->getSampleRate()) {
+  channelCount_ = 2;
+  channelCountMode_ = ChannelCountMode::EXPLICIT;
+  channelInterpretation_ = ChannelInterpretation::SPEAKERS;
+  isInitialized_ = true;
+}
+
+int MasterBusNode::processChannel(float *data, int frames, float gainStart, float gainStep,
+                                  float &peak, float &sumSquares) const {
+  using fastmath::Float4;
+  const float knee = std::clamp(threshold, 0.1f, 0.99f);
+  alignas(16) static constexpr float kLanes[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+  const Float4 laneSteps = Float4::load(kLanes) * gainStep;
+
+  Float4 peak4 = Float4::broadcast(0.0f);
+  Float4 squares4 = Float4::broadcast(0.0f);
+  Float4 limited4 = Float4::broadcast(0.0f);
+
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    Float4 x = Float4::load(data + i) * (laneSteps + (gainStart + gainStep * static_cast<float>(i)));
+    if (limiter) {
+      Float4 limited;
+      x = softClip(x, knee, limited);
+      limited4 = limited4 + limited;
+    }
+    x.store(data + i);
+    peak4 = fastmath::max(peak4, fastmath::abs(x));
+    squares4 = squares4 + x * x;
+  }
+
+  alignas(16) float lanes[4];
+  peak4.store(lanes);
+  peak = std::max({peak, lanes[0], lanes[1], lanes[2], lanes[3]});
+  sumSquares += fastmath::sum(squares4);
+  int limitedCount = static_cast<int>(fastmath::sum(limited4));
+
+  for (; i < frames; ++i) {
+    float x = data[i] * (gainStart + gainStep * static_cast<float>(i));
+    if (limiter) {
+      float limited;
+      x = softClip(x, knee, limited);
+      limitedCount += static_cast<int>(limited);
+    }
+    data[i] = x;
+    peak = std::max(peak, std::fabs(x));
+    sumSquares += x * x;
+  }
+  return limitedCount;
+}
+
+void MasterBusNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) {
+  CUSTOM_NODES_RT_SCOPE("MasterBus");
+  if (framesToProcess <= 0) {
+    return;
+  }
+  // Steps are the voices' business; here only NaN/Inf and late callbacks
+  const float maxStep = std::numeric_limits<float>::max();
+  GlitchDetector::Scope glitchScope(glitches_, bus, framesToProcess, sampleRate_, maxStep);
+  CUSTOM_NODES_DSP_SCOPE(dspLoad_, framesToProcess, sampleRate_);
+  CUSTOM_NODES_TRACE_SCOPE("dsp", "MasterBus");
+  const float frames = static_cast<float>(framesToProcess);
+
+  // Exponential glide towards the target, applied as a linear ramp per block
+  const float target = targetGain_.load(std::memory_order_relaxed);
+  float gainEnd = target + (gain_ - target) * std::exp(-frames / (kGainSmoothingSeconds * sampleRate_));
+  if (std::fabs(gainEnd - target) < 1e-5f) {
+    gainEnd = target;
+  }
+  const float gainStep = (gainEnd - gain_) / frames;
+
+  float peak = 0.0f;
+  float sumSquares = 0.0f;
+  int limited = 0;
+  const int numChannels = bus->getNumberOfChannels();
+  for (int c = 0; c < numChannels; ++c) {
+    limited += processChannel(bus->getChannel(c)->getData(), framesToProcess, gain_, gainStep, peak, sumSquares);
+  }
+  gain_ = gainEnd;
+
+  // Meters: peak falls off and the mean square is averaged over kMeterSeconds
+  const float decay = std::exp(-frames / (kMeterSeconds * sampleRate_));
+  const float blockMeanSquare = sumSquares / (frames * static_cast<float>(std::max(numChannels, 1)));
+  peakHold_ = std::max(peak, peakHold_ * decay);
+  meanSquare_ = blockMeanSquare + (meanSquare_ - blockMeanSquare) * decay;
+  peak_.store(peakHold_, std::memory_order_relaxed);
+  rms_.store(std::sqrt(meanSquare_), std::memory_order_relaxed);
+  if (limited > 0) {
+    limitedSamples_.fetch_add(static_cast<uint64_t>(limited), std::memory_order_relaxed);
+  }
+}
+
+} // namespace audioapi
@@ -0,0 +1,68 @@
+#pragma once
+#include <audioapi/core/AudioNode.h>
+#include <audioapi/core/BaseAudioContext.h>
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include <atomic>
+#include <cstdint>
+
+namespace audioapi {
+class AudioBus;
+
+// Last stage before the destination: master gain, soft limiter and meters.
+//
+// The master volume is one atomic write from JS; the node glides to it over
+// kGainSmoothingSeconds so slider moves never click. The limiter is a
+// memoryless soft clipper (no look-ahead, no latency): samples below
+// threshold pass unchanged, louder ones bend smoothly towards full scale and
+// never exceed it. Gain, limiter and meters run four samples at a time on
+// fastmath::Float4.
+//
+// Sits after the VoiceMixNode, so the master volume is not part of the
+// session render cache and moving it never drops a replay back to synthesis.
+class MasterBusNode : public AudioNode {
+public:
+  static constexpr float kGainSmoothingSeconds = 0.05f;
+  static constexpr float kMeterSeconds = 0.3f;  // peak fall-off and RMS window
+
+  explicit MasterBusNode(BaseAudioContext *context);
+  ~MasterBusNode() override = default;
+
+  // JS thread
+  void setGain(float gain) { targetGain_.store(gain, std::memory_order_relaxed); }
+  float getGain() const { return targetGain_.load(std::memory_order_relaxed); }
+
+  // Output meters, linear full scale (after gain and limiter)
+  float getPeak() const { return peak_.load(std::memory_order_relaxed); }
+  float getRms() const { return rms_.load(std::memory_order_relaxed); }
+  // Samples the limiter has bent since the node was created
+  uint64_t getLimitedSamples() const { return limitedSamples_.load(std::memory_order_relaxed); }
+
+  bool limiter = true;
+  float threshold = 0.8f;  // limiter knee, linear (about -2 dBFS)
+
+protected:
+  void processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override;
+
+private:
+  // Gain ramp and limiter on one channel; returns the number of limited samples
+  int processChannel(float *data, int frames, float gainStart, float gainStep,
+                     float &peak, float &sumSquares) const;
+
+  float sampleRate_;
+  std::atomic<float> targetGain_{1.0f};
+  float gain_ = 1.0f;
+
+  float peakHold_ = 0.0f;
+  float meanSquare_ = 0.0f;
+  std::atomic<float> peak_{0.0f};
+  std::atomic<float> rms_{0.0f};
+  std::atomic<uint64_t> limitedSamples_{0};
+
+  DspLoadMeter dspLoad_{"MasterBus"};
+  GlitchDetector glitches_{"MasterBus"};
+};
+
+} // namespace audioapi
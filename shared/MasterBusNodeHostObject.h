@@ -0,0 +1,65 @@
+#pragma once
+#include "MasterBusNode.h"
+#include <audioapi/HostObjects/AudioNodeHostObject.h>
+#include <jsi/jsi.h>
+
+using namespace facebook;
+
+namespace audioapi {
+
+class MasterBusNodeHostObject : public AudioNodeHostObject {
+public:
+  explicit MasterBusNodeHostObject(const std::shared_ptr<MasterBusNode> &node)
+      : AudioNodeHostObject(node), node_(node) {}
+
+  jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    trace::Scope traceScope("jsi", "MasterBus.get", node_.get());
+    auto propName = propNameId.utf8(runtime);
+
+    if (propName == "gain") {
+      return jsi::Value(static_cast<double>(node_->getGain()));
+    }
+    if (propName == "limiter") {
+      return jsi::Value(node_->limiter);
+    }
+    if (propName == "threshold") {
+      return jsi::Value(static_cast<double>(node_->threshold));
+    }
+    if (propName == "peak") {
+      return jsi::Value(static_cast<double>(node_->getPeak()));
+    }
+    if (propName == "rms") {
+      return jsi::Value(static_cast<double>(node_->getRms()));
+    }
+    if (propName == "limitedSamples") {
+      return jsi::Value(static_cast<double>(node_->getLimitedSamples()));
+    }
+
+    return AudioNodeHostObject::get(runtime, propNameId);
+  }
+
+  void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    trace::Scope traceScope("jsi", "MasterBus.set", node_.get());
+    auto propName = propNameId.utf8(runtime);
+
+    if (propName == "gain") {
+      node_->setGain(static_cast<float>(value.asNumber()));
+      return;
+    }
+    if (propName == "limiter") {
+      node_->limiter = value.asBool();
+      return;
+    }
+    if (propName == "threshold") {
+      node_->threshold = static_cast<float>(value.asNumber());
+      return;
+    }
+
+    AudioNodeHostObject::set(runtime, propNameId, value);
+  }
+
+private:
+  std::shared_ptr<MasterBusNode> node_;
+};
+
+} // namespace audioapi
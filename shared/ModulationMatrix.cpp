@@ -0,0 +1,318 @@
+#include "ModulationMatrix.h"
+#include "VoiceRenderer.h"
+#include <algorithm>
+#include <tuple>
+
+namespace audioapi {
+
+int ModulationPorts::addSignal(const char *name) {
+  if (signalCount_ >= kMaxSignals) {
+    return -1;
+  }
+  signalNames_[signalCount_] = name;
+  return signalCount_++;
+}
+
+void ModulationPorts::addParam(const char *name, float *value) {
+  if (paramCount_ < kMaxParams) {
+    params_[paramCount_++] = {name, value, nullptr};
+  }
+}
+
+void ModulationPorts::addParam(const char *name, double *value) {
+  if (paramCount_ < kMaxParams) {
+    params_[paramCount_++] = {name, nullptr, value};
+  }
+}
+
+int ModulationPorts::findSignal(const std::string &name) const {
+  for (int i = 0; i < signalCount_; ++i) {
+    if (name == signalNames_[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int ModulationPorts::findParam(const std::string &name) const {
+  for (int i = 0; i < paramCount_; ++i) {
+    if (name == params_[i].name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void ModulationPorts::setParam(int index, float value) const {
+  const auto &param = params_[index];
+  if (param.floatValue != nullptr) {
+    *param.floatValue = value;
+  } else {
+    *param.doubleValue = value;
+  }
+}
+
+float ModulationPorts::getParam(int index) const {
+  const auto &param = params_[index];
+  return param.floatValue != nullptr ? *param.floatValue : static_cast<float>(*param.doubleValue);
+}
+
+void ModulationPorts::attachRoute(int index) {
+  auto &param = params_[index];
+  if (param.routes++ == 0) {
+    param.base = getParam(index);
+    param.routed = param.base;
+  }
+}
+
+void ModulationPorts::detachRoute(int index) {
+  auto &param = params_[index];
+  if (param.routes > 0 && --param.routes == 0) {
+    setParam(index, routedBase(index));
+  }
+}
+
+float ModulationPorts::routedBase(int index) {
+  auto &param = params_[index];
+  const float value = getParam(index);
+  if (value != param.routed) {
+    param.base = value;
+    param.routed = value;
+  }
+  return param.base;
+}
+
+void ModulationPorts::setRouted(int index, float value) {
+  setParam(index, value);
+  // What a double parameter reads back as, so routedBase() sees no change
+  params_[index].routed = getParam(index);
+}
+
+void ModulationPorts::rampParam(int index, float value, int frames) {
+  if (index < 0 || index >= paramCount_) {
+    return;
+  }
+  auto &ramp = ramps_[index];
+  ramp.target.store(value, std::memory_order_relaxed);
+  ramp.frames.store(std::max(frames, 0), std::memory_order_relaxed);
+  ramp.serial.fetch_add(1, std::memory_order_release);
+  rampSerial_.fetch_add(1, std::memory_order_release);
+}
+
+void ModulationPorts::advanceRamps(int frames) {
+  const uint32_t serial = rampSerial_.load(std::memory_order_acquire);
+  if (serial != rampSeen_) {
+    rampSeen_ = serial;
+    for (int i = 0; i < paramCount_; ++i) {
+      auto &ramp = ramps_[i];
+      const uint32_t requested = ramp.serial.load(std::memory_order_acquire);
+      if (requested == ramp.seen) {
+        continue;
+      }
+      ramp.seen = requested;
+      activeRamps_ += ramp.active ? 0 : 1;
+      ramp.active = true;
+      ramp.from = params_[i].routes > 0 ? routedBase(i) : getParam(i);
+      ramp.to = ramp.target.load(std::memory_order_relaxed);
+      ramp.total = ramp.frames.load(std::memory_order_relaxed);
+      ramp.elapsed = 0;
+    }
+  }
+  if (activeRamps_ == 0) {
+    return;
+  }
+
+  for (int i = 0; i < paramCount_; ++i) {
+    auto &ramp = ramps_[i];
+    if (!ramp.active) {
+      continue;
+    }
+    ramp.elapsed = std::min(ramp.elapsed + frames, ramp.total);
+    if (ramp.elapsed >= ramp.total) {
+      setParam(i, ramp.to);
+      ramp.active = false;
+      --activeRamps_;
+    } else {
+      const float t = static_cast<float>(ramp.elapsed) / static_cast<float>(ramp.total);
+      setParam(i, ramp.from + (ramp.to - ramp.from) * t);
+    }
+  }
+}
+
+int ModulationMatrix::addRoute(VoiceRenderer *source, const std::string &signal,
+                               VoiceRenderer *target, const std::string &param,
+                               float depth, float offset) {
+  if (source == nullptr || target == nullptr || routeCount_ >= kMaxRoutes) {
+    return -1;
+  }
+  const int signalIndex = source->modulation().findSignal(signal);
+  const int paramIndex = target->modulation().findParam(param);
+  if (signalIndex < 0 || paramIndex < 0) {
+    return -1;
+  }
+  auto &route = routes_[routeCount_++];
+  route = {source, target, signalIndex, paramIndex, depth, offset, nextId_++};
+  return route.id;
+}
+
+bool ModulationMatrix::hasRoutes(const VoiceRenderer *voice) const {
+  for (int r = 0; r < routeCount_; ++r) {
+    if (routes_[r].source == voice || routes_[r].target == voice) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ModulationMatrix::removeRoute(int id) {
+  for (int r = 0; r < routeCount_; ++r) {
+    if (routes_[r].id == id) {
+      routes_[r] = routes_[--routeCount_];
+      return true;
+    }
+  }
+  return false;
+}
+
+void ModulationMatrix::removeVoice(VoiceRenderer *voice) {
+  for (int r = 0; r < routeCount_;) {
+    if (routes_[r].source == voice || routes_[r].target == voice) {
+      routes_[r] = routes_[--routeCount_];
+    } else {
+      ++r;
+    }
+  }
+}
+
+void ModulationMatrix::clear() {
+  routeCount_ = 0;
+}
+
+bool ModulationMatrix::hasRoute(int id) const {
+  for (int r = 0; r < routeCount_; ++r) {
+    if (routes_[r].id == id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ModulationMatrix::syncPorts(const ModulationMatrix &previous) const {
+  for (int r = 0; r < previous.routeCount_; ++r) {
+    const auto &route = previous.routes_[r];
+    if (!hasRoute(route.id)) {
+      route.target->modulation().detachRoute(route.param);
+    }
+  }
+  for (int r = 0; r < routeCount_; ++r) {
+    const auto &route = routes_[r];
+    if (!previous.hasRoute(route.id)) {
+      route.target->modulation().attachRoute(route.param);
+    }
+  }
+}
+
+void ModulationMatrix::rebuild(const VoiceRenderer *const *voices, int voiceCount) {
+  voiceCount = std::min(voiceCount, kMaxVoices);
+  auto slotOf = [&](const VoiceRenderer *voice) {
+    for (int v = 0; v < voiceCount; ++v) {
+      if (voices[v] == voice) {
+        return v;
+      }
+    }
+    return -1;
+  };
+
+  std::array<int, kMaxRoutes> sourceSlot{};
+  std::array<int, kMaxRoutes> targetSlot{};
+  std::array<int, kMaxVoices> pending{};  // unprocessed incoming routes
+  for (int r = 0; r < routeCount_; ++r) {
+    sourceSlot[r] = slotOf(routes_[r].source);
+    targetSlot[r] = slotOf(routes_[r].target);
+    if (sourceSlot[r] >= 0 && targetSlot[r] >= 0 && sourceSlot[r] != targetSlot[r]) {
+      ++pending[targetSlot[r]];
+    }
+  }
+
+  // Kahn's algorithm, lowest slot first. When only cycles are left, the
+  // lowest remaining slot goes next and its unprocessed incoming routes
+  // become feedback (previous quantum's value).
+  std::array<int, kMaxVoices> level{};
+  std::array<bool, kMaxVoices> done{};
+  for (int step = 0; step < voiceCount; ++step) {
+    int next = -1;
+    for (int v = 0; v < voiceCount && next < 0; ++v) {
+      if (!done[v] && pending[v] == 0) {
+        next = v;
+      }
+    }
+    for (int v = 0; v < voiceCount && next < 0; ++v) {
+      if (!done[v]) {
+        next = v;
+      }
+    }
+    done[next] = true;
+    for (int r = 0; r < routeCount_; ++r) {
+      const int target = targetSlot[r];
+      if (sourceSlot[r] == next && target >= 0 && !done[target]) {
+        --pending[target];
+        level[target] = std::max(level[target], level[next] + 1);
+      }
+    }
+  }
+
+  // Slots grouped by level, in slot order within a level
+  levelCount_ = 0;
+  int position = 0;
+  for (int l = 0; position < voiceCount; ++l) {
+    levelStarts_[l] = position;
+    for (int v = 0; v < voiceCount; ++v) {
+      if (level[v] == l) {
+        order_[position++] = v;
+      }
+    }
+    levelCount_ = l + 1;
+  }
+  levelStarts_[levelCount_] = position;
+
+  // Routes grouped by target level, then by target parameter
+  int routes = 0;
+  for (int r = 0; r < routeCount_; ++r) {
+    if (sourceSlot[r] >= 0 && targetSlot[r] >= 0) {
+      sortedRoutes_[routes++] = r;
+    }
+  }
+  auto key = [&](int r) {
+    return std::make_tuple(level[targetSlot[r]], targetSlot[r], routes_[r].param);
+  };
+  std::sort(sortedRoutes_.begin(), sortedRoutes_.begin() + routes,
+            [&](int a, int b) { return key(a) < key(b); });
+
+  int cursor = 0;
+  for (int l = 0; l <= levelCount_; ++l) {
+    routeStarts_[l] = cursor;
+    while (cursor < routes && l < levelCount_ && level[targetSlot[sortedRoutes_[cursor]]] == l) {
+      ++cursor;
+    }
+  }
+  for (int i = 0; i < routes; ++i) {
+    firstOfParam_[i] = i == 0 || key(sortedRoutes_[i - 1]) != key(sortedRoutes_[i]);
+  }
+}
+
+void ModulationMatrix::applyLevel(int level) const {
+  const int end = routeStarts_[level + 1];
+  float value = 0.0f;
+  for (int i = routeStarts_[level]; i < end; ++i) {
+    const auto &route = routes_[sortedRoutes_[i]];
+    if (firstOfParam_[i]) {
+      value = route.target->modulation().routedBase(route.param);
+    }
+    value += route.offset + route.depth * route.source->modulation().signal(route.signal);
+    if (i + 1 == end || firstOfParam_[i + 1]) {
+      route.target->modulation().setRouted(route.param, value);
+    }
+  }
+}
+
+} // namespace audioapi
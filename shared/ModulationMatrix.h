@@ -0,0 +1,169 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace audioapi {
+class VoiceRenderer;
+
+// Named control signals a voice publishes once per rendered block, and the
+// numeric parameters other voices' signals may drive. Every voice declares
+// its ports in its constructor; they never change afterwards, so the mixer
+// can resolve names to indices on the JS thread and only use indices while
+// rendering.
+//
+// The same parameters can also be ramped (rampParam), which is how a running
+// voice is retargeted to a new preset without a jump: the mixer advances the
+// ramps once per chunk, before applying routes, so a routed parameter keeps
+// following its routes.
+class ModulationPorts {
+public:
+  static constexpr int kMaxSignals = 4;
+  static constexpr int kMaxParams = 8;
+
+  // Constructor of the owning voice only. Returns the signal's index for publish().
+  int addSignal(const char *name);
+  void addParam(const char *name, float *value);
+  void addParam(const char *name, double *value);
+
+  // -1 if the voice has no such port
+  int findSignal(const std::string &name) const;
+  int findParam(const std::string &name) const;
+
+  // Audio thread, at the end of the voice's block. Readers are ordered
+  // after the writer by the mixer (see ModulationMatrix).
+  void publish(int signal, float value) { signalValues_[signal] = value; }
+  float signal(int index) const { return signalValues_[index]; }
+  void setParam(int index, float value) const;
+  float getParam(int index) const;
+
+  // Routed parameters. The matrix writes base + the sum of its routes, where
+  // base is the value the parameter had when its first route was added. A
+  // write by anything else (a host object setter, a ramp) is taken as the new
+  // base at the next block, and the base is written back once the last route
+  // is gone. From ModulationMatrix::syncPorts:
+  void attachRoute(int index);
+  void detachRoute(int index);
+  // Audio thread, from ModulationMatrix::applyLevel
+  float routedBase(int index);
+  void setRouted(int index, float value);
+
+  // JS thread. Moves the parameter linearly from its value (its base, if
+  // routed) when the ramp starts to value over the next frames rendered
+  // frames (at once for 0); a new ramp replaces the running one.
+  void rampParam(int index, float value, int frames);
+  // Audio thread, once per chunk of frames
+  void advanceRamps(int frames);
+
+private:
+  struct Param {
+    const char *name = nullptr;
+    float *floatValue = nullptr;
+    double *doubleValue = nullptr;
+    int routes = 0;
+    float base = 0.0f;
+    float routed = 0.0f;  // last value the matrix wrote
+  };
+
+  std::array<const char *, kMaxSignals> signalNames_{};
+  std::array<float, kMaxSignals> signalValues_{};
+  int signalCount_ = 0;
+  std::array<Param, kMaxParams> params_{};
+  int paramCount_ = 0;
+
+  // Requests are published by bumping serial (and rampSerial_); the rest
+  // belongs to the audio thread
+  struct Ramp {
+    std::atomic<float> target{0.0f};
+    std::atomic<int> frames{0};
+    std::atomic<uint32_t> serial{0};
+    uint32_t seen = 0;
+    float from = 0.0f;
+    float to = 0.0f;
+    int total = 0;
+    int elapsed = 0;
+    bool active = false;
+  };
+  std::array<Ramp, kMaxParams> ramps_{};
+  std::atomic<uint32_t> rampSerial_{0};
+  uint32_t rampSeen_ = 0;
+  int activeRamps_ = 0;
+};
+
+// Routes from one voice's signal to another voice's parameter, owned by a
+// VoiceMixNode:
+//
+//   param = base + offset + depth * signal
+//
+// (several routes to one parameter add up; base is the parameter's own
+// value, see ModulationPorts::attachRoute). Routes are edited on the JS
+// thread, which also sorts the voices into levels: a voice is rendered after
+// every voice it listens to, so within a quantum a target reads the value its
+// sources published for that same quantum. A route that closes a cycle reads
+// the previous quantum's value instead. The mixer renders level by level,
+// applying the routes into a level just before rendering it; the audio thread
+// only walks the prebuilt arrays and never allocates.
+class ModulationMatrix {
+public:
+  static constexpr int kMaxRoutes = 64;
+  static constexpr int kMaxVoices = 32;
+
+  struct Route {
+    VoiceRenderer *source = nullptr;
+    VoiceRenderer *target = nullptr;
+    int signal = -1;
+    int param = -1;
+    float depth = 1.0f;
+    float offset = 0.0f;
+    int id = 0;
+  };
+
+  // JS thread, on the mixer's staged copy. Returns the route id, or -1 if
+  // a port does not exist or the table is full. rebuild() must follow. The
+  // voices' ports only see the edits through syncPorts().
+  int addRoute(VoiceRenderer *source, const std::string &signal,
+               VoiceRenderer *target, const std::string &param,
+               float depth, float offset);
+  bool removeRoute(int id);
+  // Drops the routes from or to a voice that is leaving the mixer
+  void removeVoice(VoiceRenderer *voice);
+  void clear();
+  int routeCount() const { return routeCount_; }
+  // Whether a route reads or writes the voice
+  bool hasRoutes(const VoiceRenderer *voice) const;
+  bool hasRoute(int id) const;
+
+  // Detaches the routes of previous that this matrix no longer has, then
+  // attaches the new ones (ModulationPorts::attachRoute). Called by the
+  // mixer when it installs this copy in place of previous, while every voice
+  // of both is alive and none is rendering.
+  void syncPorts(const ModulationMatrix &previous) const;
+
+  // Recomputes the render order for the mixer's current voices (in slot
+  // order). Voices without routes keep their relative order in level 0.
+  void rebuild(const VoiceRenderer *const *voices, int voiceCount);
+
+  // Audio thread
+  int levelCount() const { return levelCount_; }
+  // Slots of level l are order()[levelStart(l)] .. order()[levelStart(l + 1) - 1]
+  int levelStart(int level) const { return levelStarts_[level]; }
+  const std::array<int, kMaxVoices> &order() const { return order_; }
+  // Writes the parameters of every voice in the level from its routes
+  void applyLevel(int level) const;
+
+private:
+  std::array<Route, kMaxRoutes> routes_{};
+  int routeCount_ = 0;
+  int nextId_ = 1;
+
+  // Rebuilt by rebuild(): routes sorted by target level then target/param
+  std::array<int, kMaxRoutes> sortedRoutes_{};
+  std::array<bool, kMaxRoutes> firstOfParam_{};
+  std::array<int, kMaxVoices + 1> routeStarts_{};  // per level, into sortedRoutes_
+  std::array<int, kMaxVoices> order_{};
+  std::array<int, kMaxVoices + 1> levelStarts_{};
+  int levelCount_ = 0;
+};
+
+} // namespace audioapi
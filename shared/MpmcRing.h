@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace audioapi {
+
+// Bounded lock-free ring of N preallocated T (Vyukov MPMC). Any thread may
+// push: one CAS claims a slot, the item is written in place and published
+// with a release store, nothing allocates or blocks. A full ring refuses the
+// item instead of waiting. Consumers take items in order; drain() must not
+// run on two threads at once (NativeLog serializes it with a mutex,
+// TraceRecorder has a single flusher).
+template <typename T, size_t N>
+class MpmcRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "MpmcRing capacity must be a power of two");
+
+public:
+  static constexpr size_t kCapacity = N;
+
+  MpmcRing() { reset(); }
+
+  MpmcRing(const MpmcRing &) = delete;
+  MpmcRing &operator=(const MpmcRing &) = delete;
+
+  // Empties the ring. Only while nothing pushes or drains.
+  void reset() {
+    for (size_t i = 0; i < N; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    head_.store(0, std::memory_order_relaxed);
+    tail_ = 0;
+  }
+
+  // Claims a slot, calls fill(T &) on it and publishes it. False, without
+  // calling fill, if the ring is full.
+  template <typename Fill>
+  bool push(Fill &&fill) {
+    uint64_t position = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = slots_[position & (N - 1)];
+      const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          fill(slot.item);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        // Full: the consumer has not freed this slot yet
+        return false;
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Calls consume(const T &) on every published item in order, freeing each
+  // slot after its call. Returns the number of items.
+  template <typename Consume>
+  size_t drain(Consume &&consume) {
+    size_t count = 0;
+    for (;;) {
+      Slot &slot = slots_[tail_ & (N - 1)];
+      if (slot.sequence.load(std::memory_order_acquire) != tail_ + 1) {
+        return count;
+      }
+      consume(static_cast<const T &>(slot.item));
+      slot.sequence.store(tail_ + N, std::memory_order_release);
+      ++tail_;
+      ++count;
+    }
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    T item{};
+  };
+
+  std::array<Slot, N> slots_;
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) uint64_t tail_ = 0;  // consumer only
+};
+
+} // namespace audioapi
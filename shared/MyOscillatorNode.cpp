@@ -1,9 +1,9 @@
 #include "MyOscillatorNode.h"
+#include "NativeLog.h"
 #include <audioapi/core/BaseAudioContext.h>
 #include <audioapi/utils/AudioBus.h>
 #include <audioapi/utils/AudioArray.h>
 #include <cmath>
-#include <cstdio>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -17,9 +17,12 @@ MyOscillatorNode::MyOscillatorNode(BaseAudioContext *context)
 
 void MyOscillatorNode::processNode(const std::shared_ptr<AudioBus> &bus,
                                   int framesToProcess) {
-    printf("MyOscillatorNode: processNode called\n");
+    CUSTOM_NODES_RT_SCOPE("MyOscillator");
+    CUSTOM_NODES_LOG_VERBOSE("MyOscillatorNode", "processNode called");
 
     auto sampleRate = _context->getSampleRate();
+    CUSTOM_NODES_DSP_SCOPE(_dspLoad, framesToProcess, sampleRate);
+    CUSTOM_NODES_TRACE_SCOPE("dsp", "MyOscillator");
 
     for (int i = 0; i < framesToProcess; ++i) {
         float value = sinf(_phase) * volume;
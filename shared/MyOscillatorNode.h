@@ -1,5 +1,8 @@
 #pragma once
 #include <audioapi/core/AudioNode.h>
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
 
 namespace audioapi {
 class AudioBus;
@@ -8,6 +11,7 @@ class BaseAudioContext; // Forward declare
 class MyOscillatorNode : public AudioNode {
 private:
   BaseAudioContext* _context;
+  DspLoadMeter _dspLoad{"MyOscillator"};
 public:
   explicit MyOscillatorNode(BaseAudioContext *context);
   float _phase = 0.0;
@@ -5,7 +5,7 @@
 
 #include <memory>
 #include <vector>
-#include <cstdio> // For printf debugging
+#include "NativeLog.h"
 
 namespace audioapi {
 using namespace facebook;
@@ -15,7 +15,7 @@ public:
   explicit MyOscillatorNodeHostObject(
       const std::shared_ptr<MyOscillatorNode> &node)
       : AudioNodeHostObject(node) {
-    printf("MyOscillatorNodeHostObject: Creating MyOscillatorNodeHostObject\n");
+    CUSTOM_NODES_LOG_DEBUG("MyOscillatorNodeHostObject", "Creating MyOscillatorNodeHostObject");
     addGetters(JSI_EXPORT_PROPERTY_GETTER(MyOscillatorNodeHostObject, frequency));
     addSetters(JSI_EXPORT_PROPERTY_SETTER(MyOscillatorNodeHostObject, frequency));
     addGetters(JSI_EXPORT_PROPERTY_GETTER(MyOscillatorNodeHostObject, volume));
@@ -23,7 +23,7 @@ public:
   }
 
   ~MyOscillatorNodeHostObject() override {
-      printf("MyOscillatorNodeHostObject: Destroying MyOscillatorNodeHostObject\n");
+      CUSTOM_NODES_LOG_DEBUG("MyOscillatorNodeHostObject", "Destroying MyOscillatorNodeHostObject");
   }
 
   JSI_PROPERTY_GETTER(frequency) {
@@ -32,7 +32,7 @@ public:
   }
 
   JSI_PROPERTY_SETTER(frequency) {
-    printf("MyOscillatorNodeHostObject: Setting frequency to %f\n", value.getNumber());
+    CUSTOM_NODES_LOG_DEBUG("MyOscillatorNodeHostObject", "Setting frequency to %f", value.getNumber());
     auto oscillatorNode = std::static_pointer_cast<MyOscillatorNode>(node_);
     oscillatorNode->frequency = value.getNumber();
   }
@@ -43,7 +43,7 @@ public:
   }
 
   JSI_PROPERTY_SETTER(volume) {
-    printf("MyOscillatorNodeHostObject: Setting volume to %f\n", value.getNumber());
+    CUSTOM_NODES_LOG_DEBUG("MyOscillatorNodeHostObject", "Setting volume to %f", value.getNumber());
     auto oscillatorNode = std::static_pointer_cast<MyOscillatorNode>(node_);
     oscillatorNode->volume = value.getNumber();
   }
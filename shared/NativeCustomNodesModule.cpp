@@ -5,9 +5,19 @@
 #include "SymmetryNodeHostObject.h"
 #include "MartigliBinauralNodeHostObject.h"
 #include "NoiseNodeHostObject.h"
+#include "SampleNodeHostObject.h"
+#include "VoiceMixNodeHostObject.h"
+#include "MasterBusNodeHostObject.h"
+#include "BreathingClockHostObject.h"
+#include <algorithm>
+#include <exception>
 #include <iostream>
 #include <functional>
 #include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <audioapi/HostObjects/BaseAudioContextHostObject.h>
 #include "MyOscillatorNode.h"
 #include "MartigliNode.h"
@@ -15,40 +25,268 @@
 #include "SymmetryNode.h"
 #include "MartigliBinauralNode.h"
 #include "NoiseNode.h"
-#include <cstdio> // For printf debugging
+#include "SampleNode.h"
+#include "VoiceMixNode.h"
+#include "MasterBusNode.h"
+#include "VoiceRenderPool.h"
+#include "SessionRenderCache.h"
+#include "FastMathAccuracy.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "GlitchDetector.h"
+#include "RealtimeSafety.h"
+#include "NativeLog.h"
+#include "VoiceNodePool.h"
+#include "StartupProfiler.h"
+#include "PresetFormat.h"
+#include "PresetDiff.h"
+#include "PresetLibrary.h"
+#include "CostModel.h"
 
 namespace facebook::react {
 
+namespace {
+
+std::shared_ptr<audioapi::BaseAudioContext> contextFromArgument(jsi::Runtime &runtime, const jsi::Value *args,
+                                                                size_t count) {
+  if (count == 0 || !args[0].isObject()) {
+    return nullptr;
+  }
+  auto context = args[0].getObject(runtime).getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
+  return context != nullptr ? context->context_ : nullptr;
+}
+
+// Voice types as named in presets, which are also the pool's kinds
+void prewarmVoice(const std::shared_ptr<audioapi::BaseAudioContext> &context, const std::string &kind, int count) {
+  auto &pool = audioapi::VoiceNodePool::instance();
+  if (kind == "Martigli") {
+    pool.prewarm<audioapi::MartigliNode, audioapi::MartigliNodeHostObject>(context, "Martigli", count);
+  } else if (kind == "Martigli-Binaural") {
+    pool.prewarm<audioapi::MartigliBinauralNode, audioapi::MartigliBinauralNodeHostObject>(
+        context, "Martigli-Binaural", count);
+  } else if (kind == "Binaural") {
+    pool.prewarm<audioapi::BinauralNode, audioapi::BinauralNodeHostObject>(context, "Binaural", count);
+  } else if (kind == "Symmetry") {
+    pool.prewarm<audioapi::SymmetryNode, audioapi::SymmetryNodeHostObject>(context, "Symmetry", count);
+  } else if (kind == "Noise") {
+    pool.prewarm<audioapi::NoiseNode, audioapi::NoiseNodeHostObject>(context, "Noise", count);
+  } else if (kind == "Sample") {
+    pool.prewarm<audioapi::SampleNode, audioapi::SampleNodeHostObject>(context, "Sample", count);
+  } else {
+    CUSTOM_NODES_LOG_WARN("NativeCustomNodesModule", "prewarmVoices: unknown voice type %s", kind.c_str());
+  }
+}
+
+// { path?, tag } options of the preset library functions
+std::pair<std::string, std::string> libraryLocation(jsi::Runtime &runtime, const jsi::Object &options) {
+  std::string path = audioapi::PresetLibrary::defaultPath();
+  std::string tag;
+  auto pathValue = options.getProperty(runtime, "path");
+  if (pathValue.isString()) {
+    path = pathValue.asString(runtime).utf8(runtime);
+  }
+  auto tagValue = options.getProperty(runtime, "tag");
+  if (tagValue.isString()) {
+    tag = tagValue.asString(runtime).utf8(runtime);
+  }
+  return {path, tag};
+}
+
+// Decodes a binary preset (ArrayBuffer) or the preset of that id in the
+// open preset library
+bool decodePresetArgument(jsi::Runtime &runtime, const jsi::Value &source, audioapi::preset::Preset &preset) {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  if (source.isString()) {
+    auto view = audioapi::PresetLibrary::instance().preset(source.asString(runtime).utf8(runtime));
+    data = view.data;
+    size = view.size;
+  } else if (source.isObject() && source.asObject(runtime).isArrayBuffer(runtime)) {
+    auto buffer = source.asObject(runtime).getArrayBuffer(runtime);
+    data = buffer.data(runtime);
+    size = buffer.size(runtime);
+  }
+  return audioapi::preset::decode(data, size, preset);
+}
+
+// A pooled node of the given type, with the node itself for setting it up
+template <typename Node, typename HostObject>
+std::pair<std::shared_ptr<jsi::HostObject>, std::shared_ptr<Node>> acquireVoice(
+    const std::shared_ptr<audioapi::BaseAudioContext> &context, const char *kind) {
+  auto hostObject = audioapi::VoiceNodePool::instance().acquire<Node, HostObject>(context, kind);
+  auto voice = std::dynamic_pointer_cast<audioapi::VoiceHostObject>(hostObject)->getVoiceRenderer();
+  return {hostObject, std::static_pointer_cast<Node>(voice)};
+}
+
+// The node of a decoded preset voice, with its parameters set; nullptr for
+// unknown voice types and samples that cannot be loaded
+std::shared_ptr<jsi::HostObject> createPresetVoice(const std::shared_ptr<audioapi::BaseAudioContext> &context,
+                                                   const audioapi::preset::Voice &voice, uint32_t seed) {
+  using audioapi::preset::VoiceType;
+  const char *kind = audioapi::preset::typeName(voice.type);
+  switch (voice.type) {
+    case VoiceType::Martigli: {
+      auto [hostObject, node] = acquireVoice<audioapi::MartigliNode, audioapi::MartigliNodeHostObject>(context, kind);
+      node->applyParams(std::get<audioapi::MartigliParams>(voice.params));
+      return hostObject;
+    }
+    case VoiceType::MartigliBinaural: {
+      auto [hostObject, node] =
+          acquireVoice<audioapi::MartigliBinauralNode, audioapi::MartigliBinauralNodeHostObject>(context, kind);
+      node->applyParams(std::get<audioapi::MartigliBinauralParams>(voice.params));
+      return hostObject;
+    }
+    case VoiceType::Binaural: {
+      auto [hostObject, node] = acquireVoice<audioapi::BinauralNode, audioapi::BinauralNodeHostObject>(context, kind);
+      node->applyParams(std::get<audioapi::BinauralParams>(voice.params));
+      return hostObject;
+    }
+    case VoiceType::Symmetry: {
+      auto [hostObject, node] = acquireVoice<audioapi::SymmetryNode, audioapi::SymmetryNodeHostObject>(context, kind);
+      node->setSeed(seed);
+      node->applyParams(std::get<audioapi::SymmetryParams>(voice.params));
+      return hostObject;
+    }
+    case VoiceType::Noise: {
+      auto [hostObject, node] = acquireVoice<audioapi::NoiseNode, audioapi::NoiseNodeHostObject>(context, kind);
+      node->setSeed(seed);
+      node->applyParams(std::get<audioapi::NoiseParams>(voice.params));
+      return hostObject;
+    }
+    case VoiceType::Sample: {
+      auto [hostObject, node] = acquireVoice<audioapi::SampleNode, audioapi::SampleNodeHostObject>(context, kind);
+      if (voice.path.empty() || !node->load(voice.path)) {
+        CUSTOM_NODES_LOG_WARN("NativeCustomNodesModule", "preset sample cannot be loaded: %s", voice.path.c_str());
+        audioapi::VoiceNodePool::instance().release(context, hostObject, node);
+        return nullptr;
+      }
+      node->applyParams(std::get<audioapi::SampleParams>(voice.params));
+      return hostObject;
+    }
+    default:
+      return nullptr;
+  }
+}
+
+// Cost model coefficients as { martigli: [by waveform], ..., pan: [by mode],
+// sample, symmetryEvent, mix, calibrated }, in nanoseconds per frame
+jsi::Object costCoefficientsObject(jsi::Runtime &runtime, const audioapi::cost::Coefficients &coefficients) {
+  const auto table = [&runtime](const auto &values) {
+    jsi::Array array(runtime, values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      array.setValueAtIndex(runtime, i, values[i]);
+    }
+    return array;
+  };
+  jsi::Object result(runtime);
+  result.setProperty(runtime, "martigli", table(coefficients.martigli));
+  result.setProperty(runtime, "martigliBinaural", table(coefficients.martigliBinaural));
+  result.setProperty(runtime, "binaural", table(coefficients.binaural));
+  result.setProperty(runtime, "symmetry", table(coefficients.symmetry));
+  result.setProperty(runtime, "noise", table(coefficients.noise));
+  result.setProperty(runtime, "pan", table(coefficients.pan));
+  result.setProperty(runtime, "sample", coefficients.sample);
+  result.setProperty(runtime, "symmetryEvent", coefficients.symmetryEvent);
+  result.setProperty(runtime, "mix", coefficients.mix);
+  result.setProperty(runtime, "calibrated", coefficients.calibrated);
+  return result;
+}
+
+} // namespace
+
 NativeCustomNodesModule::NativeCustomNodesModule(std::shared_ptr<CallInvoker> jsInvoker)
     : NativeCustomNodesModuleCxxSpec(std::move(jsInvoker)) {
-        printf("NativeCustomNodesModule: Initialized\n");
+        audioapi::startup::mark("moduleCreated");
+        audioapi::log::start();
+        CUSTOM_NODES_LOG_INFO("NativeCustomNodesModule", "Initialized");
     }
 
 void NativeCustomNodesModule::injectCustomProcessorInstaller(jsi::Runtime &runtime) {
-  printf("NativeCustomNodesModule: injectCustomProcessorInstaller called\n");
+  CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "injectCustomProcessorInstaller called");
+  audioapi::startup::Span startupSpan("injectInstallers");
   auto oscillatorInstaller = createOscillatorInstaller(runtime);
   auto martigliInstaller = createMartigliInstaller(runtime);
   auto binauralInstaller = createBinauralInstaller(runtime);
   auto symmetryInstaller = createSymmetryInstaller(runtime);
   auto martigliBinauralInstaller = createMartigliBinauralInstaller(runtime);
   auto noiseInstaller = createNoiseInstaller(runtime);
+  auto sampleInstaller = createSampleInstaller(runtime);
+  auto voiceMixInstaller = createVoiceMixInstaller(runtime);
+  auto masterBusInstaller = createMasterBusInstaller(runtime);
+  auto breathingClockInstaller = createBreathingClockInstaller(runtime);
+  auto voiceRenderingBenchmark = createVoiceRenderingBenchmark(runtime);
+  auto renderCacheConfigurator = createRenderCacheConfigurator(runtime);
+  auto fastMathAccuracyReport = createFastMathAccuracyReport(runtime);
+  auto dspLoadReport = createDspLoadReport(runtime);
+  auto traceStarter = createTraceStarter(runtime);
+  auto traceStopper = createTraceStopper(runtime);
+  auto glitchReport = createGlitchReport(runtime);
+  auto glitchReset = createGlitchReset(runtime);
+  auto realtimeSafetyReport = createRealtimeSafetyReport(runtime);
+  auto realtimeSafetyReset = createRealtimeSafetyReset(runtime);
+  auto logLevelSetter = createLogLevelSetter(runtime);
+  auto voicePrewarmer = createVoicePrewarmer(runtime);
+  auto voiceReleaser = createVoiceReleaser(runtime);
+  auto voicePoolDrainer = createVoicePoolDrainer(runtime);
+  auto voicePoolReport = createVoicePoolReport(runtime);
+  auto sessionPreparer = createSessionPreparer(runtime);
+  auto startupMarker = createStartupMarker(runtime);
+  auto startupReport = createStartupReport(runtime);
+  auto presetVoiceCreator = createPresetVoiceCreator(runtime);
+  auto presetDiffApplier = createPresetDiffApplier(runtime);
+  auto presetLibraryOpener = createPresetLibraryOpener(runtime);
+  auto presetLibraryWriter = createPresetLibraryWriter(runtime);
+  auto presetLibraryLister = createPresetLibraryLister(runtime);
+  auto presetLibraryMetaReader = createPresetLibraryMetaReader(runtime);
+  auto costEstimator = createCostEstimator(runtime);
+  auto costModelCalibrator = createCostModelCalibrator(runtime);
   runtime.global().setProperty(runtime, "createMyOscillatorNode", oscillatorInstaller);
   runtime.global().setProperty(runtime, "createMartigliNode", martigliInstaller);
   runtime.global().setProperty(runtime, "createBinauralNode", binauralInstaller);
   runtime.global().setProperty(runtime, "createSymmetryNode", symmetryInstaller);
   runtime.global().setProperty(runtime, "createMartigliBinauralNode", martigliBinauralInstaller);
   runtime.global().setProperty(runtime, "createNoiseNode", noiseInstaller);
-  printf("NativeCustomNodesModule: All node installers injected globally\n");
+  runtime.global().setProperty(runtime, "createSampleNode", sampleInstaller);
+  runtime.global().setProperty(runtime, "createVoiceMixNode", voiceMixInstaller);
+  runtime.global().setProperty(runtime, "createMasterBusNode", masterBusInstaller);
+  runtime.global().setProperty(runtime, "createBreathingClock", breathingClockInstaller);
+  runtime.global().setProperty(runtime, "benchmarkVoiceRendering", voiceRenderingBenchmark);
+  runtime.global().setProperty(runtime, "configureRenderCache", renderCacheConfigurator);
+  runtime.global().setProperty(runtime, "fastMathAccuracyReport", fastMathAccuracyReport);
+  runtime.global().setProperty(runtime, "dspLoadReport", dspLoadReport);
+  runtime.global().setProperty(runtime, "startTrace", traceStarter);
+  runtime.global().setProperty(runtime, "stopTrace", traceStopper);
+  runtime.global().setProperty(runtime, "glitchReport", glitchReport);
+  runtime.global().setProperty(runtime, "resetGlitches", glitchReset);
+  runtime.global().setProperty(runtime, "realtimeSafetyReport", realtimeSafetyReport);
+  runtime.global().setProperty(runtime, "resetRealtimeSafety", realtimeSafetyReset);
+  runtime.global().setProperty(runtime, "setNativeLogLevel", logLevelSetter);
+  runtime.global().setProperty(runtime, "prewarmVoices", voicePrewarmer);
+  runtime.global().setProperty(runtime, "releaseVoices", voiceReleaser);
+  runtime.global().setProperty(runtime, "drainVoicePool", voicePoolDrainer);
+  runtime.global().setProperty(runtime, "voicePoolReport", voicePoolReport);
+  runtime.global().setProperty(runtime, "prepareSession", sessionPreparer);
+  runtime.global().setProperty(runtime, "markStartup", startupMarker);
+  runtime.global().setProperty(runtime, "startupReport", startupReport);
+  runtime.global().setProperty(runtime, "createPresetVoices", presetVoiceCreator);
+  runtime.global().setProperty(runtime, "applyPresetDiff", presetDiffApplier);
+  runtime.global().setProperty(runtime, "openPresetLibrary", presetLibraryOpener);
+  runtime.global().setProperty(runtime, "writePresetLibrary", presetLibraryWriter);
+  runtime.global().setProperty(runtime, "presetLibraryList", presetLibraryLister);
+  runtime.global().setProperty(runtime, "presetLibraryMeta", presetLibraryMetaReader);
+  runtime.global().setProperty(runtime, "estimateCost", costEstimator);
+  runtime.global().setProperty(runtime, "calibrateCostModel", costModelCalibrator);
+  CUSTOM_NODES_LOG_INFO("NativeCustomNodesModule", "All node installers injected globally");
 }
 
 jsi::Function NativeCustomNodesModule::createInstaller(jsi::Runtime &runtime) {
-    printf("NativeCustomNodesModule: createInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMyOscillatorNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeCustomNodesModule: createMyOscillatorNode called from JS\n");
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMyOscillatorNode called from JS");
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
@@ -61,13 +299,13 @@ jsi::Function NativeCustomNodesModule::createInstaller(jsi::Runtime &runtime) {
     }
 
 jsi::Function NativeCustomNodesModule::createOscillatorInstaller(jsi::Runtime &runtime) {
-    printf("NativeCustomNodesModule: createOscillatorInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createOscillatorInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMyOscillatorNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeCustomNodesModule: createMyOscillatorNode called from JS\n");
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMyOscillatorNode called from JS");
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
@@ -80,18 +318,18 @@ jsi::Function NativeCustomNodesModule::createOscillatorInstaller(jsi::Runtime &r
     }
 
 jsi::Function NativeCustomNodesModule::createMartigliInstaller(jsi::Runtime &runtime) {
-    printf("NativeCustomNodesModule: createMartigliInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMartigliInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMartigliNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeCustomNodesModule: createMartigliNode called from JS\n");
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMartigliNode called from JS");
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          auto node = std::make_shared<audioapi::MartigliNode>(context->context_.get());
-          auto nodeHostObject = std::make_shared<audioapi::MartigliNodeHostObject>(node);
+          auto nodeHostObject = audioapi::VoiceNodePool::instance()
+                                    .acquire<audioapi::MartigliNode, audioapi::MartigliNodeHostObject>(context->context_, "Martigli");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
         return jsi::Object::createFromHostObject(runtime, nullptr);
@@ -99,106 +337,1097 @@ jsi::Function NativeCustomNodesModule::createMartigliInstaller(jsi::Runtime &run
     }
 
 jsi::Function NativeCustomNodesModule::createBinauralInstaller(jsi::Runtime &runtime) {
-    printf("NativeCustomNodesModule: createBinauralInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createBinauralInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createBinauralNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeCustomNodesModule: createBinauralNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createBinauralNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeCustomNodesModule: ERROR - no arguments passed to createBinauralNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "no arguments passed to createBinauralNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeCustomNodesModule: Creating BinauralNode with context\n");
-          auto node = std::make_shared<audioapi::BinauralNode>(context->context_.get());
-          auto nodeHostObject = std::make_shared<audioapi::BinauralNodeHostObject>(node);
-          printf("NativeCustomNodesModule: BinauralNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "Creating BinauralNode with context");
+          auto nodeHostObject = audioapi::VoiceNodePool::instance()
+                                    .acquire<audioapi::BinauralNode, audioapi::BinauralNodeHostObject>(context->context_, "Binaural");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "BinauralNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeCustomNodesModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
 
 jsi::Function NativeCustomNodesModule::createSymmetryInstaller(jsi::Runtime &runtime) {
-    printf("NativeCustomNodesModule: createSymmetryInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createSymmetryInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createSymmetryNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeCustomNodesModule: createSymmetryNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createSymmetryNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeCustomNodesModule: ERROR - no arguments passed to createSymmetryNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "no arguments passed to createSymmetryNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeCustomNodesModule: Creating SymmetryNode with context\n");
-          auto node = std::make_shared<audioapi::SymmetryNode>(context->context_.get());
-          auto nodeHostObject = std::make_shared<audioapi::SymmetryNodeHostObject>(node);
-          printf("NativeCustomNodesModule: SymmetryNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "Creating SymmetryNode with context");
+          auto nodeHostObject = audioapi::VoiceNodePool::instance()
+                                    .acquire<audioapi::SymmetryNode, audioapi::SymmetryNodeHostObject>(context->context_, "Symmetry");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "SymmetryNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeCustomNodesModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
 
 jsi::Function NativeCustomNodesModule::createMartigliBinauralInstaller(jsi::Runtime &runtime) {
-    printf("NativeCustomNodesModule: createMartigliBinauralInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMartigliBinauralInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMartigliBinauralNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeCustomNodesModule: createMartigliBinauralNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMartigliBinauralNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeCustomNodesModule: ERROR - no arguments passed to createMartigliBinauralNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "no arguments passed to createMartigliBinauralNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeCustomNodesModule: Creating MartigliBinauralNode with context\n");
-          auto node = std::make_shared<audioapi::MartigliBinauralNode>(context->context_.get());
-          auto nodeHostObject = std::make_shared<audioapi::MartigliBinauralNodeHostObject>(node);
-          printf("NativeCustomNodesModule: MartigliBinauralNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "Creating MartigliBinauralNode with context");
+          auto nodeHostObject = audioapi::VoiceNodePool::instance()
+                                    .acquire<audioapi::MartigliBinauralNode, audioapi::MartigliBinauralNodeHostObject>(context->context_, "Martigli-Binaural");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "MartigliBinauralNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeCustomNodesModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
 
 jsi::Function NativeCustomNodesModule::createNoiseInstaller(jsi::Runtime &runtime) {
-    printf("NativeCustomNodesModule: createNoiseInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createNoiseInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createNoiseNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeCustomNodesModule: createNoiseNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createNoiseNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeCustomNodesModule: ERROR - no arguments passed to createNoiseNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "no arguments passed to createNoiseNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeCustomNodesModule: Creating NoiseNode with context\n");
-          auto node = std::make_shared<audioapi::NoiseNode>(context->context_.get());
-          auto nodeHostObject = std::make_shared<audioapi::NoiseNodeHostObject>(node);
-          printf("NativeCustomNodesModule: NoiseNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "Creating NoiseNode with context");
+          auto nodeHostObject = audioapi::VoiceNodePool::instance()
+                                    .acquire<audioapi::NoiseNode, audioapi::NoiseNodeHostObject>(context->context_, "Noise");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "NoiseNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeCustomNodesModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
+
+jsi::Function NativeCustomNodesModule::createSampleInstaller(jsi::Runtime &runtime) {
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createSampleInstaller called");
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "createSampleNode"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createSampleNode called from JS with %zu args", count);
+        if (count == 0) {
+          CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "no arguments passed to createSampleNode");
+          return jsi::Object::createFromHostObject(runtime, nullptr);
+        }
+        auto object = args[0].getObject(runtime);
+        auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
+        if (context != nullptr) {
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "Creating SampleNode with context");
+          auto nodeHostObject = audioapi::VoiceNodePool::instance()
+                                    .acquire<audioapi::SampleNode, audioapi::SampleNodeHostObject>(context->context_, "Sample");
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "SampleNode created successfully");
+          return jsi::Object::createFromHostObject(runtime, nodeHostObject);
+        }
+        CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "context is null");
+        return jsi::Object::createFromHostObject(runtime, nullptr);
+      });
+    }
+
+jsi::Function NativeCustomNodesModule::createVoiceMixInstaller(jsi::Runtime &runtime) {
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createVoiceMixInstaller called");
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "createVoiceMixNode"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createVoiceMixNode called from JS with %zu args", count);
+        if (count == 0) {
+          CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "no arguments passed to createVoiceMixNode");
+          return jsi::Object::createFromHostObject(runtime, nullptr);
+        }
+        auto object = args[0].getObject(runtime);
+        auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
+        if (context != nullptr) {
+          audioapi::startup::Span startupSpan("constructNode", "VoiceMix");
+          auto node = std::make_shared<audioapi::VoiceMixNode>(context->context_.get());
+          auto nodeHostObject = std::make_shared<audioapi::VoiceMixNodeHostObject>(node);
+          return jsi::Object::createFromHostObject(runtime, nodeHostObject);
+        }
+        CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "context is null");
+        return jsi::Object::createFromHostObject(runtime, nullptr);
+      });
+    }
+
+jsi::Function NativeCustomNodesModule::createMasterBusInstaller(jsi::Runtime &runtime) {
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMasterBusInstaller called");
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "createMasterBusNode"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createMasterBusNode called from JS with %zu args", count);
+        if (count == 0) {
+          CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "no arguments passed to createMasterBusNode");
+          return jsi::Object::createFromHostObject(runtime, nullptr);
+        }
+        auto object = args[0].getObject(runtime);
+        auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
+        if (context != nullptr) {
+          audioapi::startup::Span startupSpan("constructNode", "MasterBus");
+          auto node = std::make_shared<audioapi::MasterBusNode>(context->context_.get());
+          auto nodeHostObject = std::make_shared<audioapi::MasterBusNodeHostObject>(node);
+          return jsi::Object::createFromHostObject(runtime, nodeHostObject);
+        }
+        CUSTOM_NODES_LOG_ERROR("NativeCustomNodesModule", "context is null");
+        return jsi::Object::createFromHostObject(runtime, nullptr);
+      });
+}
+
+// createBreathingClock() -> clock to assign to voice.breathingClock. Not an
+// audio node, so it does not take the context.
+jsi::Function NativeCustomNodesModule::createBreathingClockInstaller(jsi::Runtime &runtime) {
+    CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "createBreathingClockInstaller called");
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "createBreathingClock"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto clock = std::make_shared<audioapi::BreathingClock>();
+        auto clockHostObject = std::make_shared<audioapi::BreathingClockHostObject>(clock);
+        return jsi::Object::createFromHostObject(runtime, clockHostObject);
+      });
+}
+
+// benchmarkVoiceRendering(maxVoices = 32, frames = 128, iterations = 200)
+// -> [{ voices, serialMicros, parallelMicros }]
+jsi::Function NativeCustomNodesModule::createVoiceRenderingBenchmark(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "benchmarkVoiceRendering"),
+      3,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        int maxVoices = count > 0 && args[0].isNumber() ? static_cast<int>(args[0].asNumber()) : 32;
+        int frames = count > 1 && args[1].isNumber() ? static_cast<int>(args[1].asNumber()) : 128;
+        int iterations = count > 2 && args[2].isNumber() ? static_cast<int>(args[2].asNumber()) : 200;
+
+        auto results = audioapi::benchmarkVoiceRendering(maxVoices, frames, iterations);
+        jsi::Array array(runtime, results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "voices", results[i].voices);
+          entry.setProperty(runtime, "serialMicros", results[i].serialMicros);
+          entry.setProperty(runtime, "parallelMicros", results[i].parallelMicros);
+          array.setValueAtIndex(runtime, i, entry);
+        }
+        return jsi::Value(runtime, array);
+      });
+}
+
+// configureRenderCache({ directory?, maxBytes?, clear? })
+// -> { directory, maxBytes, usedBytes }
+jsi::Function NativeCustomNodesModule::createRenderCacheConfigurator(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "configureRenderCache"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto &cache = audioapi::SessionRenderCache::shared();
+        std::string directory;
+        uint64_t maxBytes = 0;
+        bool clear = false;
+        if (count > 0 && args[0].isObject()) {
+          auto options = args[0].asObject(runtime);
+          auto directoryValue = options.getProperty(runtime, "directory");
+          if (directoryValue.isString()) {
+            directory = directoryValue.asString(runtime).utf8(runtime);
+          }
+          auto maxBytesValue = options.getProperty(runtime, "maxBytes");
+          if (maxBytesValue.isNumber()) {
+            maxBytes = static_cast<uint64_t>(maxBytesValue.asNumber());
+          }
+          auto clearValue = options.getProperty(runtime, "clear");
+          clear = clearValue.isBool() && clearValue.getBool();
+        }
+
+        cache.configure(directory, maxBytes);
+        if (clear) {
+          CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "clearing render cache");
+          cache.clear();
+        }
+
+        jsi::Object result(runtime);
+        result.setProperty(runtime, "directory", jsi::String::createFromUtf8(runtime, cache.getDirectory()));
+        result.setProperty(runtime, "maxBytes", static_cast<double>(cache.getMaxBytes()));
+        result.setProperty(runtime, "usedBytes", static_cast<double>(cache.getUsedBytes()));
+        return jsi::Value(runtime, result);
+      });
+}
+
+// fastMathAccuracyReport(samples = 65536)
+// -> [{ function, tier, maxAbsError, maxErrorDb, maxErrorCents, nanosPerCall }]
+jsi::Function NativeCustomNodesModule::createFastMathAccuracyReport(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "fastMathAccuracyReport"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        int samples = count > 0 && args[0].isNumber() ? static_cast<int>(args[0].asNumber()) : 1 << 16;
+
+        auto results = audioapi::fastmath::measureFastMathAccuracy(samples);
+        jsi::Array array(runtime, results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "function", jsi::String::createFromUtf8(runtime, results[i].function));
+          entry.setProperty(runtime, "tier", jsi::String::createFromUtf8(runtime, results[i].tier));
+          entry.setProperty(runtime, "maxAbsError", results[i].maxAbsError);
+          entry.setProperty(runtime, "maxErrorDb", results[i].maxErrorDb);
+          entry.setProperty(runtime, "maxErrorCents", results[i].maxErrorCents);
+          entry.setProperty(runtime, "nanosPerCall", results[i].nanosPerCall);
+          array.setValueAtIndex(runtime, i, entry);
+        }
+        return jsi::Value(runtime, array);
+      });
+}
+
+// dspLoadReport() -> processing time statistics of every live custom node.
+// Empty in release builds, where the meters are compiled out.
+jsi::Function NativeCustomNodesModule::createDspLoadReport(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "dspLoadReport"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto results = audioapi::collectDspLoad();
+        jsi::Array array(runtime, results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "node", jsi::String::createFromUtf8(runtime, results[i].node));
+          entry.setProperty(runtime, "blocks", static_cast<double>(results[i].blocks));
+          entry.setProperty(runtime, "meanMicros", results[i].meanMicros);
+          entry.setProperty(runtime, "p99Micros", results[i].p99Micros);
+          entry.setProperty(runtime, "maxMicros", results[i].maxMicros);
+          entry.setProperty(runtime, "budgetPercent", results[i].budgetPercent);
+          entry.setProperty(runtime, "peakBudgetPercent", results[i].peakBudgetPercent);
+          array.setValueAtIndex(runtime, i, entry);
+        }
+        return jsi::Value(runtime, array);
+      });
+}
+
+// startTrace(path) -> true if a Chrome trace capture started writing to path.
+// The file is only complete once stopTrace() returns.
+jsi::Function NativeCustomNodesModule::createTraceStarter(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "startTrace"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        if (count == 0 || !args[0].isString()) {
+          return jsi::Value(false);
+        }
+        auto path = args[0].asString(runtime).utf8(runtime);
+        bool started = audioapi::trace::TraceRecorder::shared().start(path);
+        CUSTOM_NODES_LOG_INFO("NativeCustomNodesModule", "startTrace(%s) %s", path.c_str(), started ? "started" : "failed");
+        return jsi::Value(started);
+      });
+}
+
+// stopTrace() -> { path, events, dropped } of the capture, or null if none
+// was running
+jsi::Function NativeCustomNodesModule::createTraceStopper(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "stopTrace"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto summary = audioapi::trace::TraceRecorder::shared().stop();
+        if (summary.path.empty()) {
+          return jsi::Value::null();
+        }
+        jsi::Object result(runtime);
+        result.setProperty(runtime, "path", jsi::String::createFromUtf8(runtime, summary.path));
+        result.setProperty(runtime, "events", static_cast<double>(summary.events));
+        result.setProperty(runtime, "dropped", static_cast<double>(summary.dropped));
+        return jsi::Value(runtime, result);
+      });
+}
+
+// glitchReport() -> output jumps, NaN/Inf and late callbacks of every live
+// custom node, with the last offending frames of each
+jsi::Function NativeCustomNodesModule::createGlitchReport(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "glitchReport"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        static const char *kKinds[] = {"jump", "nonFinite", "deadlineMiss"};
+        auto results = audioapi::collectGlitches();
+        jsi::Array array(runtime, results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+          const auto &stats = results[i];
+          jsi::Array recent(runtime, stats.recent.size());
+          for (size_t r = 0; r < stats.recent.size(); ++r) {
+            const auto &glitch = stats.recent[r];
+            jsi::Array samples(runtime, glitch.sampleCount);
+            for (int s = 0; s < glitch.sampleCount; ++s) {
+              samples.setValueAtIndex(runtime, s, static_cast<double>(glitch.samples[s]));
+            }
+            jsi::Object entry(runtime);
+            entry.setProperty(runtime, "kind", jsi::String::createFromAscii(runtime, kKinds[static_cast<int>(glitch.kind)]));
+            entry.setProperty(runtime, "channel", glitch.channel);
+            entry.setProperty(runtime, "frame", static_cast<double>(glitch.frame));
+            entry.setProperty(runtime, "previous", static_cast<double>(glitch.previous));
+            entry.setProperty(runtime, "value", static_cast<double>(glitch.value));
+            entry.setProperty(runtime, "threshold", static_cast<double>(glitch.threshold));
+            entry.setProperty(runtime, "samples", samples);
+            recent.setValueAtIndex(runtime, r, entry);
+          }
+          jsi::Object node(runtime);
+          node.setProperty(runtime, "node", jsi::String::createFromUtf8(runtime, stats.node));
+          node.setProperty(runtime, "blocks", static_cast<double>(stats.blocks));
+          node.setProperty(runtime, "jumps", static_cast<double>(stats.jumps));
+          node.setProperty(runtime, "nonFinite", static_cast<double>(stats.nonFinite));
+          node.setProperty(runtime, "deadlineMisses", static_cast<double>(stats.deadlineMisses));
+          node.setProperty(runtime, "recent", recent);
+          array.setValueAtIndex(runtime, i, node);
+        }
+        return jsi::Value(runtime, array);
+      });
+}
+
+// resetGlitches() -> clears every node's counters and captures at its next block
+jsi::Function NativeCustomNodesModule::createGlitchReset(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "resetGlitches"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        audioapi::resetGlitches();
+        return jsi::Value::undefined();
+      });
+}
+
+// realtimeSafetyReport() -> allocations, locks and stdio calls made inside
+// processNode, with stacks. enabled is false unless built with
+// CUSTOM_NODES_RT_CHECK=1.
+jsi::Function NativeCustomNodesModule::createRealtimeSafetyReport(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "realtimeSafetyReport"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto report = audioapi::rt::report();
+        jsi::Array recent(runtime, report.recent.size());
+        for (size_t i = 0; i < report.recent.size(); ++i) {
+          const auto &violation = report.recent[i];
+          jsi::Array stack(runtime, violation.stack.size());
+          for (size_t f = 0; f < violation.stack.size(); ++f) {
+            stack.setValueAtIndex(runtime, f, jsi::String::createFromUtf8(runtime, violation.stack[f]));
+          }
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "what", jsi::String::createFromUtf8(runtime, violation.what));
+          entry.setProperty(runtime, "node", jsi::String::createFromUtf8(runtime, violation.node));
+          entry.setProperty(runtime, "stack", stack);
+          recent.setValueAtIndex(runtime, i, entry);
+        }
+        jsi::Object result(runtime);
+        result.setProperty(runtime, "enabled", report.enabled);
+        result.setProperty(runtime, "total", static_cast<double>(report.total));
+        result.setProperty(runtime, "recent", recent);
+        return jsi::Value(runtime, result);
+      });
+}
+
+// resetRealtimeSafety() -> starts counting violations from now
+jsi::Function NativeCustomNodesModule::createRealtimeSafetyReset(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "resetRealtimeSafety"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        audioapi::rt::reset();
+        return jsi::Value::undefined();
+      });
+}
+
+// setNativeLogLevel(level) -> 0 verbose ... 4 error, 5 silences everything.
+// Messages below the compile-time CUSTOM_NODES_LOG_LEVEL stay compiled out.
+jsi::Function NativeCustomNodesModule::createLogLevelSetter(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "setNativeLogLevel"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        if (count == 0 || !args[0].isNumber()) {
+          return jsi::Value::undefined();
+        }
+        const int level = std::clamp(static_cast<int>(args[0].asNumber()), 0, 5);
+        audioapi::log::setLevel(static_cast<audioapi::log::Level>(level));
+        return jsi::Value::undefined();
+      });
+}
+
+// prewarmVoices(context, { Martigli: 1, Noise: 2, ... }) -> constructs voice
+// nodes until that many of each type are idle in the pool
+jsi::Function NativeCustomNodesModule::createVoicePrewarmer(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "prewarmVoices"),
+      2,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto context = contextFromArgument(runtime, args, count);
+        if (context == nullptr || count < 2 || !args[1].isObject()) {
+          return jsi::Value::undefined();
+        }
+        auto counts = args[1].asObject(runtime);
+        auto kinds = counts.getPropertyNames(runtime);
+        for (size_t i = 0; i < kinds.size(runtime); ++i) {
+          auto kind = kinds.getValueAtIndex(runtime, i).asString(runtime).utf8(runtime);
+          auto value = counts.getProperty(runtime, kind.c_str());
+          if (value.isNumber()) {
+            prewarmVoice(context, kind, static_cast<int>(value.asNumber()));
+          }
+        }
+        return jsi::Value::undefined();
+      });
+}
+
+// releaseVoices(context, nodes) -> number of nodes taken back by the pool.
+// The nodes must be out of every mixer and disconnected; JS must not use
+// them afterwards.
+jsi::Function NativeCustomNodesModule::createVoiceReleaser(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "releaseVoices"),
+      2,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto context = contextFromArgument(runtime, args, count);
+        if (context == nullptr || count < 2 || !args[1].isObject() || !args[1].asObject(runtime).isArray(runtime)) {
+          return jsi::Value(0);
+        }
+        auto nodes = args[1].asObject(runtime).asArray(runtime);
+        int released = 0;
+        for (size_t i = 0; i < nodes.size(runtime); ++i) {
+          auto value = nodes.getValueAtIndex(runtime, i);
+          if (!value.isObject()) {
+            continue;
+          }
+          auto hostObject = value.asObject(runtime).getHostObject(runtime);
+          auto voiceHostObject = std::dynamic_pointer_cast<audioapi::VoiceHostObject>(hostObject);
+          if (voiceHostObject != nullptr &&
+              audioapi::VoiceNodePool::instance().release(context, hostObject, voiceHostObject->getVoiceRenderer())) {
+            ++released;
+          }
+        }
+        return jsi::Value(released);
+      });
+}
+
+// drainVoicePool(context) -> frees the context's idle voice nodes
+jsi::Function NativeCustomNodesModule::createVoicePoolDrainer(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "drainVoicePool"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        if (auto context = contextFromArgument(runtime, args, count)) {
+          audioapi::VoiceNodePool::instance().drain(context.get());
+        }
+        return jsi::Value::undefined();
+      });
+}
+
+// voicePoolReport(context) -> [{ kind, idle, created, reused }]
+jsi::Function NativeCustomNodesModule::createVoicePoolReport(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "voicePoolReport"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        auto context = contextFromArgument(runtime, args, count);
+        auto stats = audioapi::VoiceNodePool::instance().stats(context.get());
+        jsi::Array array(runtime, stats.size());
+        for (size_t i = 0; i < stats.size(); ++i) {
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "kind", jsi::String::createFromUtf8(runtime, stats[i].kind));
+          entry.setProperty(runtime, "idle", stats[i].idle);
+          entry.setProperty(runtime, "created", static_cast<double>(stats[i].created));
+          entry.setProperty(runtime, "reused", static_cast<double>(stats[i].reused));
+          array.setValueAtIndex(runtime, i, entry);
+        }
+        return jsi::Value(runtime, array);
+      });
+}
+
+// prepareSession(mixer, { voices, descriptor, duration, seed }) -> Promise of
+// the render cache mode ("replay" | "record" | "off"). Prepares the voices
+// (note tables, sample pages) and the mixer's render cache file on a
+// background thread. Call it before the voices are added to the mixer and
+// leave them alone until it resolves; the mixer's useRenderCache() with the
+// same arguments then only installs the prepared file.
+jsi::Function NativeCustomNodesModule::createSessionPreparer(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "prepareSession"),
+      2,
+      [jsInvoker = jsInvoker_](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args,
+                               size_t count) -> jsi::Value {
+        std::shared_ptr<audioapi::VoiceMixNode> mixer;
+        if (count > 0 && args[0].isObject() && args[0].asObject(runtime).isHostObject(runtime)) {
+          auto mixerHostObject = std::dynamic_pointer_cast<audioapi::VoiceMixNodeHostObject>(
+              args[0].asObject(runtime).getHostObject(runtime));
+          mixer = mixerHostObject != nullptr ? mixerHostObject->getMixer() : nullptr;
+        }
+
+        std::vector<std::shared_ptr<audioapi::VoiceRenderer>> voices;
+        std::string descriptor;
+        double duration = 0.0;
+        uint32_t seed = 0;
+        if (count > 1 && args[1].isObject()) {
+          auto options = args[1].asObject(runtime);
+          auto voicesValue = options.getProperty(runtime, "voices");
+          if (voicesValue.isObject() && voicesValue.asObject(runtime).isArray(runtime)) {
+            auto array = voicesValue.asObject(runtime).asArray(runtime);
+            for (size_t i = 0; i < array.size(runtime); ++i) {
+              auto value = array.getValueAtIndex(runtime, i);
+              if (!value.isObject() || !value.asObject(runtime).isHostObject(runtime)) {
+                continue;
+              }
+              auto voiceHostObject = std::dynamic_pointer_cast<audioapi::VoiceHostObject>(
+                  value.asObject(runtime).getHostObject(runtime));
+              if (voiceHostObject != nullptr) {
+                voices.push_back(voiceHostObject->getVoiceRenderer());
+              }
+            }
+          }
+          auto descriptorValue = options.getProperty(runtime, "descriptor");
+          if (descriptorValue.isString()) {
+            descriptor = descriptorValue.asString(runtime).utf8(runtime);
+          }
+          auto durationValue = options.getProperty(runtime, "duration");
+          if (durationValue.isNumber()) {
+            duration = durationValue.asNumber();
+          }
+          auto seedValue = options.getProperty(runtime, "seed");
+          if (seedValue.isNumber()) {
+            seed = static_cast<uint32_t>(seedValue.asNumber());
+          }
+        }
+
+        auto executor = jsi::Function::createFromHostFunction(
+            runtime,
+            jsi::PropNameID::forAscii(runtime, "prepareSessionExecutor"),
+            2,
+            [jsInvoker, mixer, voices = std::move(voices), descriptor = std::move(descriptor), duration,
+             seed](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+              // The callbacks are JS values: they only travel through the
+              // worker and are released on the JS thread, in invokeAsync
+              auto resolve = std::make_shared<jsi::Value>(runtime, args[0]);
+              auto reject = std::make_shared<jsi::Value>(runtime, args[1]);
+              std::thread([jsInvoker, mixer, voices, descriptor, duration, seed, resolve = std::move(resolve),
+                           reject = std::move(reject)]() mutable {
+                auto mode = audioapi::VoiceMixNode::CacheMode::Off;
+                std::string error;
+                try {
+                  audioapi::startup::Span startupSpan("prepareSession");
+                  for (const auto &voice : voices) {
+                    voice->prepareVoice();
+                  }
+                  if (mixer != nullptr && !descriptor.empty() && duration > 0.0) {
+                    mode = mixer->prepareRenderCache(descriptor, duration, seed);
+                  }
+                } catch (const std::exception &e) {
+                  error = e.what();
+                  if (error.empty()) {
+                    error = "prepareSession failed";
+                  }
+                }
+                jsInvoker->invokeAsync([resolve = std::move(resolve), reject = std::move(reject), mode,
+                                        error = std::move(error)](jsi::Runtime &runtime) {
+                  if (!error.empty()) {
+                    auto errorValue = runtime.global().getPropertyAsFunction(runtime, "Error").callAsConstructor(
+                        runtime, jsi::String::createFromUtf8(runtime, error));
+                    reject->asObject(runtime).asFunction(runtime).call(runtime, errorValue);
+                    return;
+                  }
+                  resolve->asObject(runtime).asFunction(runtime).call(
+                      runtime, jsi::String::createFromAscii(runtime, audioapi::cacheModeName(mode)));
+                });
+              }).detach();
+              return jsi::Value::undefined();
+            });
+        return runtime.global().getPropertyAsFunction(runtime, "Promise").callAsConstructor(runtime, executor);
+      });
+}
+
+// markStartup(phase) -> timestamps a JS-side startup phase ("play" opens a
+// new attempt); unknown phases are ignored
+jsi::Function NativeCustomNodesModule::createStartupMarker(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "markStartup"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        if (count == 0 || !args[0].isString()) {
+          return jsi::Value::undefined();
+        }
+        const char *phase = audioapi::startup::phaseName(args[0].asString(runtime).utf8(runtime));
+        if (phase == nullptr) {
+          return jsi::Value::undefined();
+        }
+        if (std::string(phase) == "play") {
+          audioapi::startup::beginAttempt();
+        }
+        audioapi::startup::mark(phase);
+        return jsi::Value::undefined();
+      });
+}
+
+// startupReport() -> { playMs, timeToFirstAudioMs, phases, nodes }, times in
+// milliseconds since the module was created
+jsi::Function NativeCustomNodesModule::createStartupReport(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "startupReport"),
+      0,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        const auto report = audioapi::startup::report();
+        auto millis = [&report](uint64_t nanos) {
+          return static_cast<double>(nanos - report.originNanos) * 1e-6;
+        };
+
+        jsi::Array phases(runtime, report.phases.size());
+        for (size_t i = 0; i < report.phases.size(); ++i) {
+          const auto &phase = report.phases[i];
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "name", jsi::String::createFromAscii(runtime, phase.name));
+          if (phase.subject != nullptr) {
+            entry.setProperty(runtime, "subject", jsi::String::createFromAscii(runtime, phase.subject));
+          }
+          entry.setProperty(runtime, "startMs", millis(phase.startNanos));
+          entry.setProperty(runtime, "durationMs", static_cast<double>(phase.durationNanos) * 1e-6);
+          phases.setValueAtIndex(runtime, i, entry);
+        }
+
+        uint64_t firstSound = 0;
+        jsi::Array nodes(runtime, report.nodes.size());
+        for (size_t i = 0; i < report.nodes.size(); ++i) {
+          const auto &node = report.nodes[i];
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "node", jsi::String::createFromUtf8(runtime, node.node));
+          entry.setProperty(runtime, "firstBlockMs", millis(node.firstBlockNanos));
+          if (node.firstSoundNanos != 0) {
+            entry.setProperty(runtime, "firstSoundMs", millis(node.firstSoundNanos));
+            firstSound = firstSound == 0 ? node.firstSoundNanos : std::min(firstSound, node.firstSoundNanos);
+          } else {
+            entry.setProperty(runtime, "firstSoundMs", jsi::Value::null());
+          }
+          nodes.setValueAtIndex(runtime, i, entry);
+        }
+
+        jsi::Object result(runtime);
+        const bool played = report.playNanos != 0;
+        result.setProperty(runtime, "playMs", played ? jsi::Value(millis(report.playNanos)) : jsi::Value::null());
+        result.setProperty(runtime, "timeToFirstAudioMs",
+                           played && firstSound != 0
+                               ? jsi::Value(static_cast<double>(firstSound - report.playNanos) * 1e-6)
+                               : jsi::Value::null());
+        result.setProperty(runtime, "phases", phases);
+        result.setProperty(runtime, "nodes", nodes);
+        return jsi::Value(runtime, result);
+      });
+}
+
+// createPresetVoices(context, buffer | id) -> { duration, seed, voices: [{
+// type, node }] } from a binary preset (PresetFormat.h), or from the preset
+// of that id in the open preset library (decoded from the mapping, without a
+// copy), with the voices' nodes taken from the pool and their parameters
+// set; node is null for voices that could not be created. Returns null if
+// there is no such preset or it is not valid.
+jsi::Function NativeCustomNodesModule::createPresetVoiceCreator(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "createPresetVoices"),
+      2,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) -> jsi::Value {
+        auto context = contextFromArgument(runtime, args, count);
+        if (context == nullptr || count < 2) {
+          return jsi::Value::null();
+        }
+        audioapi::preset::Preset preset;
+        {
+          audioapi::startup::Span startupSpan("decodePreset");
+          if (!decodePresetArgument(runtime, args[1], preset)) {
+            return jsi::Value::null();
+          }
+        }
+
+        jsi::Array voices(runtime, preset.voices.size());
+        for (size_t i = 0; i < preset.voices.size(); ++i) {
+          const auto &voice = preset.voices[i];
+          const char *type = audioapi::preset::typeName(voice.type);
+          auto hostObject = createPresetVoice(context, voice, preset.seed);
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "type", type != nullptr ? jsi::Value(jsi::String::createFromAscii(runtime, type))
+                                                             : jsi::Value::null());
+          entry.setProperty(runtime, "node", hostObject != nullptr
+                                                 ? jsi::Value(jsi::Object::createFromHostObject(runtime, hostObject))
+                                                 : jsi::Value::null());
+          voices.setValueAtIndex(runtime, i, entry);
+        }
+        jsi::Object result(runtime);
+        result.setProperty(runtime, "duration", static_cast<double>(preset.duration));
+        result.setProperty(runtime, "seed", static_cast<double>(preset.seed));
+        result.setProperty(runtime, "voices", voices);
+        return jsi::Value(runtime, result);
+      });
+}
+
+// applyPresetDiff(context, nodes, buffer | id, { rampSeconds, volumes }) ->
+// { duration, seed, changed, voices: [{ type, node, previous }], removed }
+// moves the running voices (nodes) to another preset (see PresetDiff.h).
+// For each voice of the preset, previous is the index in nodes of the voice
+// now retargeted to it, its parameters and volume (volumes, by preset voice)
+// ramping over rampSeconds (default 2), or -1 with node a new pooled voice,
+// set up but not started (null if it could not be created). removed lists
+// the indices in nodes of the voices the preset no longer has, left playing
+// for the caller to fade out. changed counts the parameters written. Returns
+// null if the preset is not valid.
+jsi::Function NativeCustomNodesModule::createPresetDiffApplier(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "applyPresetDiff"),
+      4,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) -> jsi::Value {
+        auto context = contextFromArgument(runtime, args, count);
+        if (context == nullptr || count < 3 || !args[1].isObject() || !args[1].asObject(runtime).isArray(runtime)) {
+          return jsi::Value::null();
+        }
+        audioapi::preset::Preset preset;
+        if (!decodePresetArgument(runtime, args[2], preset)) {
+          return jsi::Value::null();
+        }
+
+        double rampSeconds = 2.0;
+        std::vector<float> volumes;
+        if (count > 3 && args[3].isObject()) {
+          auto options = args[3].asObject(runtime);
+          auto rampValue = options.getProperty(runtime, "rampSeconds");
+          if (rampValue.isNumber()) {
+            rampSeconds = std::max(0.0, rampValue.asNumber());
+          }
+          auto volumesValue = options.getProperty(runtime, "volumes");
+          if (volumesValue.isObject() && volumesValue.asObject(runtime).isArray(runtime)) {
+            auto array = volumesValue.asObject(runtime).asArray(runtime);
+            for (size_t i = 0; i < array.size(runtime); ++i) {
+              auto value = array.getValueAtIndex(runtime, i);
+              volumes.push_back(value.isNumber() ? static_cast<float>(value.asNumber()) : -1.0f);
+            }
+          }
+        }
+        const int rampFrames = static_cast<int>(rampSeconds * context->getSampleRate());
+
+        // Running voices by index in nodes; null for anything else
+        auto nodes = args[1].asObject(runtime).asArray(runtime);
+        std::vector<std::shared_ptr<audioapi::VoiceRenderer>> running(nodes.size(runtime));
+        std::vector<audioapi::VoiceRenderer *> runningVoices(running.size(), nullptr);
+        for (size_t i = 0; i < running.size(); ++i) {
+          auto value = nodes.getValueAtIndex(runtime, i);
+          if (!value.isObject() || !value.asObject(runtime).isHostObject(runtime)) {
+            continue;
+          }
+          auto voiceHostObject =
+              std::dynamic_pointer_cast<audioapi::VoiceHostObject>(value.asObject(runtime).getHostObject(runtime));
+          if (voiceHostObject != nullptr) {
+            running[i] = voiceHostObject->getVoiceRenderer();
+            runningVoices[i] = running[i].get();
+          }
+        }
+
+        audioapi::trace::Scope traceScope("jsi", "applyPresetDiff");
+        const auto matches = audioapi::preset::matchVoices(runningVoices, preset);
+        std::vector<bool> kept(running.size(), false);
+        int changed = 0;
+        jsi::Array voices(runtime, preset.voices.size());
+        for (size_t i = 0; i < preset.voices.size(); ++i) {
+          const auto &voice = preset.voices[i];
+          const char *type = audioapi::preset::typeName(voice.type);
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "type", type != nullptr ? jsi::Value(jsi::String::createFromAscii(runtime, type))
+                                                             : jsi::Value::null());
+          entry.setProperty(runtime, "previous", matches[i]);
+          if (matches[i] >= 0) {
+            auto &target = *running[matches[i]];
+            kept[matches[i]] = true;
+            changed += audioapi::preset::retargetVoice(target, voice, rampFrames);
+            const int volumePort = target.modulation().findParam("volume");
+            if (i < volumes.size() && volumes[i] >= 0.0f && volumePort >= 0 &&
+                target.modulation().getParam(volumePort) != volumes[i]) {
+              target.modulation().rampParam(volumePort, volumes[i], rampFrames);
+              ++changed;
+            }
+            entry.setProperty(runtime, "node", jsi::Value::null());
+          } else {
+            auto hostObject = createPresetVoice(context, voice, preset.seed);
+            entry.setProperty(runtime, "node", hostObject != nullptr
+                                                   ? jsi::Value(jsi::Object::createFromHostObject(runtime, hostObject))
+                                                   : jsi::Value::null());
+          }
+          voices.setValueAtIndex(runtime, i, entry);
+        }
+
+        std::vector<int> removedIndices;
+        for (size_t r = 0; r < running.size(); ++r) {
+          if (running[r] != nullptr && !kept[r]) {
+            removedIndices.push_back(static_cast<int>(r));
+          }
+        }
+        jsi::Array removed(runtime, removedIndices.size());
+        for (size_t i = 0; i < removedIndices.size(); ++i) {
+          removed.setValueAtIndex(runtime, i, removedIndices[i]);
+        }
+        CUSTOM_NODES_LOG_DEBUG("NativeCustomNodesModule", "preset diff: %zu voices, %zu removed, %d params",
+                               preset.voices.size(), removedIndices.size(), changed);
+
+        jsi::Object result(runtime);
+        result.setProperty(runtime, "duration", static_cast<double>(preset.duration));
+        result.setProperty(runtime, "seed", static_cast<double>(preset.seed));
+        result.setProperty(runtime, "changed", changed);
+        result.setProperty(runtime, "voices", voices);
+        result.setProperty(runtime, "removed", removed);
+        return jsi::Value(runtime, result);
+      });
+}
+
+// openPresetLibrary({ path?, tag }) -> number of presets, or -1 if there is
+// no library with that tag at path (default: presets.cnpl in the app's cache
+// directory) and it has to be written first
+jsi::Function NativeCustomNodesModule::createPresetLibraryOpener(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "openPresetLibrary"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        if (count == 0 || !args[0].isObject()) {
+          return jsi::Value(-1);
+        }
+        auto [path, tag] = libraryLocation(runtime, args[0].asObject(runtime));
+        auto &library = audioapi::PresetLibrary::instance();
+        audioapi::startup::Span startupSpan("openPresetLibrary");
+        return jsi::Value(library.open(path, tag) ? library.size() : -1);
+      });
+}
+
+// writePresetLibrary({ path?, tag, presets: [{ id, name, preset, meta }] })
+// -> true once written, preset being a binary preset (ArrayBuffer) and meta
+// a JSON string. Open it afterwards with openPresetLibrary().
+jsi::Function NativeCustomNodesModule::createPresetLibraryWriter(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "writePresetLibrary"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        if (count == 0 || !args[0].isObject()) {
+          return jsi::Value(false);
+        }
+        auto options = args[0].asObject(runtime);
+        auto [path, tag] = libraryLocation(runtime, options);
+        auto presetsValue = options.getProperty(runtime, "presets");
+        if (!presetsValue.isObject() || !presetsValue.asObject(runtime).isArray(runtime)) {
+          return jsi::Value(false);
+        }
+        auto presets = presetsValue.asObject(runtime).asArray(runtime);
+        std::vector<audioapi::PresetLibrary::Source> sources;
+        sources.reserve(presets.size(runtime));
+        for (size_t i = 0; i < presets.size(runtime); ++i) {
+          auto value = presets.getValueAtIndex(runtime, i);
+          if (!value.isObject()) {
+            continue;
+          }
+          auto entry = value.asObject(runtime);
+          auto id = entry.getProperty(runtime, "id");
+          auto name = entry.getProperty(runtime, "name");
+          auto preset = entry.getProperty(runtime, "preset");
+          auto meta = entry.getProperty(runtime, "meta");
+          if (!id.isString() || !preset.isObject() || !preset.asObject(runtime).isArrayBuffer(runtime)) {
+            continue;
+          }
+          audioapi::PresetLibrary::Source source;
+          source.id = id.asString(runtime).utf8(runtime);
+          source.name = name.isString() ? name.asString(runtime).utf8(runtime) : source.id;
+          auto buffer = preset.asObject(runtime).getArrayBuffer(runtime);
+          source.preset.assign(buffer.data(runtime), buffer.data(runtime) + buffer.size(runtime));
+          source.meta = meta.isString() ? meta.asString(runtime).utf8(runtime) : "{}";
+          sources.push_back(std::move(source));
+        }
+        // The open library may be the file being replaced
+        audioapi::PresetLibrary::instance().close();
+        return jsi::Value(audioapi::PresetLibrary::write(path, tag, std::move(sources)));
+      });
+}
+
+// presetLibraryList(query?) -> [{ id, name, duration, voices }] of the open
+// library, filtered by id or name, in id order
+jsi::Function NativeCustomNodesModule::createPresetLibraryLister(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "presetLibraryList"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        const std::string query = count > 0 && args[0].isString() ? args[0].asString(runtime).utf8(runtime) : "";
+        auto entries = audioapi::PresetLibrary::instance().list(query);
+        jsi::Array array(runtime, entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "id", jsi::String::createFromUtf8(runtime, entries[i].id));
+          entry.setProperty(runtime, "name", jsi::String::createFromUtf8(runtime, entries[i].name));
+          entry.setProperty(runtime, "duration", static_cast<double>(entries[i].duration));
+          entry.setProperty(runtime, "voices", entries[i].voices);
+          array.setValueAtIndex(runtime, i, entry);
+        }
+        return jsi::Value(runtime, array);
+      });
+}
+
+// presetLibraryMeta(id) -> the preset's JSON metadata, or null
+jsi::Function NativeCustomNodesModule::createPresetLibraryMetaReader(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "presetLibraryMeta"),
+      1,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
+        if (count == 0 || !args[0].isString()) {
+          return jsi::Value::null();
+        }
+        auto meta = audioapi::PresetLibrary::instance().meta(args[0].asString(runtime).utf8(runtime));
+        if (meta.data() == nullptr) {
+          return jsi::Value::null();
+        }
+        return jsi::Value(jsi::String::createFromUtf8(runtime, std::string(meta)));
+      });
+}
+
+// estimateCost(buffer | id, { sampleRate = 48000, budgetPercent = 50 })
+// -> { nanosPerFrame, budgetPercent, fits, sharedVoices, calibrated,
+// voices: [{ type, nanosPerFrame, shared }] }, the static CPU cost of the
+// preset's voices (CostModel.h); fits if it takes at most budgetPercent of
+// real time. Needs no context, so it runs over the whole library as well as
+// before a preset is built. Null if the preset is not valid.
+jsi::Function NativeCustomNodesModule::createCostEstimator(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "estimateCost"),
+      2,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) -> jsi::Value {
+        audioapi::preset::Preset preset;
+        if (count == 0 || !decodePresetArgument(runtime, args[0], preset)) {
+          return jsi::Value::null();
+        }
+        double sampleRate = 48000.0;
+        double budgetPercent = 50.0;
+        if (count > 1 && args[1].isObject()) {
+          auto options = args[1].asObject(runtime);
+          auto sampleRateValue = options.getProperty(runtime, "sampleRate");
+          if (sampleRateValue.isNumber() && sampleRateValue.asNumber() > 0.0) {
+            sampleRate = sampleRateValue.asNumber();
+          }
+          auto budgetValue = options.getProperty(runtime, "budgetPercent");
+          if (budgetValue.isNumber()) {
+            budgetPercent = budgetValue.asNumber();
+          }
+        }
+
+        const auto coefficients = audioapi::cost::coefficients();
+        const auto estimate = audioapi::cost::estimate(preset, static_cast<float>(sampleRate), coefficients);
+        jsi::Array voices(runtime, estimate.voices.size());
+        for (size_t i = 0; i < estimate.voices.size(); ++i) {
+          const char *type = audioapi::preset::typeName(estimate.voices[i].type);
+          jsi::Object entry(runtime);
+          entry.setProperty(runtime, "type", type != nullptr ? jsi::Value(jsi::String::createFromAscii(runtime, type))
+                                                             : jsi::Value::null());
+          entry.setProperty(runtime, "nanosPerFrame", estimate.voices[i].nanosPerFrame);
+          entry.setProperty(runtime, "shared", estimate.voices[i].shared);
+          voices.setValueAtIndex(runtime, i, entry);
+        }
+
+        jsi::Object result(runtime);
+        result.setProperty(runtime, "nanosPerFrame", estimate.nanosPerFrame);
+        result.setProperty(runtime, "budgetPercent", estimate.budgetPercent);
+        result.setProperty(runtime, "fits", estimate.budgetPercent <= budgetPercent);
+        result.setProperty(runtime, "sharedVoices", estimate.sharedVoices);
+        result.setProperty(runtime, "calibrated", coefficients.calibrated);
+        result.setProperty(runtime, "voices", voices);
+        return jsi::Value(runtime, result);
+      });
+}
+
+// calibrateCostModel(context, { frames = 128, iterations = 32 }) -> the
+// coefficients estimateCost() uses from now on, timed on this device (see
+// cost::calibrate()), or null without a context. Blocks the JS thread for
+// a few tens of milliseconds on a phone: call it while nothing plays.
+jsi::Function NativeCustomNodesModule::createCostModelCalibrator(jsi::Runtime &runtime) {
+  return jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "calibrateCostModel"),
+      2,
+      [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) -> jsi::Value {
+        auto context = contextFromArgument(runtime, args, count);
+        if (context == nullptr) {
+          return jsi::Value::null();
+        }
+        int frames = 128;
+        int iterations = 32;
+        if (count > 1 && args[1].isObject()) {
+          auto options = args[1].asObject(runtime);
+          auto framesValue = options.getProperty(runtime, "frames");
+          if (framesValue.isNumber()) {
+            frames = static_cast<int>(framesValue.asNumber());
+          }
+          auto iterationsValue = options.getProperty(runtime, "iterations");
+          if (iterationsValue.isNumber()) {
+            iterations = static_cast<int>(iterationsValue.asNumber());
+          }
+        }
+
+        audioapi::trace::Scope traceScope("jsi", "calibrateCostModel");
+        const auto coefficients = audioapi::cost::calibrate(context.get(), frames, iterations);
+        audioapi::cost::setCoefficients(coefficients);
+        CUSTOM_NODES_LOG_INFO("NativeCustomNodesModule", "cost model calibrated: sine binaural %.1f ns/frame",
+                              coefficients.binaural[0]);
+        return jsi::Value(runtime, costCoefficientsObject(runtime, coefficients));
+      });
+}
 } // namespace facebook::react
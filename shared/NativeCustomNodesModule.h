@@ -22,6 +22,36 @@ private:
   jsi::Function createSymmetryInstaller(jsi::Runtime &runtime);
   jsi::Function createMartigliBinauralInstaller(jsi::Runtime &runtime);
   jsi::Function createNoiseInstaller(jsi::Runtime &runtime);
+  jsi::Function createSampleInstaller(jsi::Runtime &runtime);
+  jsi::Function createVoiceMixInstaller(jsi::Runtime &runtime);
+  jsi::Function createMasterBusInstaller(jsi::Runtime &runtime);
+  jsi::Function createBreathingClockInstaller(jsi::Runtime &runtime);
+  jsi::Function createVoiceRenderingBenchmark(jsi::Runtime &runtime);
+  jsi::Function createRenderCacheConfigurator(jsi::Runtime &runtime);
+  jsi::Function createFastMathAccuracyReport(jsi::Runtime &runtime);
+  jsi::Function createDspLoadReport(jsi::Runtime &runtime);
+  jsi::Function createTraceStarter(jsi::Runtime &runtime);
+  jsi::Function createTraceStopper(jsi::Runtime &runtime);
+  jsi::Function createGlitchReport(jsi::Runtime &runtime);
+  jsi::Function createGlitchReset(jsi::Runtime &runtime);
+  jsi::Function createRealtimeSafetyReport(jsi::Runtime &runtime);
+  jsi::Function createRealtimeSafetyReset(jsi::Runtime &runtime);
+  jsi::Function createLogLevelSetter(jsi::Runtime &runtime);
+  jsi::Function createVoicePrewarmer(jsi::Runtime &runtime);
+  jsi::Function createVoiceReleaser(jsi::Runtime &runtime);
+  jsi::Function createVoicePoolDrainer(jsi::Runtime &runtime);
+  jsi::Function createVoicePoolReport(jsi::Runtime &runtime);
+  jsi::Function createSessionPreparer(jsi::Runtime &runtime);
+  jsi::Function createStartupMarker(jsi::Runtime &runtime);
+  jsi::Function createStartupReport(jsi::Runtime &runtime);
+  jsi::Function createPresetVoiceCreator(jsi::Runtime &runtime);
+  jsi::Function createPresetDiffApplier(jsi::Runtime &runtime);
+  jsi::Function createPresetLibraryOpener(jsi::Runtime &runtime);
+  jsi::Function createPresetLibraryWriter(jsi::Runtime &runtime);
+  jsi::Function createPresetLibraryLister(jsi::Runtime &runtime);
+  jsi::Function createPresetLibraryMetaReader(jsi::Runtime &runtime);
+  jsi::Function createCostEstimator(jsi::Runtime &runtime);
+  jsi::Function createCostModelCalibrator(jsi::Runtime &runtime);
 };
 
 } // namespace facebook::react
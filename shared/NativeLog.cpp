@@ -0,0 +1,111 @@
+#include "NativeLog.h"
+#include "MpmcRing.h"
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#if defined(__ANDROID__)
+#include <android/log.h>
+#endif
+
+namespace audioapi::log {
+
+namespace {
+
+// Writers format in place into a slot of the ring; the writer thread (or
+// flush()) consumes it, one at a time under consumerMutex.
+struct Message {
+  Level level = Level::Info;
+  const char *tag = nullptr;
+  char text[kMessageBytes];
+};
+
+struct Ring {
+  MpmcRing<Message, kCapacity> messages;
+  std::mutex consumerMutex;
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<Level> level{Level::Verbose};
+  std::atomic<bool> started{false};
+};
+
+Ring &ring() {
+  static Ring instance;
+  return instance;
+}
+
+void output(Level level, const char *tag, const char *message) {
+#if defined(__ANDROID__)
+  static constexpr int kPriorities[] = {ANDROID_LOG_VERBOSE, ANDROID_LOG_DEBUG, ANDROID_LOG_INFO,
+                                        ANDROID_LOG_WARN, ANDROID_LOG_ERROR};
+  __android_log_write(kPriorities[static_cast<int>(level)], tag, message);
+#else
+  static constexpr char kLetters[] = "VDIWE";
+  fprintf(stderr, "%c %s: %s\n", kLetters[static_cast<int>(level)], tag, message);
+#endif
+}
+
+void drain(Ring &log) {
+  std::lock_guard<std::mutex> lock(log.consumerMutex);
+  log.messages.drain([](const Message &message) { output(message.level, message.tag, message.text); });
+  if (const uint64_t dropped = log.dropped.exchange(0, std::memory_order_relaxed)) {
+    char message[64];
+    snprintf(message, sizeof(message), "%llu messages dropped (ring full)", static_cast<unsigned long long>(dropped));
+    output(Level::Warn, "NativeLog", message);
+  }
+#if !defined(__ANDROID__)
+  fflush(stderr);
+#endif
+}
+
+} // namespace
+
+void start() {
+  Ring &log = ring();
+  bool expected = false;
+  if (!log.started.compare_exchange_strong(expected, true)) {
+    return;
+  }
+  // Lives as long as the process, like logcat itself
+  std::thread([&log] {
+    for (;;) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kFlushIntervalMs));
+      drain(log);
+    }
+  }).detach();
+}
+
+void setLevel(Level level) {
+  ring().level.store(level, std::memory_order_relaxed);
+}
+
+Level level() {
+  return ring().level.load(std::memory_order_relaxed);
+}
+
+void write(Level level, const char *tag, const char *format, ...) {
+  Ring &log = ring();
+  if (level < log.level.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  va_list args;
+  va_start(args, format);
+  const bool queued = log.messages.push([&](Message &message) {
+    message.level = level;
+    message.tag = tag;
+    vsnprintf(message.text, kMessageBytes, format, args);
+  });
+  va_end(args);
+  if (!queued) {
+    log.dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void flush() {
+  drain(ring());
+}
+
+} // namespace audioapi::log
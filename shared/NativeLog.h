@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+
+// Native logging for the custom nodes.
+//
+// Call sites use the CUSTOM_NODES_LOG_<LEVEL>(tag, format, ...) macros. Levels
+// below CUSTOM_NODES_LOG_LEVEL are removed by the preprocessor, arguments and
+// format strings included. Enabled messages are formatted with vsnprintf
+// straight into a slot of a preallocated lock-free ring (no allocation, no
+// stdio lock, safe on the audio thread) and written out by a background
+// thread: to logcat on Android, to stderr elsewhere. When the ring is full
+// messages are dropped and counted, never waited for.
+//
+// Integer and string conversions format without allocating on every libc we
+// ship on; keep floating point conversions off the audio thread.
+#define CUSTOM_NODES_LOG_LEVEL_VERBOSE 0
+#define CUSTOM_NODES_LOG_LEVEL_DEBUG 1
+#define CUSTOM_NODES_LOG_LEVEL_INFO 2
+#define CUSTOM_NODES_LOG_LEVEL_WARN 3
+#define CUSTOM_NODES_LOG_LEVEL_ERROR 4
+#define CUSTOM_NODES_LOG_LEVEL_NONE 5
+
+// Debug builds keep debug messages, release builds info and above
+#ifndef CUSTOM_NODES_LOG_LEVEL
+#if defined(DEBUG) || (!defined(__APPLE__) && !defined(NDEBUG))
+#define CUSTOM_NODES_LOG_LEVEL CUSTOM_NODES_LOG_LEVEL_DEBUG
+#else
+#define CUSTOM_NODES_LOG_LEVEL CUSTOM_NODES_LOG_LEVEL_INFO
+#endif
+#endif
+
+namespace audioapi::log {
+
+enum class Level : uint8_t { Verbose = 0, Debug = 1, Info = 2, Warn = 3, Error = 4 };
+
+constexpr int kCapacity = 256;       // messages in flight
+constexpr int kMessageBytes = 232;   // longer messages are truncated
+constexpr int kFlushIntervalMs = 100;
+
+// Starts the writer thread. Messages logged before are kept (up to
+// kCapacity) and written once it runs. JS thread, idempotent.
+void start();
+
+// Runtime filter on top of the compile-time one
+void setLevel(Level level);
+Level level();
+
+// tag must outlive the message: pass a string literal
+void write(Level level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+// Writes out everything logged so far, on the calling thread. JS thread.
+void flush();
+
+} // namespace audioapi::log
+
+#if CUSTOM_NODES_LOG_LEVEL <= CUSTOM_NODES_LOG_LEVEL_VERBOSE
+#define CUSTOM_NODES_LOG_VERBOSE(tag, ...) ::audioapi::log::write(::audioapi::log::Level::Verbose, (tag), __VA_ARGS__)
+#else
+#define CUSTOM_NODES_LOG_VERBOSE(tag, ...) ((void)0)
+#endif
+
+#if CUSTOM_NODES_LOG_LEVEL <= CUSTOM_NODES_LOG_LEVEL_DEBUG
+#define CUSTOM_NODES_LOG_DEBUG(tag, ...) ::audioapi::log::write(::audioapi::log::Level::Debug, (tag), __VA_ARGS__)
+#else
+#define CUSTOM_NODES_LOG_DEBUG(tag, ...) ((void)0)
+#endif
+
+#if CUSTOM_NODES_LOG_LEVEL <= CUSTOM_NODES_LOG_LEVEL_INFO
+#define CUSTOM_NODES_LOG_INFO(tag, ...) ::audioapi::log::write(::audioapi::log::Level::Info, (tag), __VA_ARGS__)
+#else
+#define CUSTOM_NODES_LOG_INFO(tag, ...) ((void)0)
+#endif
+
+#if CUSTOM_NODES_LOG_LEVEL <= CUSTOM_NODES_LOG_LEVEL_WARN
+#define CUSTOM_NODES_LOG_WARN(tag, ...) ::audioapi::log::write(::audioapi::log::Level::Warn, (tag), __VA_ARGS__)
+#else
+#define CUSTOM_NODES_LOG_WARN(tag, ...) ((void)0)
+#endif
+
+#if CUSTOM_NODES_LOG_LEVEL <= CUSTOM_NODES_LOG_LEVEL_ERROR
+#define CUSTOM_NODES_LOG_ERROR(tag, ...) ::audioapi::log::write(::audioapi::log::Level::Error, (tag), __VA_ARGS__)
+#else
+#define CUSTOM_NODES_LOG_ERROR(tag, ...) ((void)0)
+#endif
@@ -15,17 +15,18 @@
 #include "SymmetryNode.h"
 #include "MartigliBinauralNode.h"
 #include "NoiseNode.h"
-#include <cstdio> // For printf debugging
+#include "NativeLog.h"
 
 namespace facebook::react {
 
 NativeOscillatorModule::NativeOscillatorModule(std::shared_ptr<CallInvoker> jsInvoker)
     : NativeOscillatorModuleCxxSpec(std::move(jsInvoker)) {
-        printf("NativeOscillatorModule: Initialized\n");
+        audioapi::log::start();
+        CUSTOM_NODES_LOG_INFO("NativeOscillatorModule", "Initialized");
     }
 
 void NativeOscillatorModule::injectCustomProcessorInstaller(jsi::Runtime &runtime) {
-  printf("NativeOscillatorModule: injectCustomProcessorInstaller called\n");
+  CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "injectCustomProcessorInstaller called");
   auto oscillatorInstaller = createOscillatorInstaller(runtime);
   auto martigliInstaller = createMartigliInstaller(runtime);
   auto binauralInstaller = createBinauralInstaller(runtime);
@@ -38,17 +39,17 @@ void NativeOscillatorModule::injectCustomProcessorInstaller(jsi::Runtime &runtim
   runtime.global().setProperty(runtime, "createSymmetryNode", symmetryInstaller);
   runtime.global().setProperty(runtime, "createMartigliBinauralNode", martigliBinauralInstaller);
   runtime.global().setProperty(runtime, "createNoiseNode", noiseInstaller);
-  printf("NativeOscillatorModule: All node installers injected globally\n");
+  CUSTOM_NODES_LOG_INFO("NativeOscillatorModule", "All node installers injected globally");
 }
 
 jsi::Function NativeOscillatorModule::createInstaller(jsi::Runtime &runtime) {
-    printf("NativeOscillatorModule: createInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMyOscillatorNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeOscillatorModule: createMyOscillatorNode called from JS\n");
+        CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createMyOscillatorNode called from JS");
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
@@ -61,13 +62,13 @@ jsi::Function NativeOscillatorModule::createInstaller(jsi::Runtime &runtime) {
     }
 
 jsi::Function NativeOscillatorModule::createOscillatorInstaller(jsi::Runtime &runtime) {
-    printf("NativeOscillatorModule: createOscillatorInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createOscillatorInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMyOscillatorNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeOscillatorModule: createMyOscillatorNode called from JS\n");
+        CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createMyOscillatorNode called from JS");
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
@@ -80,13 +81,13 @@ jsi::Function NativeOscillatorModule::createOscillatorInstaller(jsi::Runtime &ru
     }
 
 jsi::Function NativeOscillatorModule::createMartigliInstaller(jsi::Runtime &runtime) {
-    printf("NativeOscillatorModule: createMartigliInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createMartigliInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMartigliNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeOscillatorModule: createMartigliNode called from JS\n");
+        CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createMartigliNode called from JS");
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
@@ -99,105 +100,105 @@ jsi::Function NativeOscillatorModule::createMartigliInstaller(jsi::Runtime &runt
     }
 
 jsi::Function NativeOscillatorModule::createBinauralInstaller(jsi::Runtime &runtime) {
-    printf("NativeOscillatorModule: createBinauralInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createBinauralInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createBinauralNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeOscillatorModule: createBinauralNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createBinauralNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeOscillatorModule: ERROR - no arguments passed to createBinauralNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "no arguments passed to createBinauralNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeOscillatorModule: Creating BinauralNode with context\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "Creating BinauralNode with context");
           auto node = std::make_shared<audioapi::BinauralNode>(context->context_.get());
           auto nodeHostObject = std::make_shared<audioapi::BinauralNodeHostObject>(node);
-          printf("NativeOscillatorModule: BinauralNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "BinauralNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeOscillatorModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
 
 jsi::Function NativeOscillatorModule::createSymmetryInstaller(jsi::Runtime &runtime) {
-    printf("NativeOscillatorModule: createSymmetryInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createSymmetryInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createSymmetryNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeOscillatorModule: createSymmetryNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createSymmetryNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeOscillatorModule: ERROR - no arguments passed to createSymmetryNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "no arguments passed to createSymmetryNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeOscillatorModule: Creating SymmetryNode with context\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "Creating SymmetryNode with context");
           auto node = std::make_shared<audioapi::SymmetryNode>(context->context_.get());
           auto nodeHostObject = std::make_shared<audioapi::SymmetryNodeHostObject>(node);
-          printf("NativeOscillatorModule: SymmetryNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "SymmetryNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeOscillatorModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
 
 jsi::Function NativeOscillatorModule::createMartigliBinauralInstaller(jsi::Runtime &runtime) {
-    printf("NativeOscillatorModule: createMartigliBinauralInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createMartigliBinauralInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createMartigliBinauralNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeOscillatorModule: createMartigliBinauralNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createMartigliBinauralNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeOscillatorModule: ERROR - no arguments passed to createMartigliBinauralNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "no arguments passed to createMartigliBinauralNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeOscillatorModule: Creating MartigliBinauralNode with context\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "Creating MartigliBinauralNode with context");
           auto node = std::make_shared<audioapi::MartigliBinauralNode>(context->context_.get());
           auto nodeHostObject = std::make_shared<audioapi::MartigliBinauralNodeHostObject>(node);
-          printf("NativeOscillatorModule: MartigliBinauralNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "MartigliBinauralNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeOscillatorModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
 
 jsi::Function NativeOscillatorModule::createNoiseInstaller(jsi::Runtime &runtime) {
-    printf("NativeOscillatorModule: createNoiseInstaller called\n");
+    CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createNoiseInstaller called");
   return jsi::Function::createFromHostFunction(
       runtime,
       jsi::PropNameID::forAscii(runtime, "createNoiseNode"),
       0,
       [](jsi::Runtime &runtime, const jsi::Value &thisVal, const jsi::Value *args, size_t count) {
-        printf("NativeOscillatorModule: createNoiseNode called from JS with %zu args\n", count);
+        CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "createNoiseNode called from JS with %zu args", count);
         if (count == 0) {
-          printf("NativeOscillatorModule: ERROR - no arguments passed to createNoiseNode\n");
+          CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "no arguments passed to createNoiseNode");
           return jsi::Object::createFromHostObject(runtime, nullptr);
         }
         auto object = args[0].getObject(runtime);
         auto context = object.getHostObject<audioapi::BaseAudioContextHostObject>(runtime);
         if (context != nullptr) {
-          printf("NativeOscillatorModule: Creating NoiseNode with context\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "Creating NoiseNode with context");
           auto node = std::make_shared<audioapi::NoiseNode>(context->context_.get());
           auto nodeHostObject = std::make_shared<audioapi::NoiseNodeHostObject>(node);
-          printf("NativeOscillatorModule: NoiseNode created successfully\n");
+          CUSTOM_NODES_LOG_DEBUG("NativeOscillatorModule", "NoiseNode created successfully");
           return jsi::Object::createFromHostObject(runtime, nodeHostObject);
         }
-        printf("NativeOscillatorModule: ERROR - context is null\n");
+        CUSTOM_NODES_LOG_ERROR("NativeOscillatorModule", "context is null");
         return jsi::Object::createFromHostObject(runtime, nullptr);
       });
     }
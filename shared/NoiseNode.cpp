@@ -2,19 +2,59 @@
 #include <audioapi/utils/AudioBus.h>
 #include <audioapi/utils/AudioArray.h>
 #include <cmath>
-#include <cstdlib>
 #include <algorithm>
+#include <random>
 
 namespace audioapi {
 
 NoiseNode::NoiseNode(BaseAudioContext *context)
-    : AudioNode(context), _context(context) {
+    : AudioNode(context), _context(context), rngState_(std::random_device{}() | 1u) {
   channelCount_ = 2;
   channelCountMode_ = ChannelCountMode::EXPLICIT;
   channelInterpretation_ = ChannelInterpretation::SPEAKERS;
+  modulation().addSignal("envelope");
+  modulation().addSignal("level");
+  modulation().addParam("volume", &volume);
   isInitialized_ = true;
 }
 
+void NoiseNode::resetVoice() {
+  applyParams(kNoiseDefaults);
+  volume = 0.3f;
+  isPaused = false;
+  isRunning_ = false;
+  shouldStart = false;
+  shouldStop = false;
+  shouldPause = false;
+  shouldResume = false;
+
+  currentGain_ = 0.0f;
+  startGain_ = 0.0f;
+  targetGain_ = 0.0f;
+  rampDuration_ = 0.3f;
+  rampElapsed_ = 0.0f;
+  isRamping_ = false;
+  targetNoiseColor_ = 0;
+  isColorSwitching_ = false;
+  std::fill(std::begin(pinkState_), std::end(pinkState_), 0.0f);
+  std::fill(std::begin(pinkEconomy_), std::end(pinkEconomy_), 0.0f);
+  economyPink_ = false;
+  pinkFadeLeft_ = 0;
+  brownState_ = 0.0f;
+
+  glitches_.reset();
+  touchParams();
+}
+
+void NoiseNode::applyParams(const NoiseParams &params) {
+  noiseColor = params.noiseColor;
+  touchParams();
+}
+
+NoiseParams NoiseNode::getParams() {
+  return {noiseColor};
+}
+
 void NoiseNode::start() {
   shouldStart = true;
 }
@@ -31,17 +71,40 @@ void NoiseNode::resume() {
   shouldResume = true;
 }
 
+void NoiseNode::setSeed(uint32_t seed) {
+  // Spread small seeds over the state; xorshift must never be seeded with 0
+  rngState_ = (seed * 2654435761u) | 1u;
+}
+
+float NoiseNode::nextRandom() {
+  rngState_ ^= rngState_ << 13;
+  rngState_ ^= rngState_ >> 17;
+  rngState_ ^= rngState_ << 5;
+  return static_cast<float>(rngState_) * (2.0f / 4294967295.0f) - 1.0f;
+}
+
 float NoiseNode::generateWhiteNoise() {
   // Generate random value between -1 and 1, scaled down to match perceived loudness
   // White noise is perceptually louder due to high-frequency energy
-  return ((static_cast<float>(rand()) / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f) * 0.25f;
+  return nextRandom() * 0.25f;
 }
 
 float NoiseNode::generatePinkNoise() {
+  float white = generateWhiteNoise();
+  if (pinkFadeLeft_ == 0) {
+    return economyPink_ ? filterPinkEconomy(white) : filterPink(white);
+  }
+  // Crossfading from the other tier's filter
+  const float t = 1.0f - static_cast<float>(pinkFadeLeft_) / kPinkFadeFrames;
+  --pinkFadeLeft_;
+  const float economy = filterPinkEconomy(white);
+  const float full = filterPink(white);
+  return economyPink_ ? full + (economy - full) * t : economy + (full - economy) * t;
+}
+
+float NoiseNode::filterPink(float white) {
   // Paul Kellet's pink noise algorithm
   // Approximates 1/f spectrum using weighted sum of white noise
-  float white = generateWhiteNoise();
-  
   pinkState_[0] = 0.99886f * pinkState_[0] + white * 0.0555179f;
   pinkState_[1] = 0.99332f * pinkState_[1] + white * 0.0750759f;
   pinkState_[2] = 0.96900f * pinkState_[2] + white * 0.1538520f;
@@ -58,10 +121,42 @@ float NoiseNode::generatePinkNoise() {
   return pink * 0.11f; // Scale down to ~[-1, 1]
 }
 
+float NoiseNode::filterPinkEconomy(float white) {
+  // Paul Kellet's economy version: three poles, within 0.5 dB of 1/f above
+  // about 10 Hz
+  pinkEconomy_[0] = 0.99765f * pinkEconomy_[0] + white * 0.0990460f;
+  pinkEconomy_[1] = 0.96300f * pinkEconomy_[1] + white * 0.2965164f;
+  pinkEconomy_[2] = 0.57000f * pinkEconomy_[2] + white * 1.0526913f;
+  
+  float pink = pinkEconomy_[0] + pinkEconomy_[1] + pinkEconomy_[2] + white * 0.1848f;
+  
+  return pink * 0.11f; // Same level as the full filter, within 0.2 dB
+}
+
+void NoiseNode::setEconomyPink(bool economy) {
+  if (economy == economyPink_) {
+    return;
+  }
+  // Start the incoming filter from the outgoing one's low frequencies (the
+  // poles nearest in time constant), so that the two agree from the start
+  if (economy) {
+    pinkEconomy_[0] = pinkState_[0] + pinkState_[1];
+    pinkEconomy_[1] = pinkState_[2] + pinkState_[3];
+    pinkEconomy_[2] = pinkState_[4];
+  } else {
+    pinkState_[0] = pinkState_[1] = 0.5f * pinkEconomy_[0];
+    pinkState_[2] = pinkState_[3] = 0.5f * pinkEconomy_[1];
+    pinkState_[4] = pinkEconomy_[2];
+    pinkState_[5] = pinkState_[6] = 0.0f;
+  }
+  economyPink_ = economy;
+  pinkFadeLeft_ = kPinkFadeFrames;
+}
+
 float NoiseNode::generateBrownNoise() {
   // Brown noise (Brownian/red noise) via random walk
   // Use full-amplitude white noise for the random walk (not the scaled version)
-  float white = (static_cast<float>(rand()) / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f;
+  float white = nextRandom();
   brownState_ += white * 0.02f;
   
   // Prevent drift too far from zero
@@ -78,7 +173,20 @@ void NoiseNode::processNode(
   const std::shared_ptr<AudioBus> &processingBus,
   int framesToProcess
 ) {
+  CUSTOM_NODES_RT_SCOPE("Noise");
+  // The pink and brown filter states decay towards zero
+  rt::ScopedFlushDenormals flushDenormals;
+  // Noise may legitimately swing across its whole range in one sample
+  const float maxStep = 2.0f * volume;
+  GlitchDetector::Scope glitchScope(glitches_, processingBus, framesToProcess, _context->getSampleRate(), maxStep);
+  CUSTOM_NODES_DSP_SCOPE(dspLoad_, framesToProcess, _context->getSampleRate());
+  CUSTOM_NODES_TRACE_SCOPE("dsp", "Noise");
+
   // Handle control flags
+  trace::commandsApplied(this, {CUSTOM_NODES_TRACE_FLAG(shouldStart),
+                                CUSTOM_NODES_TRACE_FLAG(shouldPause),
+                                CUSTOM_NODES_TRACE_FLAG(shouldResume),
+                                CUSTOM_NODES_TRACE_FLAG(shouldStop)});
   if (shouldStart) {
     isRunning_ = true;
     isPaused = false;
@@ -130,6 +238,8 @@ void NoiseNode::processNode(
   const double sampleRate = _context->getSampleRate();
   const float frameDuration = 1.0f / sampleRate;
 
+  setEconomyPink(getQualityTier() >= QualityTier::Reduced);
+
   for (int i = 0; i < framesToProcess; ++i) {
     // Update volume ramping
     if (isRamping_) {
@@ -194,6 +304,9 @@ void NoiseNode::processNode(
     leftChannel[i] = output;
     rightChannel[i] = output;
   }
+
+  modulation().publish(kEnvelopeSignal, currentGain_);
+  modulation().publish(kLevelSignal, volume * currentGain_);
 }
 
 } // namespace audioapi
@@ -1,11 +1,18 @@
 #pragma once
 #include <audioapi/core/AudioNode.h>
 #include <audioapi/core/BaseAudioContext.h>
+#include "VoiceRenderer.h"
+#include "VoiceParams.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include <cstdint>
 #include <memory>
 
 namespace audioapi {
 
-class NoiseNode : public AudioNode {
+class NoiseNode : public AudioNode, public VoiceRenderer {
 public:
   explicit NoiseNode(BaseAudioContext *context);
   ~NoiseNode() override = default;
@@ -14,6 +21,14 @@ public:
     const std::shared_ptr<AudioBus> &processingBus,
     int framesToProcess
   ) override;
+  void renderVoice(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override {
+    processNode(bus, framesToProcess);
+  }
+  void resetVoice() override;
+  // Sets the preset parameters, as decoded from a binary preset. JS thread.
+  void applyParams(const NoiseParams &params);
+  // The current preset parameters, as applyParams() takes them. JS thread.
+  NoiseParams getParams();
 
   // Control methods
   void start();
@@ -21,8 +36,11 @@ public:
   void pause();
   void resume();
 
+  // Makes the noise sequence reproducible (e.g. for the rendered-session cache)
+  void setSeed(uint32_t seed);
+
   // Properties
-  int noiseColor = 0;  // 0=white, 1=pink, 2=brown
+  int noiseColor = kNoiseDefaults.noiseColor; // 0=white, 1=pink, 2=brown
   float volume = 0.3;
   bool isPaused = false;
 
@@ -36,6 +54,13 @@ private:
   bool shouldPause = false;
   bool shouldResume = false;
 
+  // Modulation signals, in the order they are declared to modulation():
+  // envelope (start/stop ramp), level (volume * envelope)
+  enum ModulationSignal { kEnvelopeSignal, kLevelSignal };
+
+  DspLoadMeter dspLoad_{"Noise"};
+  GlitchDetector glitches_{"Noise"};
+
   // Volume ramping
   float currentGain_ = 0.0f;
   float startGain_ = 0.0f;
@@ -51,12 +76,28 @@ private:
   // Pink noise state (1/f filter)
   float pinkState_[7] = {0, 0, 0, 0, 0, 0, 0};
 
+  // Below QualityTier::Full, pink noise comes from a 3-pole filter instead.
+  // A tier change crossfades between the two over kPinkFadeFrames, both
+  // filtering the same white noise.
+  static constexpr int kPinkFadeFrames = 2048;
+  float pinkEconomy_[3] = {0, 0, 0};
+  bool economyPink_ = false;
+  int pinkFadeLeft_ = 0;
+  void setEconomyPink(bool economy);
+
   // Brown noise state (integrated)
   float brownState_ = 0.0f;
 
+  // Per-node xorshift state. rand() shares hidden global state, which is not
+  // safe once voices render on several threads.
+  uint32_t rngState_ = 1;
+  float nextRandom();  // uniform in [-1, 1]
+
   // Noise generation functions
   float generateWhiteNoise();
   float generatePinkNoise();
+  float filterPink(float white);
+  float filterPinkEconomy(float white);
   float generateBrownNoise();
 };
 
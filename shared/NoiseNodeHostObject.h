@@ -1,5 +1,6 @@
 #pragma once
 #include "NoiseNode.h"
+#include "VoiceRenderer.h"
 #include <audioapi/HostObjects/AudioNodeHostObject.h>
 #include <jsi/jsi.h>
 
@@ -7,12 +8,13 @@ using namespace facebook;
 
 namespace audioapi {
 
-class NoiseNodeHostObject : public AudioNodeHostObject {
+class NoiseNodeHostObject : public AudioNodeHostObject, public VoiceHostObject {
 public:
   explicit NoiseNodeHostObject(const std::shared_ptr<NoiseNode> &node)
       : AudioNodeHostObject(node), node_(node) {}
 
   jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    trace::Scope traceScope("jsi", "Noise.get", node_.get());
     auto propName = propNameId.utf8(runtime);
 
     if (propName == "noiseColor") {
@@ -30,6 +32,7 @@ public:
         jsi::PropNameID::forAscii(runtime, "start"),
         0,
         [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          trace::commandQueued("shouldStart", true, node_.get());
           node_->start();
           return jsi::Value::undefined();
         });
@@ -40,6 +43,7 @@ public:
         jsi::PropNameID::forAscii(runtime, "stop"),
         0,
         [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          trace::commandQueued("shouldStop", true, node_.get());
           node_->stop();
           return jsi::Value::undefined();
         });
@@ -50,6 +54,7 @@ public:
         jsi::PropNameID::forAscii(runtime, "pause"),
         0,
         [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          trace::commandQueued("shouldPause", true, node_.get());
           node_->pause();
           return jsi::Value::undefined();
         });
@@ -60,6 +65,7 @@ public:
         jsi::PropNameID::forAscii(runtime, "resume"),
         0,
         [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          trace::commandQueued("shouldResume", true, node_.get());
           node_->resume();
           return jsi::Value::undefined();
         });
@@ -69,20 +75,33 @@ public:
   }
 
   void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    trace::Scope traceScope("jsi", "Noise.set", node_.get());
     auto propName = propNameId.utf8(runtime);
+    trace::commandQueued(propName, value.isBool() && value.getBool(), node_.get());
 
     if (propName == "noiseColor") {
       node_->noiseColor = static_cast<int>(value.asNumber());
+      node_->touchParams();
       return;
     }
     if (propName == "volume") {
       node_->volume = static_cast<float>(value.asNumber());
+      node_->touchParams();
+      return;
+    }
+    if (propName == "seed") {
+      node_->setSeed(static_cast<uint32_t>(value.asNumber()));
+      node_->touchParams();
       return;
     }
 
     AudioNodeHostObject::set(runtime, propNameId, value);
   }
 
+  std::shared_ptr<VoiceRenderer> getVoiceRenderer() const override {
+    return node_;
+  }
+
 private:
   std::shared_ptr<NoiseNode> node_;
 };
@@ -0,0 +1,134 @@
+#include "PresetDiff.h"
+#include "MartigliNode.h"
+#include "MartigliBinauralNode.h"
+#include "BinauralNode.h"
+#include "SymmetryNode.h"
+#include "NoiseNode.h"
+#include "SampleNode.h"
+#include <cstring>
+
+namespace audioapi::preset {
+
+namespace {
+
+// Compares the fields as stored (4 bytes each), so that an unchanged NaN or
+// -0 does not count as a change
+template <typename Node, typename Params>
+int retarget(VoiceRenderer &voice, VoiceType type, const Params &next, int rampFrames) {
+  auto *node = dynamic_cast<Node *>(&voice);
+  if (node == nullptr) {
+    return 0;
+  }
+  const Params current = node->getParams();
+  Params stepped = current;
+  const auto *from = reinterpret_cast<const uint8_t *>(&current);
+  const auto *to = reinterpret_cast<const uint8_t *>(&next);
+  auto *out = reinterpret_cast<uint8_t *>(&stepped);
+
+  int changed = 0;
+  bool step = false;
+  for (const Field &field : fields(type)) {
+    if (std::memcmp(from + field.offset, to + field.offset, 4) == 0) {
+      continue;
+    }
+    ++changed;
+    const int port =
+        field.kind == FieldKind::Float && rampFrames > 0 ? node->modulation().findParam(field.name) : -1;
+    if (port >= 0) {
+      float value;
+      std::memcpy(&value, to + field.offset, 4);
+      node->modulation().rampParam(port, value, rampFrames);
+    } else {
+      std::memcpy(out + field.offset, to + field.offset, 4);
+      step = true;
+    }
+  }
+
+  // applyParams() also rebuilds what depends on the parameters (Symmetry's
+  // note table), so it only runs for a change that needs it
+  if (step) {
+    node->applyParams(stepped);
+  } else if (changed > 0) {
+    node->touchParams();
+  }
+  return changed;
+}
+
+} // namespace
+
+VoiceType voiceType(VoiceRenderer &voice) {
+  if (dynamic_cast<MartigliNode *>(&voice) != nullptr) {
+    return VoiceType::Martigli;
+  }
+  if (dynamic_cast<MartigliBinauralNode *>(&voice) != nullptr) {
+    return VoiceType::MartigliBinaural;
+  }
+  if (dynamic_cast<BinauralNode *>(&voice) != nullptr) {
+    return VoiceType::Binaural;
+  }
+  if (dynamic_cast<SymmetryNode *>(&voice) != nullptr) {
+    return VoiceType::Symmetry;
+  }
+  if (dynamic_cast<NoiseNode *>(&voice) != nullptr) {
+    return VoiceType::Noise;
+  }
+  if (dynamic_cast<SampleNode *>(&voice) != nullptr) {
+    return VoiceType::Sample;
+  }
+  return VoiceType::None;
+}
+
+std::vector<int> matchVoices(const std::vector<VoiceRenderer *> &running, const Preset &next) {
+  std::vector<VoiceType> types(running.size(), VoiceType::None);
+  for (size_t r = 0; r < running.size(); ++r) {
+    if (running[r] != nullptr) {
+      types[r] = voiceType(*running[r]);
+    }
+  }
+  std::vector<bool> taken(running.size(), false);
+  const auto fits = [&](size_t r, const Voice &voice) {
+    if (taken[r] || voice.type == VoiceType::None || types[r] != voice.type) {
+      return false;
+    }
+    return voice.type != VoiceType::Sample || static_cast<SampleNode *>(running[r])->isLoaded(voice.path);
+  };
+
+  std::vector<int> matches(next.voices.size(), -1);
+  for (size_t i = 0; i < next.voices.size() && i < running.size(); ++i) {
+    if (fits(i, next.voices[i])) {
+      matches[i] = static_cast<int>(i);
+      taken[i] = true;
+    }
+  }
+  for (size_t i = 0; i < next.voices.size(); ++i) {
+    for (size_t r = 0; r < running.size() && matches[i] < 0; ++r) {
+      if (fits(r, next.voices[i])) {
+        matches[i] = static_cast<int>(r);
+        taken[r] = true;
+      }
+    }
+  }
+  return matches;
+}
+
+int retargetVoice(VoiceRenderer &voice, const Voice &next, int rampFrames) {
+  switch (next.type) {
+    case VoiceType::Martigli:
+      return retarget<MartigliNode>(voice, next.type, std::get<MartigliParams>(next.params), rampFrames);
+    case VoiceType::MartigliBinaural:
+      return retarget<MartigliBinauralNode>(voice, next.type, std::get<MartigliBinauralParams>(next.params),
+                                            rampFrames);
+    case VoiceType::Binaural:
+      return retarget<BinauralNode>(voice, next.type, std::get<BinauralParams>(next.params), rampFrames);
+    case VoiceType::Symmetry:
+      return retarget<SymmetryNode>(voice, next.type, std::get<SymmetryParams>(next.params), rampFrames);
+    case VoiceType::Noise:
+      return retarget<NoiseNode>(voice, next.type, std::get<NoiseParams>(next.params), rampFrames);
+    case VoiceType::Sample:
+      return retarget<SampleNode>(voice, next.type, std::get<SampleParams>(next.params), rampFrames);
+    default:
+      return 0;
+  }
+}
+
+} // namespace audioapi::preset
@@ -0,0 +1,37 @@
+#pragma once
+#include "PresetFormat.h"
+#include <vector>
+
+namespace audioapi {
+class VoiceRenderer;
+}
+
+namespace audioapi::preset {
+
+// Switching a running session to another preset without rebuilding it:
+// voices both presets have are retargeted in place, and only the voices the
+// new preset adds are created (and the ones it drops faded out) by the
+// caller.
+//
+// matchVoices() pairs each voice of the new preset with a running voice of
+// the same type, a Sample only with one playing the same file: first the
+// voice at the same index, so a preset edited in place keeps every voice
+// where it was, then the first free one. retargetVoice() writes only the
+// parameters that differ. Those the voice exposes as modulation ports
+// (volume, carrier frequencies, modulation depth, playback rate) ramp; the
+// others (waveforms, breathing periods, note tables...) change at once, as
+// they do from a host object setter.
+
+// The preset type of a voice node; None for other nodes
+VoiceType voiceType(VoiceRenderer &voice);
+
+// For each voice of next, the index in running of the voice to retarget, or
+// -1 for a voice to create. A running voice is used at most once.
+std::vector<int> matchVoices(const std::vector<VoiceRenderer *> &running, const Preset &next);
+
+// JS thread, while the voice plays. Ports ramp over rampFrames (0: at the
+// next block). Returns the number of parameters that changed; 0 if the voice
+// is not of next's type.
+int retargetVoice(VoiceRenderer &voice, const Voice &next, int rampFrames);
+
+} // namespace audioapi::preset
@@ -0,0 +1,186 @@
+#include "PresetFormat.h"
+#include "NativeLog.h"
+#include <cstring>
+
+namespace audioapi::preset {
+
+namespace {
+
+#define PRESET_FLOAT(Params, name) Field{#name, offsetof(Params, name), FieldKind::Float}
+#define PRESET_INT(Params, name) Field{#name, offsetof(Params, name), FieldKind::Int}
+
+// Wire order of each voice type's fields. Append only: the JS encoder and
+// stored presets index fields by position.
+const Field kMartigliFields[] = {
+    PRESET_FLOAT(MartigliParams, mf0),        PRESET_FLOAT(MartigliParams, ma),
+    PRESET_FLOAT(MartigliParams, mp0),        PRESET_FLOAT(MartigliParams, mp1),
+    PRESET_FLOAT(MartigliParams, md),         PRESET_FLOAT(MartigliParams, inhaleDur),
+    PRESET_FLOAT(MartigliParams, exhaleDur),  PRESET_INT(MartigliParams, waveformM),
+    PRESET_INT(MartigliParams, panOsc),       PRESET_FLOAT(MartigliParams, panOscPeriod),
+    PRESET_FLOAT(MartigliParams, panOscTrans),
+};
+
+const Field kMartigliBinauralFields[] = {
+    PRESET_FLOAT(MartigliBinauralParams, fl),           PRESET_FLOAT(MartigliBinauralParams, fr),
+    PRESET_INT(MartigliBinauralParams, waveformL),      PRESET_INT(MartigliBinauralParams, waveformR),
+    PRESET_FLOAT(MartigliBinauralParams, ma),           PRESET_FLOAT(MartigliBinauralParams, mp0),
+    PRESET_FLOAT(MartigliBinauralParams, mp1),          PRESET_FLOAT(MartigliBinauralParams, md),
+    PRESET_FLOAT(MartigliBinauralParams, inhaleDur),    PRESET_FLOAT(MartigliBinauralParams, exhaleDur),
+    PRESET_INT(MartigliBinauralParams, panOsc),         PRESET_FLOAT(MartigliBinauralParams, panOscPeriod),
+    PRESET_FLOAT(MartigliBinauralParams, panOscTrans),
+};
+
+const Field kBinauralFields[] = {
+    PRESET_FLOAT(BinauralParams, fl),          PRESET_FLOAT(BinauralParams, fr),
+    PRESET_INT(BinauralParams, waveformL),     PRESET_INT(BinauralParams, waveformR),
+    PRESET_INT(BinauralParams, panOsc),        PRESET_FLOAT(BinauralParams, panOscPeriod),
+    PRESET_FLOAT(BinauralParams, panOscTrans),
+};
+
+const Field kSymmetryFields[] = {
+    PRESET_FLOAT(SymmetryParams, f0),      PRESET_FLOAT(SymmetryParams, noctaves),
+    PRESET_INT(SymmetryParams, nnotes),    PRESET_FLOAT(SymmetryParams, d),
+    PRESET_INT(SymmetryParams, waveform),  PRESET_INT(SymmetryParams, permfunc),
+    PRESET_FLOAT(SymmetryParams, release),
+};
+
+const Field kNoiseFields[] = {
+    PRESET_INT(NoiseParams, noiseColor),
+};
+
+const Field kSampleFields[] = {
+    PRESET_INT(SampleParams, loop),            PRESET_FLOAT(SampleParams, loopStart),
+    PRESET_FLOAT(SampleParams, loopEnd),       PRESET_FLOAT(SampleParams, loopCrossfade),
+    PRESET_FLOAT(SampleParams, playbackRate),
+};
+
+#undef PRESET_FLOAT
+#undef PRESET_INT
+
+// Starts from the defaults and overwrites the fields the record gives
+template <typename Params, size_t N>
+Params readFields(const Field (&fields)[N], const uint8_t *words, int count, uint32_t present) {
+  Params params{};
+  auto *bytes = reinterpret_cast<uint8_t *>(&params);
+  for (int i = 0; i < count && i < static_cast<int>(N) && i < 32; ++i) {
+    if ((present & (1u << i)) != 0) {
+      std::memcpy(bytes + fields[i].offset, words + 4 * i, 4);
+    }
+  }
+  return params;
+}
+
+Params readParams(VoiceType type, const uint8_t *words, int count, uint32_t present) {
+  switch (type) {
+    case VoiceType::Martigli:
+      return readFields<MartigliParams>(kMartigliFields, words, count, present);
+    case VoiceType::MartigliBinaural:
+      return readFields<MartigliBinauralParams>(kMartigliBinauralFields, words, count, present);
+    case VoiceType::Binaural:
+      return readFields<BinauralParams>(kBinauralFields, words, count, present);
+    case VoiceType::Symmetry:
+      return readFields<SymmetryParams>(kSymmetryFields, words, count, present);
+    case VoiceType::Noise:
+      return readFields<NoiseParams>(kNoiseFields, words, count, present);
+    case VoiceType::Sample:
+      return readFields<SampleParams>(kSampleFields, words, count, present);
+    default:
+      return std::monostate{};
+  }
+}
+
+size_t padded(size_t bytes) {
+  return (bytes + 3) & ~size_t{3};
+}
+
+} // namespace
+
+std::span<const Field> fields(VoiceType type) {
+  switch (type) {
+    case VoiceType::Martigli:
+      return kMartigliFields;
+    case VoiceType::MartigliBinaural:
+      return kMartigliBinauralFields;
+    case VoiceType::Binaural:
+      return kBinauralFields;
+    case VoiceType::Symmetry:
+      return kSymmetryFields;
+    case VoiceType::Noise:
+      return kNoiseFields;
+    case VoiceType::Sample:
+      return kSampleFields;
+    default:
+      return {};
+  }
+}
+
+const char *typeName(VoiceType type) {
+  switch (type) {
+    case VoiceType::Martigli:
+      return "Martigli";
+    case VoiceType::MartigliBinaural:
+      return "Martigli-Binaural";
+    case VoiceType::Binaural:
+      return "Binaural";
+    case VoiceType::Symmetry:
+      return "Symmetry";
+    case VoiceType::Noise:
+      return "Noise";
+    case VoiceType::Sample:
+      return "Sample";
+    default:
+      return nullptr;
+  }
+}
+
+bool decode(const uint8_t *data, size_t size, Preset &preset) {
+  Header header;
+  if (data == nullptr || size < sizeof(Header)) {
+    CUSTOM_NODES_LOG_ERROR("PresetFormat", "preset truncated: %zu bytes", size);
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(Header));
+  if (header.magic != kMagic) {
+    CUSTOM_NODES_LOG_ERROR("PresetFormat", "not a binary preset");
+    return false;
+  }
+  if (header.version > kVersion) {
+    CUSTOM_NODES_LOG_ERROR("PresetFormat", "preset version %u is newer than %u", header.version, kVersion);
+    return false;
+  }
+
+  preset.duration = header.duration;
+  preset.seed = header.seed;
+  preset.voices.clear();
+  preset.voices.reserve(header.voiceCount);
+
+  size_t offset = sizeof(Header);
+  for (int v = 0; v < header.voiceCount; ++v) {
+    VoiceRecord record;
+    if (size - offset < sizeof(VoiceRecord)) {
+      CUSTOM_NODES_LOG_ERROR("PresetFormat", "preset truncated in voice %d", v);
+      return false;
+    }
+    std::memcpy(&record, data + offset, sizeof(VoiceRecord));
+    offset += sizeof(VoiceRecord);
+
+    const size_t fieldBytes = 4 * static_cast<size_t>(record.fieldCount);
+    const size_t pathBytes = padded(record.pathBytes);
+    if (size - offset < fieldBytes + pathBytes) {
+      CUSTOM_NODES_LOG_ERROR("PresetFormat", "preset truncated in voice %d", v);
+      return false;
+    }
+
+    Voice voice;
+    voice.type = typeName(static_cast<VoiceType>(record.type)) != nullptr ? static_cast<VoiceType>(record.type)
+                                                                          : VoiceType::None;
+    voice.params = readParams(voice.type, data + offset, record.fieldCount, record.present);
+    offset += fieldBytes;
+    voice.path.assign(reinterpret_cast<const char *>(data + offset), record.pathBytes);
+    offset += pathBytes;
+    preset.voices.push_back(std::move(voice));
+  }
+  return true;
+}
+
+} // namespace audioapi::preset
@@ -0,0 +1,95 @@
+#pragma once
+#include "VoiceParams.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace audioapi::preset {
+
+// Binary session presets, built by app/audio/PresetCodec.js (or a server)
+// and decoded here in one call, instead of one JSI property write per
+// parameter. Little endian, every item 4-byte aligned:
+//
+//   Header
+//   voiceCount times:
+//     VoiceRecord
+//     fieldCount 32-bit words: float32 or int32 per the voice type's field
+//       list (the field tables in PresetFormat.cpp)
+//     pathBytes of UTF-8 file path (Sample), zero padded to 4
+//
+// A field whose bit is clear in `present` keeps its VoiceParams.h default;
+// fields past the ones this decoder knows (from a newer encoder) are skipped.
+// Unknown voice types decode to an empty voice, so voice indices stay those
+// of the preset.
+constexpr uint32_t kMagic = 0x31504e43;  // "CNP1"
+constexpr uint16_t kVersion = 1;
+
+struct Header {
+  uint32_t magic = kMagic;
+  uint16_t version = kVersion;
+  uint16_t voiceCount = 0;
+  float duration = 0.0f;  // seconds
+  uint32_t seed = 1;
+};
+
+enum class VoiceType : uint8_t {
+  None = 0,
+  Martigli = 1,
+  MartigliBinaural = 2,
+  Binaural = 3,
+  Symmetry = 4,
+  Noise = 5,
+  Sample = 6,
+};
+
+struct VoiceRecord {
+  uint8_t type = 0;
+  uint8_t fieldCount = 0;
+  uint16_t pathBytes = 0;
+  uint32_t present = 0;  // bit i: field i is given
+};
+
+static_assert(sizeof(Header) == 16 && sizeof(VoiceRecord) == 8, "wire layout");
+
+using Params = std::variant<std::monostate, MartigliParams, MartigliBinauralParams, BinauralParams,
+                            SymmetryParams, NoiseParams, SampleParams>;
+
+struct Voice {
+  VoiceType type = VoiceType::None;
+  Params params;
+  std::string path;  // Sample only
+};
+
+struct Preset {
+  float duration = 0.0f;
+  uint32_t seed = 1;
+  std::vector<Voice> voices;
+};
+
+// Preset voice type name ("Martigli-Binaural"...), which is also the voice
+// pool's kind; nullptr for None
+const char *typeName(VoiceType type);
+
+// Every platform we ship on is little endian, like the wire format, so
+// fields are copied as they are.
+enum class FieldKind : uint8_t { Float, Int };
+
+// A parameter of a voice type: its name (the node property), and where it
+// sits in the type's VoiceParams.h struct
+struct Field {
+  const char *name;
+  size_t offset;
+  FieldKind kind;
+};
+
+// The type's fields in wire order; empty for None
+std::span<const Field> fields(VoiceType type);
+
+// False (and a logged reason) if the buffer is not a preset this version
+// can read or is truncated
+bool decode(const uint8_t *data, size_t size, Preset &preset);
+
+} // namespace audioapi::preset
@@ -0,0 +1,258 @@
+#include "PresetLibrary.h"
+#include "PresetFormat.h"
+#include "SessionRenderCache.h"
+#include "NativeLog.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace audioapi {
+
+struct PresetLibrary::Header {
+  uint32_t magic = kMagic;
+  uint16_t version = kVersion;
+  uint16_t tagBytes = 0;       // tag follows the header, padded to 4
+  uint32_t count = 0;
+  uint32_t indexOffset = 0;
+  uint32_t stringsOffset = 0;
+  uint32_t stringsBytes = 0;
+  uint32_t dataOffset = 0;
+  uint32_t fileBytes = 0;
+};
+
+struct PresetLibrary::IndexEntry {
+  uint32_t idOffset = 0;       // into the strings; the name follows the id
+  uint16_t idBytes = 0;
+  uint16_t nameBytes = 0;
+  uint32_t presetOffset = 0;   // from the start of the file
+  uint32_t presetBytes = 0;
+  uint32_t metaOffset = 0;
+  uint32_t metaBytes = 0;
+  float duration = 0.0f;
+  uint16_t voices = 0;
+  uint16_t reserved = 0;
+};
+
+static_assert(sizeof(PresetLibrary::Header) == 32, "PresetLibrary::Header must stay 32 bytes");
+static_assert(sizeof(PresetLibrary::IndexEntry) == 32, "PresetLibrary::IndexEntry must stay 32 bytes");
+
+namespace {
+
+size_t padded(size_t bytes) {
+  return (bytes + 3) & ~size_t{3};
+}
+
+std::string lowercase(std::string_view text) {
+  std::string result(text);
+  std::transform(result.begin(), result.end(), result.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return result;
+}
+
+void append(std::vector<uint8_t> &file, const void *data, size_t bytes) {
+  const auto *begin = static_cast<const uint8_t *>(data);
+  file.insert(file.end(), begin, begin + bytes);
+  file.resize(padded(file.size()), 0);
+}
+
+} // namespace
+
+PresetLibrary &PresetLibrary::instance() {
+  static PresetLibrary library;
+  return library;
+}
+
+std::string PresetLibrary::defaultPath() {
+  const std::string cache = appCacheDirectory();
+  return cache.empty() ? cache : cache + "/presets.cnpl";
+}
+
+bool PresetLibrary::write(const std::string &path, const std::string &tag, std::vector<Source> sources) {
+  std::sort(sources.begin(), sources.end(), [](const Source &a, const Source &b) { return a.id < b.id; });
+
+  Header header;
+  header.tagBytes = static_cast<uint16_t>(std::min<size_t>(tag.size(), UINT16_MAX));
+  header.count = static_cast<uint32_t>(sources.size());
+  header.indexOffset = static_cast<uint32_t>(sizeof(Header) + padded(header.tagBytes));
+  header.stringsOffset = header.indexOffset + header.count * sizeof(IndexEntry);
+
+  std::vector<IndexEntry> index(sources.size());
+  std::string strings;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    const Source &source = sources[i];
+    preset::Preset decoded;
+    if (!preset::decode(source.preset.data(), source.preset.size(), decoded)) {
+      CUSTOM_NODES_LOG_ERROR("PresetLibrary", "preset %s is not a valid binary preset", source.id.c_str());
+      return false;
+    }
+    if (i > 0 && source.id == sources[i - 1].id) {
+      CUSTOM_NODES_LOG_ERROR("PresetLibrary", "duplicate preset id %s", source.id.c_str());
+      return false;
+    }
+    IndexEntry &entry = index[i];
+    entry.idOffset = static_cast<uint32_t>(strings.size());
+    entry.idBytes = static_cast<uint16_t>(std::min<size_t>(source.id.size(), UINT16_MAX));
+    entry.nameBytes = static_cast<uint16_t>(std::min<size_t>(source.name.size(), UINT16_MAX));
+    entry.duration = decoded.duration;
+    entry.voices = static_cast<uint16_t>(decoded.voices.size());
+    strings.append(source.id, 0, entry.idBytes);
+    strings.append(source.name, 0, entry.nameBytes);
+  }
+  header.stringsBytes = static_cast<uint32_t>(strings.size());
+  header.dataOffset = static_cast<uint32_t>(padded(header.stringsOffset + strings.size()));
+
+  uint64_t offset = header.dataOffset;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    index[i].presetOffset = static_cast<uint32_t>(offset);
+    index[i].presetBytes = static_cast<uint32_t>(sources[i].preset.size());
+    offset += padded(sources[i].preset.size());
+    index[i].metaOffset = static_cast<uint32_t>(offset);
+    index[i].metaBytes = static_cast<uint32_t>(sources[i].meta.size());
+    offset += padded(sources[i].meta.size());
+  }
+  if (offset > UINT32_MAX) {
+    CUSTOM_NODES_LOG_ERROR("PresetLibrary", "library too large");
+    return false;
+  }
+  header.fileBytes = static_cast<uint32_t>(offset);
+
+  std::vector<uint8_t> file;
+  file.reserve(header.fileBytes);
+  append(file, &header, sizeof(header));
+  append(file, tag.data(), header.tagBytes);
+  append(file, index.data(), index.size() * sizeof(IndexEntry));
+  append(file, strings.data(), strings.size());
+  for (const Source &source : sources) {
+    append(file, source.preset.data(), source.preset.size());
+    append(file, source.meta.data(), source.meta.size());
+  }
+
+  const std::string temporary = path + ".tmp";
+  FILE *out = fopen(temporary.c_str(), "wb");
+  if (out == nullptr) {
+    CUSTOM_NODES_LOG_ERROR("PresetLibrary", "cannot create %s", temporary.c_str());
+    return false;
+  }
+  const bool written = fwrite(file.data(), 1, file.size(), out) == file.size();
+  const bool closed = fclose(out) == 0;
+  if (!written || !closed || rename(temporary.c_str(), path.c_str()) != 0) {
+    CUSTOM_NODES_LOG_ERROR("PresetLibrary", "cannot write %s", path.c_str());
+    unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool PresetLibrary::open(const std::string &path, const std::string &tag) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+    ::close(fd);
+    return false;
+  }
+  const size_t bytes = static_cast<size_t>(info.st_size);
+  void *base = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);  // the mapping keeps the file
+  if (base == MAP_FAILED) {
+    return false;
+  }
+  base_ = static_cast<uint8_t *>(base);
+  bytes_ = bytes;
+
+  Header header;
+  std::memcpy(&header, base_, sizeof(header));
+  const bool valid = header.magic == kMagic && header.version == kVersion && header.fileBytes == bytes_ &&
+                     sizeof(Header) + header.tagBytes <= bytes_ &&
+                     std::string_view(reinterpret_cast<const char *>(base_) + sizeof(Header), header.tagBytes) == tag &&
+                     header.indexOffset % alignof(IndexEntry) == 0 &&
+                     header.stringsOffset == header.indexOffset + uint64_t{header.count} * sizeof(IndexEntry) &&
+                     uint64_t{header.stringsOffset} + header.stringsBytes <= bytes_;
+  if (!valid) {
+    CUSTOM_NODES_LOG_INFO("PresetLibrary", "%s is stale or not a preset library", path.c_str());
+    close();
+    return false;
+  }
+  index_ = reinterpret_cast<const IndexEntry *>(base_ + header.indexOffset);
+  strings_ = reinterpret_cast<const char *>(base_ + header.stringsOffset);
+  count_ = header.count;
+
+  for (uint32_t i = 0; i < count_; ++i) {
+    const IndexEntry &entry = index_[i];
+    if (uint64_t{entry.idOffset} + entry.idBytes + entry.nameBytes > header.stringsBytes ||
+        uint64_t{entry.presetOffset} + entry.presetBytes > bytes_ ||
+        uint64_t{entry.metaOffset} + entry.metaBytes > bytes_) {
+      CUSTOM_NODES_LOG_ERROR("PresetLibrary", "%s is corrupt", path.c_str());
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void PresetLibrary::close() {
+  if (base_ != nullptr) {
+    munmap(base_, bytes_);
+  }
+  base_ = nullptr;
+  bytes_ = 0;
+  index_ = nullptr;
+  strings_ = nullptr;
+  count_ = 0;
+}
+
+std::string_view PresetLibrary::id(const IndexEntry &entry) const {
+  return {strings_ + entry.idOffset, entry.idBytes};
+}
+
+std::string_view PresetLibrary::name(const IndexEntry &entry) const {
+  return {strings_ + entry.idOffset + entry.idBytes, entry.nameBytes};
+}
+
+const PresetLibrary::IndexEntry *PresetLibrary::find(const std::string &key) const {
+  const IndexEntry *end = index_ + count_;
+  const IndexEntry *entry = std::lower_bound(
+      index_, end, key, [this](const IndexEntry &candidate, const std::string &value) { return id(candidate) < value; });
+  return entry != end && id(*entry) == key ? entry : nullptr;
+}
+
+std::vector<PresetLibraryEntry> PresetLibrary::list(const std::string &query) const {
+  const std::string needle = lowercase(query);
+  std::vector<PresetLibraryEntry> result;
+  for (uint32_t i = 0; i < count_; ++i) {
+    const IndexEntry &entry = index_[i];
+    if (!needle.empty() && lowercase(id(entry)).find(needle) == std::string::npos &&
+        lowercase(name(entry)).find(needle) == std::string::npos) {
+      continue;
+    }
+    result.push_back(PresetLibraryEntry{std::string(id(entry)), std::string(name(entry)), entry.duration,
+                                        entry.voices});
+  }
+  return result;
+}
+
+PresetLibrary::View PresetLibrary::preset(const std::string &key) const {
+  const IndexEntry *entry = find(key);
+  if (entry == nullptr) {
+    return {};
+  }
+  return {base_ + entry->presetOffset, entry->presetBytes};
+}
+
+std::string_view PresetLibrary::meta(const std::string &key) const {
+  const IndexEntry *entry = find(key);
+  if (entry == nullptr) {
+    return {};
+  }
+  return {reinterpret_cast<const char *>(base_ + entry->metaOffset), entry->metaBytes};
+}
+
+} // namespace audioapi
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace audioapi {
+
+struct PresetLibraryEntry {
+  std::string id;      // key in the catalog, e.g. "Meditazione"
+  std::string name;    // display name (header.med2)
+  float duration = 0.0f;
+  int voices = 0;
+};
+
+// The session catalog as one memory-mapped file, so that the app neither
+// ships nor parses every preset at startup:
+//
+//   Header, tag
+//   Index: count fixed-size entries sorted by id
+//   Strings: each entry's id then name
+//   Data: per preset, its binary preset (PresetFormat.h), then its JSON
+//     metadata (visual settings, modulations, volumes...)
+//
+// Listing and searching only read the header, index and string pages at the
+// front of the file. A preset's binary record is decoded straight from the
+// mapping and its metadata copied out only when that preset is selected.
+//
+// The tag identifies what the library was built from (app version, preset
+// revision); open() rejects a library with another tag so that JS rebuilds
+// it. JS thread only: views returned by preset()/meta() are valid until the
+// next open() or close().
+class PresetLibrary {
+public:
+  static constexpr uint32_t kMagic = 0x4c504e43;  // "CNPL"
+  static constexpr uint16_t kVersion = 1;
+
+  struct Source {
+    std::string id;
+    std::string name;
+    std::vector<uint8_t> preset;  // binary preset
+    std::string meta;             // JSON
+  };
+
+  struct View {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+  };
+
+  static PresetLibrary &instance();
+
+  // presets.cnpl in the app's cache directory
+  static std::string defaultPath();
+
+  // Writes a library (to a temporary file renamed into place). False if a
+  // source is not a valid binary preset or the file cannot be written.
+  static bool write(const std::string &path, const std::string &tag, std::vector<Source> sources);
+
+  // Maps the library at path; false if it is missing, corrupt, of another
+  // format version or built with another tag
+  bool open(const std::string &path, const std::string &tag);
+  void close();
+  bool isOpen() const { return base_ != nullptr; }
+  int size() const { return static_cast<int>(count_); }
+
+  // Entries whose id or name contains query (ASCII case-insensitive), in id
+  // order; all of them for an empty query
+  std::vector<PresetLibraryEntry> list(const std::string &query) const;
+
+  // Zero-copy views into the mapping, empty if there is no such preset
+  View preset(const std::string &id) const;
+  std::string_view meta(const std::string &id) const;
+
+  ~PresetLibrary() { close(); }
+
+  // File layout, defined in PresetLibrary.cpp
+  struct Header;
+  struct IndexEntry;
+
+private:
+  PresetLibrary() = default;
+  const IndexEntry *find(const std::string &id) const;
+  std::string_view id(const IndexEntry &entry) const;
+  std::string_view name(const IndexEntry &entry) const;
+
+  uint8_t *base_ = nullptr;
+  size_t bytes_ = 0;
+  const IndexEntry *index_ = nullptr;
+  const char *strings_ = nullptr;
+  uint32_t count_ = 0;
+};
+
+} // namespace audioapi
@@ -0,0 +1,100 @@
+#include "QualityGovernor.h"
+#include "NativeLog.h"
+#include <algorithm>
+
+namespace audioapi {
+
+const char *qualityTierName(QualityTier tier) {
+  switch (tier) {
+    case QualityTier::Full:
+      return "full";
+    case QualityTier::Reduced:
+      return "reduced";
+    case QualityTier::Low:
+      return "low";
+  }
+  return "";
+}
+
+QualityTier QualityGovernor::record(uint64_t nanos, uint64_t budgetNanos) {
+  if (budgetNanos == 0) {
+    return tier();
+  }
+  const double seconds = budgetNanos * 1e-9;
+  const double load = 100.0 * static_cast<double>(nanos) / static_cast<double>(budgetNanos);
+  smoothed_ += (load - smoothed_) * std::min(1.0, seconds / kSmoothingSeconds);
+  if (resetPeak_.exchange(false, std::memory_order_relaxed)) {
+    peak_ = 0.0;
+  }
+  peak_ = std::max(peak_, load);
+  loadPercent_.store(smoothed_, std::memory_order_relaxed);
+  peakPercent_.store(peak_, std::memory_order_relaxed);
+
+  int current = tier_.load(std::memory_order_relaxed);
+  sinceChange_ += seconds;
+  sinceStepUp_ += seconds;
+  if (settleLeft_ > 0.0) {
+    settleLeft_ -= seconds;
+    return static_cast<QualityTier>(current);
+  }
+  if (!isAdaptive()) {
+    lowFor_ = 0.0;
+    return static_cast<QualityTier>(current);
+  }
+
+  double hold = holdSeconds_.load(std::memory_order_relaxed);
+  if (sinceChange_ > kMaxHoldSeconds && hold > kHoldSeconds) {
+    // Steady for long enough: forget past flapping
+    hold = kHoldSeconds;
+    holdSeconds_.store(hold, std::memory_order_relaxed);
+  }
+
+  if ((smoothed_ > kDownPercent || load > kPanicPercent) && current < kQualityTierCount - 1 &&
+      sinceChange_ >= kDwellSeconds) {
+    if (sinceStepUp_ < hold) {
+      holdSeconds_.store(std::min(2.0 * hold, kMaxHoldSeconds), std::memory_order_relaxed);
+    }
+    ++current;
+    sinceChange_ = 0.0;
+    lowFor_ = 0.0;
+    stepsDown_.fetch_add(1, std::memory_order_relaxed);
+    tier_.store(static_cast<uint8_t>(current), std::memory_order_relaxed);
+    CUSTOM_NODES_LOG_INFO("QualityGovernor", "render load high, quality down to %s",
+                          qualityTierName(static_cast<QualityTier>(current)));
+  } else if (smoothed_ < kUpPercent && current > 0) {
+    lowFor_ += seconds;
+    if (lowFor_ >= hold) {
+      --current;
+      sinceChange_ = 0.0;
+      sinceStepUp_ = 0.0;
+      lowFor_ = 0.0;
+      stepsUp_.fetch_add(1, std::memory_order_relaxed);
+      tier_.store(static_cast<uint8_t>(current), std::memory_order_relaxed);
+      CUSTOM_NODES_LOG_INFO("QualityGovernor", "render load low, quality up to %s",
+                            qualityTierName(static_cast<QualityTier>(current)));
+    }
+  } else {
+    lowFor_ = 0.0;
+  }
+  return static_cast<QualityTier>(current);
+}
+
+void QualityGovernor::idle() {
+  settleLeft_ = kSettleSeconds;
+  lowFor_ = 0.0;
+}
+
+QualityReport QualityGovernor::report() {
+  QualityReport result;
+  result.tier = tier();
+  result.adaptive = isAdaptive();
+  result.loadPercent = loadPercent_.load(std::memory_order_relaxed);
+  result.peakPercent = peakPercent_.load(std::memory_order_relaxed);
+  result.stepsDown = stepsDown_.load(std::memory_order_relaxed);
+  result.stepsUp = stepsUp_.load(std::memory_order_relaxed);
+  result.holdSeconds = holdSeconds_.load(std::memory_order_relaxed);
+  resetPeak_.store(true, std::memory_order_relaxed);
+  return result;
+}
+
+} // namespace audioapi
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace audioapi {
+
+// How much per-sample precision a voice spends. A voice renders at Full
+// unless a VoiceMixNode under load lowers it; each tier keeps what the
+// previous one dropped. Every switch is click-free: the sine error stays at
+// -83 dB, control values are held for at most kControlInterval frames, and
+// the noise filters crossfade.
+enum class QualityTier : uint8_t {
+  Full = 0,
+  Reduced = 1,  // Fast fastmath sines; 3-pole pink noise filter
+  Low = 2,      // panning evaluated once per kControlInterval frames
+};
+
+inline constexpr int kQualityTierCount = 3;
+
+// Frames between control-rate updates at QualityTier::Low
+inline constexpr int kControlInterval = 32;
+
+const char *qualityTierName(QualityTier tier);
+
+struct QualityReport {
+  QualityTier tier = QualityTier::Full;
+  bool adaptive = true;
+  double loadPercent = 0.0;   // smoothed render time / quantum duration
+  double peakPercent = 0.0;   // worst quantum since the previous report
+  uint32_t stepsDown = 0;
+  uint32_t stepsUp = 0;
+  double holdSeconds = 0.0;   // low load needed before the next step up
+};
+
+// Steps a mixer's voices down through the quality tiers when their measured
+// render time nears the quantum's duration, before the audio thread misses a
+// deadline, and back up once the load stays low.
+//
+// The load is the mixer's render time over the quantum duration, smoothed
+// over kSmoothingSeconds. One tier down when the smoothed load exceeds
+// kDownPercent or a single quantum exceeds kPanicPercent (a UI animation or
+// a throttled core), at most once per kDwellSeconds so that the last step
+// shows in the load first. One tier up after the smoothed load has stayed
+// under kUpPercent for the hold time. The gap between the two thresholds and
+// the hold are the hysteresis; a step down soon after a step up doubles the
+// hold (up to kMaxHoldSeconds), so that a device at the edge settles on the
+// lower tier instead of flapping. Quanta right after the mixer had nothing to
+// render (start, cold caches) are not judged.
+//
+// record() runs on the audio thread; the other methods on any thread.
+class QualityGovernor {
+public:
+  static constexpr double kDownPercent = 60.0;
+  static constexpr double kPanicPercent = 85.0;
+  static constexpr double kUpPercent = 30.0;
+  static constexpr double kSmoothingSeconds = 0.1;
+  static constexpr double kDwellSeconds = 0.25;
+  static constexpr double kHoldSeconds = 3.0;
+  static constexpr double kMaxHoldSeconds = 60.0;
+  static constexpr double kSettleSeconds = 0.5;
+
+  // One rendered quantum took nanos of its budgetNanos. Returns the tier to
+  // render the next one at.
+  QualityTier record(uint64_t nanos, uint64_t budgetNanos);
+  // A quantum with nothing rendered: the next ones settle first
+  void idle();
+
+  QualityTier tier() const { return static_cast<QualityTier>(tier_.load(std::memory_order_relaxed)); }
+
+  // Off: the tier stays where setTier() put it
+  void setAdaptive(bool adaptive) { adaptive_.store(adaptive, std::memory_order_relaxed); }
+  bool isAdaptive() const { return adaptive_.load(std::memory_order_relaxed); }
+  // When adaptive, the governor goes on from this tier
+  void setTier(QualityTier tier) { tier_.store(static_cast<uint8_t>(tier), std::memory_order_relaxed); }
+
+  QualityReport report();
+
+private:
+  std::atomic<uint8_t> tier_{0};
+  std::atomic<bool> adaptive_{true};
+  std::atomic<double> loadPercent_{0.0};
+  std::atomic<double> peakPercent_{0.0};
+  std::atomic<bool> resetPeak_{false};
+  std::atomic<uint32_t> stepsDown_{0};
+  std::atomic<uint32_t> stepsUp_{0};
+  std::atomic<double> holdSeconds_{kHoldSeconds};
+
+  // Audio thread
+  double smoothed_ = 0.0;
+  double peak_ = 0.0;
+  double settleLeft_ = kSettleSeconds;
+  double sinceChange_ = 0.0;
+  double sinceStepUp_ = kMaxHoldSeconds;
+  double lowFor_ = 0.0;
+};
+
+} // namespace audioapi
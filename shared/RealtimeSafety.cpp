@@ -0,0 +1,441 @@
+#include "RealtimeSafety.h"
+
+#if CUSTOM_NODES_RT_CHECK
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <new>
+#include <pthread.h>
+#include <unwind.h>
+#if defined(__ANDROID__)
+#include <android/log.h>
+#endif
+#endif
+
+namespace audioapi::rt {
+
+#if CUSTOM_NODES_RT_CHECK
+
+namespace {
+
+// Everything here is constant-initialized: the interceptors may run before
+// static constructors and must not hit a guarded local static (which locks).
+struct ThreadSlot {
+  std::atomic<uintptr_t> thread{0};
+  int depth = 0;                // owner thread only
+  const char *node = nullptr;   // owner thread only
+  bool reporting = false;       // owner thread only
+};
+
+struct Record {
+  std::atomic<uint64_t> sequence{0};  // index + 1 once complete
+  const char *what = nullptr;
+  const char *node = nullptr;
+  uintptr_t frames[kStackDepth] = {};
+  int frameCount = 0;
+};
+
+ThreadSlot threadSlots[kMaxThreads];
+std::atomic<int> activeThreads{0};
+Record records[kRecentViolations];
+std::atomic<uint64_t> nextRecord{0};
+std::atomic<uint64_t> firstRecord{0};  // moved forward by reset()
+
+// pthread_t is an integer on Android and a pointer on Apple platforms
+uintptr_t currentThread() {
+  return (uintptr_t)pthread_self();
+}
+
+ThreadSlot *findSlot(uintptr_t thread) {
+  for (auto &slot : threadSlots) {
+    if (slot.thread.load(std::memory_order_acquire) == thread) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+struct StackCapture {
+  uintptr_t *frames;
+  int count;
+  int skip;
+};
+
+_Unwind_Reason_Code captureFrame(struct _Unwind_Context *context, void *arg) {
+  auto *capture = static_cast<StackCapture *>(arg);
+  const uintptr_t pc = _Unwind_GetIP(context);
+  if (pc == 0) {
+    return _URC_END_OF_STACK;
+  }
+  if (capture->skip > 0) {
+    --capture->skip;
+    return _URC_NO_REASON;
+  }
+  capture->frames[capture->count++] = pc;
+  return capture->count < kStackDepth ? _URC_NO_REASON : _URC_END_OF_STACK;
+}
+
+std::string symbolize(uintptr_t pc) {
+  char buffer[64];
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void *>(pc), &info) == 0) {
+    snprintf(buffer, sizeof(buffer), "0x%" PRIxPTR, pc);
+    return buffer;
+  }
+  const char *library = info.dli_fname != nullptr ? info.dli_fname : "?";
+  if (const char *slash = std::strrchr(library, '/')) {
+    library = slash + 1;
+  }
+  std::string frame;
+  if (info.dli_sname != nullptr) {
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    frame = status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+    std::free(demangled);
+    snprintf(buffer, sizeof(buffer), "+0x%" PRIxPTR, pc - reinterpret_cast<uintptr_t>(info.dli_saddr));
+  } else {
+    snprintf(buffer, sizeof(buffer), "0x%" PRIxPTR, pc - reinterpret_cast<uintptr_t>(info.dli_fbase));
+  }
+  return frame + buffer + " (" + library + ")";
+}
+
+} // namespace
+
+Scope::Scope(const char *node) : slot_(-1), outerNode_(nullptr) {
+  const uintptr_t self = currentThread();
+  ThreadSlot *slot = findSlot(self);
+  if (slot == nullptr) {
+    for (auto &candidate : threadSlots) {
+      uintptr_t expected = 0;
+      if (candidate.thread.compare_exchange_strong(expected, self, std::memory_order_acq_rel)) {
+        slot = &candidate;
+        activeThreads.fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+    }
+  }
+  if (slot == nullptr) {
+    return;  // more real-time threads than slots: this one goes unchecked
+  }
+  slot_ = static_cast<int>(slot - threadSlots);
+  ++slot->depth;
+  outerNode_ = slot->node;
+  slot->node = node;
+}
+
+Scope::~Scope() {
+  if (slot_ < 0) {
+    return;
+  }
+  ThreadSlot &slot = threadSlots[slot_];
+  slot.node = outerNode_;
+  if (--slot.depth == 0) {
+    slot.thread.store(0, std::memory_order_release);
+    activeThreads.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+void violation(const char *what) {
+  if (activeThreads.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  ThreadSlot *slot = findSlot(currentThread());
+  if (slot == nullptr || slot->reporting) {
+    return;
+  }
+  slot->reporting = true;
+
+  const uint64_t index = nextRecord.fetch_add(1, std::memory_order_relaxed);
+  Record &record = records[index % kRecentViolations];
+  record.sequence.store(0, std::memory_order_relaxed);
+  record.what = what;
+  record.node = slot->node;
+  // Skip violation() and the interceptor that called it
+  StackCapture capture{record.frames, 0, 2};
+  _Unwind_Backtrace(captureFrame, &capture);
+  record.frameCount = capture.count;
+  record.sequence.store(index + 1, std::memory_order_release);
+
+  slot->reporting = false;
+}
+
+RtSafetyReport report() {
+  RtSafetyReport result;
+  result.enabled = true;
+  const uint64_t end = nextRecord.load(std::memory_order_acquire);
+  const uint64_t begin = std::min(firstRecord.load(std::memory_order_relaxed), end);
+  result.total = end - begin;
+
+  const uint64_t first = std::max<uint64_t>(begin, end > kRecentViolations ? end - kRecentViolations : 0);
+  for (uint64_t index = first; index < end; ++index) {
+    const Record &record = records[index % kRecentViolations];
+    if (record.sequence.load(std::memory_order_acquire) != index + 1) {
+      continue;  // still being written, or already overwritten
+    }
+    const char *what = record.what;
+    const char *node = record.node;
+    uintptr_t frames[kStackDepth];
+    const int frameCount = record.frameCount;
+    std::copy(record.frames, record.frames + frameCount, frames);
+    if (record.sequence.load(std::memory_order_acquire) != index + 1) {
+      continue;
+    }
+
+    RtViolation entry;
+    entry.what = what != nullptr ? what : "?";
+    entry.node = node != nullptr ? node : "?";
+    entry.stack.reserve(frameCount);
+    for (int i = 0; i < frameCount; ++i) {
+      entry.stack.push_back(symbolize(frames[i]));
+    }
+    result.recent.push_back(std::move(entry));
+  }
+  return result;
+}
+
+void reset() {
+  firstRecord.store(nextRecord.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+#else
+
+RtSafetyReport report() {
+  return {};
+}
+
+void reset() {}
+
+#endif
+
+} // namespace audioapi::rt
+
+#if CUSTOM_NODES_RT_CHECK && CUSTOM_NODES_RT_CHECK_WRAP
+
+// Link-time wrappers, enabled by -Wl,--wrap=<symbol> (see the CMake option).
+// Every call this library makes to <symbol> lands in __wrap_<symbol>, and
+// __real_<symbol> is the original.
+extern "C" {
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void __real_free(void *pointer);
+int __real_pthread_mutex_lock(pthread_mutex_t *mutex);
+void __real__ZNSt6__ndk15mutex4lockEv(void *mutex);  // std::mutex::lock()
+int __real_puts(const char *text);
+int __real_fputs(const char *text, FILE *stream);
+size_t __real_fwrite(const void *data, size_t size, size_t count, FILE *stream);
+
+void *__wrap_malloc(size_t size) {
+  audioapi::rt::violation("malloc");
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  audioapi::rt::violation("calloc");
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+  audioapi::rt::violation("realloc");
+  return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void *pointer) {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("free");
+  }
+  __real_free(pointer);
+}
+
+int __wrap_pthread_mutex_lock(pthread_mutex_t *mutex) {
+  audioapi::rt::violation("pthread_mutex_lock");
+  return __real_pthread_mutex_lock(mutex);
+}
+
+void __wrap__ZNSt6__ndk15mutex4lockEv(void *mutex) {
+  audioapi::rt::violation("std::mutex::lock");
+  __real__ZNSt6__ndk15mutex4lockEv(mutex);
+}
+
+// operator new/delete, by their mangled names (size_t is unsigned long on
+// LP64 targets, unsigned int on 32-bit ones)
+#if defined(__LP64__)
+void *__real__Znwm(size_t size);
+void *__real__Znam(size_t size);
+void __real__ZdlPvm(void *pointer, size_t size);
+void __real__ZdaPvm(void *pointer, size_t size);
+
+void *__wrap__Znwm(size_t size) {
+  audioapi::rt::violation("operator new");
+  return __real__Znwm(size);
+}
+
+void *__wrap__Znam(size_t size) {
+  audioapi::rt::violation("operator new[]");
+  return __real__Znam(size);
+}
+
+void __wrap__ZdlPvm(void *pointer, size_t size) {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete");
+  }
+  __real__ZdlPvm(pointer, size);
+}
+
+void __wrap__ZdaPvm(void *pointer, size_t size) {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete[]");
+  }
+  __real__ZdaPvm(pointer, size);
+}
+#else
+void *__real__Znwj(size_t size);
+void *__real__Znaj(size_t size);
+void __real__ZdlPvj(void *pointer, size_t size);
+void __real__ZdaPvj(void *pointer, size_t size);
+
+void *__wrap__Znwj(size_t size) {
+  audioapi::rt::violation("operator new");
+  return __real__Znwj(size);
+}
+
+void *__wrap__Znaj(size_t size) {
+  audioapi::rt::violation("operator new[]");
+  return __real__Znaj(size);
+}
+
+void __wrap__ZdlPvj(void *pointer, size_t size) {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete");
+  }
+  __real__ZdlPvj(pointer, size);
+}
+
+void __wrap__ZdaPvj(void *pointer, size_t size) {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete[]");
+  }
+  __real__ZdaPvj(pointer, size);
+}
+#endif
+
+void __real__ZdlPv(void *pointer);
+void __real__ZdaPv(void *pointer);
+
+void __wrap__ZdlPv(void *pointer) {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete");
+  }
+  __real__ZdlPv(pointer);
+}
+
+void __wrap__ZdaPv(void *pointer) {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete[]");
+  }
+  __real__ZdaPv(pointer);
+}
+
+int __wrap_printf(const char *format, ...) {
+  audioapi::rt::violation("printf");
+  va_list args;
+  va_start(args, format);
+  int result = vprintf(format, args);
+  va_end(args);
+  return result;
+}
+
+int __wrap_fprintf(FILE *stream, const char *format, ...) {
+  audioapi::rt::violation("fprintf");
+  va_list args;
+  va_start(args, format);
+  int result = vfprintf(stream, format, args);
+  va_end(args);
+  return result;
+}
+
+int __wrap_puts(const char *text) {
+  audioapi::rt::violation("puts");
+  return __real_puts(text);
+}
+
+int __wrap_fputs(const char *text, FILE *stream) {
+  audioapi::rt::violation("fputs");
+  return __real_fputs(text, stream);
+}
+
+size_t __wrap_fwrite(const void *data, size_t size, size_t count, FILE *stream) {
+  audioapi::rt::violation("fwrite");
+  return __real_fwrite(data, size, count, stream);
+}
+
+#if defined(__ANDROID__)
+int __wrap___android_log_print(int priority, const char *tag, const char *format, ...) {
+  audioapi::rt::violation("__android_log_print");
+  va_list args;
+  va_start(args, format);
+  int result = __android_log_vprint(priority, tag, format, args);
+  va_end(args);
+  return result;
+}
+#endif
+
+} // extern "C"
+
+#elif CUSTOM_NODES_RT_CHECK
+
+// No link-time wrapping here: replace the global allocation functions, which
+// every C++ allocation of the process goes through. The standard library's
+// nothrow forms forward to these; aligned allocations are not checked.
+void *operator new(std::size_t size) {
+  audioapi::rt::violation("operator new");
+  if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+  audioapi::rt::violation("operator new[]");
+  if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete");
+  }
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete[]");
+  }
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete");
+  }
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  if (pointer != nullptr) {
+    audioapi::rt::violation("operator delete[]");
+  }
+  std::free(pointer);
+}
+
+#endif
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+// Real-time safety checker. Opt-in debug mode (define CUSTOM_NODES_RT_CHECK=1;
+// on Android the CMake option of the same name also sets up the link-time
+// wrappers) that reports every allocation, blocking lock and stdio call
+// made on an audio thread while it is inside a custom node's processNode,
+// with the call stack.
+//
+// What is intercepted:
+// - Android: malloc/calloc/realloc/free, operator new/delete,
+//   pthread_mutex_lock, std::mutex::lock, printf/puts/fprintf/fputs/fwrite
+//   and __android_log_print, through -Wl,--wrap on this library's own calls
+//   (which includes the std:: templates it instantiates)
+// - elsewhere (iOS, host builds): operator new/delete, which the standard
+//   lets a program replace; malloc, locks and stdio are not reachable there
+//   without a hooking library
+//
+// Audio threads are tracked in a small fixed table rather than thread_local,
+// which on older Android runtimes is emulated and allocates on first use.
+#ifndef CUSTOM_NODES_RT_CHECK
+#define CUSTOM_NODES_RT_CHECK 0
+#endif
+
+namespace audioapi {
+
+struct RtViolation {
+  std::string what;                 // "malloc", "pthread_mutex_lock", ...
+  std::string node;                 // innermost node kind in processNode
+  std::vector<std::string> stack;   // symbolized frames, innermost first
+};
+
+struct RtSafetyReport {
+  bool enabled = false;             // false when compiled without the checker
+  uint64_t total = 0;               // violations since start (or the last reset)
+  std::vector<RtViolation> recent;  // last rt::kRecentViolations, oldest first
+};
+
+namespace rt {
+
+constexpr int kMaxThreads = 16;          // audio thread plus voice render workers
+constexpr int kRecentViolations = 64;
+constexpr int kStackDepth = 16;
+
+#if CUSTOM_NODES_RT_CHECK
+
+// Marks the current thread as real-time until the scope ends. Nests.
+class Scope {
+public:
+  explicit Scope(const char *node);
+  ~Scope();
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  int slot_;
+  const char *outerNode_;
+};
+
+// Called by the interceptors; records a violation if the calling thread is
+// inside a Scope. Never allocates, locks or prints.
+void violation(const char *what);
+
+#define CUSTOM_NODES_RT_SCOPE(node) ::audioapi::rt::Scope rtScope_(node)
+
+#else
+
+#define CUSTOM_NODES_RT_SCOPE(node) ((void)0)
+
+#endif
+
+// JS thread. Symbolizes the recorded stacks.
+RtSafetyReport report();
+void reset();
+
+// Flush-to-zero and denormals-are-zero for the enclosing scope, restoring
+// the previous mode on exit. Recursive filters whose state decays towards
+// zero (the pink and brown noise filters) otherwise reach the denormal range,
+// where every multiply costs up to a hundred times more on many cores.
+// Always on: a checker build must not change the sound.
+class ScopedFlushDenormals {
+public:
+  ScopedFlushDenormals() {
+#if defined(__aarch64__)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    saved_ = fpcr;
+    fpcr |= (1ULL << 24);  // FZ
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#elif defined(__arm__) && defined(__ARM_FP)
+    uint32_t fpscr;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+    saved_ = fpscr;
+    fpscr |= (1U << 24);  // FZ
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"(fpscr));
+#elif defined(__x86_64__) || defined(__i386__)
+    saved_ = _mm_getcsr();
+    _mm_setcsr(static_cast<unsigned int>(saved_) | 0x8040);  // FTZ | DAZ
+#endif
+  }
+
+  ~ScopedFlushDenormals() {
+#if defined(__aarch64__)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(saved_));
+#elif defined(__arm__) && defined(__ARM_FP)
+    const uint32_t fpscr = static_cast<uint32_t>(saved_);
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"(fpscr));
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_setcsr(static_cast<unsigned int>(saved_));
+#endif
+  }
+
+  ScopedFlushDenormals(const ScopedFlushDenormals &) = delete;
+  ScopedFlushDenormals &operator=(const ScopedFlushDenormals &) = delete;
+
+private:
+  uint64_t saved_ = 0;
+};
+
+} // namespace rt
+} // namespace audioapi
@@ -0,0 +1,503 @@
+#include "SampleNode.h"
+#include "NativeLog.h"
+#include <audioapi/utils/AudioBus.h>
+#include <audioapi/utils/AudioArray.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace audioapi {
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+constexpr double kPrefetchIntervalSeconds = 0.5;
+constexpr double kPrefetchAheadSeconds = 2.0;
+
+// WAV is little-endian, as are all the platforms we ship on.
+uint16_t readU16(const uint8_t *p) {
+  uint16_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t readU32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Accept file:// URIs as handed out by the asset loaders.
+std::string filePathOf(const std::string &path) {
+  const std::string prefix = "file://";
+  return path.compare(0, prefix.size(), prefix) == 0 ? path.substr(prefix.size()) : path;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// MappedSample
+
+MappedSample::~MappedSample() {
+  if (base_ != nullptr) {
+    munmap(base_, size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+std::shared_ptr<MappedSample> MappedSample::open(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    CUSTOM_NODES_LOG_ERROR("SampleNode", "cannot open %s", path.c_str());
+    return nullptr;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < 44) {
+    close(fd);
+    return nullptr;
+  }
+
+  std::shared_ptr<MappedSample> sample(new MappedSample());
+  sample->fd_ = fd;
+  sample->size_ = static_cast<size_t>(info.st_size);
+  void *base = mmap(nullptr, sample->size_, PROT_READ, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+  sample->base_ = static_cast<uint8_t *>(base);
+
+  const uint8_t *bytes = sample->base_;
+  if (memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) {
+    CUSTOM_NODES_LOG_ERROR("SampleNode", "%s is not a WAV file", path.c_str());
+    return nullptr;
+  }
+
+  uint16_t format = 0;
+  uint16_t bitsPerSample = 0;
+  size_t dataSize = 0;
+  size_t offset = 12;
+  while (offset + 8 <= sample->size_) {
+    const uint8_t *chunk = bytes + offset;
+    const size_t chunkSize = readU32(chunk + 4);
+    const size_t available = std::min(chunkSize, sample->size_ - offset - 8);
+
+    if (memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+      format = readU16(chunk + 8);
+      sample->channels_ = readU16(chunk + 10);
+      sample->sampleRate_ = static_cast<float>(readU32(chunk + 12));
+      bitsPerSample = readU16(chunk + 22);
+      if (format == kFormatExtensible && available >= 26) {
+        format = readU16(chunk + 32);  // first two bytes of the SubFormat GUID
+      }
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      sample->data_ = chunk + 8;
+      dataSize = available;
+      break;
+    }
+    offset += 8 + chunkSize + (chunkSize & 1);
+  }
+
+  if (format == kFormatPcm && bitsPerSample == 16) {
+    sample->encoding_ = Encoding::Int16;
+  } else if (format == kFormatPcm && bitsPerSample == 24) {
+    sample->encoding_ = Encoding::Int24;
+  } else if (format == kFormatPcm && bitsPerSample == 32) {
+    sample->encoding_ = Encoding::Int32;
+  } else if (format == kFormatFloat && bitsPerSample == 32) {
+    sample->encoding_ = Encoding::Float32;
+  } else {
+    CUSTOM_NODES_LOG_ERROR("SampleNode", "unsupported WAV format %u/%u bits in %s",
+                           format, bitsPerSample, path.c_str());
+    return nullptr;
+  }
+  if (sample->data_ == nullptr || sample->channels_ <= 0 || sample->sampleRate_ <= 0.0f) {
+    CUSTOM_NODES_LOG_ERROR("SampleNode", "%s has no audio data", path.c_str());
+    return nullptr;
+  }
+
+  sample->bytesPerSample_ = bitsPerSample / 8;
+  sample->frames_ = static_cast<int64_t>(dataSize / (sample->bytesPerSample_ * sample->channels_));
+  if (sample->frames_ == 0) {
+    return nullptr;
+  }
+
+  // Make the first seconds resident so start is instant.
+  sample->prefetch(0, static_cast<int64_t>(kPrefetchAheadSeconds * sample->sampleRate_));
+  CUSTOM_NODES_LOG_INFO("SampleNode", "mapped %s (%lld frames, %d ch, %.0f Hz)", path.c_str(),
+                        static_cast<long long>(sample->frames_), sample->channels_, sample->sampleRate_);
+  return sample;
+}
+
+float MappedSample::sampleAt(int64_t frame, int channel) const {
+  frame = std::max<int64_t>(0, std::min(frame, frames_ - 1));
+  const uint8_t *p = data_ + (frame * channels_ + channel) * bytesPerSample_;
+  switch (encoding_) {
+    case Encoding::Int16: {
+      int16_t value;
+      memcpy(&value, p, sizeof(value));
+      return static_cast<float>(value) * (1.0f / 32768.0f);
+    }
+    case Encoding::Int24: {
+      // Assemble into the top of an int32 so the sign is kept.
+      const int32_t value = static_cast<int32_t>(
+          (static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) |
+          (static_cast<uint32_t>(p[2]) << 24));
+      return static_cast<float>(value) * (1.0f / 2147483648.0f);
+    }
+    case Encoding::Int32: {
+      int32_t value;
+      memcpy(&value, p, sizeof(value));
+      return static_cast<float>(value) * (1.0f / 2147483648.0f);
+    }
+    case Encoding::Float32: {
+      float value;
+      memcpy(&value, p, sizeof(value));
+      return value;
+    }
+  }
+  return 0.0f;
+}
+
+void MappedSample::prefetch(int64_t frame, int64_t count) const {
+  if (frame >= frames_ || count <= 0) {
+    return;
+  }
+  count = std::min(count, frames_ - frame);
+  const size_t frameBytes = static_cast<size_t>(bytesPerSample_ * channels_);
+  const uintptr_t pageMask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+  auto start = reinterpret_cast<uintptr_t>(data_ + frame * frameBytes);
+  auto end = reinterpret_cast<uintptr_t>(data_ + (frame + count) * frameBytes);
+  start &= ~pageMask;
+  madvise(reinterpret_cast<void *>(start), end - start, MADV_WILLNEED);
+}
+
+void MappedSample::touch(int64_t frame, int64_t count) const {
+  if (frame >= frames_ || count <= 0) {
+    return;
+  }
+  count = std::min(count, frames_ - frame);
+  const size_t frameBytes = static_cast<size_t>(bytesPerSample_ * channels_);
+  const size_t pageBytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const volatile uint8_t *start = data_ + frame * frameBytes;
+  const size_t bytes = static_cast<size_t>(count) * frameBytes;
+  for (size_t offset = 0; offset < bytes; offset += pageBytes) {
+    (void)start[offset];
+  }
+}
+
+// ---------------------------------------------------------------------------
+// SampleNode
+
+SampleNode::SampleNode(BaseAudioContext *context)
+    : AudioNode(context), _context(context) {
+  channelCount_ = 2;
+  channelCountMode_ = ChannelCountMode::EXPLICIT;
+  channelInterpretation_ = ChannelInterpretation::SPEAKERS;
+  modulation().addSignal("envelope");
+  modulation().addSignal("level");
+  modulation().addParam("volume", &volume);
+  modulation().addParam("playbackRate", &playbackRate);
+  isInitialized_ = true;
+}
+
+bool SampleNode::load(const std::string &path) {
+  const std::string filePath = filePathOf(path);
+  const bool mapped = filePath == samplePath_ && getFrames() > 0;
+  auto sample = mapped ? nullptr : MappedSample::open(filePath);
+  std::lock_guard<std::mutex> lock(sampleMutex_);
+  if (!mapped) {
+    // After the swap `sample` holds the previous mapping, which is unmapped
+    // when it goes out of scope here, on the calling thread.
+    sample_.swap(sample);
+    samplePath_ = sample_ ? filePath : std::string();
+  }
+  readIndex_ = 0;
+  readFraction_ = 0.0;
+  positionSeconds_ = 0.0;
+  nextPrefetchFrame_ = 0;
+  return sample_ != nullptr;
+}
+
+void SampleNode::prepareVoice() {
+  std::shared_ptr<MappedSample> sample;
+  {
+    std::lock_guard<std::mutex> lock(sampleMutex_);
+    sample = sample_;
+  }
+  if (!sample) {
+    return;
+  }
+  const auto ahead = static_cast<int64_t>(kPrefetchAheadSeconds * sample->sampleRate());
+  sample->touch(0, ahead);
+  if (loop && loopStart > 0) {
+    sample->touch(loopStart, ahead);
+  }
+}
+
+void SampleNode::resetVoice() {
+  loop = kSampleDefaults.loop != 0;
+  loopStart = 0;
+  loopEnd = 0;
+  loopCrossfade = kSampleDefaults.loopCrossfade;
+  playbackRate = kSampleDefaults.playbackRate;
+  volume = 0.25f;
+
+  shouldStart = false;
+  shouldPause = false;
+  shouldResume = false;
+  shouldStop = false;
+  isPaused = false;
+  isRunning_ = false;
+  currentGain_ = 0.0f;
+  startGain_ = 0.0f;
+  targetGain_ = 0.0f;
+  rampDuration_ = 1.5f;
+  rampElapsed_ = 0.0f;
+  isRamping_ = false;
+
+  std::lock_guard<std::mutex> lock(sampleMutex_);
+  readIndex_ = 0;
+  readFraction_ = 0.0;
+  positionSeconds_ = 0.0;
+  nextPrefetchFrame_ = 0;
+
+  glitches_.reset();
+  touchParams();
+}
+
+void SampleNode::applyParams(const SampleParams &params) {
+  const double rate = getFileSampleRate();
+  loop = params.loop != 0;
+  loopStart = static_cast<int64_t>(std::llround(params.loopStart * rate));
+  loopEnd = static_cast<int64_t>(std::llround(params.loopEnd * rate));
+  loopCrossfade = params.loopCrossfade;
+  playbackRate = params.playbackRate;
+  touchParams();
+}
+
+SampleParams SampleNode::getParams() {
+  const double rate = getFileSampleRate();
+  const auto seconds = [rate](int64_t frames) {
+    return rate > 0.0 ? static_cast<float>(static_cast<double>(frames) / rate) : 0.0f;
+  };
+  return {loop ? 1 : 0, seconds(loopStart), seconds(loopEnd), loopCrossfade, playbackRate};
+}
+
+bool SampleNode::isLoaded(const std::string &path) const {
+  return !samplePath_.empty() && filePathOf(path) == samplePath_;
+}
+
+int64_t SampleNode::getFrames() {
+  std::lock_guard<std::mutex> lock(sampleMutex_);
+  return sample_ ? sample_->frames() : 0;
+}
+
+int SampleNode::getChannels() {
+  std::lock_guard<std::mutex> lock(sampleMutex_);
+  return sample_ ? sample_->channels() : 0;
+}
+
+float SampleNode::getFileSampleRate() {
+  std::lock_guard<std::mutex> lock(sampleMutex_);
+  return sample_ ? sample_->sampleRate() : 0.0f;
+}
+
+float SampleNode::readInterpolated(int64_t index, float fraction, int channel) const {
+  const auto &sample = *sample_;
+  const float y0 = sample.sampleAt(index - 1, channel);
+  const float y1 = sample.sampleAt(index, channel);
+  if (fraction == 0.0f) {
+    return y1;  // unity rate at the file's sample rate: no interpolation
+  }
+  const float y2 = sample.sampleAt(index + 1, channel);
+  const float y3 = sample.sampleAt(index + 2, channel);
+
+  // 4-point, 3rd-order Hermite
+  const float c1 = 0.5f * (y2 - y0);
+  const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+  const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+  return ((c3 * fraction + c2) * fraction + c1) * fraction + y1;
+}
+
+void SampleNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) {
+  CUSTOM_NODES_RT_SCOPE("Sample");
+  // Recorded material may legitimately swing across its whole range
+  const float maxStep = 2.0f * volume;
+  GlitchDetector::Scope glitchScope(glitches_, bus, framesToProcess, _context->getSampleRate(), maxStep);
+  CUSTOM_NODES_DSP_SCOPE(dspLoad_, framesToProcess, _context->getSampleRate());
+  CUSTOM_NODES_TRACE_SCOPE("dsp", "Sample");
+
+  // Handle control flags
+  trace::commandsApplied(this, {CUSTOM_NODES_TRACE_FLAG(shouldStart),
+                                CUSTOM_NODES_TRACE_FLAG(shouldPause),
+                                CUSTOM_NODES_TRACE_FLAG(shouldResume),
+                                CUSTOM_NODES_TRACE_FLAG(shouldStop)});
+  if (shouldStart) {
+    shouldStart = false;
+    isRunning_ = true;
+    isPaused = false;
+    readIndex_ = 0;
+    readFraction_ = 0.0;
+    nextPrefetchFrame_ = 0;
+    // Start fade-in
+    startGain_ = 0.0f;
+    currentGain_ = 0.0f;
+    targetGain_ = 1.0f;
+    rampDuration_ = 1.5f;
+    rampElapsed_ = 0.0f;
+    isRamping_ = true;
+  }
+  if (shouldStop) {
+    shouldStop = false;
+    startGain_ = currentGain_;
+    targetGain_ = 0.0f;
+    rampDuration_ = 1.5f;
+    rampElapsed_ = 0.0f;
+    isRamping_ = true;
+  }
+  if (shouldPause) {
+    shouldPause = false;
+    isPaused = true;
+    startGain_ = currentGain_;
+    targetGain_ = 0.0f;
+    rampDuration_ = 0.5f;
+    rampElapsed_ = 0.0f;
+    isRamping_ = true;
+  }
+  if (shouldResume) {
+    shouldResume = false;
+    isPaused = false;
+    startGain_ = currentGain_;
+    targetGain_ = 1.0f;
+    rampDuration_ = 0.5f;
+    rampElapsed_ = 0.0f;
+    isRamping_ = true;
+  }
+
+  bus->zero();
+  if (!isRunning_ || (isPaused && !isRamping_)) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(sampleMutex_, std::try_to_lock);
+  if (!lock.owns_lock() || !sample_) {
+    return;
+  }
+  const auto &sample = *sample_;
+  const int64_t frames = sample.frames();
+  const float fileRate = sample.sampleRate();
+  const double step = static_cast<double>(fileRate) / _context->getSampleRate() *
+                      std::max(0.0f, playbackRate);
+
+  // Loop region, resolved once per quantum since JS may move it at any time.
+  const int64_t start = std::max<int64_t>(0, std::min(loopStart, frames - 1));
+  const int64_t end = loopEnd > 0 ? std::min(loopEnd, frames) : frames;
+  const bool looping = loop && end - start > 1;
+  const int64_t crossfade = looping
+      ? std::min(static_cast<int64_t>(std::max(0.0f, loopCrossfade) * fileRate), (end - start) / 2)
+      : 0;
+  const int64_t fadeStart = end - crossfade;
+
+  if (const uint64_t seek = takePendingSeek(); seek > 0 && !isPaused) {
+    // Catch up with a replay the mixer falls back from, through the loop
+    // region as it is now. The mixer fades the voice in, so the start ramp
+    // is past as well.
+    rampElapsed_ += static_cast<float>(static_cast<double>(seek) / _context->getSampleRate());
+    double position = static_cast<double>(readIndex_) + readFraction_ + step * static_cast<double>(seek);
+    if (looping && position >= end) {
+      position = start + crossfade + std::fmod(position - end, static_cast<double>(end - start - crossfade));
+    } else if (!looping && position >= frames) {
+      isRunning_ = false;  // the replay had played it to the end
+      return;
+    }
+    readIndex_ = static_cast<int64_t>(position);
+    readFraction_ = position - static_cast<double>(readIndex_);
+    nextPrefetchFrame_ = readIndex_;
+  }
+
+  if (readIndex_ >= nextPrefetchFrame_) {
+    const auto ahead = static_cast<int64_t>(kPrefetchAheadSeconds * fileRate);
+    sample.prefetch(readIndex_, ahead);
+    if (looping && readIndex_ + ahead >= fadeStart) {
+      sample.prefetch(start, ahead);
+    }
+    nextPrefetchFrame_ = readIndex_ + static_cast<int64_t>(kPrefetchIntervalSeconds * fileRate);
+  }
+
+  float *left = bus->getChannel(0)->getData();
+  float *right = bus->getChannel(1)->getData();
+  const int rightSource = sample.channels() > 1 ? 1 : 0;
+  const float frameDuration = 1.0f / _context->getSampleRate();
+
+  for (int i = 0; i < framesToProcess; ++i) {
+    // Update volume ramping
+    if (isRamping_) {
+      rampElapsed_ += frameDuration;
+      float t = rampElapsed_ / rampDuration_;
+      if (t >= 1.0f) {
+        currentGain_ = targetGain_;
+        isRamping_ = false;
+        if (targetGain_ == 0.0f && !isPaused) {
+          isRunning_ = false;  // stop fade-out finished
+          break;
+        }
+      } else {
+        currentGain_ = startGain_ + (targetGain_ - startGain_) * t;
+      }
+    }
+
+    if (!looping && readIndex_ >= frames) {
+      isRunning_ = false;  // played to the end
+      break;
+    }
+
+    const auto fraction = static_cast<float>(readFraction_);
+    float l = readInterpolated(readIndex_, fraction, 0);
+    float r = rightSource == 0 ? l : readInterpolated(readIndex_, fraction, rightSource);
+
+    if (crossfade > 0 && readIndex_ >= fadeStart && readIndex_ < end) {
+      // Equal-power blend of the loop's tail into its head; after the jump
+      // playback continues from loopStart + crossfade.
+      const int64_t headIndex = start + (readIndex_ - fadeStart);
+      const float t = (static_cast<float>(readIndex_ - fadeStart) + fraction) / static_cast<float>(crossfade);
+      const float tailGain = std::sqrt(1.0f - t);
+      const float headGain = std::sqrt(t);
+      const float headL = readInterpolated(headIndex, fraction, 0);
+      const float headR = rightSource == 0 ? headL : readInterpolated(headIndex, fraction, rightSource);
+      l = l * tailGain + headL * headGain;
+      r = r * tailGain + headR * headGain;
+    }
+
+    const float gain = volume * currentGain_;
+    left[i] = l * gain;
+    right[i] = r * gain;
+
+    // Advance the read position; the integer part stays exact so loop
+    // points land on the sample.
+    if (!isPaused || isRamping_) {
+      readFraction_ += step;
+      const auto whole = static_cast<int64_t>(readFraction_);
+      readIndex_ += whole;
+      readFraction_ -= static_cast<double>(whole);
+      if (looping && readIndex_ >= end) {
+        readIndex_ = start + crossfade + (readIndex_ - end);
+      }
+    }
+  }
+
+  positionSeconds_ = static_cast<double>(readIndex_) / fileRate;
+  modulation().publish(kEnvelopeSignal, currentGain_);
+  modulation().publish(kLevelSignal, volume * currentGain_);
+}
+
+} // namespace audioapi
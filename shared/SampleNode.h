@@ -0,0 +1,139 @@
+#pragma once
+#include <audioapi/core/AudioNode.h>
+#include <audioapi/core/BaseAudioContext.h>
+#include "VoiceRenderer.h"
+#include "VoiceParams.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace audioapi {
+
+// A WAV file mapped read-only into memory. Samples are converted to float as
+// they are read from the mapped pages; the file is never copied to the heap.
+// Supports PCM 16/24/32-bit integer and 32-bit float, any channel count.
+class MappedSample {
+public:
+  ~MappedSample();
+
+  // Returns nullptr if the file cannot be opened or is not a supported WAV.
+  static std::shared_ptr<MappedSample> open(const std::string &path);
+
+  int64_t frames() const { return frames_; }
+  int channels() const { return channels_; }
+  float sampleRate() const { return sampleRate_; }
+
+  // Frame is clamped to the file; channel must be < channels().
+  float sampleAt(int64_t frame, int channel) const;
+
+  // Starts asynchronous read-ahead of [frame, frame + count). Does not block.
+  void prefetch(int64_t frame, int64_t count) const;
+
+  // Reads the pages of [frame, frame + count) in now, on the calling thread.
+  // Blocks on I/O, so background threads only.
+  void touch(int64_t frame, int64_t count) const;
+
+private:
+  enum class Encoding { Int16, Int24, Int32, Float32 };
+
+  MappedSample() = default;
+
+  int fd_ = -1;
+  uint8_t *base_ = nullptr;
+  size_t size_ = 0;
+  const uint8_t *data_ = nullptr;  // first byte of the data chunk
+  Encoding encoding_ = Encoding::Int16;
+  int bytesPerSample_ = 2;
+  int channels_ = 0;
+  int64_t frames_ = 0;
+  float sampleRate_ = 0.0f;
+};
+
+// "Sample" voice: plays a WAV asset straight from its memory mapping, with
+// sample-accurate loop points, a crossfaded loop seam and resampling from
+// the file's rate to the context's rate (4-point Hermite interpolation).
+class SampleNode : public AudioNode, public VoiceRenderer {
+public:
+  explicit SampleNode(BaseAudioContext *context);
+  ~SampleNode() override = default;
+
+  void processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override;
+  void renderVoice(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override {
+    processNode(bus, framesToProcess);
+  }
+  // Keeps the mapped file, so that loading it again is free
+  void resetVoice() override;
+  // Reads in the pages played first: the start and the loop start
+  void prepareVoice() override;
+
+  // Called from the JS thread. Maps the file and rewinds; the previous
+  // mapping (if any) is released here rather than on the audio thread.
+  // Loading the file that is already mapped only rewinds.
+  bool load(const std::string &path);
+  // Sets the preset parameters, as decoded from a binary preset. Loop points
+  // are converted with the file's sample rate: call it after load().
+  void applyParams(const SampleParams &params);
+  // The current preset parameters, as applyParams() takes them
+  SampleParams getParams();
+  // Whether path (as given to load()) is the file mapped now
+  bool isLoaded(const std::string &path) const;
+
+  int64_t getFrames();
+  int getChannels();
+  float getFileSampleRate();
+  double getPositionSeconds() const { return positionSeconds_; }
+
+  // Loop points in file frames. loopEnd <= 0 means the end of the file.
+  bool loop = kSampleDefaults.loop != 0;
+  int64_t loopStart = 0;
+  int64_t loopEnd = 0;
+  float loopCrossfade = kSampleDefaults.loopCrossfade; // seconds, clamped to half the loop
+  float playbackRate = kSampleDefaults.playbackRate;
+  float volume = 0.25f;
+
+  // Control flags
+  bool shouldStart = false;
+  bool shouldPause = false;
+  bool shouldResume = false;
+  bool shouldStop = false;
+  bool isPaused = false;
+
+private:
+  float readInterpolated(int64_t index, float fraction, int channel) const;
+
+  BaseAudioContext *_context;
+
+  // Held by the JS thread while swapping sample_; the audio thread only
+  // try_locks it and outputs silence for the quantum if it is busy.
+  std::mutex sampleMutex_;
+  std::shared_ptr<MappedSample> sample_;
+  std::string samplePath_;  // file of sample_, JS thread only
+
+  int64_t readIndex_ = 0;     // integer part of the read position, file frames
+  double readFraction_ = 0.0;
+  double positionSeconds_ = 0.0;
+  int64_t nextPrefetchFrame_ = 0;
+
+  // Modulation signals, in the order they are declared to modulation():
+  // envelope (start/stop ramp), level (volume * envelope)
+  enum ModulationSignal { kEnvelopeSignal, kLevelSignal };
+
+  DspLoadMeter dspLoad_{"Sample"};
+  GlitchDetector glitches_{"Sample"};
+
+  bool isRunning_ = false;
+  float currentGain_ = 0.0f;
+  float startGain_ = 0.0f;
+  float targetGain_ = 0.0f;
+  float rampDuration_ = 1.5f;
+  float rampElapsed_ = 0.0f;
+  bool isRamping_ = false;
+};
+
+} // namespace audioapi
@@ -0,0 +1,146 @@
+#pragma once
+#include "SampleNode.h"
+#include "VoiceRenderer.h"
+#include <audioapi/HostObjects/AudioNodeHostObject.h>
+#include <jsi/jsi.h>
+
+using namespace facebook;
+
+namespace audioapi {
+
+class SampleNodeHostObject : public AudioNodeHostObject, public VoiceHostObject {
+public:
+  explicit SampleNodeHostObject(const std::shared_ptr<SampleNode> &node)
+      : AudioNodeHostObject(node), node_(node) {}
+
+  jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    trace::Scope traceScope("jsi", "Sample.get", node_.get());
+    auto propName = propNameId.utf8(runtime);
+
+    if (propName == "volume") {
+      return jsi::Value(static_cast<double>(node_->volume));
+    }
+    if (propName == "loop") {
+      return jsi::Value(node_->loop);
+    }
+    if (propName == "loopStart") {
+      return jsi::Value(static_cast<double>(node_->loopStart));
+    }
+    if (propName == "loopEnd") {
+      return jsi::Value(static_cast<double>(node_->loopEnd));
+    }
+    if (propName == "loopCrossfade") {
+      return jsi::Value(static_cast<double>(node_->loopCrossfade));
+    }
+    if (propName == "playbackRate") {
+      return jsi::Value(static_cast<double>(node_->playbackRate));
+    }
+    if (propName == "frames") {
+      return jsi::Value(static_cast<double>(node_->getFrames()));
+    }
+    if (propName == "channels") {
+      return jsi::Value(node_->getChannels());
+    }
+    if (propName == "fileSampleRate") {
+      return jsi::Value(static_cast<double>(node_->getFileSampleRate()));
+    }
+    if (propName == "position") {
+      return jsi::Value(node_->getPositionSeconds());
+    }
+    if (propName == "isPaused") {
+      return jsi::Value(node_->isPaused);
+    }
+    if (propName == "shouldStart") {
+      return jsi::Value(node_->shouldStart);
+    }
+    if (propName == "shouldPause") {
+      return jsi::Value(node_->shouldPause);
+    }
+    if (propName == "shouldResume") {
+      return jsi::Value(node_->shouldResume);
+    }
+    if (propName == "shouldStop") {
+      return jsi::Value(node_->shouldStop);
+    }
+    if (propName == "load") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "load"),
+        1,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          if (count == 0 || !arguments[0].isString()) {
+            return jsi::Value(false);
+          }
+          bool loaded = node_->load(arguments[0].asString(runtime).utf8(runtime));
+          node_->touchParams();
+          return jsi::Value(loaded);
+        });
+    }
+
+    return AudioNodeHostObject::get(runtime, propNameId);
+  }
+
+  void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    trace::Scope traceScope("jsi", "Sample.set", node_.get());
+    auto propName = propNameId.utf8(runtime);
+    trace::commandQueued(propName, value.isBool() && value.getBool(), node_.get());
+
+    if (propName == "volume") {
+      node_->volume = static_cast<float>(value.asNumber());
+      node_->touchParams();
+      return;
+    }
+    if (propName == "loop") {
+      node_->loop = value.asBool();
+      node_->touchParams();
+      return;
+    }
+    if (propName == "loopStart") {
+      node_->loopStart = static_cast<int64_t>(value.asNumber());
+      node_->touchParams();
+      return;
+    }
+    if (propName == "loopEnd") {
+      node_->loopEnd = static_cast<int64_t>(value.asNumber());
+      node_->touchParams();
+      return;
+    }
+    if (propName == "loopCrossfade") {
+      node_->loopCrossfade = static_cast<float>(value.asNumber());
+      node_->touchParams();
+      return;
+    }
+    if (propName == "playbackRate") {
+      node_->playbackRate = static_cast<float>(value.asNumber());
+      node_->touchParams();
+      return;
+    }
+    if (propName == "shouldStart") {
+      node_->shouldStart = value.asBool();
+      return;
+    }
+    if (propName == "shouldPause") {
+      node_->shouldPause = value.asBool();
+      return;
+    }
+    if (propName == "shouldResume") {
+      node_->shouldResume = value.asBool();
+      return;
+    }
+    if (propName == "shouldStop") {
+      node_->shouldStop = value.asBool();
+      return;
+    }
+
+    AudioNodeHostObject::set(runtime, propNameId, value);
+  }
+
+  std::shared_ptr<VoiceRenderer> getVoiceRenderer() const override {
+    return node_;
+  }
+
+private:
+  std::shared_ptr<SampleNode> node_;
+};
+
+} // namespace audioapi
@@ -0,0 +1,448 @@
+#include "SessionRenderCache.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace audioapi {
+
+namespace {
+
+constexpr uint32_t kFormatVersion = 1;
+constexpr const char *kExtension = ".pcm";
+
+uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+int64_t nowSeconds() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// RenderedSession
+
+RenderedSession::~RenderedSession() {
+  if (base_ != nullptr) {
+    munmap(base_, size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void RenderedSession::prefetch(uint64_t frame, uint64_t count) const {
+  const uint64_t frames = header_->frames;
+  if (frame >= frames) {
+    return;
+  }
+  count = std::min(count, frames - frame);
+  const uintptr_t pageMask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+  for (int c = 0; c < channels(); ++c) {
+    auto start = reinterpret_cast<uintptr_t>(channelData(c) + frame);
+    auto end = reinterpret_cast<uintptr_t>(channelData(c) + frame + count);
+    start &= ~pageMask;
+    madvise(reinterpret_cast<void *>(start), end - start, MADV_WILLNEED);
+  }
+}
+
+void RenderedSession::touch(uint64_t frame, uint64_t count) const {
+  const uint64_t frames = header_->frames;
+  if (frame >= frames) {
+    return;
+  }
+  count = std::min(count, frames - frame);
+  const uint64_t pageFloats = static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) / sizeof(float);
+  for (int c = 0; c < channels(); ++c) {
+    volatile float *data = channelData(c);
+    for (uint64_t i = frame; i < frame + count; i += pageFloats) {
+      if (writable_) {
+        data[i] = 0.0f;
+      } else {
+        (void)data[i];
+      }
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// RecordingWriter
+
+RecordingWriter::RecordingWriter(std::shared_ptr<RenderedSession> session)
+    : session_(std::move(session)),
+      frames_(session_->frames()),
+      channels_(session_->channels()) {
+  ring_.assign(static_cast<size_t>(channels_) * kRingFrames, 0.0f);
+  controls_.assign(kRingBlocks, 0.0f);
+  thread_ = std::thread(&RecordingWriter::writerLoop, this);
+}
+
+RecordingWriter::~RecordingWriter() {
+  finish();
+}
+
+bool RecordingWriter::write(const float *const *channels, int channelCount, int frames, float animation) {
+  const uint64_t position = written_.load(std::memory_order_relaxed);
+  frames = static_cast<int>(std::min<uint64_t>(frames, frames_ - position));
+  if (frames <= 0 || position + frames - copied_.load(std::memory_order_acquire) > kRingFrames) {
+    return false;
+  }
+  const int start = static_cast<int>(position & (kRingFrames - 1));
+  const int first = std::min(frames, kRingFrames - start);
+  for (int c = 0; c < channels_; ++c) {
+    float *plane = ring_.data() + static_cast<size_t>(c) * kRingFrames;
+    if (c < channelCount) {
+      memcpy(plane + start, channels[c], first * sizeof(float));
+      memcpy(plane, channels[c] + first, (frames - first) * sizeof(float));
+    } else {
+      memset(plane + start, 0, first * sizeof(float));
+      memset(plane, 0, (frames - first) * sizeof(float));
+    }
+  }
+  const uint64_t lastBlock = (position + frames - 1) / RenderedSession::kControlBlock;
+  for (uint64_t b = position / RenderedSession::kControlBlock; b <= lastBlock; ++b) {
+    controls_[b % kRingBlocks] = animation;
+  }
+  written_.store(position + frames, std::memory_order_release);
+  return true;
+}
+
+uint64_t RecordingWriter::finish() {
+  if (thread_.joinable()) {
+    quit_.store(true, std::memory_order_relaxed);
+    thread_.join();
+    drain(true);
+  }
+  return copied_.load(std::memory_order_relaxed);
+}
+
+void RecordingWriter::writerLoop() {
+  while (!quit_.load(std::memory_order_relaxed)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kFlushIntervalMs));
+    drain(false);
+  }
+}
+
+void RecordingWriter::drain(bool last) {
+  const uint64_t target = written_.load(std::memory_order_acquire);
+  uint64_t position = copied_.load(std::memory_order_relaxed);
+  while (position < target) {
+    const int start = static_cast<int>(position & (kRingFrames - 1));
+    const int count = static_cast<int>(std::min<uint64_t>(target - position, kRingFrames - start));
+    for (int c = 0; c < channels_; ++c) {
+      memcpy(session_->channelData(c) + position, ring_.data() + static_cast<size_t>(c) * kRingFrames + start,
+             count * sizeof(float));
+    }
+    position += count;
+  }
+
+  // A control block is final once the quanta past it have started
+  const uint64_t blocks = last || target == frames_
+      ? RenderedSession::controlCountFor(target)
+      : target / RenderedSession::kControlBlock;
+  float *control = session_->controlData();
+  for (; controlsCopied_ < blocks; ++controlsCopied_) {
+    control[controlsCopied_] = controls_[controlsCopied_ % kRingBlocks];
+  }
+
+  copied_.store(position, std::memory_order_release);
+  if (position == frames_ && !session_->isComplete()) {
+    session_->markComplete();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// SessionRenderCache
+
+SessionRenderCache::SessionRenderCache() : directory_(defaultDirectory()) {}
+
+SessionRenderCache &SessionRenderCache::shared() {
+  static SessionRenderCache cache;
+  return cache;
+}
+
+std::string appCacheDirectory() {
+#if defined(__APPLE__)
+  if (const char *home = getenv("HOME")) {
+    return std::string(home) + "/Library/Caches";
+  }
+#elif defined(__ANDROID__)
+  // The app's private cache dir is /data/data/<package>/cache; the package
+  // name is the process name (minus any ":service" suffix).
+  if (FILE *file = fopen("/proc/self/cmdline", "r")) {
+    char name[256] = {0};
+    size_t length = fread(name, 1, sizeof(name) - 1, file);
+    fclose(file);
+    name[length] = '\0';
+    if (char *colon = strchr(name, ':')) {
+      *colon = '\0';
+    }
+    if (name[0] != '\0') {
+      return std::string("/data/data/") + name + "/cache";
+    }
+  }
+#endif
+  return "";
+}
+
+std::string SessionRenderCache::defaultDirectory() {
+  const std::string cache = appCacheDirectory();
+  return cache.empty() ? cache : cache + "/RenderedSessions";
+}
+
+uint64_t SessionRenderCache::makeKey(const std::string &descriptor, double durationSeconds,
+                                     float sampleRate, uint32_t seed) {
+  uint64_t hash = 14695981039346656037ull;
+  hash = fnv1a(hash, &kRenderVersion, sizeof(kRenderVersion));
+  hash = fnv1a(hash, descriptor.data(), descriptor.size());
+  hash = fnv1a(hash, &durationSeconds, sizeof(durationSeconds));
+  hash = fnv1a(hash, &sampleRate, sizeof(sampleRate));
+  hash = fnv1a(hash, &seed, sizeof(seed));
+  return hash;
+}
+
+void SessionRenderCache::configure(const std::string &directory, uint64_t maxBytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!directory.empty() && directory != directory_) {
+    directory_ = directory;
+    scanned_ = false;
+    entries_.clear();
+  }
+  if (maxBytes > 0) {
+    maxBytes_ = maxBytes;
+  }
+  scanDirectory();
+  evictFor(0);
+}
+
+std::string SessionRenderCache::getDirectory() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return directory_;
+}
+
+uint64_t SessionRenderCache::getMaxBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return maxBytes_;
+}
+
+uint64_t SessionRenderCache::getUsedBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  scanDirectory();
+  uint64_t used = 0;
+  for (const auto &entry : entries_) {
+    used += entry.bytes;
+  }
+  return used;
+}
+
+std::string SessionRenderCache::pathFor(uint64_t key) const {
+  char name[32];
+  snprintf(name, sizeof(name), "/%016" PRIx64, key);
+  return directory_ + name + kExtension;
+}
+
+void SessionRenderCache::scanDirectory() {
+  if (scanned_ || directory_.empty()) {
+    return;
+  }
+  scanned_ = true;
+  mkdir(directory_.c_str(), 0755);
+
+  DIR *dir = opendir(directory_.c_str());
+  if (dir == nullptr) {
+    return;
+  }
+  while (dirent *item = readdir(dir)) {
+    std::string name = item->d_name;
+    std::string path = directory_ + "/" + name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+      unlink(path.c_str()); // recording interrupted by a crash or kill
+      continue;
+    }
+    uint64_t key = 0;
+    if (sscanf(name.c_str(), "%" SCNx64, &key) != 1 || name.find(kExtension) == std::string::npos) {
+      continue;
+    }
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+      entries_.push_back({key, static_cast<uint64_t>(info.st_size), static_cast<int64_t>(info.st_mtime)});
+    }
+  }
+  closedir(dir);
+}
+
+void SessionRenderCache::evictFor(uint64_t bytesNeeded) {
+  uint64_t used = 0;
+  for (const auto &entry : entries_) {
+    used += entry.bytes;
+  }
+  // Least recently replayed first.
+  std::sort(entries_.begin(), entries_.end(),
+            [](const Entry &a, const Entry &b) { return a.lastUsed < b.lastUsed; });
+  auto it = entries_.begin();
+  while (it != entries_.end() && used + bytesNeeded > maxBytes_) {
+    unlink(pathFor(it->key).c_str());
+    used -= it->bytes;
+    it = entries_.erase(it);
+  }
+}
+
+std::shared_ptr<RenderedSession> SessionRenderCache::openForReplay(uint64_t key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (directory_.empty()) {
+    return nullptr;
+  }
+  scanDirectory();
+
+  std::string path = pathFor(key);
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(RenderedSession::Header)) {
+    close(fd);
+    return nullptr;
+  }
+
+  std::shared_ptr<RenderedSession> session(new RenderedSession());
+  session->path_ = path;
+  session->fd_ = fd;
+  session->size_ = static_cast<size_t>(info.st_size);
+  void *base = mmap(nullptr, session->size_, PROT_READ, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+  session->base_ = static_cast<uint8_t *>(base);
+  session->header_ = reinterpret_cast<RenderedSession::Header *>(base);
+
+  const auto *header = session->header_;
+  const uint64_t expectedSize = RenderedSession::fileSizeFor(header->frames, static_cast<int>(header->channels));
+  if (memcmp(header->magic, "CNRS", 4) != 0 || header->version != kFormatVersion ||
+      header->key != key || header->complete == 0 ||
+      header->controlBlock != RenderedSession::kControlBlock || expectedSize != session->size_) {
+    session.reset();
+    unlink(path.c_str());
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [key](const Entry &e) { return e.key == key; }),
+                   entries_.end());
+    return nullptr;
+  }
+
+  madvise(session->base_, session->size_, MADV_SEQUENTIAL);
+  session->prefetch(0, static_cast<uint64_t>(header->sampleRate) * 4);
+
+  // Replaying counts as a use for LRU purposes.
+  futimens(fd, nullptr);
+  for (auto &entry : entries_) {
+    if (entry.key == key) {
+      entry.lastUsed = nowSeconds();
+    }
+  }
+  return session;
+}
+
+std::shared_ptr<RenderedSession> SessionRenderCache::beginRecording(
+    uint64_t key, uint64_t frames, int channels, float sampleRate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (directory_.empty() || frames == 0 || channels <= 0) {
+    return nullptr;
+  }
+  scanDirectory();
+
+  const uint64_t bytes = RenderedSession::fileSizeFor(frames, channels);
+  if (bytes > maxBytes_) {
+    return nullptr;
+  }
+  evictFor(bytes);
+
+  std::string path = pathFor(key) + ".tmp";
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return nullptr;
+  }
+  if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    close(fd);
+    unlink(path.c_str());
+    return nullptr;
+  }
+
+  std::shared_ptr<RenderedSession> session(new RenderedSession());
+  session->path_ = path;
+  session->writable_ = true;
+  session->fd_ = fd;
+  session->size_ = static_cast<size_t>(bytes);
+  void *base = mmap(nullptr, session->size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    session.reset();
+    unlink(path.c_str());
+    return nullptr;
+  }
+  session->base_ = static_cast<uint8_t *>(base);
+  session->header_ = reinterpret_cast<RenderedSession::Header *>(base);
+
+  auto *header = session->header_;
+  memcpy(header->magic, "CNRS", 4);
+  header->version = kFormatVersion;
+  header->key = key;
+  header->frames = frames;
+  header->channels = static_cast<uint32_t>(channels);
+  header->sampleRate = sampleRate;
+  header->complete = 0;
+  header->controlBlock = RenderedSession::kControlBlock;
+  madvise(session->base_, session->size_, MADV_SEQUENTIAL);
+  return session;
+}
+
+void SessionRenderCache::commit(const std::shared_ptr<RenderedSession> &session) {
+  if (!session || !session->writable_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  session->writable_ = false;
+
+  const uint64_t key = session->key();
+  if (!session->isComplete()) {
+    unlink(session->path_.c_str());
+    return;
+  }
+
+  msync(session->base_, session->size_, MS_ASYNC);
+  std::string finalPath = pathFor(key);
+  if (rename(session->path_.c_str(), finalPath.c_str()) != 0) {
+    unlink(session->path_.c_str());
+    return;
+  }
+  session->path_ = finalPath;
+  entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                [key](const Entry &e) { return e.key == key; }),
+                 entries_.end());
+  entries_.push_back({key, session->size_, nowSeconds()});
+}
+
+void SessionRenderCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  scanDirectory();
+  for (const auto &entry : entries_) {
+    unlink(pathFor(entry.key).c_str());
+  }
+  entries_.clear();
+}
+
+} // namespace audioapi
@@ -0,0 +1,195 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audioapi {
+
+// One fully rendered session stored as planar float32 PCM in a file that is
+// memory-mapped for its whole lifetime. Channel c of frame i lives at
+// channelData(c)[i], so replay is a memcpy from the mapping into the bus.
+//
+// File layout: 64-byte Header, then `channels` planes of `frames` floats, then
+// a control plane with one float per `controlBlock` frames (the Martigli
+// animation value, so the UI keeps breathing while a session is replayed).
+class RenderedSession {
+public:
+  static constexpr uint32_t kControlBlock = 128;
+
+  struct Header {
+    char magic[4];          // "CNRS"
+    uint32_t version;
+    uint64_t key;
+    uint64_t frames;
+    uint32_t channels;
+    float sampleRate;
+    uint32_t complete;      // set once every frame has been written
+    uint32_t controlBlock;
+    uint8_t reserved[24];
+  };
+  static_assert(sizeof(Header) == 64, "RenderedSession::Header must stay 64 bytes");
+
+  ~RenderedSession();
+
+  uint64_t key() const { return header_->key; }
+  uint64_t frames() const { return header_->frames; }
+  int channels() const { return static_cast<int>(header_->channels); }
+  float sampleRate() const { return header_->sampleRate; }
+  bool isComplete() const { return header_->complete != 0; }
+
+  float *channelData(int channel) const {
+    return reinterpret_cast<float *>(base_ + sizeof(Header)) + channel * header_->frames;
+  }
+  float *controlData() const { return channelData(channels()); }
+  uint64_t controlCount() const { return controlCountFor(header_->frames); }
+
+  static uint64_t controlCountFor(uint64_t frames) {
+    return (frames + kControlBlock - 1) / kControlBlock;
+  }
+  static uint64_t fileSizeFor(uint64_t frames, int channels) {
+    return sizeof(Header) + (frames * channels + controlCountFor(frames)) * sizeof(float);
+  }
+
+  // Recording only, by its RecordingWriter. Flags the file as complete; it is
+  // moved into place by SessionRenderCache::commit() on a non-audio thread.
+  void markComplete() { header_->complete = 1; }
+
+  // Starts asynchronous read-ahead of [frame, frame + count). Does not block.
+  void prefetch(uint64_t frame, uint64_t count) const;
+
+  // Faults [frame, frame + count) in now, on the calling thread: reads the
+  // pages of a replay, writes (the zeros they already hold into) the pages
+  // of a recording. Blocks on I/O, so background threads only.
+  void touch(uint64_t frame, uint64_t count) const;
+
+private:
+  friend class SessionRenderCache;
+  RenderedSession() = default;
+
+  std::string path_;
+  bool writable_ = false;
+  int fd_ = -1;
+  uint8_t *base_ = nullptr;
+  size_t size_ = 0;
+  Header *header_ = nullptr;
+};
+
+// Moves a recording from the audio thread into its RenderedSession. The
+// audio thread only copies each quantum into a preallocated ring; a
+// background thread copies the ring into the mapping every
+// kFlushIntervalMs, so the page faults of first writes land there. The
+// session is marked complete once its last frame is in the file.
+class RecordingWriter {
+public:
+  static constexpr int kRingFrames = 1 << 16;  // 1.4 s at 48 kHz
+  static constexpr int kFlushIntervalMs = 20;
+
+  // JS thread; starts the writer thread
+  explicit RecordingWriter(std::shared_ptr<RenderedSession> session);
+  ~RecordingWriter();
+
+  RecordingWriter(const RecordingWriter &) = delete;
+  RecordingWriter &operator=(const RecordingWriter &) = delete;
+
+  // Audio thread. Appends frames of each channel (channels the session has
+  // beyond channelCount are zero) and the Martigli animation value of the
+  // quantum. Returns false, dropping them, if the writer has fallen a whole
+  // ring behind: the recording is then incomplete.
+  bool write(const float *const *channels, int channelCount, int frames, float animation);
+
+  // Not the audio thread, after the last write(): copies what is left, ends
+  // the writer thread and returns the frames in the file.
+  uint64_t finish();
+
+  const std::shared_ptr<RenderedSession> &session() const { return session_; }
+
+private:
+  static constexpr int kRingBlocks = 2 * kRingFrames / RenderedSession::kControlBlock;
+
+  void writerLoop();
+  // Copies the ring up to the frames written so far; `last`: also the final,
+  // partial control block
+  void drain(bool last);
+
+  std::shared_ptr<RenderedSession> session_;
+  std::vector<float> ring_;      // channels planes of kRingFrames
+  std::vector<float> controls_;  // kRingBlocks control values
+  uint64_t frames_ = 0;          // session length, frames
+  int channels_ = 0;
+  alignas(64) std::atomic<uint64_t> written_{0};  // audio thread
+  alignas(64) std::atomic<uint64_t> copied_{0};   // writer thread
+  uint64_t controlsCopied_ = 0;                   // blocks, writer thread
+  std::atomic<bool> quit_{false};
+  std::thread thread_;
+};
+
+// The app's private cache directory (no trailing slash), or "" off device
+std::string appCacheDirectory();
+
+// Directory of rendered sessions keyed by a hash of what produced them, with
+// a total size limit enforced by evicting the least recently replayed files.
+//
+// All methods are for the JS thread (or a background thread); none of them
+// may be called from processNode.
+class SessionRenderCache {
+public:
+  static constexpr uint64_t kDefaultMaxBytes = 1024ull * 1024ull * 1024ull;
+
+  static SessionRenderCache &shared();
+
+  // Part of every key. Bump it with any change to what a voice or the mixer
+  // renders for the same preset (DSP, defaults, fast math, seeding), so that
+  // files recorded by an older build are never replayed; they age out of
+  // the cache like any other.
+  static constexpr uint32_t kRenderVersion = 1;
+
+  // Hash of everything that determines the rendered audio: `descriptor` is a
+  // canonical serialization of the preset voices supplied by JS, and
+  // kRenderVersion stands for the code that renders them.
+  static uint64_t makeKey(const std::string &descriptor, double durationSeconds,
+                          float sampleRate, uint32_t seed);
+
+  void configure(const std::string &directory, uint64_t maxBytes);
+  std::string getDirectory();
+  uint64_t getMaxBytes();
+  uint64_t getUsedBytes();
+
+  // Maps a complete cached session for reading, or returns nullptr.
+  std::shared_ptr<RenderedSession> openForReplay(uint64_t key);
+
+  // Creates and maps a temporary file sized for the whole session, evicting
+  // older sessions to stay under the size limit. nullptr if it cannot fit.
+  std::shared_ptr<RenderedSession> beginRecording(uint64_t key, uint64_t frames,
+                                                  int channels, float sampleRate);
+
+  // Publishes a finished recording, or deletes it if it is incomplete.
+  void commit(const std::shared_ptr<RenderedSession> &session);
+
+  void clear();
+
+private:
+  struct Entry {
+    uint64_t key;
+    uint64_t bytes;
+    int64_t lastUsed;
+  };
+
+  SessionRenderCache();
+  void scanDirectory();
+  void evictFor(uint64_t bytesNeeded);
+  std::string pathFor(uint64_t key) const;
+  static std::string defaultDirectory();
+
+  std::mutex mutex_;
+  std::string directory_;
+  uint64_t maxBytes_ = kDefaultMaxBytes;
+  std::vector<Entry> entries_;
+  bool scanned_ = false;
+};
+
+} // namespace audioapi
@@ -0,0 +1,80 @@
+#include "StartupProfiler.h"
+#include "GlitchDetector.h"
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+namespace audioapi::startup {
+
+namespace detail {
+std::atomic<uint32_t> currentAttempt{0};
+}
+
+namespace {
+
+// Phases the JS side reports through markStartup()
+constexpr const char *kPhaseNames[] = {
+    "audioContextCreated", "play", "voicesCreated", "voicesConfigured", "renderCacheStarted",
+};
+
+struct Phases {
+  std::mutex mutex;
+  std::array<Phase, kCapacity> entries;
+  uint64_t count = 0;
+  uint64_t originNanos = 0;
+  uint64_t playNanos = 0;
+};
+
+Phases &phases() {
+  static Phases instance;
+  return instance;
+}
+
+} // namespace
+
+void record(const char *name, const char *subject, uint64_t startNanos, uint64_t durationNanos) {
+  auto &log = phases();
+  std::lock_guard<std::mutex> lock(log.mutex);
+  if (log.originNanos == 0) {
+    log.originNanos = startNanos;
+  }
+  log.entries[log.count % kCapacity] = Phase{name, subject, startNanos, durationNanos};
+  ++log.count;
+}
+
+void beginAttempt() {
+  auto &log = phases();
+  {
+    std::lock_guard<std::mutex> lock(log.mutex);
+    log.playNanos = trace::nowNanos();
+  }
+  detail::currentAttempt.fetch_add(1, std::memory_order_relaxed);
+}
+
+const char *phaseName(const std::string &name) {
+  for (const char *phase : kPhaseNames) {
+    if (name == phase) {
+      return phase;
+    }
+  }
+  return nullptr;
+}
+
+Report report() {
+  Report result;
+  {
+    auto &log = phases();
+    std::lock_guard<std::mutex> lock(log.mutex);
+    result.originNanos = log.originNanos;
+    result.playNanos = log.playNanos;
+    const uint64_t count = std::min<uint64_t>(log.count, kCapacity);
+    result.phases.reserve(count);
+    for (uint64_t i = log.count - count; i < log.count; ++i) {
+      result.phases.push_back(log.entries[i % kCapacity]);
+    }
+  }
+  result.nodes = collectStartup();
+  return result;
+}
+
+} // namespace audioapi::startup
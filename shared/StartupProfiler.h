@@ -0,0 +1,90 @@
+#pragma once
+#include "TraceRecorder.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace audioapi::startup {
+
+// Where the time between pressing play and hearing sound goes.
+//
+// Phases are timestamped natively as they happen: module creation, installer
+// injection, node construction per voice type, session preparation, and the
+// JS-side steps reported through markStartup() (AudioContext creation, play,
+// voices created, JSI parameter writes done, render cache started). Every
+// phase is also a slice or instant of category "startup" in the trace.
+//
+// "play" opens a new attempt. Each node's GlitchDetector, which already sees
+// every output block, then stamps the node's first block and its first
+// non-silent sample of the attempt (lock-free, one relaxed load per block
+// once the node is sounding).
+struct Phase {
+  const char *name = nullptr;     // string literals only
+  const char *subject = nullptr;  // voice type, or nullptr
+  uint64_t startNanos = 0;
+  uint64_t durationNanos = 0;     // 0 for instants
+};
+
+struct NodeStartup {
+  std::string node;               // as in the glitch report, e.g. "Binaural#3"
+  uint64_t firstBlockNanos = 0;
+  uint64_t firstSoundNanos = 0;   // 0 while the node has only output silence
+};
+
+struct Report {
+  uint64_t originNanos = 0;       // first phase recorded, i.e. module creation
+  uint64_t playNanos = 0;         // start of the current attempt, 0 before the first play
+  std::vector<Phase> phases;      // last kCapacity, oldest first
+  std::vector<NodeStartup> nodes; // nodes that ran in the current attempt
+};
+
+constexpr int kCapacity = 256;
+// Output below this (-100 dBFS) counts as silence
+constexpr float kSilence = 1e-5f;
+
+// Any thread but the audio thread
+void record(const char *name, const char *subject, uint64_t startNanos, uint64_t durationNanos);
+
+inline void mark(const char *name, const char *subject = nullptr) {
+  if (trace::enabled()) {
+    trace::TraceRecorder::shared().record('i', "startup", name, 0);
+  }
+  record(name, subject, trace::nowNanos(), 0);
+}
+
+// Opens a new attempt: nodes stamp their first block and first sound again
+void beginAttempt();
+
+namespace detail {
+extern std::atomic<uint32_t> currentAttempt;
+}
+
+// Audio thread: compared against each node's last seen attempt every block
+inline uint32_t attempt() {
+  return detail::currentAttempt.load(std::memory_order_relaxed);
+}
+
+// Static name of a phase JS may mark ("play"...), or nullptr
+const char *phaseName(const std::string &name);
+
+Report report();
+
+// Records the enclosing scope as a phase, and as a trace slice
+class Span {
+public:
+  explicit Span(const char *name, const char *subject = nullptr)
+      : name_(name), subject_(subject), startNanos_(trace::nowNanos()), traceScope_("startup", name) {}
+  ~Span() { record(name_, subject_, startNanos_, trace::nowNanos() - startNanos_); }
+
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+
+private:
+  const char *name_;
+  const char *subject_;
+  uint64_t startNanos_;
+  trace::Scope traceScope_;
+};
+
+} // namespace audioapi::startup
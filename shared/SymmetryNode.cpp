@@ -2,10 +2,22 @@
 #include <audioapi/utils/AudioBus.h>
 #include <audioapi/utils/AudioArray.h>
 #include <algorithm>
+#include <numeric>
 #include <random>
 
 namespace audioapi {
 
+namespace {
+
+// Order used until the first permutation, and by rotate/reverse sequences
+const std::array<uint8_t, SymmetryNode::kMaxNotes> kIdentityOrder = [] {
+  std::array<uint8_t, SymmetryNode::kMaxNotes> order{};
+  std::iota(order.begin(), order.end(), 0);
+  return order;
+}();
+
+} // namespace
+
 SymmetryNode::SymmetryNode(BaseAudioContext *context) 
   : AudioNode(context), _rng(std::random_device{}()) {
   
@@ -15,30 +27,227 @@ SymmetryNode::SymmetryNode(BaseAudioContext *context)
   channelCountMode_ = ChannelCountMode::EXPLICIT;
   channelInterpretation_ = ChannelInterpretation::SPEAKERS;
   
-  // Initialize note array
-  initializeNotes();
+  modulation().addSignal("gate");
+  modulation().addSignal("envelope");
+  modulation().addSignal("level");
+  modulation().addParam("volume", &volume);
+  
+  // Initialize note table
+  _seed = std::random_device{}();
+  prepareSequence();
+  acquireSequence();
+}
+
+void SymmetryNode::resetVoice() {
+  applyParams(kSymmetryDefaults);
+  volume = 0.5f;
+  shouldStart = false;
+  shouldStop = false;
+  shouldPause = false;
+  shouldResume = false;
+  frameCount = 0;
+  
+  _voices = VoicePool{};
+  _noteSerial = 0;
+  _activeVoices = 0;
+  _currentNoteIndex = 0;
+  _nextEvent = 0;
+  _eventCount = 0;
+  _loopFrame = 0;
+  _loopFrames = 0;
+  _noteSep = 0.0f;
+  _noteDur = 0.0f;
+  _useEnvelope = false;
+  _shape = EnvelopeShape{};
+  _rampState = RampState::IDLE;
+  _currentGain = 0.0f;
+  _targetGain = 0.0f;
+  _rampDuration = 1.0f;
+  _rampStep = 0.0f;
+  _rampFramesLeft = 0;
+  
+  acquireSequence();
+  _glitches.reset();
+  touchParams();
+}
+
+void SymmetryNode::applyParams(const SymmetryParams &params) {
+  f0 = params.f0;
+  noctaves = params.noctaves;
+  nnotes = params.nnotes;
+  d = params.d;
+  waveform = params.waveform;
+  permfunc = params.permfunc;
+  release = params.release;
+  prepareSequence();
+  touchParams();
+}
+
+SymmetryParams SymmetryNode::getParams() {
+  return {f0, noctaves, nnotes, d, waveform, permfunc, release};
+}
+
+void SymmetryNode::prepareVoice() {
+  acquireSequence();
+  _loopFrames = std::max<int64_t>(1, static_cast<int64_t>(std::llround(d * context_->getSampleRate())));
+  buildEnvelopeShape(context_->getSampleRate());
+}
+
+void SymmetryNode::setSeed(uint32_t seed) {
+  _seed = seed;
+  prepareSequence();
+}
+
+void SymmetryNode::prepareSequence() {
+  std::lock_guard<std::mutex> lock(_tableMutex);
+  SequenceTable &table = _tables[1 - _activeTable];
+  
+  table.count = std::clamp(nnotes, 1, kMaxNotes);
+  table.seed = _seed;
+  
+  // Note i sits i * noctaves / nnotes octaves above f0, i.e.
+  // f0 * freqFact^i with freqFact = 2^(noctaves/nnotes)
+  const float octavesPerNote = noctaves / static_cast<float>(table.count);
+  table.notes[0] = f0;
+  for (int i = 1; i < table.count; i++) {
+    table.notes[i] = f0 * fastmath::exp2<fastmath::Accuracy::Precise>(octavesPerNote * i);
+  }
+  
+  // Fisher-Yates shuffles, drawn here so the audio thread only picks one
+  _rng.seed(_seed);
+  for (auto &order : table.shuffles) {
+    std::iota(order.begin(), order.begin() + table.count, 0);
+    for (int i = table.count - 1; i > 0; i--) {
+      std::uniform_int_distribution<int> dist(0, i);
+      std::swap(order[i], order[dist(_rng)]);
+    }
+  }
+  
+  _tableReady.store(true, std::memory_order_release);
+}
+
+uint64_t SymmetryNode::renderKey() const {
+  uint64_t hash = hashBytes(14695981039346656037ull, "Symmetry", 8);
+  for (float value : {f0, noctaves, d, release}) {
+    hash = hashBytes(hash, &value, sizeof(value));
+  }
+  for (int value : {nnotes, waveform, permfunc}) {
+    hash = hashBytes(hash, &value, sizeof(value));
+  }
+  return hashBytes(hash, &_seed, sizeof(_seed));
+}
+
+uint32_t SymmetryNode::pendingControls() const {
+  return (shouldStart ? static_cast<uint32_t>(kStartControl) : 0u) |
+         (shouldStop ? static_cast<uint32_t>(kStopControl) : 0u) |
+         (shouldPause ? static_cast<uint32_t>(kPauseControl) : 0u) |
+         (shouldResume ? static_cast<uint32_t>(kResumeControl) : 0u);
+}
+
+void SymmetryNode::dropControls(uint32_t controls) {
+  shouldStart = shouldStart && (controls & kStartControl) == 0;
+  shouldStop = shouldStop && (controls & kStopControl) == 0;
+  shouldPause = shouldPause && (controls & kPauseControl) == 0;
+  shouldResume = shouldResume && (controls & kResumeControl) == 0;
+}
+
+void SymmetryNode::copyRenderState(const VoiceRenderer &voice) {
+  const auto &leader = static_cast<const SymmetryNode &>(voice);
+  
+  // The tables are equal in content but not in slot, so the order is copied
+  // as an index into them
+  const SequenceTable &table = leader._tables[leader._activeTable];
+  _tables[_activeTable] = table;
+  _order = kIdentityOrder.data();
+  for (int s = 0; s < kPermutationPoolSize; ++s) {
+    if (leader._order == table.shuffles[s].data()) {
+      _order = _tables[_activeTable].shuffles[s].data();
+    }
+  }
+  _orderStart = leader._orderStart;
+  _orderDirection = leader._orderDirection;
+  _pickState = leader._pickState;
+  
+  _voices = leader._voices;
+  _noteSerial = leader._noteSerial;
+  _activeVoices = leader._activeVoices;
+  _currentNoteIndex = leader._currentNoteIndex;
+  _nextEvent = leader._nextEvent;
+  _eventCount = leader._eventCount;
+  _loopFrame = leader._loopFrame;
+  _loopFrames = leader._loopFrames;
+  _noteSep = leader._noteSep;
+  _noteDur = leader._noteDur;
+  _useEnvelope = leader._useEnvelope;
+  _shape = leader._shape;
+  frameCount = leader.frameCount;
+  
+  // The output scales with the gain, which follows the volume
+  const float ratio = leader.volume > 0.0f ? volume / leader.volume : 1.0f;
+  _rampState = leader._rampState;
+  _currentGain = leader._currentGain * ratio;
+  _targetGain = leader._targetGain * ratio;
+  _rampStep = leader._rampStep * ratio;
+  _rampDuration = leader._rampDuration;
+  _rampFramesLeft = leader._rampFramesLeft;
+}
+
+void SymmetryNode::acquireSequence() {
+  if (!_tableReady.load(std::memory_order_acquire)) {
+    return;
+  }
+  
+  // The JS thread may be writing the staging table; try again next loop
+  std::unique_lock<std::mutex> lock(_tableMutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  
+  _activeTable = 1 - _activeTable;
+  _tableReady.store(false, std::memory_order_relaxed);
+  resetOrder();
+}
+
+void SymmetryNode::resetOrder() {
+  _order = kIdentityOrder.data();
+  _orderStart = 0;
+  _orderDirection = 1;
+  // Spread small seeds over the state; xorshift must never be seeded with 0
+  _pickState = (_tables[_activeTable].seed * 2654435761u) | 1u;
 }
 
 void SymmetryNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) {
+  CUSTOM_NODES_RT_SCOPE("Symmetry");
   if (framesToProcess == 0 || bus->getNumberOfChannels() < 2) {
     return;
   }
+  // Every voice may sound the highest note at once
+  const float maxStep = kMaxVoices * GlitchDetector::waveformStep(waveform, f0 * std::exp2(noctaves), volume,
+                                                                   context_->getSampleRate());
+  GlitchDetector::Scope glitchScope(_glitches, bus, framesToProcess, context_->getSampleRate(), maxStep);
+  CUSTOM_NODES_DSP_SCOPE(_dspLoad, framesToProcess, context_->getSampleRate());
+  CUSTOM_NODES_TRACE_SCOPE("dsp", "Symmetry");
   
-  auto leftChannel = bus->getChannel(0);
-  auto rightChannel = bus->getChannel(1);
+  float *left = bus->getChannel(0)->getData();
+  float *right = bus->getChannel(1)->getData();
   const float sampleRate = context_->getSampleRate();
-  const float deltaTime = 1.0f / sampleRate;
   
   // Handle control flags
+  trace::commandsApplied(this, {CUSTOM_NODES_TRACE_FLAG(shouldStart),
+                                CUSTOM_NODES_TRACE_FLAG(shouldPause),
+                                CUSTOM_NODES_TRACE_FLAG(shouldResume),
+                                CUSTOM_NODES_TRACE_FLAG(shouldStop)});
   if (shouldStart) {
     shouldStart = false;
     _rampState = RampState::RAMPING_UP;
     _currentGain = 0.0f;
-    _targetGain = volume;
-    _rampProgress = 0.0f;
+    
+    acquireSequence();
+    resetOrder();
+    applyPermutation();
     
     // Determine ramp duration based on note separation
-    _noteSep = d / static_cast<float>(nnotes);
+    _noteSep = d / static_cast<float>(noteCount());
     _noteDur = _noteSep / 2.0f;
     _useEnvelope = (_noteSep > 10.0f);
     
@@ -47,124 +256,113 @@ void SymmetryNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesT
     } else {
       _rampDuration = 1.5f; // Fixed 1.5 seconds
     }
+    beginRamp(volume, sampleRate);
     
-    _loopPhaseTime = 0.0f;
-    _noteStartTime = 0.0f;
+    _loopFrame = 0;
     _currentNoteIndex = 0;
-    _phase = 0.0f;
-    _notePhaseTime = 0.0f;
-    _envelopeGain = 0.0f;
+    _voices = VoicePool{};
+    _activeVoices = 0;
     
-    initializeNotes();
-    applyPermutation();
+    scheduleLoop(sampleRate);
   }
   
   if (shouldStop) {
     shouldStop = false;
     _rampState = RampState::RAMPING_DOWN;
-    _targetGain = 0.0f;
-    _rampProgress = 0.0f;
     
     if (_useEnvelope) {
       _rampDuration = ENVELOPE_DECAY; // Use envelope decay time
     } else {
       _rampDuration = 1.5f; // Fixed 1.5 seconds
     }
+    beginRamp(0.0f, sampleRate);
   }
   
   if (shouldPause) {
     shouldPause = false;
     _rampState = RampState::RAMPING_DOWN;
-    _targetGain = 0.0f;
-    _rampProgress = 0.0f;
     _rampDuration = 0.5f;
+    beginRamp(0.0f, sampleRate);
   }
   
   if (shouldResume) {
     shouldResume = false;
     _rampState = RampState::RAMPING_UP;
-    _targetGain = volume;
-    _rampProgress = 0.0f;
     _rampDuration = 0.5f; // Fixed 0.5 seconds for resume
+    beginRamp(volume, sampleRate);
+  }
+  
+  if (const uint64_t frames = takePendingSeek();
+      frames > 0 && _rampState != RampState::IDLE && _rampState != RampState::PAUSED) {
+    seekSequence(static_cast<int64_t>(frames), sampleRate);
+    // The mixer fades the voice in, so the start ramp is past as well
+    const int64_t ramped = std::min<int64_t>(static_cast<int64_t>(frames), _rampFramesLeft);
+    _currentGain += _rampStep * static_cast<float>(ramped);
+    advanceRamp(static_cast<int>(ramped));
+  }
+  
+  frameCount += framesToProcess;
+  
+  if (_rampState == RampState::IDLE) {
+    std::fill(left, left + framesToProcess, 0.0f);
+    std::fill(right, right + framesToProcess, 0.0f);
+    return;
   }
   
-  // Process audio samples
-  for (int i = 0; i < framesToProcess; i++) {
-    frameCount++;
+  // Render the quantum as runs between sequencer events and ramp ends
+  int written = 0;
+  while (written < framesToProcess) {
+    if (_loopFrame >= _loopFrames) {
+      // Completed a full loop
+      _loopFrame = 0;
+      acquireSequence();
+      applyPermutation();
+      scheduleLoop(sampleRate);
+    }
     
-    // Update volume ramping
-    updateVolumeRamp(deltaTime);
+    while (_nextEvent < _eventCount && eventFrame(_nextEvent) <= _loopFrame) {
+      applyEvent(_nextEvent++, sampleRate);
+    }
     
-    float sample = 0.0f;
+    if (_rampState == RampState::PLAYING) {
+      // Track volume changes while playing
+      _currentGain = volume;
+    }
     
-    if (_rampState != RampState::IDLE) {
-      // Update loop phase
-      _loopPhaseTime += deltaTime;
-      _notePhaseTime += deltaTime;
-      
-      // Check if we've completed a full loop
-      if (_loopPhaseTime >= d) {
-        _loopPhaseTime -= d;
-        _noteStartTime = 0.0f;
-        _currentNoteIndex = 0;
-        _notePhaseTime = 0.0f;
-        applyPermutation();
-      }
-      
-      // Check if it's time to start a new note
-      float nextNoteTime = _currentNoteIndex * _noteSep;
-      if (_loopPhaseTime >= nextNoteTime && _currentNoteIndex < nnotes) {
-        if (_loopPhaseTime >= _noteStartTime + _noteSep) {
-          _noteStartTime += _noteSep;
-          _currentNoteIndex++;
-          _notePhaseTime = 0.0f;
-          _phase = 0.0f; // Reset phase for new note
-        }
-      }
-      
-      // Generate audio if within note duration
-      if (_currentNoteIndex < nnotes && _notePhaseTime < _noteDur) {
-        float frequency = _notes[_currentNoteIndex];
-        sample = generateSample(frequency);
-        
-        // ALWAYS apply per-note envelope to prevent clicks
-        float envGain = calculateEnvelopeGain();
-        sample *= envGain;
-        
-        // Advance phase
-        _phase += (frequency / sampleRate);
-        if (_phase >= 1.0f) {
-          _phase -= 1.0f;
-        }
-      }
-      
-      // Apply volume ramping
-      sample *= _currentGain;
+    int64_t boundary = _nextEvent < _eventCount ? eventFrame(_nextEvent) : _loopFrames;
+    int64_t span = std::min<int64_t>(framesToProcess - written, boundary - _loopFrame);
+    if (_rampFramesLeft > 0) {
+      span = std::min(span, _rampFramesLeft);
     }
+    if (_activeVoices > 0) {
+      span = std::min(span, framesToNextVoiceSegment());
+    }
+    
+    renderSpan(left + written, static_cast<int>(span));
+    advanceRamp(static_cast<int>(span));
     
-    // Write to both channels (mono signal)
-    leftChannel->getData()[i] = sample;
-    rightChannel->getData()[i] = sample;
+    _loopFrame += span;
+    written += static_cast<int>(span);
   }
+  
+  // Mono signal on both channels
+  std::copy(left, left + framesToProcess, right);
+  publishSignals();
 }
 
-void SymmetryNode::initializeNotes() {
-  _notes.clear();
-  
-  if (nnotes <= 0) {
-    nnotes = 1;
-  }
-  
-  // Calculate frequency factor: freqFact = 2^(noctaves/nnotes)
-  float freqFact = std::pow(2.0f, noctaves / static_cast<float>(nnotes));
-  
-  // Generate note sequence
-  _notes.push_back(f0);
-  for (int i = 1; i < nnotes; i++) {
-    _notes.push_back(f0 * std::pow(freqFact, static_cast<float>(i)));
+void SymmetryNode::publishSignals() {
+  bool gate = false;
+  float envelope = 0.0f;
+  for (int v = 0; v < kMaxVoices; ++v) {
+    const VoiceStage stage = _voices.stage[v];
+    gate = gate || stage == VoiceStage::Attack || stage == VoiceStage::Sustain;
+    if (stage != VoiceStage::Idle) {
+      envelope = std::max(envelope, _voices.envelope[v]);
+    }
   }
-  
-  _currentNoteIndex = 0;
+  modulation().publish(kGateSignal, gate ? 1.0f : 0.0f);
+  modulation().publish(kEnvelopeSignal, envelope);
+  modulation().publish(kLevelSignal, _currentGain * envelope);
 }
 
 void SymmetryNode::applyPermutation() {
@@ -178,47 +376,35 @@ void SymmetryNode::applyPermutation() {
   }
 }
 
-float SymmetryNode::generateSample(float frequency) {
-  float sample = 0.0f;
+// Audio thread. Events are not stored: eventFrame() derives each from its
+// index, so a new loop only resets the counters and never allocates.
+void SymmetryNode::scheduleLoop(float sampleRate) {
+  _nextEvent = 0;
+  _currentNoteIndex = 0;
   
-  switch (waveform) {
-    case 0: // Sine
-      sample = std::sin(2.0f * M_PI * _phase);
-      break;
-      
-    case 1: // Triangle
-      if (_phase < 0.25f) {
-        sample = 4.0f * _phase;
-      } else if (_phase < 0.75f) {
-        sample = 2.0f - 4.0f * _phase;
-      } else {
-        sample = 4.0f * _phase - 4.0f;
-      }
-      break;
-      
-    case 2: // Square
-      sample = (_phase < 0.5f) ? 1.0f : -1.0f;
-      break;
-      
-    case 3: // Sawtooth
-      sample = 2.0f * _phase - 1.0f;
-      break;
-      
-    default:
-      sample = std::sin(2.0f * M_PI * _phase);
-      break;
-  }
+  _loopFrames = std::max<int64_t>(1, static_cast<int64_t>(std::llround(d * sampleRate)));
+  _eventCount = noteCount() * kEventsPerNote;
   
-  return sample;
+  if (_shape.loopFrames != _loopFrames || _shape.noteCount != noteCount() || _shape.release != release) {
+    buildEnvelopeShape(sampleRate);
+  }
 }
 
-float SymmetryNode::calculateEnvelopeGain() {
-  float gain = 1.0f;
+void SymmetryNode::buildEnvelopeShape(float sampleRate) {
+  const int64_t count = noteCount();
+  _shape.loopFrames = _loopFrames;
+  _shape.noteCount = static_cast<int>(count);
+  _shape.release = release;
+  
+  // Note i starts at frame i * loopFrames / count and sounds for half
+  // of the note separation
+  _shape.noteFrames = std::max<int64_t>(1, _loopFrames / (2 * count));
+  _noteSep = static_cast<float>(_loopFrames) / (sampleRate * count);
+  _noteDur = static_cast<float>(_shape.noteFrames) / sampleRate;
+  _useEnvelope = (_noteSep > 10.0f);
   
-  // Use shorter attack/release times for short notes to prevent clicks
   float attackTime = ENVELOPE_ATTACK;
   float releaseTime = ENVELOPE_DECAY;
-  
   if (!_useEnvelope) {
     // For short notes, use a fixed minimum envelope to prevent clicks
     // Use 5ms minimum (very fast but enough to prevent clicks)
@@ -227,90 +413,321 @@ float SymmetryNode::calculateEnvelopeGain() {
     attackTime = std::min(0.05f, std::max(0.005f, fifteenPercent));
     releaseTime = std::min(0.05f, std::max(0.005f, fifteenPercent));
   }
-  
-  // Attack phase
-  if (_notePhaseTime < attackTime) {
-    gain = _notePhaseTime / attackTime;
+  if (release > 0.0f) {
+    releaseTime = release;
   }
-  // Release phase
-  else if (_notePhaseTime > (_noteDur - releaseTime)) {
-    float timeIntoRelease = _notePhaseTime - (_noteDur - releaseTime);
-    gain = 1.0f - (timeIntoRelease / releaseTime);
+  _shape.attackFrames = std::clamp<int64_t>(static_cast<int64_t>(attackTime * sampleRate), 1, std::max<int64_t>(1, _shape.noteFrames / 2));
+  // Release tails run past the note-off; keep them short enough that the
+  // regular sequence never has to steal a sounding voice
+  const int64_t separationFrames = std::max<int64_t>(1, _loopFrames / count);
+  _shape.releaseFrames = std::clamp<int64_t>(static_cast<int64_t>(releaseTime * sampleRate), 1, separationFrames * (kMaxVoices - 1));
+  _shape.attackStep = 1.0f / static_cast<float>(_shape.attackFrames);
+  _shape.releaseRate = 1.0f / static_cast<float>(_shape.releaseFrames);
+}
+
+int64_t SymmetryNode::eventFrame(int event) const {
+  const int64_t on = static_cast<int64_t>(event / kEventsPerNote) * _loopFrames / noteCount();
+  return static_cast<EventType>(event % kEventsPerNote) == EventType::NoteOn ? on : on + _shape.noteFrames;
+}
+
+void SymmetryNode::applyEvent(int event, float sampleRate) {
+  const int position = event / kEventsPerNote;
+  
+  if (static_cast<EventType>(event % kEventsPerNote) == EventType::NoteOff) {
+    for (int v = 0; v < kMaxVoices; v++) {
+      if (_voices.position[v] == position &&
+          (_voices.stage[v] == VoiceStage::Attack || _voices.stage[v] == VoiceStage::Sustain)) {
+        // Release from wherever the envelope is
+        _voices.stage[v] = VoiceStage::Release;
+        _voices.envelopeStep[v] = -_voices.envelope[v] * _shape.releaseRate;
+        _voices.segmentFramesLeft[v] = _shape.releaseFrames;
+      }
+    }
+    return;
   }
-  // Sustain phase
-  else {
-    gain = 1.0f;
+  
+  _currentNoteIndex = position;
+  const int count = noteCount();
+  int slot = _orderStart + _orderDirection * position;
+  if (slot >= count) {
+    slot -= count;
+  } else if (slot < 0) {
+    slot += count;
   }
   
-  // Clamp to 0.0 - 1.0
-  if (gain < 0.0f) gain = 0.0f;
-  if (gain > 1.0f) gain = 1.0f;
+  // A fresh voice starts at phase 0 from silence, so nothing is cut off
+  const int v = allocateVoice();
+  _voices.phase[v] = 0.0f;
+  _voices.increment[v] = _tables[_activeTable].notes[_order[slot]] / sampleRate;
+  _voices.envelope[v] = 0.0f;
+  _voices.envelopeStep[v] = _shape.attackStep;
+  _voices.segmentFramesLeft[v] = _shape.attackFrames;
+  _voices.stage[v] = VoiceStage::Attack;
+  _voices.serial[v] = _noteSerial++;
+  _voices.position[v] = position;
+}
+
+// Catches up with a replay the mixer falls back from (seekVoice()): runs the
+// loops in between without rendering, so that the permutations walk on as
+// they would have. Notes over by the seek point are skipped; the one
+// sounding at it restarts its attack there.
+void SymmetryNode::seekSequence(int64_t frames, float sampleRate) {
+  while (frames >= _loopFrames - _loopFrame) {
+    frames -= _loopFrames - _loopFrame;
+    _loopFrame = 0;
+    acquireSequence();
+    applyPermutation();
+    scheduleLoop(sampleRate);
+  }
+  _loopFrame += frames;
   
-  return gain;
+  int sounding = -1;
+  while (_nextEvent < _eventCount && eventFrame(_nextEvent) <= _loopFrame) {
+    const int position = _nextEvent / kEventsPerNote;
+    if (static_cast<EventType>(_nextEvent % kEventsPerNote) == EventType::NoteOn) {
+      sounding = _nextEvent;
+    } else if (sounding >= 0 && sounding / kEventsPerNote == position) {
+      sounding = -1;
+    }
+    _currentNoteIndex = position;
+    ++_nextEvent;
+  }
+  if (sounding >= 0) {
+    applyEvent(sounding, sampleRate);
+  }
 }
 
-void SymmetryNode::updateVolumeRamp(float deltaTime) {
-  if (_rampState == RampState::RAMPING_UP || _rampState == RampState::RAMPING_DOWN) {
-    _rampProgress += deltaTime / _rampDuration;
+int SymmetryNode::allocateVoice() {
+  // An idle voice if there is one, otherwise steal the oldest note
+  int oldest = 0;
+  for (int v = 0; v < kMaxVoices; v++) {
+    if (_voices.stage[v] == VoiceStage::Idle) {
+      _activeVoices++;
+      return v;
+    }
+    if (_noteSerial - _voices.serial[v] > _noteSerial - _voices.serial[oldest]) {
+      oldest = v;
+    }
+  }
+  return oldest;
+}
+
+int64_t SymmetryNode::framesToNextVoiceSegment() const {
+  int64_t frames = INT64_MAX;
+  for (int v = 0; v < kMaxVoices; v++) {
+    if (_voices.segmentFramesLeft[v] > 0) {
+      frames = std::min(frames, _voices.segmentFramesLeft[v]);
+    }
+  }
+  return frames;
+}
+
+void SymmetryNode::advanceVoices(int count, bool rendered) {
+  for (int v = 0; v < kMaxVoices; v++) {
+    if (_voices.segmentFramesLeft[v] <= 0) {
+      continue;
+    }
+    if (!rendered) {
+      _voices.envelope[v] += _voices.envelopeStep[v] * count;
+    }
     
-    if (_rampProgress >= 1.0f) {
-      _rampProgress = 1.0f;
-      _currentGain = _targetGain;
-      
-      if (_rampState == RampState::RAMPING_UP) {
-        _rampState = RampState::PLAYING;
-      } else { // RAMPING_DOWN
-        if (_targetGain == 0.0f) {
-          // Check if this was a pause or a stop
-          // If shouldResume hasn't been set, assume it's a pause
-          _rampState = RampState::PAUSED;
-        }
-      }
+    _voices.segmentFramesLeft[v] -= count;
+    if (_voices.segmentFramesLeft[v] > 0) {
+      continue;
+    }
+    
+    _voices.segmentFramesLeft[v] = 0;
+    _voices.envelopeStep[v] = 0.0f;
+    if (_voices.stage[v] == VoiceStage::Attack) {
+      _voices.stage[v] = VoiceStage::Sustain;
+      _voices.envelope[v] = 1.0f;
     } else {
-      // Linear interpolation
-      float startGain = (_rampState == RampState::RAMPING_UP) ? 0.0f : _currentGain;
-      _currentGain = startGain + (_targetGain - startGain) * _rampProgress;
+      // End of the release tail
+      _voices.stage[v] = VoiceStage::Idle;
+      _voices.envelope[v] = 0.0f;
+      _voices.increment[v] = 0.0f;
+      _activeVoices--;
     }
-  } else if (_rampState == RampState::PLAYING) {
-    // Track volume changes while playing
-    if (_currentGain != volume) {
-      _currentGain = volume;
+  }
+}
+
+namespace {
+
+using fastmath::Float4;
+
+// Triangle, square and sawtooth on four phases at once (phases in [0, 1))
+inline Float4 triangle(Float4 phase) {
+  Float4 shifted = phase + 0.25f;
+  shifted = shifted - fastmath::floor(shifted);
+  return 1.0f - 4.0f * fastmath::abs(shifted - 0.5f);
+}
+
+inline Float4 square(Float4 phase) {
+  return fastmath::selectGreater(Float4::broadcast(0.5f), phase, Float4::broadcast(1.0f), Float4::broadcast(-1.0f));
+}
+
+inline Float4 sawtooth(Float4 phase) {
+  return 2.0f * phase - 1.0f;
+}
+
+// One straight run of a bunch of four voices: no scheduling decisions inside
+// the loop, one lane per voice, summed into the output
+template <typename Wave>
+void renderBunch(float *output, int count, bool accumulate, float *phases, const float *increments,
+                 float *envelopes, const float *envelopeSteps, Wave wave) {
+  Float4 phase = Float4::load(phases);
+  const Float4 increment = Float4::load(increments);
+  Float4 envelope = Float4::load(envelopes);
+  const Float4 envelopeStep = Float4::load(envelopeSteps);
+  
+  for (int i = 0; i < count; i++) {
+    const float sample = fastmath::sum(wave(phase) * envelope);
+    output[i] = accumulate ? output[i] + sample : sample;
+    phase = phase + increment;
+    phase = phase - fastmath::floor(phase);
+    envelope = envelope + envelopeStep;
+  }
+  
+  phase.store(phases);
+  envelope.store(envelopes);
+}
+
+// Multiplies a block by a linear gain segment. Each sample's gain depends only
+// on its index, so the loop has no carried dependency and vectorizes.
+void applyGainSegment(float *output, int count, float gain, float step) {
+  if (step == 0.0f) {
+    if (gain != 1.0f) {
+      for (int i = 0; i < count; i++) {
+        output[i] *= gain;
+      }
     }
+    return;
+  }
+  for (int i = 0; i < count; i++) {
+    output[i] *= gain + step * static_cast<float>(i);
+  }
+}
+
+} // namespace
+
+void SymmetryNode::renderSpan(float *output, int count) {
+  static_assert(kMaxVoices % 4 == 0, "voices are rendered in bunches of four");
+  const float gainStep = _rampFramesLeft > 0 ? _rampStep : 0.0f;
+  
+  if (_activeVoices == 0 || _rampState == RampState::PAUSED) {
+    std::fill(output, output + count, 0.0f);
+    advanceVoices(count, false);
+    _currentGain += gainStep * count;
+    return;
+  }
+  
+  // Every bunch costs the same whether its lanes are sounding or not, so a
+  // block costs at most kMaxVoices oscillators
+  const bool fastSine = getQualityTier() >= QualityTier::Reduced;
+  for (int b = 0; b < kMaxVoices; b += 4) {
+    float *phases = &_voices.phase[b];
+    const float *increments = &_voices.increment[b];
+    float *envelopes = &_voices.envelope[b];
+    const float *envelopeSteps = &_voices.envelopeStep[b];
+    const bool accumulate = b > 0;
+    
+    switch (waveform) {
+      case 1: // Triangle
+        renderBunch(output, count, accumulate, phases, increments, envelopes, envelopeSteps,
+                    [](Float4 phase) { return triangle(phase); });
+        break;
+        
+      case 2: // Square
+        renderBunch(output, count, accumulate, phases, increments, envelopes, envelopeSteps,
+                    [](Float4 phase) { return square(phase); });
+        break;
+        
+      case 3: // Sawtooth
+        renderBunch(output, count, accumulate, phases, increments, envelopes, envelopeSteps,
+                    [](Float4 phase) { return sawtooth(phase); });
+        break;
+        
+      default: // Sine
+        if (fastSine) {
+          renderBunch(output, count, accumulate, phases, increments, envelopes, envelopeSteps,
+                      [](Float4 phase) { return fastmath::sin2pi<fastmath::Accuracy::Fast>(phase); });
+        } else {
+          renderBunch(output, count, accumulate, phases, increments, envelopes, envelopeSteps,
+                      [](Float4 phase) { return fastmath::sin2pi<kAccuracy>(phase); });
+        }
+        break;
+    }
+  }
+  advanceVoices(count, true);
+  
+  // Volume ramp is linear over the span
+  applyGainSegment(output, count, _currentGain, gainStep);
+  _currentGain += gainStep * count;
+}
+
+void SymmetryNode::beginRamp(float targetGain, float sampleRate) {
+  _targetGain = targetGain;
+  _rampFramesLeft = std::max<int64_t>(1, static_cast<int64_t>(_rampDuration * sampleRate));
+  _rampStep = (_targetGain - _currentGain) / static_cast<float>(_rampFramesLeft);
+}
+
+void SymmetryNode::advanceRamp(int count) {
+  if (_rampFramesLeft <= 0) {
+    return;
+  }
+  
+  _rampFramesLeft -= count;
+  if (_rampFramesLeft > 0) {
+    return;
+  }
+  
+  _rampFramesLeft = 0;
+  _currentGain = _targetGain;
+  if (_rampState == RampState::RAMPING_UP) {
+    _rampState = RampState::PLAYING;
+  } else if (_rampState == RampState::RAMPING_DOWN) {
+    // Pause and stop both end here; shouldResume ramps back up
+    _rampState = RampState::PAUSED;
   }
 }
 
 // Permutation functions
 void SymmetryNode::shuffleNotes() {
-  if (_notes.size() <= 1) return;
+  const int count = noteCount();
+  if (count <= 1) return;
   
-  // Fisher-Yates shuffle
-  for (int i = _notes.size() - 1; i > 0; i--) {
-    std::uniform_int_distribution<int> dist(0, i);
-    int j = dist(_rng);
-    std::swap(_notes[i], _notes[j]);
-  }
+  // A prepared shuffle, entered at a random position in a random direction
+  _pickState ^= _pickState << 13;
+  _pickState ^= _pickState >> 17;
+  _pickState ^= _pickState << 5;
+  _order = _tables[_activeTable].shuffles[_pickState % kPermutationPoolSize].data();
+  _orderStart = static_cast<int>((_pickState >> 8) % static_cast<uint32_t>(count));
+  _orderDirection = (_pickState & 0x80000000u) ? -1 : 1;
 }
 
 void SymmetryNode::rotateNotesForward() {
-  if (_notes.size() <= 1) return;
+  const int count = noteCount();
+  if (count <= 1) return;
   
-  float last = _notes.back();
-  _notes.pop_back();
-  _notes.insert(_notes.begin(), last);
+  // The last note moves to the front
+  _orderStart = (_orderStart - _orderDirection + count) % count;
 }
 
 void SymmetryNode::rotateNotesBackward() {
-  if (_notes.size() <= 1) return;
+  const int count = noteCount();
+  if (count <= 1) return;
   
-  float first = _notes.front();
-  _notes.erase(_notes.begin());
-  _notes.push_back(first);
+  // The first note moves to the back
+  _orderStart = (_orderStart + _orderDirection + count) % count;
 }
 
 void SymmetryNode::reverseNotes() {
-  if (_notes.size() <= 1) return;
+  const int count = noteCount();
+  if (count <= 1) return;
   
-  std::reverse(_notes.begin(), _notes.end());
+  // Start from the current last note and walk the other way
+  _orderStart = (_orderStart + _orderDirection * (count - 1) + count) % count;
+  _orderDirection = -_orderDirection;
 }
 
 } // namespace audioapi
@@ -2,27 +2,75 @@
 
 #include <audioapi/core/AudioNode.h>
 #include <audioapi/core/BaseAudioContext.h>
-#include <vector>
+#include "VoiceRenderer.h"
+#include "VoiceParams.h"
+#include "FastMath.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <cmath>
+#include <mutex>
 #include <random>
 
 namespace audioapi {
 
-class SymmetryNode : public AudioNode {
+class SymmetryNode : public AudioNode, public VoiceRenderer {
 public:
+  // Accuracy tier of the sine oscillator (see FastMath.h). The note table
+  // always uses Precise: it is built once per sequence and pitch errors add up.
+  static constexpr fastmath::Accuracy kAccuracy = fastmath::Accuracy::Balanced;
+
   explicit SymmetryNode(BaseAudioContext *context);
   ~SymmetryNode() override = default;
 
   void processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override;
 
+  // Longest sequence; nnotes is clamped to this
+  static constexpr int kMaxNotes = 128;
+  // Shuffled orders prepared ahead; a loop picks one and a random start/direction
+  static constexpr int kPermutationPoolSize = 16;
+  // Notes that can sound at once (release tails overlap the next note). The
+  // pool is rendered as fastmath::Float4 bunches, so this is a multiple of 4.
+  static constexpr int kMaxVoices = 4;
+
+  // Makes shuffled note orders reproducible (e.g. for the rendered-session cache)
+  void setSeed(uint32_t seed);
+
+  // Rebuilds the note table and the shuffle pool from f0, noctaves, nnotes
+  // and the seed. Called from the JS thread whenever one of them changes; the
+  // audio thread picks the new table up at the next start or loop boundary.
+  void prepareSequence();
+  void renderVoice(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override {
+    processNode(bus, framesToProcess);
+  }
+  // Rebuilds the note table for the default parameters, in place
+  void resetVoice() override;
+  // Sets the preset parameters, as decoded from a binary preset. JS thread.
+  void applyParams(const SymmetryParams &params);
+  // The current preset parameters, as applyParams() takes them. JS thread.
+  SymmetryParams getParams();
+  // Installs the note table and builds the envelope shape that start uses
+  void prepareVoice() override;
+  // The sequence is a function of the parameters and the seed, so identical
+  // Symmetry voices render once
+  uint64_t renderKey() const override;
+  uint32_t pendingControls() const override;
+  void dropControls(uint32_t controls) override;
+  void copyRenderState(const VoiceRenderer &leader) override;
+
   // Core parameters
-  float f0 = 220.0f;           // Base frequency (Hz)
-  float noctaves = 1.0f;       // Number of octaves to span
-  int nnotes = 8;              // Number of notes in the sequence
-  float d = 32.0f;             // Loop duration (seconds)
-  int waveform = 0;            // 0=sine, 1=triangle, 2=square, 3=sawtooth
-  int permfunc = 0;            // 0=shuffle, 1=rotateForward, 2=rotateBack, 3=reverse, 4=none
+  float f0 = kSymmetryDefaults.f0;             // Base frequency (Hz)
+  float noctaves = kSymmetryDefaults.noctaves; // Number of octaves to span
+  int nnotes = kSymmetryDefaults.nnotes;       // Number of notes in the sequence
+  float d = kSymmetryDefaults.d;               // Loop duration (seconds)
+  int waveform = kSymmetryDefaults.waveform;   // 0=sine, 1=triangle, 2=square, 3=sawtooth
+  int permfunc = kSymmetryDefaults.permfunc;   // 0=shuffle, 1=rotateForward, 2=rotateBack, 3=reverse, 4=none
   float volume = 0.5f;         // Master volume (0.0 to 1.0)
+  float release = kSymmetryDefaults.release; // Release tail after note off (seconds); 0 = automatic
 
   // Control flags
   bool shouldStart = false;
@@ -34,23 +82,92 @@ public:
   int frameCount = 0;
 
 private:
-  // Oscillator state
-  float _phase = 0.0f;
+  // One sequencer event, at an exact frame offset within the loop. Voice
+  // envelopes are linear between events and segment ends, so spans between
+  // them are rendered without any per-sample scheduling.
+  enum class EventType {
+    NoteOn,   // take a voice, start its attack
+    NoteOff   // start the voice's release tail
+  };
+  static constexpr int kEventsPerNote = 2;
+
+  // pendingControls() bits
+  enum Control : uint32_t { kStartControl = 1, kStopControl = 2, kPauseControl = 4, kResumeControl = 8 };
+  
+  // Modulation signals, in the order they are declared to modulation():
+  // gate (1 while a note is held), envelope (loudest note envelope),
+  // level (master gain * envelope)
+  enum ModulationSignal { kGateSignal, kEnvelopeSignal, kLevelSignal };
   
-  // Note sequence
-  std::vector<float> _notes;
-  int _currentNoteIndex = 0;
+  enum class VoiceStage : uint8_t { Idle, Attack, Sustain, Release };
   
-  // Timing state
-  float _loopPhaseTime = 0.0f;  // Time within current loop (0 to d)
-  float _noteStartTime = 0.0f;  // When current note started
+  // Preallocated note voices, one SIMD lane each (structure of arrays)
+  struct VoicePool {
+    alignas(16) std::array<float, kMaxVoices> phase{};
+    alignas(16) std::array<float, kMaxVoices> increment{};
+    alignas(16) std::array<float, kMaxVoices> envelope{};
+    alignas(16) std::array<float, kMaxVoices> envelopeStep{};
+    std::array<int64_t, kMaxVoices> segmentFramesLeft{};  // until attack/release end; 0 = open-ended
+    std::array<VoiceStage, kMaxVoices> stage{};
+    std::array<uint32_t, kMaxVoices> serial{};   // note-on order, for stealing the oldest
+    std::array<int, kMaxVoices> position{};      // loop position of the note
+  };
+
+  // Everything the sequence needs, in inline storage so that the audio thread
+  // never allocates. Written by the JS thread into the staging slot only.
+  struct SequenceTable {
+    std::array<float, kMaxNotes> notes;  // ascending, notes[i] = f0 * 2^(i * noctaves / nnotes)
+    int count = 0;
+    std::array<std::array<uint8_t, kMaxNotes>, kPermutationPoolSize> shuffles;
+    uint32_t seed = 1;
+  };
+
+  // Note tables: the audio thread plays _tables[_activeTable]; the JS thread
+  // fills the other slot under _tableMutex and sets _tableReady
+  std::array<SequenceTable, 2> _tables;
+  int _activeTable = 0;
+  std::mutex _tableMutex;
+  std::atomic<bool> _tableReady{false};
+  
+  // Current order of the loop, without moving any notes: position p plays
+  // notes[order[(start + direction * p) mod count]], where order is the
+  // identity or one of the prepared shuffles
+  const uint8_t *_order = nullptr;
+  int _orderStart = 0;
+  int _orderDirection = 1;
+  uint32_t _pickState = 1;  // xorshift state for picking shuffles
+  
+  VoicePool _voices;
+  uint32_t _noteSerial = 0;
+  int _activeVoices = 0;
+  int _currentNoteIndex = 0;  // position within the loop
+  
+  // Timing state, in frames. Note boundaries are computed from the loop
+  // length with integer arithmetic, so they never drift. Event k of a loop
+  // is event type (k % 2) of the note at position k / 2.
+  int _nextEvent = 0;
+  int _eventCount = 0;
+  int64_t _loopFrame = 0;       // Frame within current loop
+  int64_t _loopFrames = 0;      // Loop length (d seconds)
   float _noteSep = 0.0f;        // Time between note starts
   float _noteDur = 0.0f;        // Duration of each note
   bool _useEnvelope = false;    // Whether to use attack/decay envelope
   
-  // Envelope state (for long notes)
-  float _envelopeGain = 0.0f;
-  float _notePhaseTime = 0.0f;  // Time within current note
+  // Attack/sustain/release shape of every note of the current configuration.
+  // Depends only on the loop length, the note count and the sample rate, and
+  // is rebuilt when one of them changes rather than evaluated per sample.
+  struct EnvelopeShape {
+    int64_t loopFrames = 0;  // configuration the shape was built for
+    int noteCount = 0;
+    float release = 0.0f;
+    int64_t noteFrames = 1;
+    int64_t attackFrames = 1;
+    int64_t releaseFrames = 1;
+    float attackStep = 1.0f;    // per-frame gain increment of the attack
+    float releaseRate = 1.0f;   // 1 / releaseFrames
+  };
+  EnvelopeShape _shape;
+  
   static constexpr float ENVELOPE_ATTACK = 2.0f;
   static constexpr float ENVELOPE_DECAY = 2.0f;
   
@@ -66,23 +183,39 @@ private:
   float _currentGain = 0.0f;
   float _targetGain = 0.0f;
   float _rampDuration = 1.0f;    // Duration of current ramp
-  float _rampProgress = 0.0f;    // Progress through current ramp (0 to 1)
+  float _rampStep = 0.0f;        // Gain increment per frame
+  int64_t _rampFramesLeft = 0;
+  
+  DspLoadMeter _dspLoad{"Symmetry"};
+  GlitchDetector _glitches{"Symmetry"};
   
-  // Random number generator for shuffle
+  // Random number generator for the shuffle pool (JS thread only)
   std::mt19937 _rng;
+  uint32_t _seed = 1;
   
   // Helper methods
-  void initializeNotes();
+  void acquireSequence();
+  void resetOrder();
   void applyPermutation();
-  float generateSample(float frequency);
-  float calculateEnvelopeGain();
-  void updateVolumeRamp(float deltaTime);
+  void scheduleLoop(float sampleRate);
+  void buildEnvelopeShape(float sampleRate);
+  int64_t eventFrame(int event) const;
+  void applyEvent(int event, float sampleRate);
+  void seekSequence(int64_t frames, float sampleRate);
+  int allocateVoice();
+  int64_t framesToNextVoiceSegment() const;
+  void advanceVoices(int count, bool rendered);
+  void renderSpan(float *output, int count);
+  void beginRamp(float targetGain, float sampleRate);
+  void advanceRamp(int count);
+  void publishSignals();
   
-  // Permutation functions
+  // Permutation functions: O(1) updates of the order, never move notes
   void shuffleNotes();
   void rotateNotesForward();
   void rotateNotesBackward();
   void reverseNotes();
+  int noteCount() const { return _tables[_activeTable].count; }
 };
 
 } // namespace audioapi
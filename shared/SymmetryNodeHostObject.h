@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SymmetryNode.h"
+#include "VoiceRenderer.h"
 #include <audioapi/HostObjects/AudioNodeHostObject.h>
 #include <jsi/jsi.h>
 #include <memory>
@@ -18,6 +19,16 @@ namespace audioapi {
 #define SYMMETRY_PROPERTY_SETTER(type, name) \
   if (propName == #name) { \
     node_->name = static_cast<type>(value.asNumber()); \
+    node_->touchParams(); \
+    return; \
+  }
+
+// Parameters that define the note table, which is rebuilt here on the JS thread
+#define SYMMETRY_SEQUENCE_SETTER(type, name) \
+  if (propName == #name) { \
+    node_->name = static_cast<type>(value.asNumber()); \
+    node_->prepareSequence(); \
+    node_->touchParams(); \
     return; \
   }
 
@@ -32,12 +43,13 @@ namespace audioapi {
     return; \
   }
 
-class SymmetryNodeHostObject : public AudioNodeHostObject {
+class SymmetryNodeHostObject : public AudioNodeHostObject, public VoiceHostObject {
 public:
   explicit SymmetryNodeHostObject(std::shared_ptr<SymmetryNode> node)
       : AudioNodeHostObject(std::static_pointer_cast<AudioNode>(node)), node_(node) {}
 
   jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    trace::Scope traceScope("jsi", "Symmetry.get", node_.get());
     auto propName = propNameId.utf8(runtime);
 
     SYMMETRY_PROPERTY(double, f0)
@@ -47,6 +59,7 @@ public:
     SYMMETRY_PROPERTY(int, waveform)
     SYMMETRY_PROPERTY(int, permfunc)
     SYMMETRY_PROPERTY(double, volume)
+    SYMMETRY_PROPERTY(double, release)
     SYMMETRY_PROPERTY_BOOL(shouldStart)
     SYMMETRY_PROPERTY_BOOL(shouldPause)
     SYMMETRY_PROPERTY_BOOL(shouldResume)
@@ -57,15 +70,23 @@ public:
   }
 
   void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    trace::Scope traceScope("jsi", "Symmetry.set", node_.get());
     auto propName = propNameId.utf8(runtime);
+    trace::commandQueued(propName, value.isBool() && value.getBool(), node_.get());
 
-    SYMMETRY_PROPERTY_SETTER(double, f0)
-    SYMMETRY_PROPERTY_SETTER(double, noctaves)
-    SYMMETRY_PROPERTY_SETTER(int, nnotes)
+    SYMMETRY_SEQUENCE_SETTER(double, f0)
+    SYMMETRY_SEQUENCE_SETTER(double, noctaves)
+    SYMMETRY_SEQUENCE_SETTER(int, nnotes)
     SYMMETRY_PROPERTY_SETTER(double, d)
     SYMMETRY_PROPERTY_SETTER(int, waveform)
     SYMMETRY_PROPERTY_SETTER(int, permfunc)
     SYMMETRY_PROPERTY_SETTER(double, volume)
+    SYMMETRY_PROPERTY_SETTER(double, release)
+    if (propName == "seed") {
+      node_->setSeed(static_cast<uint32_t>(value.asNumber()));
+      node_->touchParams();
+      return;
+    }
     SYMMETRY_PROPERTY_SETTER_BOOL(shouldStart)
     SYMMETRY_PROPERTY_SETTER_BOOL(shouldPause)
     SYMMETRY_PROPERTY_SETTER_BOOL(shouldResume)
@@ -74,12 +95,17 @@ public:
     AudioNodeHostObject::set(runtime, propNameId, value);
   }
 
+  std::shared_ptr<VoiceRenderer> getVoiceRenderer() const override {
+    return node_;
+  }
+
 private:
   std::shared_ptr<SymmetryNode> node_;
 };
 
 #undef SYMMETRY_PROPERTY
 #undef SYMMETRY_PROPERTY_SETTER
+#undef SYMMETRY_SEQUENCE_SETTER
 #undef SYMMETRY_PROPERTY_BOOL
 #undef SYMMETRY_PROPERTY_SETTER_BOOL
 
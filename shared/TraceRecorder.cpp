@@ -0,0 +1,158 @@
+#include "TraceRecorder.h"
+#include <chrono>
+#include <cinttypes>
+#include <pthread.h>
+
+namespace audioapi::trace {
+
+namespace {
+
+// Trace thread ids: a thread's id is its slot in this constant-initialized
+// table, claimed on its first event. No thread_local, whose dynamic
+// initialization (and emulated TLS on Android) may allocate on the audio
+// thread. Threads past kMaxThreads share id 0.
+constexpr int kMaxThreads = 32;
+std::atomic<uintptr_t> threadIds[kMaxThreads];
+
+uint32_t currentThread() {
+  // pthread_t is an integer on Android and a pointer on Apple platforms
+  const uintptr_t self = (uintptr_t)pthread_self();
+  for (int i = 0; i < kMaxThreads; ++i) {
+    uintptr_t id = threadIds[i].load(std::memory_order_acquire);
+    if (id == 0 && threadIds[i].compare_exchange_strong(id, self, std::memory_order_acq_rel)) {
+      return static_cast<uint32_t>(i + 1);
+    }
+    if (id == self) {
+      return static_cast<uint32_t>(i + 1);
+    }
+  }
+  return 0;
+}
+
+constexpr const char *kCommandNames[] = {
+    "shouldStart", "shouldPause", "shouldResume", "shouldStop", "shouldResetPhase",
+};
+
+} // namespace
+
+uint64_t nowNanos() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+const char *commandName(const std::string &property) {
+  for (const char *name : kCommandNames) {
+    if (property == name) {
+      return name;
+    }
+  }
+  return nullptr;
+}
+
+TraceRecorder &TraceRecorder::shared() {
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+bool TraceRecorder::start(const std::string &path) {
+  std::lock_guard<std::mutex> lock(controlMutex_);
+  if (enabled_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+  if (!ring_) {
+    ring_ = std::make_unique<MpmcRing<Event, kCapacity>>();
+  }
+  // The ring is empty here: the previous capture was drained by stop(), and
+  // a record() that saw it still on may only now be leaving
+  waitForWriters();
+  ring_->reset();
+  dropped_.store(0, std::memory_order_relaxed);
+
+  file_ = file;
+  path_ = path;
+  written_ = 0;
+  originNanos_ = nowNanos();
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file_);
+
+  flushing_.store(true, std::memory_order_relaxed);
+  flusher_ = std::thread(&TraceRecorder::flushLoop, this);
+  const uint32_t capture = capture_.load(std::memory_order_relaxed) + 1;
+  capture_.store(capture != 0 ? capture : 1, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_seq_cst);
+  return true;
+}
+
+TraceRecorder::Summary TraceRecorder::stop() {
+  std::lock_guard<std::mutex> lock(controlMutex_);
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return {};
+  }
+  enabled_.store(false, std::memory_order_seq_cst);
+  flushing_.store(false, std::memory_order_relaxed);
+  flusher_.join();
+  // Writers that saw enabled_ just before the store publish their event
+  // before leaving; the last drain must see it.
+  waitForWriters();
+  drain();
+
+  fputs("\n]}\n", file_);
+  fclose(file_);
+  file_ = nullptr;
+  return {path_, written_, dropped_.load(std::memory_order_relaxed)};
+}
+
+void TraceRecorder::record(char phase, const char *category, const char *name, uint64_t id, uint32_t capture) {
+  // Counted before the check: once stop() has turned tracing off and seen no
+  // writers, none can still write the ring (seq_cst on both sides).
+  writers_.fetch_add(1, std::memory_order_seq_cst);
+  if (enabled_.load(std::memory_order_seq_cst) &&
+      (capture == 0 || capture == capture_.load(std::memory_order_relaxed))) {
+    push(phase, category, name, id);
+  }
+  writers_.fetch_sub(1, std::memory_order_release);
+}
+
+void TraceRecorder::waitForWriters() {
+  while (writers_.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+void TraceRecorder::push(char phase, const char *category, const char *name, uint64_t id) {
+  const Event event{category, name, nowNanos(), id, currentThread(), phase};
+  if (!ring_->push([&](Event &slot) { slot = event; })) {
+    // Full: the flusher has not caught up
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void TraceRecorder::flushLoop() {
+  while (flushing_.load(std::memory_order_relaxed)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kFlushIntervalMs));
+    drain();
+  }
+}
+
+void TraceRecorder::drain() {
+  ring_->drain([this](const Event &event) { write(event); });
+  fflush(file_);
+}
+
+void TraceRecorder::write(const Event &event) {
+  const double micros = static_cast<double>(event.timestampNanos - originNanos_) * 1e-3;
+  fprintf(file_, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%" PRIu32,
+          written_ > 0 ? ",\n" : "", event.name, event.category, event.phase, micros, event.thread);
+  if (event.phase == 'b' || event.phase == 'e') {
+    fprintf(file_, ",\"id\":\"0x%" PRIx64 "\"", event.id);
+  } else if (event.id != 0 && (event.phase == 'B' || event.phase == 'i')) {
+    fprintf(file_, ",\"args\":{\"node\":\"0x%" PRIx64 "\"}", event.id);
+  }
+  fputs("}", file_);
+  ++written_;
+}
+
+} // namespace audioapi::trace
@@ -0,0 +1,157 @@
+#pragma once
+#include "MpmcRing.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace audioapi::trace {
+
+// Opt-in Chrome trace capture (chrome://tracing, ui.perfetto.dev).
+//
+// Events go into a preallocated bounded ring (MpmcRing: one CAS to claim a
+// slot, no locks, no allocation), written from the audio thread, the voice
+// render workers and the JS thread alike. A background thread drains the
+// ring every kFlushIntervalMs into a trace JSON file. When the ring is full
+// new events are dropped and counted rather than blocking the writer.
+//
+// While tracing is off every hook is a single relaxed load.
+//
+// What is recorded:
+// - processNode of every custom node, as a duration slice (category "dsp")
+// - control commands (shouldStart/Pause/Resume/Stop...), as async slices
+//   from the JS set to the quantum that applies them (category "command")
+// - JSI host object get/set calls, as duration slices (category "jsi")
+// - startup phases, and each node's first block and first sound after play,
+//   as slices and instants (category "startup", see StartupProfiler.h)
+struct Event {
+  const char *category = nullptr;  // string literals only
+  const char *name = nullptr;
+  uint64_t timestampNanos = 0;
+  uint64_t id = 0;                 // async pairing / node address
+  uint32_t thread = 0;
+  char phase = 0;                  // Chrome trace phase: B, E, b, e, i
+};
+
+class TraceRecorder {
+public:
+  static constexpr uint64_t kCapacity = 1 << 16;
+  static constexpr int kFlushIntervalMs = 50;
+
+  static TraceRecorder &shared();
+
+  // JS thread. Opens path and starts the flusher; false if tracing is
+  // already on or the file cannot be created.
+  bool start(const std::string &path);
+  // JS thread. Flushes what is left, closes the file. Returns the events
+  // written and dropped over the capture.
+  struct Summary {
+    std::string path;
+    uint64_t events = 0;
+    uint64_t dropped = 0;
+  };
+  Summary stop();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  // Identifies the running capture; 0 while tracing is off
+  uint32_t capture() const { return enabled() ? capture_.load(std::memory_order_relaxed) : 0; }
+
+  // Dropped unless tracing is on and, for a nonzero capture, still in that
+  // capture (so a slice never ends in a later capture than it began in).
+  void record(char phase, const char *category, const char *name, uint64_t id, uint32_t capture = 0);
+
+private:
+  TraceRecorder() = default;
+  void push(char phase, const char *category, const char *name, uint64_t id);
+  // Until no record() that may still write the ring is in flight
+  void waitForWriters();
+  void flushLoop();
+  void drain();
+  void write(const Event &event);
+
+  std::unique_ptr<MpmcRing<Event, kCapacity>> ring_;  // allocated by the first start()
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint32_t> capture_{0};
+  // record() calls between their enabled_ check and their publish
+  alignas(64) std::atomic<uint32_t> writers_{0};
+
+  std::mutex controlMutex_;  // start/stop
+  std::atomic<bool> flushing_{false};
+  std::thread flusher_;
+  FILE *file_ = nullptr;
+  std::string path_;
+  uint64_t written_ = 0;
+  uint64_t originNanos_ = 0;
+};
+
+uint64_t nowNanos();
+
+inline bool enabled() {
+  return TraceRecorder::shared().enabled();
+}
+
+// Duration slice for the enclosing scope. Both ends are recorded in the
+// capture running at construction, so a capture starting (or restarting)
+// mid-scope never gets an unmatched end.
+class Scope {
+public:
+  Scope(const char *category, const char *name, const void *object = nullptr)
+      : category_(category), name_(name), id_(reinterpret_cast<uintptr_t>(object)),
+        capture_(TraceRecorder::shared().capture()) {
+    if (capture_ != 0) {
+      TraceRecorder::shared().record('B', category_, name_, id_, capture_);
+    }
+  }
+  ~Scope() {
+    if (capture_ != 0) {
+      TraceRecorder::shared().record('E', category_, name_, id_, capture_);
+    }
+  }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  const char *category_;
+  const char *name_;
+  uint64_t id_;
+  uint32_t capture_;
+};
+
+// Static name of a control flag property ("shouldPause"...), or nullptr
+const char *commandName(const std::string &property);
+
+// JS thread, from a host object setter: a command was queued on a node
+inline void commandQueued(const std::string &property, bool value, const void *node) {
+  if (value && enabled()) {
+    if (const char *name = commandName(property)) {
+      TraceRecorder::shared().record('b', "command", name, reinterpret_cast<uintptr_t>(node));
+    }
+  }
+}
+
+// Audio thread, before a node consumes its flags: ends the command slices
+// of every flag that is set
+inline void commandsApplied(const void *node, std::initializer_list<std::pair<const char *, bool>> flags) {
+  if (enabled()) {
+    for (const auto &[name, set] : flags) {
+      if (set) {
+        TraceRecorder::shared().record('e', "command", name, reinterpret_cast<uintptr_t>(node));
+      }
+    }
+  }
+}
+
+} // namespace audioapi::trace
+
+#define CUSTOM_NODES_TRACE_SCOPE(category, name) \
+  ::audioapi::trace::Scope traceScope_((category), (name), this)
+
+// Names the flags by their member names, matching the host object properties
+#define CUSTOM_NODES_TRACE_FLAG(flag) std::pair<const char *, bool>(#flag, flag)
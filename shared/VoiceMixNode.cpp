@@ -0,0 +1,836 @@
+#include "VoiceMixNode.h"
+#include "VoiceRenderPool.h"
+#include "AnimationValueRegistry.h"
+#include <audioapi/utils/AudioBus.h>
+#include <audioapi/utils/AudioArray.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace audioapi {
+
+namespace {
+
+// The recording runs this long past the nominal duration so that the voices'
+// stop fade-out, triggered by the session timer, is part of the file.
+constexpr double kTailSeconds = 2.0;
+// A stop this close to the nominal end still counts as a complete session.
+constexpr double kStopGraceSeconds = 1.0;
+constexpr double kPrefetchIntervalSeconds = 0.5;
+constexpr double kPrefetchAheadSeconds = 2.0;
+// Crossfade from the cached stream back to the live voices, as long as the
+// voices' start ramp.
+constexpr float kFallbackSeconds = 1.5f;
+// Longer than the gap between two device callbacks: an audio thread away
+// this long has stopped, and waitForInstall() installs the edits itself.
+constexpr auto kIdleInstallTime = std::chrono::milliseconds(100);
+
+// Marks processNode as running for waitForInstall() (renderSeq_ is odd
+// inside)
+class RenderSeqScope {
+public:
+  explicit RenderSeqScope(std::atomic<uint32_t> &seq) : seq_(seq) { seq_.fetch_add(1, std::memory_order_seq_cst); }
+  ~RenderSeqScope() { seq_.fetch_add(1, std::memory_order_release); }
+
+private:
+  std::atomic<uint32_t> &seq_;
+};
+
+} // namespace
+
+VoiceMixNode::VoiceMixNode(BaseAudioContext *context)
+    : AudioNode(context),
+      sampleRate_(context->getSampleRate()),
+      fallbackFrames_(static_cast<int>(kFallbackSeconds * context->getSampleRate())) {
+  channelCount_ = 2;
+  channelCountMode_ = ChannelCountMode::EXPLICIT;
+  channelInterpretation_ = ChannelInterpretation::SPEAKERS;
+
+  // Scratch buses are allocated up front so processNode never allocates.
+  for (auto &slot : slots_) {
+    slot.scratch = std::make_shared<AudioBus>(kScratchFrames, 2, context->getSampleRate());
+  }
+  // Start the worker threads now rather than on the first parallel quantum,
+  // and have them join the workgroup of the device this context plays on.
+  VoiceRenderPool::shared().refreshWorkgroup();
+
+  isInitialized_ = true;
+}
+
+bool VoiceMixNode::addVoice(const std::shared_ptr<VoiceRenderer> &voice) {
+  if (!voice) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(voicesMutex_);
+  auto &staged = staged_;
+  if (staged.voiceCount >= kMaxVoices) {
+    return false;
+  }
+  staged.voices[staged.voiceCount++] = {voice};
+  rebuildModulation();
+  ++staged.mixGeneration;
+  publishStaged();
+  return true;
+}
+
+void VoiceMixNode::removeVoice(const std::shared_ptr<VoiceRenderer> &voice) {
+  uint32_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(voicesMutex_);
+    auto &staged = staged_;
+    int i = 0;
+    while (i < staged.voiceCount && staged.voices[i].voice != voice) {
+      ++i;
+    }
+    if (i == staged.voiceCount) {
+      return;
+    }
+    // Its copies render on their own from here
+    for (int j = 0; j < staged.voiceCount; ++j) {
+      if (staged.voices[j].leader == i) {
+        unshareStaged(j);
+      }
+    }
+    // Keep the remaining voices in order: summation order is part of the output.
+    for (int j = i; j < staged.voiceCount - 1; ++j) {
+      std::swap(staged.voices[j], staged.voices[j + 1]);
+    }
+    staged.voices[--staged.voiceCount] = {};
+    for (int j = 0; j < staged.voiceCount; ++j) {
+      staged.voices[j].leader -= staged.voices[j].leader > i ? 1 : 0;
+    }
+    staged.modulation.removeVoice(voice.get());
+    rebuildModulation();
+    ++staged.mixGeneration;
+    generation = publishStaged();
+  }
+  // The install writes the routed parameters back and lets the copies take
+  // over the voice's state; until then the caller's reference keeps it alive
+  waitForInstall(generation);
+}
+
+void VoiceMixNode::clearVoices() {
+  std::array<std::shared_ptr<VoiceRenderer>, kMaxVoices> voices;
+  uint32_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(voicesMutex_);
+    auto &staged = staged_;
+    staged.modulation.clear();
+    for (int i = 0; i < staged.voiceCount; ++i) {
+      voices[i] = std::move(staged.voices[i].voice);
+      staged.voices[i] = {};
+    }
+    staged.voiceCount = 0;
+    rebuildModulation();
+    ++staged.mixGeneration;
+    generation = publishStaged();
+  }
+  // Released here, on the JS thread, once the audio thread is done with them
+  waitForInstall(generation);
+}
+
+int VoiceMixNode::addModulation(const std::shared_ptr<VoiceRenderer> &source, const std::string &signal,
+                                const std::shared_ptr<VoiceRenderer> &target, const std::string &param,
+                                float depth, float offset) {
+  std::lock_guard<std::mutex> lock(voicesMutex_);
+  auto &staged = staged_;
+  auto isVoice = [&staged](const std::shared_ptr<VoiceRenderer> &voice) {
+    for (int v = 0; v < staged.voiceCount; ++v) {
+      if (staged.voices[v].voice == voice) {
+        return true;
+      }
+    }
+    return false;
+  };
+  if (!isVoice(source) || !isVoice(target)) {
+    return -1;
+  }
+  const int id = staged.modulation.addRoute(source.get(), signal, target.get(), param, depth, offset);
+  if (id >= 0) {
+    unshareRouted(source.get());
+    unshareRouted(target.get());
+    rebuildModulation();
+    ++staged.mixGeneration;
+    publishStaged();
+  }
+  return id;
+}
+
+void VoiceMixNode::removeModulation(int id) {
+  std::lock_guard<std::mutex> lock(voicesMutex_);
+  if (staged_.modulation.removeRoute(id)) {
+    rebuildModulation();
+    ++staged_.mixGeneration;
+    publishStaged();
+  }
+}
+
+void VoiceMixNode::clearModulations() {
+  std::lock_guard<std::mutex> lock(voicesMutex_);
+  if (staged_.modulation.routeCount() > 0) {
+    staged_.modulation.clear();
+    rebuildModulation();
+    ++staged_.mixGeneration;
+    publishStaged();
+  }
+}
+
+// Under voicesMutex_, on the staged voices
+void VoiceMixNode::rebuildModulation() {
+  std::array<const VoiceRenderer *, kMaxVoices> voices{};
+  for (int v = 0; v < staged_.voiceCount; ++v) {
+    voices[v] = staged_.voices[v].voice.get();
+  }
+  staged_.modulation.rebuild(voices.data(), staged_.voiceCount);
+}
+
+// Under voicesMutex_: makes the staged mix the one processNode installs next
+uint32_t VoiceMixNode::publishStaged() {
+  addedVoices_.store(staged_.voiceCount, std::memory_order_relaxed);
+  publishedGeneration_.store(++stagedGeneration_, std::memory_order_release);
+  return stagedGeneration_;
+}
+
+// JS thread, without voicesMutex_. The audio thread installs at its next
+// quantum; once it has not entered processNode for kIdleInstallTime
+// (context suspended, mixer disconnected), this thread installs instead.
+void VoiceMixNode::waitForInstall(uint32_t generation) {
+  auto installed = [this, generation] {
+    return static_cast<int32_t>(installedGeneration_.load(std::memory_order_acquire) - generation) >= 0;
+  };
+  uint32_t seq = renderSeq_.load(std::memory_order_seq_cst);
+  auto quietSince = std::chrono::steady_clock::now();
+  while (!installed()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const uint32_t current = renderSeq_.load(std::memory_order_seq_cst);
+    if (current != seq) {
+      seq = current;
+      quietSince = std::chrono::steady_clock::now();
+      continue;
+    }
+    if ((seq & 1) != 0 || std::chrono::steady_clock::now() - quietSince < kIdleInstallTime) {
+      continue;
+    }
+    // A quantum that starts now sees installingOnJs_ and outputs silence;
+    // one that started first changed renderSeq_, and this thread backs off.
+    std::lock_guard<std::mutex> lock(voicesMutex_);
+    installingOnJs_.store(true, std::memory_order_seq_cst);
+    if (renderSeq_.load(std::memory_order_seq_cst) == seq && !installed()) {
+      installStaged();
+    }
+    installingOnJs_.store(false, std::memory_order_release);
+  }
+}
+
+// Under voicesMutex_, at the start of a quantum (or see waitForInstall).
+// Route edits reach the voices' parameters here, while every voice involved
+// is still alive. A copy keeps sharing only with the leader it had, or the
+// one shareIdenticalVoices() just gave it; any other copy takes over its
+// previous leader's state, so the copies the audio thread split off since
+// the last install stay apart.
+void VoiceMixNode::installStaged() {
+  auto &staged = staged_;
+  staged.modulation.syncPorts(modulation_);
+
+  const int previousCount = voiceCount_;
+  std::array<VoiceRenderer *, kMaxVoices> previous{};
+  std::array<const VoiceRenderer *, kMaxVoices> previousLeaders{};
+  std::array<float, kMaxVoices> previousGains{};
+  std::array<uint32_t, kMaxVoices> previousControls{};
+  for (int v = 0; v < previousCount; ++v) {
+    const auto &slot = slots_[v];
+    previous[v] = slot.voice;
+    previousLeaders[v] = slot.leader >= 0 ? slots_[slot.leader].voice : nullptr;
+    previousGains[v] = slot.gain;
+    previousControls[v] = slot.controls;
+  }
+
+  int shared = 0;
+  for (int v = 0; v < staged.voiceCount; ++v) {
+    auto &next = staged.voices[v];
+    auto &slot = slots_[v];
+    const int was = static_cast<int>(std::find(previous.begin(), previous.begin() + previousCount,
+                                               next.voice.get()) - previous.begin());
+    const VoiceRenderer *oldLeader = was < previousCount ? previousLeaders[was] : nullptr;
+    const VoiceRenderer *leader = next.leader >= 0 ? staged.voices[next.leader].voice.get() : nullptr;
+    slot.voice = next.voice.get();
+    slot.volumePort = next.volumePort;
+    if (leader != nullptr && (leader == oldLeader || next.joining)) {
+      const bool kept = leader == oldLeader;
+      slot.leader = next.leader;
+      slot.gain = kept ? previousGains[was] : 1.0f;
+      slot.controls = kept ? previousControls[was] : 0;
+      ++shared;
+    } else {
+      if (oldLeader != nullptr) {
+        slot.voice->copyRenderState(*oldLeader);
+      }
+      slot.leader = -1;
+    }
+    next.leader = slot.leader;
+    next.joining = false;
+  }
+  for (int v = staged.voiceCount; v < previousCount; ++v) {
+    slots_[v].voice = nullptr;
+    slots_[v].leader = -1;
+  }
+
+  // Voices that left go back to rendering on their own, from the start
+  for (int v = 0; v < previousCount; ++v) {
+    bool stays = false;
+    for (int u = 0; u < staged.voiceCount && !stays; ++u) {
+      stays = staged.voices[u].voice.get() == previous[v];
+    }
+    if (!stays) {
+      previous[v]->setQualityTier(QualityTier::Full);
+      previous[v]->clearMartigliSnapshot();
+      previous[v]->seekVoice(0);
+    }
+  }
+
+  voiceCount_ = staged.voiceCount;
+  modulation_ = staged.modulation;
+  mixGeneration_ = staged.mixGeneration;
+  sharedVoices_ = shared;
+  renderedSharedVoices_.store(shared, std::memory_order_relaxed);
+
+  if (staged.cacheChanged) {
+    staged.cacheChanged = false;
+    std::swap(cacheSession_, staged.cacheSession);
+    std::swap(recorder_, staged.recorder);
+    const CacheMode mode = staged.cacheMode;
+    staged.cacheMode = cacheMode_.load(std::memory_order_relaxed);
+    staged.stoppedAtEnd = stoppedAtEnd_;
+    cacheMode_.store(mode, std::memory_order_relaxed);
+    sessionFrames_ = staged.sessionFrames;
+    cacheFrame_ = 0;
+    nextPrefetchFrame_ = 0;
+    fallbackFramesLeft_ = 0;
+    stoppedAtEnd_ = false;
+    paramGeneration_ = sumParamGenerations();
+  }
+  installedGeneration_.store(stagedGeneration_, std::memory_order_release);
+}
+
+int VoiceMixNode::shareIdenticalVoices() {
+  std::lock_guard<std::mutex> lock(voicesMutex_);
+  auto &staged = staged_;
+  // Copies of earlier calls keep their leaders, which lead only
+  std::array<bool, kMaxVoices> leads{};
+  for (int v = 0; v < staged.voiceCount; ++v) {
+    if (staged.voices[v].leader >= 0) {
+      leads[staged.voices[v].leader] = true;
+    }
+  }
+  // Read while the voices may be rendering: the audio thread checks keys and
+  // pending controls again before every chunk and splits a wrong pair.
+  std::array<uint64_t, kMaxVoices> keys{};
+  int shared = 0;
+  for (int v = 0; v < staged.voiceCount; ++v) {
+    auto &entry = staged.voices[v];
+    entry.volumePort = entry.voice->modulation().findParam("volume");
+    if (entry.leader < 0 && entry.volumePort >= 0 && !staged.modulation.hasRoutes(entry.voice.get())) {
+      keys[v] = entry.voice->renderKey();
+    }
+    if (leads[v]) {
+      continue;
+    }
+    for (int u = 0; u < v && keys[v] != 0; ++u) {
+      if (keys[u] == keys[v] && staged.voices[u].leader < 0 &&
+          staged.voices[u].voice->pendingControls() == entry.voice->pendingControls()) {
+        entry.leader = u;
+        entry.joining = true;
+        break;
+      }
+    }
+    shared += entry.leader >= 0 ? 1 : 0;
+  }
+  publishStaged();
+  return shared;
+}
+
+// Audio thread: the voices are not rendering
+void VoiceMixNode::unshareVoice(int index) {
+  auto &slot = slots_[index];
+  if (slot.leader < 0) {
+    return;
+  }
+  slot.voice->copyRenderState(*slots_[slot.leader].voice);
+  slot.leader = -1;
+  --sharedVoices_;
+  renderedSharedVoices_.store(sharedVoices_, std::memory_order_relaxed);
+}
+
+// Under voicesMutex_: the install copies the leader's state
+void VoiceMixNode::unshareStaged(int index) {
+  staged_.voices[index].leader = -1;
+  staged_.voices[index].joining = false;
+}
+
+void VoiceMixNode::unshareRouted(const VoiceRenderer *voice) {
+  for (int v = 0; v < staged_.voiceCount; ++v) {
+    const auto &entry = staged_.voices[v];
+    if (entry.leader >= 0 &&
+        (entry.voice.get() == voice || staged_.voices[entry.leader].voice.get() == voice)) {
+      unshareStaged(v);
+    }
+  }
+}
+
+// Before rendering the chunk: a copy whose key, pending controls or volume
+// no longer allow sharing takes over its leader's state before the leader
+// moves on
+void VoiceMixNode::checkSharedVoices() {
+  for (int v = 0; v < voiceCount_; ++v) {
+    auto &slot = slots_[v];
+    if (slot.leader < 0) {
+      continue;
+    }
+    const auto &leader = slots_[slot.leader];
+    const float leaderVolume = leader.voice->modulation().getParam(leader.volumePort);
+    slot.controls = slot.voice->pendingControls();
+    if (leaderVolume <= 0.0f || slot.voice->renderKey() != leader.voice->renderKey() ||
+        slot.controls != leader.voice->pendingControls()) {
+      unshareVoice(v);
+      continue;
+    }
+    slot.gain = slot.voice->modulation().getParam(slot.volumePort) / leaderVolume;
+  }
+}
+
+VoiceMixNode::CacheMode VoiceMixNode::useRenderCache(
+    const std::string &descriptor, double durationSeconds, uint32_t seed) {
+  auto &cache = SessionRenderCache::shared();
+  const uint64_t key = SessionRenderCache::makeKey(descriptor, durationSeconds, sampleRate_, seed);
+  const auto frames = static_cast<uint64_t>(durationSeconds * sampleRate_);
+
+  CacheMode mode = CacheMode::Off;
+  std::shared_ptr<RenderedSession> session;
+  std::shared_ptr<RenderedSession> stale;
+  {
+    std::lock_guard<std::mutex> lock(preparedMutex_);
+    if (preparedSession_ && preparedKey_ == key) {
+      session = std::move(preparedSession_);
+      mode = preparedMode_;
+    } else {
+      stale = std::move(preparedSession_);
+    }
+  }
+  cache.commit(stale);
+  if (!session) {
+    session = openRenderCache(key, durationSeconds, mode);
+  }
+
+  auto recorder = mode == CacheMode::Recording ? std::make_unique<RecordingWriter>(session) : nullptr;
+  uint32_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(voicesMutex_);
+    staged_.cacheSession = session;
+    staged_.recorder = std::move(recorder);
+    staged_.cacheMode = mode;
+    staged_.sessionFrames = frames;
+    staged_.cacheChanged = true;
+    generation = publishStaged();
+  }
+  waitForInstall(generation);
+
+  // The install handed back the session it replaced
+  std::shared_ptr<RenderedSession> previous;
+  std::unique_ptr<RecordingWriter> previousRecorder;
+  {
+    std::lock_guard<std::mutex> lock(voicesMutex_);
+    previous = std::move(staged_.cacheSession);
+    previousRecorder = std::move(staged_.recorder);
+  }
+  if (previousRecorder) {
+    previousRecorder->finish();
+  }
+  cache.commit(previous);
+  return mode;
+}
+
+VoiceMixNode::CacheMode VoiceMixNode::prepareRenderCache(
+    const std::string &descriptor, double durationSeconds, uint32_t seed) {
+  const uint64_t key = SessionRenderCache::makeKey(descriptor, durationSeconds, sampleRate_, seed);
+  CacheMode mode = CacheMode::Off;
+  auto session = openRenderCache(key, durationSeconds, mode);
+  if (mode == CacheMode::Replaying) {
+    // The first quanta of a replay read these pages: take the faults here
+    // rather than on the audio thread (recordings are written off it anyway)
+    session->touch(0, static_cast<uint64_t>(kPrefetchAheadSeconds * sampleRate_));
+  }
+
+  std::shared_ptr<RenderedSession> previous;
+  {
+    std::lock_guard<std::mutex> lock(preparedMutex_);
+    previous = std::move(preparedSession_);
+    preparedSession_ = session;
+    preparedKey_ = key;
+    preparedMode_ = mode;
+  }
+  SessionRenderCache::shared().commit(previous);
+  return mode;
+}
+
+std::shared_ptr<RenderedSession> VoiceMixNode::openRenderCache(uint64_t key, double durationSeconds,
+                                                               CacheMode &mode) {
+  auto &cache = SessionRenderCache::shared();
+  const auto frames = static_cast<uint64_t>(durationSeconds * sampleRate_);
+  const auto tailFrames = static_cast<uint64_t>(kTailSeconds * sampleRate_);
+
+  mode = CacheMode::Replaying;
+  auto session = cache.openForReplay(key);
+  if (!session) {
+    mode = CacheMode::Recording;
+    session = cache.beginRecording(key, frames + tailFrames, 2, sampleRate_);
+  }
+  if (!session) {
+    mode = CacheMode::Off;
+  }
+  return session;
+}
+
+void VoiceMixNode::finishRenderCache() {
+  std::shared_ptr<RenderedSession> prepared;
+  {
+    std::lock_guard<std::mutex> lock(preparedMutex_);
+    prepared = std::move(preparedSession_);
+  }
+  SessionRenderCache::shared().commit(prepared);
+
+  uint32_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(voicesMutex_);
+    staged_.cacheSession.reset();
+    staged_.recorder.reset();
+    staged_.cacheMode = CacheMode::Off;
+    staged_.sessionFrames = 0;
+    staged_.cacheChanged = true;
+    generation = publishStaged();
+  }
+  waitForInstall(generation);
+
+  std::shared_ptr<RenderedSession> session;
+  std::unique_ptr<RecordingWriter> recorder;
+  bool fillTail = false;
+  {
+    std::lock_guard<std::mutex> lock(voicesMutex_);
+    session = std::move(staged_.cacheSession);
+    recorder = std::move(staged_.recorder);
+    fillTail = recorder && staged_.cacheMode == CacheMode::Recording && staged_.stoppedAtEnd;
+  }
+  if (recorder) {
+    const uint64_t recorded = recorder->finish();
+    if (fillTail && !session->isComplete()) {
+      // The stop fade-out has finished by now; the rest of the tail is silence.
+      const uint64_t remaining = session->frames() - recorded;
+      for (int c = 0; c < session->channels(); ++c) {
+        memset(session->channelData(c) + recorded, 0, remaining * sizeof(float));
+      }
+      const uint64_t block = recorded / RenderedSession::kControlBlock;
+      std::fill(session->controlData() + block, session->controlData() + session->controlCount(),
+                animationValue_.load(std::memory_order_relaxed));
+      session->markComplete();
+    }
+  }
+  SessionRenderCache::shared().commit(session);
+}
+
+uint32_t VoiceMixNode::sumParamGenerations() const {
+  // Voices joining or leaving and routes change the sound as much as the
+  // voices' own parameters do; the sum alone would miss a voice whose
+  // generation is 0, or a swap of two with equal generations.
+  uint32_t sum = mixGeneration_;
+  for (int v = 0; v < voiceCount_; ++v) {
+    sum += slots_[v].voice->getParamGeneration();
+  }
+  return sum;
+}
+
+void VoiceMixNode::rampGain(float target, float seconds) {
+  gainTarget_ = target;
+  gainStep_ = (target - gain_) / (seconds * sampleRate_);
+}
+
+void VoiceMixNode::handleControlFlags() {
+  trace::commandsApplied(this, {CUSTOM_NODES_TRACE_FLAG(shouldStart),
+                                CUSTOM_NODES_TRACE_FLAG(shouldPause),
+                                CUSTOM_NODES_TRACE_FLAG(shouldResume),
+                                CUSTOM_NODES_TRACE_FLAG(shouldStop)});
+  CacheMode mode = cacheMode_.load(std::memory_order_relaxed);
+
+  if (shouldStart) {
+    shouldStart = false;
+    isRunning_ = true;
+    isPaused_ = false;
+    // No ramp: the cached audio already contains the voices' fade-in.
+    gain_ = 1.0f;
+    gainTarget_ = 1.0f;
+    gainStep_ = 0.0f;
+  }
+  if (shouldStop) {
+    shouldStop = false;
+    rampGain(0.0f, 1.5f);
+    if (mode == CacheMode::Recording) {
+      const auto grace = static_cast<uint64_t>(kStopGraceSeconds * sampleRate_);
+      if (cacheFrame_ + grace >= sessionFrames_) {
+        stoppedAtEnd_ = true; // keep recording the fade-out into the tail
+      } else {
+        mode = CacheMode::Off; // stopped early: left incomplete, deleted on commit
+      }
+    }
+  }
+  if (shouldPause) {
+    shouldPause = false;
+    isPaused_ = true;
+    rampGain(0.0f, 0.5f);
+    // The voices keep their position while paused but the session clock
+    // does not, so a paused recording no longer matches a continuous one.
+    if (mode == CacheMode::Recording) {
+      mode = CacheMode::Off;
+    }
+  }
+  if (shouldResume) {
+    shouldResume = false;
+    isPaused_ = false;
+    rampGain(1.0f, 0.5f);
+  }
+
+  cacheMode_.store(mode, std::memory_order_relaxed);
+}
+
+void VoiceMixNode::renderSlot(void *mixer, int index) {
+  auto *self = static_cast<VoiceMixNode *>(mixer);
+  auto &slot = self->slots_[self->modulation_.order()[self->levelBase_ + index]];
+  if (slot.leader >= 0) {
+    return;
+  }
+  slot.voice->renderVoice(slot.scratch, self->chunkFrames_);
+}
+
+void VoiceMixNode::renderVoices(const std::shared_ptr<AudioBus> &bus, int framesToProcess, int numChannels) {
+  const bool useParallel = parallel && voiceCount_ >= parallelThreshold;
+  const QualityTier tier = governor_.tier();
+  for (int v = 0; v < voiceCount_; ++v) {
+    slots_[v].voice->setQualityTier(tier);
+  }
+
+  for (int offset = 0; offset < framesToProcess; offset += kScratchFrames) {
+    chunkFrames_ = std::min(kScratchFrames, framesToProcess - offset);
+    // Voices following the Martigli animation read it as of the chunk's
+    // start, whichever worker renders the Martigli voice and when
+    const float martigli = AnimationValueRegistry::getInstance().getMartigliAnimationValue();
+    for (int v = 0; v < voiceCount_; ++v) {
+      slots_[v].voice->modulation().advanceRamps(chunkFrames_);
+      slots_[v].voice->setMartigliSnapshot(martigli);
+    }
+    if (sharedVoices_ > 0) {
+      checkSharedVoices();
+    }
+
+    // Level by level: a level's parameters are written from the signals its
+    // sources published earlier in this chunk
+    for (int level = 0; level < modulation_.levelCount(); ++level) {
+      levelBase_ = modulation_.levelStart(level);
+      const int levelVoices = modulation_.levelStart(level + 1) - levelBase_;
+      modulation_.applyLevel(level);
+
+      if (useParallel && levelVoices > 1) {
+        VoiceRenderPool::shared().run(&VoiceMixNode::renderSlot, this, levelVoices);
+      } else {
+        for (int v = 0; v < levelVoices; ++v) {
+          renderSlot(this, v);
+        }
+      }
+    }
+
+    // Deterministic summation: always voice 0, 1, 2, ...
+    for (int c = 0; c < numChannels; ++c) {
+      float *out = bus->getChannel(c)->getData() + offset;
+      for (int v = 0; v < voiceCount_; ++v) {
+        const auto &slot = slots_[v];
+        if (slot.leader >= 0) {
+          const float *in = slots_[slot.leader].scratch->getChannel(c)->getData();
+          for (int i = 0; i < chunkFrames_; ++i) {
+            out[i] += slot.gain * in[i];
+          }
+          continue;
+        }
+        const float *in = slot.scratch->getChannel(c)->getData();
+        for (int i = 0; i < chunkFrames_; ++i) {
+          out[i] += in[i];
+        }
+      }
+    }
+    for (int v = 0; v < voiceCount_ && sharedVoices_ > 0; ++v) {
+      if (slots_[v].leader >= 0) {
+        slots_[v].voice->dropControls(slots_[v].controls);
+      }
+    }
+  }
+}
+
+void VoiceMixNode::mixCached(const std::shared_ptr<AudioBus> &bus, int framesToProcess, int numChannels) {
+  const auto &session = *cacheSession_;
+
+  // Paused or stopped: hold the position until resumed.
+  if (!isRunning_ || (gain_ <= 0.0f && gainTarget_ <= 0.0f)) {
+    fallbackFramesLeft_ = 0;
+    return;
+  }
+
+  if (cacheFrame_ >= nextPrefetchFrame_) {
+    session.prefetch(cacheFrame_, static_cast<uint64_t>(kPrefetchAheadSeconds * sampleRate_));
+    nextPrefetchFrame_ = cacheFrame_ + static_cast<uint64_t>(kPrefetchIntervalSeconds * sampleRate_);
+  }
+
+  const uint64_t available = session.frames() > cacheFrame_ ? session.frames() - cacheFrame_ : 0;
+  const int frames = static_cast<int>(std::min<uint64_t>(framesToProcess, available));
+  if (frames == 0) {
+    fallbackFramesLeft_ = 0;
+    return;
+  }
+  const int channels = std::min(numChannels, session.channels());
+
+  if (gainStep_ == 0.0f && gain_ == 1.0f && fallbackFramesLeft_ == 0) {
+    // Steady-state replay: the bus is still zero, so this is a straight copy.
+    for (int c = 0; c < channels; ++c) {
+      memcpy(bus->getChannel(c)->getData(), session.channelData(c) + cacheFrame_, frames * sizeof(float));
+    }
+  } else {
+    float *out[2] = {nullptr, nullptr};
+    const float *in[2] = {nullptr, nullptr};
+    for (int c = 0; c < channels; ++c) {
+      out[c] = bus->getChannel(c)->getData();
+      in[c] = session.channelData(c) + cacheFrame_;
+    }
+    // Falling back: the live voices, already in the bus at full level, fade
+    // in as the cached stream fades out, so the sum stays level
+    const bool fading = fallbackFramesLeft_ > 0;
+    for (int i = 0; i < frames; ++i) {
+      float gain = gain_;
+      float live = 1.0f;
+      if (fading) {
+        const float fade = static_cast<float>(fallbackFramesLeft_) / static_cast<float>(fallbackFrames_);
+        gain *= fade;
+        live = 1.0f - fade;
+        fallbackFramesLeft_ = std::max(fallbackFramesLeft_ - 1, 0);
+      }
+      for (int c = 0; c < channels; ++c) {
+        out[c][i] = out[c][i] * live + in[c][i] * gain;
+      }
+      if (gainStep_ != 0.0f) {
+        gain_ += gainStep_;
+        if ((gainStep_ > 0.0f && gain_ >= gainTarget_) || (gainStep_ < 0.0f && gain_ <= gainTarget_)) {
+          gain_ = gainTarget_;
+          gainStep_ = 0.0f;
+        }
+      }
+    }
+  }
+
+  animationValue_.store(session.controlData()[cacheFrame_ / RenderedSession::kControlBlock],
+                        std::memory_order_relaxed);
+  cacheFrame_ += frames;
+}
+
+void VoiceMixNode::record(const std::shared_ptr<AudioBus> &bus, int framesToProcess, int numChannels) {
+  if (!isRunning_) {
+    return;
+  }
+  const uint64_t sessionLength = cacheSession_->frames();
+  const int frames = static_cast<int>(std::min<uint64_t>(framesToProcess, sessionLength - cacheFrame_));
+
+  // Only a copy into the ring here: the recorder's thread writes the mapping
+  // and takes the page faults of first writes.
+  const float *channels[2] = {};
+  for (int c = 0; c < numChannels; ++c) {
+    channels[c] = bus->getChannel(c)->getData();
+  }
+  const float animation = AnimationValueRegistry::getInstance().getMartigliAnimationValue();
+  animationValue_.store(animation, std::memory_order_relaxed);
+  if (!recorder_->write(channels, numChannels, frames, animation)) {
+    // The writer fell a whole ring behind: left incomplete, deleted on commit
+    cacheMode_.store(CacheMode::Off, std::memory_order_relaxed);
+    return;
+  }
+
+  cacheFrame_ += frames;
+  if (cacheFrame_ >= sessionLength) {
+    cacheMode_.store(CacheMode::Off, std::memory_order_relaxed); // the recorder marks it complete
+  }
+}
+
+void VoiceMixNode::processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) {
+  CUSTOM_NODES_RT_SCOPE("VoiceMix");
+  // The voices check their own steps; here only NaN/Inf and late callbacks
+  const float maxStep = std::numeric_limits<float>::max();
+  GlitchDetector::Scope glitchScope(glitches_, bus, framesToProcess, sampleRate_, maxStep);
+  CUSTOM_NODES_DSP_SCOPE(dspLoad_, framesToProcess, sampleRate_);
+  CUSTOM_NODES_TRACE_SCOPE("dsp", "VoiceMix");
+  RenderSeqScope renderScope(renderSeq_);
+  bus->zero();
+
+  if (installingOnJs_.load(std::memory_order_seq_cst)) {
+    // Only right after the audio thread stopped for kIdleInstallTime
+    return;
+  }
+  if (publishedGeneration_.load(std::memory_order_acquire) !=
+      installedGeneration_.load(std::memory_order_relaxed)) {
+    // Busy: render the installed mix, and install at a later quantum
+    std::unique_lock<std::mutex> lock(voicesMutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+      installStaged();
+    }
+  }
+
+  handleControlFlags();
+  const int numChannels = std::min(bus->getNumberOfChannels(), 2);
+
+  CacheMode mode = cacheMode_.load(std::memory_order_relaxed);
+  if ((mode != CacheMode::Off && sumParamGenerations() != paramGeneration_) ||
+      (mode == CacheMode::Recording && governor_.tier() != QualityTier::Full)) {
+    // A voice parameter changed: the cached audio no longer matches. A
+    // recording is abandoned (deleted on commit), as is one the governor
+    // degraded, so that replays never keep the lower quality; a replay
+    // crossfades into the live voices. They have not rendered since the
+    // start, so they first jump to the replay's position (breathing clock,
+    // sequence, phases) and the mixer fades them in from there.
+    if (mode == CacheMode::Replaying) {
+      fallbackFramesLeft_ = fallbackFrames_;
+      for (int v = 0; v < voiceCount_; ++v) {
+        if (slots_[v].leader < 0) {
+          slots_[v].voice->seekVoice(cacheFrame_);
+        }
+      }
+    }
+    mode = CacheMode::Off;
+    cacheMode_.store(mode, std::memory_order_relaxed);
+  }
+
+  if (mode == CacheMode::Replaying) {
+    governor_.idle();
+    mixCached(bus, framesToProcess, numChannels);
+    return;
+  }
+
+  if (voiceCount_ > 0) {
+    const auto start = std::chrono::steady_clock::now();
+    renderVoices(bus, framesToProcess, numChannels);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    governor_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                     static_cast<uint64_t>(1e9 * framesToProcess / sampleRate_));
+  } else {
+    governor_.idle();
+  }
+  if (fallbackFramesLeft_ > 0) {
+    mixCached(bus, framesToProcess, numChannels);
+  }
+  if (mode == CacheMode::Recording) {
+    record(bus, framesToProcess, numChannels);
+  }
+}
+
+} // namespace audioapi
@@ -0,0 +1,250 @@
+#pragma once
+#include <audioapi/core/AudioNode.h>
+#include <audioapi/core/BaseAudioContext.h>
+#include "VoiceRenderer.h"
+#include "SessionRenderCache.h"
+#include "ModulationMatrix.h"
+#include "DspLoadMeter.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafety.h"
+#include "GlitchDetector.h"
+#include "QualityGovernor.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace audioapi {
+class AudioBus;
+
+// Renders a session's voices and sums them into one stereo output.
+//
+// Voices added here are NOT connected to the graph themselves: the mixer calls
+// their renderVoice() into per-voice scratch buses, in parallel on the shared
+// VoiceRenderPool once there are at least parallelThreshold voices, and then
+// sums the scratch buses in voice order so the output does not depend on
+// which thread finished first.
+//
+// With useRenderCache() the mixer either records its output into a
+// SessionRenderCache file, or replays a cached rendering without running the
+// voices at all. A parameter change on any voice, or a voice or route added
+// or removed, ends recording, and during replay crossfades back to live
+// synthesis, the voices moved to the replay's position first.
+//
+// Voices can drive each other's parameters through the mixer's
+// ModulationMatrix (addModulation); voices are then rendered level by level
+// so that every voice renders after the voices it listens to.
+//
+// Identical voices (shareIdenticalVoices) are rendered once: the copies add
+// the first one's output scaled by their volume, and split off, taking over
+// its state, as soon as their parameters or control flags differ.
+//
+// Edits from JS (voices, routes, sharing, the render cache) go to a staged
+// copy; processNode installs it at the start of a quantum, and keeps
+// rendering the voices it has while a JS thread is editing. Removing voices
+// and switching the render cache wait for the install.
+//
+// The mixer times its rendering every quantum and its QualityGovernor lowers
+// the voices' quality tier when that nears the quantum's duration, raising
+// it again once the load has stayed low. A recording is abandoned as soon
+// as the tier drops.
+class VoiceMixNode : public AudioNode {
+public:
+  static constexpr int kMaxVoices = 32;
+  static constexpr int kScratchFrames = 512;
+
+  enum class CacheMode { Off, Recording, Replaying };
+
+  explicit VoiceMixNode(BaseAudioContext *context);
+  ~VoiceMixNode() override = default;
+
+  // Called from the JS thread. removeVoice() and clearVoices() return once
+  // the audio thread has let go of the voices.
+  bool addVoice(const std::shared_ptr<VoiceRenderer> &voice);
+  void removeVoice(const std::shared_ptr<VoiceRenderer> &voice);
+  void clearVoices();
+  int getVoiceCount() const { return addedVoices_.load(std::memory_order_relaxed); }
+
+  // Called from the JS thread. Both voices must already be added. The route
+  // adds offset + depth * signal to the parameter's own value, which comes
+  // back once no route drives it. Returns the route id for
+  // removeModulation(), or -1 if either voice lacks the named
+  // signal/parameter or the route table is full.
+  int addModulation(const std::shared_ptr<VoiceRenderer> &source, const std::string &signal,
+                    const std::shared_ptr<VoiceRenderer> &target, const std::string &param,
+                    float depth, float offset);
+  void removeModulation(int id);
+  void clearModulations();
+
+  // Called from the JS thread once the session's voices are added, set up
+  // and routed, before they start. Groups voices with the same renderKey()
+  // that are not part of a route. Returns how many voices now render through
+  // another one.
+  int shareIdenticalVoices();
+  // As of the last rendered chunk
+  int getSharedVoiceCount() const { return renderedSharedVoices_.load(std::memory_order_relaxed); }
+
+  // Called from the JS thread after the voices are added and configured,
+  // before start. Returns the mode the session will run in.
+  CacheMode useRenderCache(const std::string &descriptor, double durationSeconds, uint32_t seed);
+  // Called from a background thread (prepareSession) ahead of the
+  // useRenderCache() call with the same arguments: does the file work
+  // (mapping a cached session and faulting its first seconds in, or creating
+  // the recording file, which may evict older ones), so that useRenderCache()
+  // only installs the result.
+  CacheMode prepareRenderCache(const std::string &descriptor, double durationSeconds, uint32_t seed);
+  // Called from the JS thread once the session is over: publishes a finished
+  // recording (or deletes an aborted one) and releases the mapping. Also drops
+  // a prepared session that was never used.
+  void finishRenderCache();
+
+  CacheMode getCacheMode() const { return cacheMode_.load(std::memory_order_relaxed); }
+  // Martigli animation value stored alongside the cached audio.
+  float getAnimationValue() const { return animationValue_.load(std::memory_order_relaxed); }
+
+  // Control flags, set by JS alongside the voices' own flags. They only
+  // matter while recording or replaying.
+  bool shouldStart = false;
+  bool shouldPause = false;
+  bool shouldResume = false;
+  bool shouldStop = false;
+
+  // Adaptive quality: tier, switch and report, from any thread
+  QualityGovernor &qualityGovernor() { return governor_; }
+
+  // Below this many voices the pool's wake-up cost outweighs the gain
+  // (see benchmarkVoiceRendering); render serially on the audio thread.
+  int parallelThreshold = 3;
+  bool parallel = true;
+
+protected:
+  void processNode(const std::shared_ptr<AudioBus> &bus, int framesToProcess) override;
+
+private:
+  // A voice as processNode renders it. The staged voices own the renderers;
+  // a voice removed on the JS thread stays alive until the install.
+  struct VoiceSlot {
+    VoiceRenderer *voice = nullptr;
+    std::shared_ptr<AudioBus> scratch;
+    // Shared rendering: the slot whose output this voice adds, scaled by
+    // gain, instead of rendering (-1: renders itself)
+    int leader = -1;
+    int volumePort = -1;
+    float gain = 1.0f;
+    uint32_t controls = 0;  // pending when the leader rendered for it
+  };
+
+  struct StagedVoice {
+    std::shared_ptr<VoiceRenderer> voice;
+    int leader = -1;
+    int volumePort = -1;
+    bool joining = false;  // shared by shareIdenticalVoices() since the last install
+  };
+
+  // The JS thread's copy of the mix, edited under voicesMutex_. The render
+  // cache fields are swapped with the audio thread's on install, so the
+  // session and recorder it replaces come back here to be released on the
+  // JS thread, with the mode and stoppedAtEnd they ended with.
+  struct StagedMix {
+    std::array<StagedVoice, kMaxVoices> voices;
+    int voiceCount = 0;
+    ModulationMatrix modulation;
+    uint32_t mixGeneration = 0;
+    bool cacheChanged = false;
+    std::shared_ptr<RenderedSession> cacheSession;
+    std::unique_ptr<RecordingWriter> recorder;
+    CacheMode cacheMode = CacheMode::Off;
+    uint64_t sessionFrames = 0;
+    bool stoppedAtEnd = false;
+  };
+
+  static void renderSlot(void *mixer, int index);
+  uint32_t publishStaged();
+  void waitForInstall(uint32_t generation);
+  void installStaged();
+  void rebuildModulation();
+  void unshareVoice(int index);
+  void unshareStaged(int index);
+  void unshareRouted(const VoiceRenderer *voice);
+  void checkSharedVoices();
+  void handleControlFlags();
+  uint32_t sumParamGenerations() const;
+  void renderVoices(const std::shared_ptr<AudioBus> &bus, int framesToProcess, int numChannels);
+  void mixCached(const std::shared_ptr<AudioBus> &bus, int framesToProcess, int numChannels);
+  void record(const std::shared_ptr<AudioBus> &bus, int framesToProcess, int numChannels);
+  void rampGain(float target, float seconds);
+  std::shared_ptr<RenderedSession> openRenderCache(uint64_t key, double durationSeconds, CacheMode &mode);
+
+  // Guards staged_. The audio thread only try_locks it, to install a newer
+  // generation; while it is busy the quantum renders the installed voices.
+  std::mutex voicesMutex_;
+  StagedMix staged_;
+  uint32_t stagedGeneration_ = 0;
+  std::atomic<uint32_t> publishedGeneration_{0};
+  std::atomic<uint32_t> installedGeneration_{0};
+  std::atomic<int> addedVoices_{0};
+  std::atomic<int> renderedSharedVoices_{0};
+  // Bumped on entering and leaving processNode (odd while inside), so that
+  // waitForInstall() notices a stopped audio thread and installs itself,
+  // setting installingOnJs_ meanwhile.
+  std::atomic<uint32_t> renderSeq_{0};
+  std::atomic<bool> installingOnJs_{false};
+
+  // The installed mix, audio thread only
+  std::array<VoiceSlot, kMaxVoices> slots_;
+  int voiceCount_ = 0;
+  int chunkFrames_ = 0;
+  ModulationMatrix modulation_;
+  int levelBase_ = 0;            // renderSlot index -> modulation_.order()[levelBase_ + index]
+  uint32_t mixGeneration_ = 0;  // bumped when the voices or routes change
+  int sharedVoices_ = 0;         // slots with a leader
+
+  // Includes the voices rendered by the mixer
+  DspLoadMeter dspLoad_{"VoiceMix"};
+  GlitchDetector glitches_{"VoiceMix"};
+  QualityGovernor governor_;
+  float sampleRate_;
+
+  // Render cache state, audio thread only. cacheSession_ and recorder_ are
+  // swapped with staged_'s on install and released on the JS thread, never in processNode (munmap
+  // and joining the writer block). recorder_ is set while recording.
+  std::shared_ptr<RenderedSession> cacheSession_;
+  std::unique_ptr<RecordingWriter> recorder_;
+  std::atomic<CacheMode> cacheMode_{CacheMode::Off};
+  uint64_t cacheFrame_ = 0;
+  uint64_t sessionFrames_ = 0;      // nominal duration; the file adds a fade-out tail
+  uint32_t paramGeneration_ = 0;
+  uint64_t nextPrefetchFrame_ = 0;
+  int fallbackFrames_;
+  int fallbackFramesLeft_ = 0;      // cached stream fading out, live voices in
+  bool stoppedAtEnd_ = false;
+  std::atomic<float> animationValue_{0.0f};
+
+  // Result of prepareRenderCache(), waiting for useRenderCache()
+  std::mutex preparedMutex_;
+  std::shared_ptr<RenderedSession> preparedSession_;
+  uint64_t preparedKey_ = 0;
+  CacheMode preparedMode_ = CacheMode::Off;
+
+  // Mixer transport, mirroring the voices' start/pause/stop ramps.
+  bool isRunning_ = false;
+  bool isPaused_ = false;
+  float gain_ = 0.0f;
+  float gainTarget_ = 0.0f;
+  float gainStep_ = 0.0f;
+};
+
+// "replay", "record" or "off", as JS sees the mode
+inline const char *cacheModeName(VoiceMixNode::CacheMode mode) {
+  switch (mode) {
+    case VoiceMixNode::CacheMode::Replaying:
+      return "replay";
+    case VoiceMixNode::CacheMode::Recording:
+      return "record";
+    default:
+      return "off";
+  }
+}
+
+} // namespace audioapi
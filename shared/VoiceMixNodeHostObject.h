@@ -0,0 +1,257 @@
+#pragma once
+#include "VoiceMixNode.h"
+#include "VoiceRenderer.h"
+#include <audioapi/HostObjects/AudioNodeHostObject.h>
+#include <jsi/jsi.h>
+#include <algorithm>
+
+using namespace facebook;
+
+namespace audioapi {
+
+class VoiceMixNodeHostObject : public AudioNodeHostObject {
+public:
+  explicit VoiceMixNodeHostObject(const std::shared_ptr<VoiceMixNode> &node)
+      : AudioNodeHostObject(node), node_(node) {}
+
+  std::shared_ptr<VoiceMixNode> getMixer() const { return node_; }
+
+  jsi::Value get(jsi::Runtime &runtime, const jsi::PropNameID &propNameId) override {
+    trace::Scope traceScope("jsi", "VoiceMix.get", node_.get());
+    auto propName = propNameId.utf8(runtime);
+
+    if (propName == "voiceCount") {
+      return jsi::Value(node_->getVoiceCount());
+    }
+    if (propName == "sharedVoiceCount") {
+      return jsi::Value(node_->getSharedVoiceCount());
+    }
+    if (propName == "parallelThreshold") {
+      return jsi::Value(node_->parallelThreshold);
+    }
+    if (propName == "parallel") {
+      return jsi::Value(node_->parallel);
+    }
+    if (propName == "isReplaying") {
+      return jsi::Value(node_->getCacheMode() == VoiceMixNode::CacheMode::Replaying);
+    }
+    if (propName == "adaptiveQuality") {
+      return jsi::Value(node_->qualityGovernor().isAdaptive());
+    }
+    if (propName == "qualityTier") {
+      return jsi::Value(static_cast<int>(node_->qualityGovernor().tier()));
+    }
+    if (propName == "animationValue") {
+      return jsi::Value(static_cast<double>(node_->getAnimationValue()));
+    }
+    if (propName == "shouldStart") {
+      return jsi::Value(node_->shouldStart);
+    }
+    if (propName == "shouldPause") {
+      return jsi::Value(node_->shouldPause);
+    }
+    if (propName == "shouldResume") {
+      return jsi::Value(node_->shouldResume);
+    }
+    if (propName == "shouldStop") {
+      return jsi::Value(node_->shouldStop);
+    }
+    if (propName == "useRenderCache") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "useRenderCache"),
+        3,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          if (count < 2 || !arguments[0].isString() || !arguments[1].isNumber()) {
+            return jsi::String::createFromAscii(runtime, "off");
+          }
+          auto descriptor = arguments[0].asString(runtime).utf8(runtime);
+          double duration = arguments[1].asNumber();
+          uint32_t seed = count > 2 && arguments[2].isNumber() ? static_cast<uint32_t>(arguments[2].asNumber()) : 0;
+          auto mode = node_->useRenderCache(descriptor, duration, seed);
+          return jsi::String::createFromAscii(runtime, cacheModeName(mode));
+        });
+    }
+    if (propName == "finishRenderCache") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "finishRenderCache"),
+        0,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          node_->finishRenderCache();
+          return jsi::Value::undefined();
+        });
+    }
+    if (propName == "addVoice") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "addVoice"),
+        1,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          auto voice = voiceFromArgument(runtime, arguments, count);
+          return jsi::Value(voice != nullptr && node_->addVoice(voice));
+        });
+    }
+    if (propName == "removeVoice") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "removeVoice"),
+        1,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          auto voice = voiceFromArgument(runtime, arguments, count);
+          if (voice != nullptr) {
+            node_->removeVoice(voice);
+          }
+          return jsi::Value::undefined();
+        });
+    }
+    if (propName == "clearVoices") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "clearVoices"),
+        0,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          node_->clearVoices();
+          return jsi::Value::undefined();
+        });
+    }
+    if (propName == "addModulation") {
+      // addModulation(source, signal, target, param, depth = 1, offset = 0)
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "addModulation"),
+        6,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          if (count < 4 || !arguments[1].isString() || !arguments[3].isString()) {
+            return jsi::Value(-1);
+          }
+          auto source = voiceFromValue(runtime, arguments[0]);
+          auto target = voiceFromValue(runtime, arguments[2]);
+          if (source == nullptr || target == nullptr) {
+            return jsi::Value(-1);
+          }
+          float depth = count > 4 && arguments[4].isNumber() ? static_cast<float>(arguments[4].asNumber()) : 1.0f;
+          float offset = count > 5 && arguments[5].isNumber() ? static_cast<float>(arguments[5].asNumber()) : 0.0f;
+          return jsi::Value(node_->addModulation(
+              source, arguments[1].asString(runtime).utf8(runtime),
+              target, arguments[3].asString(runtime).utf8(runtime), depth, offset));
+        });
+    }
+    if (propName == "removeModulation") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "removeModulation"),
+        1,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          if (count > 0 && arguments[0].isNumber()) {
+            node_->removeModulation(static_cast<int>(arguments[0].asNumber()));
+          }
+          return jsi::Value::undefined();
+        });
+    }
+    if (propName == "clearModulations") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "clearModulations"),
+        0,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          node_->clearModulations();
+          return jsi::Value::undefined();
+        });
+    }
+    if (propName == "shareIdenticalVoices") {
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "shareIdenticalVoices"),
+        0,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          return jsi::Value(node_->shareIdenticalVoices());
+        });
+    }
+    if (propName == "qualityReport") {
+      // qualityReport() -> { tier, adaptive, loadPercent, peakPercent, stepsDown, stepsUp, holdSeconds }
+      return jsi::Function::createFromHostFunction(
+        runtime,
+        jsi::PropNameID::forAscii(runtime, "qualityReport"),
+        0,
+        [this](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *arguments, size_t count) -> jsi::Value {
+          const QualityReport report = node_->qualityGovernor().report();
+          jsi::Object result(runtime);
+          result.setProperty(runtime, "tier", static_cast<int>(report.tier));
+          result.setProperty(runtime, "adaptive", report.adaptive);
+          result.setProperty(runtime, "loadPercent", report.loadPercent);
+          result.setProperty(runtime, "peakPercent", report.peakPercent);
+          result.setProperty(runtime, "stepsDown", static_cast<double>(report.stepsDown));
+          result.setProperty(runtime, "stepsUp", static_cast<double>(report.stepsUp));
+          result.setProperty(runtime, "holdSeconds", report.holdSeconds);
+          return result;
+        });
+    }
+
+    return AudioNodeHostObject::get(runtime, propNameId);
+  }
+
+  void set(jsi::Runtime &runtime, const jsi::PropNameID &propNameId, const jsi::Value &value) override {
+    trace::Scope traceScope("jsi", "VoiceMix.set", node_.get());
+    auto propName = propNameId.utf8(runtime);
+    trace::commandQueued(propName, value.isBool() && value.getBool(), node_.get());
+
+    if (propName == "parallelThreshold") {
+      node_->parallelThreshold = static_cast<int>(value.asNumber());
+      return;
+    }
+    if (propName == "parallel") {
+      node_->parallel = value.asBool();
+      return;
+    }
+    if (propName == "adaptiveQuality") {
+      node_->qualityGovernor().setAdaptive(value.asBool());
+      return;
+    }
+    if (propName == "qualityTier") {
+      const int tier = std::clamp(static_cast<int>(value.asNumber()), 0, kQualityTierCount - 1);
+      node_->qualityGovernor().setTier(static_cast<QualityTier>(tier));
+      return;
+    }
+    if (propName == "shouldStart") {
+      node_->shouldStart = value.asBool();
+      return;
+    }
+    if (propName == "shouldPause") {
+      node_->shouldPause = value.asBool();
+      return;
+    }
+    if (propName == "shouldResume") {
+      node_->shouldResume = value.asBool();
+      return;
+    }
+    if (propName == "shouldStop") {
+      node_->shouldStop = value.asBool();
+      return;
+    }
+
+    AudioNodeHostObject::set(runtime, propNameId, value);
+  }
+
+private:
+  static std::shared_ptr<VoiceRenderer> voiceFromArgument(
+      jsi::Runtime &runtime, const jsi::Value *arguments, size_t count) {
+    return count == 0 ? nullptr : voiceFromValue(runtime, arguments[0]);
+  }
+
+  static std::shared_ptr<VoiceRenderer> voiceFromValue(jsi::Runtime &runtime, const jsi::Value &value) {
+    if (!value.isObject()) {
+      return nullptr;
+    }
+    auto object = value.asObject(runtime);
+    if (!object.isHostObject(runtime)) {
+      return nullptr;
+    }
+    auto voiceHostObject = std::dynamic_pointer_cast<VoiceHostObject>(object.getHostObject(runtime));
+    return voiceHostObject != nullptr ? voiceHostObject->getVoiceRenderer() : nullptr;
+  }
+
+  std::shared_ptr<VoiceMixNode> node_;
+};
+
+} // namespace audioapi
@@ -0,0 +1,113 @@
+#include "VoiceNodePool.h"
+#include <algorithm>
+#include <iterator>
+
+namespace audioapi {
+
+VoiceNodePool &VoiceNodePool::instance() {
+  static VoiceNodePool pool;
+  return pool;
+}
+
+VoiceNodePool::Bucket *VoiceNodePool::findBucket(const BaseAudioContext *context, std::type_index type) {
+  for (auto &entry : buckets_) {
+    if (entry.key == context && entry.type == type) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+VoiceNodePool::Bucket &VoiceNodePool::bucket(const std::shared_ptr<BaseAudioContext> &context,
+                                             std::type_index type, const char *kind) {
+  // A new context can reuse the address of a destroyed one: forget the old
+  // one's nodes before looking up by address
+  buckets_.erase(std::remove_if(buckets_.begin(), buckets_.end(),
+                                [](const Bucket &entry) { return entry.context.expired(); }),
+                 buckets_.end());
+  if (auto *existing = findBucket(context.get(), type)) {
+    return *existing;
+  }
+  buckets_.push_back(Bucket{context.get(), context, type, kind, {}, 0, 0});
+  return buckets_.back();
+}
+
+std::shared_ptr<facebook::jsi::HostObject> VoiceNodePool::take(const std::shared_ptr<BaseAudioContext> &context,
+                                                               std::type_index type, const char *kind) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &pool = bucket(context, type, kind);
+  if (pool.idle.empty()) {
+    ++pool.created;
+    return nullptr;
+  }
+  // Last in, first out: the most recently used node is the likeliest to
+  // still be in cache
+  auto hostObject = std::move(pool.idle.back().hostObject);
+  pool.idle.pop_back();
+  ++pool.reused;
+  return hostObject;
+}
+
+void VoiceNodePool::addPrewarmed(const std::shared_ptr<BaseAudioContext> &context, std::type_index type,
+                                 const char *kind, std::shared_ptr<facebook::jsi::HostObject> hostObject,
+                                 std::shared_ptr<VoiceRenderer> voice) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &pool = bucket(context, type, kind);
+  ++pool.created;
+  pool.idle.push_back(Entry{std::move(hostObject), std::move(voice)});
+}
+
+int VoiceNodePool::idleCount(const std::shared_ptr<BaseAudioContext> &context, std::type_index type,
+                             const char *kind) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int>(bucket(context, type, kind).idle.size());
+}
+
+bool VoiceNodePool::release(const std::shared_ptr<BaseAudioContext> &context,
+                            const std::shared_ptr<facebook::jsi::HostObject> &hostObject,
+                            const std::shared_ptr<VoiceRenderer> &voice) {
+  if (!context || !hostObject || !voice) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Only types that were handed out by acquire() or prewarm() have a bucket
+  auto *pool = findBucket(context.get(), typeid(*voice));
+  if (pool == nullptr) {
+    return false;
+  }
+  for (const auto &entry : pool->idle) {
+    if (entry.voice == voice) {
+      return false;
+    }
+  }
+  voice->resetVoice();
+  if (static_cast<int>(pool->idle.size()) < kMaxIdlePerKind) {
+    pool->idle.push_back(Entry{hostObject, voice});
+  }
+  return true;
+}
+
+void VoiceNodePool::drain(const BaseAudioContext *context) {
+  std::vector<Bucket> drained;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto split = std::stable_partition(buckets_.begin(), buckets_.end(),
+                                       [context](const Bucket &entry) { return entry.key != context; });
+    std::move(split, buckets_.end(), std::back_inserter(drained));
+    buckets_.erase(split, buckets_.end());
+  }
+  // Nodes are destroyed here, outside the lock
+}
+
+std::vector<VoicePoolStats> VoiceNodePool::stats(const BaseAudioContext *context) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<VoicePoolStats> result;
+  for (const auto &entry : buckets_) {
+    if (entry.key == context) {
+      result.push_back(VoicePoolStats{entry.kind, static_cast<int>(entry.idle.size()), entry.created, entry.reused});
+    }
+  }
+  return result;
+}
+
+} // namespace audioapi
@@ -0,0 +1,101 @@
+#pragma once
+#include "StartupProfiler.h"
+#include "VoiceRenderer.h"
+#include <jsi/jsi.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace audioapi {
+class BaseAudioContext;
+
+struct VoicePoolStats {
+  std::string kind;       // preset voice type ("Martigli", "Sample", ...)
+  int idle = 0;           // nodes waiting in the pool
+  uint64_t created = 0;   // nodes constructed because the pool was empty
+  uint64_t reused = 0;    // nodes handed out from the pool
+};
+
+// Idle voice nodes, with their host objects, kept per audio context and node
+// type so that a session reuses the previous session's objects instead of
+// constructing new ones: no allocation, no table builds and no file mapping
+// between start() and the first quantum, and no heap churn over a long app
+// lifetime of starting and stopping sessions.
+//
+// The createXxxNode installers take from the pool; SessionManager returns
+// its voices once the mixer has dropped them and warms the pool up for a
+// preset as soon as it is loaded. JS thread only.
+class VoiceNodePool {
+public:
+  // Idle nodes kept per context and type; released nodes above it are freed
+  static constexpr int kMaxIdlePerKind = 16;
+
+  static VoiceNodePool &instance();
+
+  // A pooled node of type Node, reset to its defaults, or a new one
+  template <typename Node, typename HostObject>
+  std::shared_ptr<facebook::jsi::HostObject> acquire(const std::shared_ptr<BaseAudioContext> &context,
+                                                     const char *kind) {
+    if (auto hostObject = take(context, typeid(Node), kind)) {
+      return hostObject;
+    }
+    startup::Span startupSpan("constructNode", kind);
+    return std::make_shared<HostObject>(std::make_shared<Node>(context.get()));
+  }
+
+  // Constructs nodes until count of type Node are idle in the pool
+  template <typename Node, typename HostObject>
+  void prewarm(const std::shared_ptr<BaseAudioContext> &context, const char *kind, int count) {
+    for (int i = idleCount(context, typeid(Node), kind); i < count && i < kMaxIdlePerKind; ++i) {
+      startup::Span startupSpan("prewarmNode", kind);
+      auto node = std::make_shared<Node>(context.get());
+      addPrewarmed(context, typeid(Node), kind, std::make_shared<HostObject>(node), node);
+    }
+  }
+
+  // Resets the voice and keeps it for the next acquire(). The voice must not
+  // be in a mixer or connected to the graph any more, and JS must drop its
+  // references to it. Returns false if the voice was already in the pool.
+  bool release(const std::shared_ptr<BaseAudioContext> &context,
+               const std::shared_ptr<facebook::jsi::HostObject> &hostObject,
+               const std::shared_ptr<VoiceRenderer> &voice);
+
+  // Frees every idle node of the context, e.g. before the context is closed
+  void drain(const BaseAudioContext *context);
+
+  std::vector<VoicePoolStats> stats(const BaseAudioContext *context);
+
+private:
+  struct Entry {
+    std::shared_ptr<facebook::jsi::HostObject> hostObject;
+    std::shared_ptr<VoiceRenderer> voice;
+  };
+
+  struct Bucket {
+    const BaseAudioContext *key = nullptr;
+    std::weak_ptr<BaseAudioContext> context;
+    std::type_index type;
+    const char *kind = nullptr;
+    std::vector<Entry> idle;
+    uint64_t created = 0;
+    uint64_t reused = 0;
+  };
+
+  std::shared_ptr<facebook::jsi::HostObject> take(const std::shared_ptr<BaseAudioContext> &context,
+                                                  std::type_index type, const char *kind);
+  void addPrewarmed(const std::shared_ptr<BaseAudioContext> &context, std::type_index type, const char *kind,
+                    std::shared_ptr<facebook::jsi::HostObject> hostObject, std::shared_ptr<VoiceRenderer> voice);
+  int idleCount(const std::shared_ptr<BaseAudioContext> &context, std::type_index type, const char *kind);
+
+  // Under mutex_. Drops the buckets of destroyed contexts first.
+  Bucket &bucket(const std::shared_ptr<BaseAudioContext> &context, std::type_index type, const char *kind);
+  Bucket *findBucket(const BaseAudioContext *context, std::type_index type);
+
+  std::mutex mutex_;
+  std::vector<Bucket> buckets_;
+};
+
+} // namespace audioapi
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+
+namespace audioapi {
+
+// Preset parameters of each voice type, with their defaults. These are the
+// only place the defaults are written down: the nodes initialize and reset
+// their properties from them, and a preset that leaves a field out (see
+// PresetFormat.h) gets the value below. Field names match the node
+// properties and the preset JSON. Volume is not a preset parameter: the
+// session sets it from iniVolume or the app's per-type default.
+//
+// Plain aggregates of 4-byte fields, so that they map 1:1 onto the binary
+// preset records.
+
+struct MartigliParams {
+  float mf0 = 250.0f;          // Base frequency
+  float ma = 90.0f;            // Modulation amount
+  float mp0 = 10.0f;           // Initial period
+  float mp1 = 20.0f;           // Final period
+  float md = 600.0f;           // Ramp duration
+  float inhaleDur = -1.0f;     // Inhale duration (optional, sets the ratio)
+  float exhaleDur = -1.0f;     // Exhale duration (optional)
+  int32_t waveformM = 0;       // 0=sine, 1=triangle, 2=square, 3=sawtooth
+  int32_t panOsc = 0;          // 0=none, 1=envelope, 2=sine, 3=synced to the breath
+  float panOscPeriod = 120.0f;
+  float panOscTrans = 20.0f;
+};
+
+struct MartigliBinauralParams {
+  float fl = 250.0f;           // Left carrier frequency
+  float fr = 260.0f;           // Right carrier frequency
+  int32_t waveformL = 0;
+  int32_t waveformR = 0;
+  float ma = 90.0f;
+  float mp0 = 11.0f;
+  float mp1 = 20.0f;
+  float md = 600.0f;
+  float inhaleDur = 3.0f;
+  float exhaleDur = 8.0f;
+  int32_t panOsc = 0;
+  float panOscPeriod = 120.0f;
+  float panOscTrans = 20.0f;
+};
+
+struct BinauralParams {
+  float fl = 340.0f;
+  float fr = 160.0f;
+  int32_t waveformL = 0;
+  int32_t waveformR = 0;
+  int32_t panOsc = 0;
+  float panOscPeriod = 120.0f;
+  float panOscTrans = 20.0f;
+};
+
+struct SymmetryParams {
+  float f0 = 220.0f;           // Base frequency (Hz)
+  float noctaves = 1.0f;       // Number of octaves to span
+  int32_t nnotes = 8;          // Number of notes in the sequence
+  float d = 32.0f;             // Loop duration (seconds)
+  int32_t waveform = 0;
+  int32_t permfunc = 0;        // 0=shuffle, 1=rotateForward, 2=rotateBack, 3=reverse, 4=none
+  float release = 0.0f;        // Release tail after note off (seconds); 0 = automatic
+};
+
+struct NoiseParams {
+  int32_t noiseColor = 0;      // 0=white, 1=pink, 2=brown
+};
+
+// The file path is carried next to these, not in them
+struct SampleParams {
+  int32_t loop = 1;
+  float loopStart = 0.0f;      // seconds
+  float loopEnd = 0.0f;        // seconds; <= 0 means the end of the file
+  float loopCrossfade = 0.05f; // seconds, clamped to half the loop
+  float playbackRate = 1.0f;
+};
+
+inline constexpr MartigliParams kMartigliDefaults{};
+inline constexpr MartigliBinauralParams kMartigliBinauralDefaults{};
+inline constexpr BinauralParams kBinauralDefaults{};
+inline constexpr SymmetryParams kSymmetryDefaults{};
+inline constexpr NoiseParams kNoiseDefaults{};
+inline constexpr SampleParams kSampleDefaults{};
+
+} // namespace audioapi
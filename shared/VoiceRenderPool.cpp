@@ -0,0 +1,314 @@
+#include "VoiceRenderPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#if defined(__APPLE__)
+#include <os/workgroup.h>
+#endif
+#if defined(__ANDROID__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace audioapi {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+inline void cpuRelax() {
+#if defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+std::atomic<VoiceRenderPool::WorkgroupProvider> workgroupProvider{nullptr};
+
+// Workers only: the workgroup this thread has joined
+struct JoinedWorkgroup {
+#if defined(__APPLE__)
+  os_workgroup_t workgroup = nullptr;
+  os_workgroup_join_token_s token{};
+#endif
+  uint32_t generation = 0;
+};
+
+void leaveWorkgroup(JoinedWorkgroup &joined) {
+#if defined(__APPLE__)
+  if (joined.workgroup != nullptr) {
+    os_workgroup_leave(joined.workgroup, &joined.token);
+    os_release(joined.workgroup);
+    joined.workgroup = nullptr;
+  }
+#endif
+}
+
+} // namespace
+
+VoiceRenderPool::VoiceRenderPool(int workerCount) {
+  workerCount = std::max(0, std::min(workerCount, kMaxWorkers));
+  threads_.reserve(workerCount);
+  for (int i = 0; i < workerCount; ++i) {
+    threads_.emplace_back([this, i] { workerLoop(i + 1); });
+  }
+}
+
+VoiceRenderPool::~VoiceRenderPool() {
+  quit_.store(true);
+  epoch_.fetch_add(2);
+  epoch_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+#if defined(__APPLE__)
+  if (workgroup_ != nullptr) {
+    os_release(static_cast<os_workgroup_t>(workgroup_));
+  }
+#endif
+}
+
+void VoiceRenderPool::setWorkgroupProvider(WorkgroupProvider provider) {
+  workgroupProvider.store(provider);
+  shared().refreshWorkgroup();
+}
+
+void VoiceRenderPool::refreshWorkgroup() {
+#if defined(__APPLE__)
+  const WorkgroupProvider provider = workgroupProvider.load();
+  void *workgroup = provider != nullptr ? provider() : nullptr;
+  std::lock_guard<std::mutex> lock(workgroupMutex_);
+  if (workgroup == workgroup_) {
+    return;
+  }
+  if (workgroup != nullptr) {
+    os_retain(static_cast<os_workgroup_t>(workgroup));
+  }
+  if (workgroup_ != nullptr) {
+    os_release(static_cast<os_workgroup_t>(workgroup_));
+  }
+  workgroup_ = workgroup;
+  workgroupGeneration_.fetch_add(1, std::memory_order_release);
+#endif
+}
+
+int VoiceRenderPool::defaultWorkerCount() {
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  // Phones have 6-8 cores of which only a few are fast; three helpers plus
+  // the audio thread is where rendering stops scaling on typical devices.
+  return std::min(std::max(cores - 1, 0), 3);
+}
+
+VoiceRenderPool &VoiceRenderPool::shared() {
+  static VoiceRenderPool pool(defaultWorkerCount());
+  return pool;
+}
+
+void VoiceRenderPool::run(Task task, void *context, int count) {
+  if (count <= 0) {
+    return;
+  }
+  // The job state below is single-caller; a second caller never waits for
+  // the first, it renders its own tasks
+  if (threads_.empty() || count == 1 || busy_.exchange(true, std::memory_order_acquire)) {
+    runSerially(task, context, count);
+    return;
+  }
+
+  // Odd epoch: workers must not pick up the job while it is being rewritten.
+  // Wait for stragglers that are still scanning the previous job's ranges
+  // (all its tasks are done). One that was preempted there may not run again
+  // for a while: past the deadline, render this job alone and republish the
+  // previous, exhausted job.
+  epoch_.fetch_add(1);
+  const auto stragglerDeadline = Clock::now() + std::chrono::microseconds(kStragglerDeadlineMicros);
+  while (activeWorkers_.load() != 0) {
+    if (Clock::now() > stragglerDeadline) {
+      epoch_.fetch_add(1);
+      runSerially(task, context, count);
+      busy_.store(false, std::memory_order_release);
+      return;
+    }
+    cpuRelax();
+  }
+
+  task_ = task;
+  context_ = context;
+  participants_ = std::min(count, workerCount() + 1);
+  const int perParticipant = count / participants_;
+  const int extra = count % participants_;
+  int begin = 0;
+  for (int p = 0; p < kMaxParticipants; ++p) {
+    int size = p < participants_ ? perParticipant + (p < extra ? 1 : 0) : 0;
+    ranges_[p].next.store(begin, std::memory_order_relaxed);
+    ranges_[p].end = begin + size;
+    begin += size;
+  }
+  remaining_.store(count, std::memory_order_relaxed);
+
+  epoch_.fetch_add(1);
+  epoch_.notify_all();
+
+  // The caller renders its own range, then every task no worker has claimed
+  // yet. What is left is tasks a worker is in the middle of: a voice cannot
+  // be taken over halfway, so past the deadline the caller yields its core,
+  // which is what a worker preempted on it needs.
+  drain(0);
+  const auto finishDeadline = Clock::now() + std::chrono::microseconds(kFinishDeadlineMicros);
+  while (remaining_.load(std::memory_order_acquire) != 0) {
+    if (Clock::now() > finishDeadline) {
+      std::this_thread::yield();
+    } else {
+      cpuRelax();
+    }
+  }
+  busy_.store(false, std::memory_order_release);
+}
+
+void VoiceRenderPool::runSerially(Task task, void *context, int count) {
+  for (int i = 0; i < count; ++i) {
+    task(context, i);
+  }
+}
+
+void VoiceRenderPool::drain(int participant) {
+  const int participants = participants_;
+  for (int k = 0; k < participants; ++k) {
+    TaskRange &range = ranges_[(participant + k) % participants];
+    int index;
+    while ((index = range.next.fetch_add(1, std::memory_order_relaxed)) < range.end) {
+      task_(context_, index);
+      remaining_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+}
+
+void VoiceRenderPool::workerLoop(int participant) {
+#if defined(__ANDROID__)
+  // ANDROID_PRIORITY_URGENT_AUDIO, the priority the platform gives an app's
+  // audio threads
+  setpriority(PRIO_PROCESS, gettid(), -19);
+#endif
+  JoinedWorkgroup joined;
+  uint32_t seen = epoch_.load();
+  while (true) {
+    epoch_.wait(seen);
+    const uint32_t epoch = epoch_.load();
+    seen = epoch;
+    if (quit_.load()) {
+      break;
+    }
+    if (epoch & 1u) {
+      continue;
+    }
+    activeWorkers_.fetch_add(1);
+    if (epoch_.load() == epoch) {
+      drain(participant);
+    }
+    activeWorkers_.fetch_sub(1);
+
+    // Between jobs: follow the device's workgroup
+    const uint32_t generation = workgroupGeneration_.load(std::memory_order_acquire);
+    if (generation != joined.generation) {
+      joined.generation = generation;
+      leaveWorkgroup(joined);
+#if defined(__APPLE__)
+      std::lock_guard<std::mutex> lock(workgroupMutex_);
+      if (workgroup_ != nullptr) {
+        auto workgroup = static_cast<os_workgroup_t>(workgroup_);
+        if (os_workgroup_join(workgroup, &joined.token) == 0) {
+          os_retain(workgroup);
+          joined.workgroup = workgroup;
+        }
+      }
+#endif
+    }
+  }
+  leaveWorkgroup(joined);
+}
+
+namespace {
+
+struct BenchmarkVoice {
+  double phaseL = 0.0;
+  double phaseR = 0.0;
+  double incL = 0.0;
+  double incR = 0.0;
+  std::vector<float> left;
+  std::vector<float> right;
+
+  void render(int frames) {
+    for (int i = 0; i < frames; ++i) {
+      left[i] = static_cast<float>(std::sin(2.0 * M_PI * phaseL));
+      right[i] = static_cast<float>(std::sin(2.0 * M_PI * phaseR));
+      phaseL += incL;
+      phaseR += incR;
+      if (phaseL >= 1.0) phaseL -= 1.0;
+      if (phaseR >= 1.0) phaseR -= 1.0;
+    }
+  }
+};
+
+struct BenchmarkJob {
+  std::vector<BenchmarkVoice> *voices;
+  int frames;
+};
+
+void renderBenchmarkVoice(void *context, int index) {
+  auto *job = static_cast<BenchmarkJob *>(context);
+  (*job->voices)[index].render(job->frames);
+}
+
+} // namespace
+
+std::vector<VoiceRenderBenchmarkResult> benchmarkVoiceRendering(
+    int maxVoices, int framesPerQuantum, int iterations) {
+  using Clock = std::chrono::steady_clock;
+  maxVoices = std::max(1, maxVoices);
+  framesPerQuantum = std::max(1, framesPerQuantum);
+  iterations = std::max(1, iterations);
+
+  std::vector<BenchmarkVoice> voices(maxVoices);
+  for (int v = 0; v < maxVoices; ++v) {
+    voices[v].incL = (200.0 + 10.0 * v) / 48000.0;
+    voices[v].incR = (210.0 + 10.0 * v) / 48000.0;
+    voices[v].left.assign(framesPerQuantum, 0.0f);
+    voices[v].right.assign(framesPerQuantum, 0.0f);
+  }
+
+  VoiceRenderPool pool(VoiceRenderPool::defaultWorkerCount());
+  BenchmarkJob job{&voices, framesPerQuantum};
+  std::vector<VoiceRenderBenchmarkResult> results;
+  results.reserve(maxVoices);
+
+  for (int count = 1; count <= maxVoices; ++count) {
+    VoiceRenderBenchmarkResult result;
+    result.voices = count;
+
+    auto start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+      for (int v = 0; v < count; ++v) {
+        voices[v].render(framesPerQuantum);
+      }
+    }
+    result.serialMicros =
+        std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+      pool.run(&renderBenchmarkVoice, &job, count);
+    }
+    result.parallelMicros =
+        std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+    results.push_back(result);
+  }
+  return results;
+}
+
+} // namespace audioapi
@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace audioapi {
+
+// Fixed-size worker pool used to render the independent voices of one render
+// quantum in parallel.
+//
+// - Threads are created once; run() never allocates, locks or blocks on a
+//   kernel object. Workers are woken with an atomic notify and the calling
+//   (audio) thread works on its own share of tasks instead of sleeping.
+// - Tasks are split into contiguous ranges, one per participant. A
+//   participant drains its own range first and then steals from the others
+//   through the same atomic cursor, so an expensive voice does not stall the
+//   quantum behind it. A worker that has not woken up in time therefore
+//   finds its range already rendered by the caller.
+// - Workers run at audio priority: in the audio device's workgroup on iOS
+//   (setWorkgroupProvider), at ANDROID_PRIORITY_URGENT_AUDIO on Android. The
+//   caller's spin-waits have deadlines, after which it yields its core
+//   rather than spin against a preempted worker.
+class VoiceRenderPool {
+public:
+  static constexpr int kMaxWorkers = 7;
+  static constexpr int kMaxParticipants = kMaxWorkers + 1;
+  // How long run() spins for workers still leaving the previous job before
+  // it renders the new one serially, and for claimed tasks to finish before
+  // it starts yielding
+  static constexpr int kStragglerDeadlineMicros = 100;
+  static constexpr int kFinishDeadlineMicros = 500;
+
+  using Task = void (*)(void *context, int index);
+  // Returns the audio device's os_workgroup_t, or nullptr. JS thread.
+  using WorkgroupProvider = void *(*)();
+
+  explicit VoiceRenderPool(int workerCount);
+  ~VoiceRenderPool();
+
+  VoiceRenderPool(const VoiceRenderPool &) = delete;
+  VoiceRenderPool &operator=(const VoiceRenderPool &) = delete;
+
+  // Runs task(context, i) for every i in [0, count) and returns once all of
+  // them have completed. A call made while another thread is inside run()
+  // (two mixers on different render threads) runs its tasks serially on the
+  // calling thread rather than wait.
+  void run(Task task, void *context, int count);
+
+  int workerCount() const { return static_cast<int>(threads_.size()); }
+
+  // Process-wide pool sized from the number of cores (one core is left to the
+  // UI/JS threads). Created on first use, which should be off the audio thread.
+  static VoiceRenderPool &shared();
+  static int defaultWorkerCount();
+
+  // iOS: where the workers find the workgroup to join, set once by the
+  // platform module. refreshWorkgroup() asks it again (the device, and with
+  // it the workgroup, changes when the audio engine restarts); the workers
+  // move to the new one after their next job. No-ops elsewhere.
+  static void setWorkgroupProvider(WorkgroupProvider provider);
+  void refreshWorkgroup();
+
+private:
+  struct alignas(64) TaskRange {
+    std::atomic<int> next{0};
+    int end = 0;
+  };
+
+  void workerLoop(int participant);
+  void drain(int participant);
+  void runSerially(Task task, void *context, int count);
+
+  std::array<TaskRange, kMaxParticipants> ranges_;
+  Task task_ = nullptr;
+  void *context_ = nullptr;
+  int participants_ = 1;
+
+  // Even = a job is published, odd = the caller is rewriting the job.
+  alignas(64) std::atomic<uint32_t> epoch_{0};
+  alignas(64) std::atomic<int> remaining_{0};
+  alignas(64) std::atomic<int> activeWorkers_{0};
+  std::atomic<bool> quit_{false};
+  // Held by the thread inside run()
+  alignas(64) std::atomic<bool> busy_{false};
+
+  // The workgroup the workers should be in (retained), and a counter bumped
+  // on every change; workers compare it after each job
+  std::mutex workgroupMutex_;
+  void *workgroup_ = nullptr;
+  std::atomic<uint32_t> workgroupGeneration_{0};
+
+  std::vector<std::thread> threads_;
+};
+
+struct VoiceRenderBenchmarkResult {
+  int voices = 0;
+  double serialMicros = 0.0;    // mean time per quantum, single thread
+  double parallelMicros = 0.0;  // mean time per quantum, through the pool
+};
+
+// Renders a synthetic two-oscillator voice (roughly a BinauralNode) for 1 to
+// maxVoices voices, serially and through a pool the size of
+// VoiceRenderPool::shared() (its own, so that the mixers playing meanwhile
+// keep theirs), and reports the mean time per quantum. Use it on a device to
+// choose VoiceMixNode::parallelThreshold. Runs synchronously on the calling
+// thread.
+std::vector<VoiceRenderBenchmarkResult> benchmarkVoiceRendering(
+    int maxVoices, int framesPerQuantum, int iterations);
+
+} // namespace audioapi
@@ -0,0 +1,126 @@
+#pragma once
+#include "AnimationValueRegistry.h"
+#include "ModulationMatrix.h"
+#include "QualityGovernor.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace audioapi {
+class AudioBus;
+
+// Implemented by every custom voice node so a VoiceMixNode can render it
+// directly into a scratch bus instead of relying on the graph's serial pull.
+// renderVoice() must only touch the voice's own state: the mixer may call it
+// from a worker thread, concurrently with other voices of the same quantum.
+class VoiceRenderer {
+public:
+  virtual ~VoiceRenderer() = default;
+  virtual void renderVoice(const std::shared_ptr<AudioBus> &bus, int framesToProcess) = 0;
+
+  // Puts the voice back in the state of a newly constructed one (default
+  // parameters, stopped, no shared breathing clock), keeping what construction
+  // and earlier sessions set up: tables, meters, a mapped sample. Lets
+  // VoiceNodePool hand the same node to the next session. JS thread, only
+  // while no mixer and no graph renders the voice.
+  virtual void resetVoice() = 0;
+
+  // Does the expensive work that depends on the current parameters (tables,
+  // faulting in file pages) ahead of start, so that the first rendered
+  // quantum only reads it. Called by prepareSession on a background thread,
+  // before the voice is given to a mixer; JS leaves the parameters alone
+  // until it completes.
+  virtual void prepareVoice() {}
+
+  // Bumped by host object setters whenever a parameter that changes the
+  // rendered sound is written (control flags like shouldPause do not count).
+  // Lets the mixer notice that a cached rendering no longer matches.
+  void touchParams() { paramGeneration_.fetch_add(1, std::memory_order_relaxed); }
+  uint32_t getParamGeneration() const { return paramGeneration_.load(std::memory_order_relaxed); }
+
+  // Signals this voice publishes and parameters other voices may drive
+  // through the mixer's ModulationMatrix
+  ModulationPorts &modulation() { return modulation_; }
+  const ModulationPorts &modulation() const { return modulation_; }
+
+  // Shared rendering (VoiceMixNode::shareIdenticalVoices), for voices whose
+  // output is fully determined by their parameters and seed. Two voices
+  // started together with the same key render the same signal up to their
+  // volume, so the mixer renders one of them for both. Audio thread, while
+  // the voices are not rendering; shareIdenticalVoices() also reads the key
+  // and pending controls on the JS thread, and the mixer checks them again
+  // before every chunk.
+  //
+  // Hash of the voice type, parameters (volume excepted) and seed; 0 for a
+  // voice that is never shared
+  virtual uint64_t renderKey() const { return 0; }
+  // Control flags set and not yet applied, as a bit mask
+  virtual uint32_t pendingControls() const { return 0; }
+  // Clears these control flags, applied by the voice rendered in its place
+  virtual void dropControls(uint32_t /*controls*/) {}
+  // Takes over the rendering state of leader (same type and key), scaled to
+  // this voice's volume, so that it can render on its own again
+  virtual void copyRenderState(const VoiceRenderer & /*leader*/) {}
+
+  // Moves the voice `frames` frames ahead at its next block, right after it
+  // applies its pending control flags, as if it had been rendering since:
+  // its breathing clock, sequence, phases, read position and start ramp.
+  // Lets VoiceMixNode bring voices it did not render during a replay to the
+  // replay's position before it falls back to them, fading them in itself.
+  // 0 cancels a pending seek.
+  void seekVoice(uint64_t frames) { pendingSeek_.store(frames, std::memory_order_relaxed); }
+
+  // Quality to render the next block at, set by the mixer from its
+  // QualityGovernor before each chunk and back to Full when the voice leaves
+  // it. Voices read it once per block.
+  void setQualityTier(QualityTier tier) { qualityTier_.store(tier, std::memory_order_relaxed); }
+  QualityTier getQualityTier() const { return qualityTier_.load(std::memory_order_relaxed); }
+
+  // The Martigli animation value of AnimationValueRegistry, for voices that
+  // follow it (Binaural with panOsc 3). Inside a mixer, the value the mixer
+  // read before the chunk: a Martigli voice of the same chunk may be writing
+  // the registry from another worker, and the voices must render the same
+  // whether in parallel or serially. Outside a mixer, the registry's.
+  void setMartigliSnapshot(float value) {
+    martigliSnapshot_.store(value, std::memory_order_relaxed);
+    hasMartigliSnapshot_.store(true, std::memory_order_relaxed);
+  }
+  void clearMartigliSnapshot() { hasMartigliSnapshot_.store(false, std::memory_order_relaxed); }
+  float getMartigliAnimationValue() const {
+    return hasMartigliSnapshot_.load(std::memory_order_relaxed)
+        ? martigliSnapshot_.load(std::memory_order_relaxed)
+        : AnimationValueRegistry::getInstance().getMartigliAnimationValue();
+  }
+
+protected:
+  // The pending seekVoice() frames, cleared; audio thread
+  uint64_t takePendingSeek() { return pendingSeek_.exchange(0, std::memory_order_relaxed); }
+
+  // FNV-1a, for renderKey()
+  static uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+private:
+  std::atomic<uint32_t> paramGeneration_{0};
+  std::atomic<QualityTier> qualityTier_{QualityTier::Full};
+  std::atomic<uint64_t> pendingSeek_{0};
+  std::atomic<float> martigliSnapshot_{0.0f};
+  std::atomic<bool> hasMartigliSnapshot_{false};
+  ModulationPorts modulation_;
+};
+
+// Implemented by the host objects of voice nodes, so JS can hand a node to a
+// VoiceMixNode without the mixer knowing every concrete host object type.
+class VoiceHostObject {
+public:
+  virtual ~VoiceHostObject() = default;
+  virtual std::shared_ptr<VoiceRenderer> getVoiceRenderer() const = 0;
+};
+
+} // namespace audioapi